@@ -316,6 +316,31 @@
  *
  *****************************************************************************/
 
+/**************************************************************************//**
+ * @def EFM8PDL_SMB0_USE_QUEUE
+ * @brief Controls inclusion of the queued master transaction API.
+ *
+ * When '1' master transactions described by @ref SMB0_Transaction_t can be
+ * queued with SMB0_queueTransaction(). Queued transactions are started back
+ * to back from the SMB0 ISR, so a sequence of register reads from several
+ * slaves completes without any foreground involvement. Requires
+ * EFM8PDL_SMB0_USE_BUFFER.
+ *
+ * Default setting is '0' and may be overridden by defining in 'efm8_config.h'.
+ *
+ *****************************************************************************/
+
+/**************************************************************************//**
+ * @def EFM8PDL_SMB0_QUEUE_DEPTH
+ * @brief Number of transactions that may be queued at one time.
+ *
+ * Must be a power of two no larger than 128. The queue only stores
+ * pointers to the caller's transaction descriptors.
+ *
+ * Default setting is 4 and may be overridden by defining in 'efm8_config.h'.
+ *
+ *****************************************************************************/
+
 /**  @} (end addtogroup smb_config_buffered Buffered API Options) */
 /**  @} (end addtogroup smb_config Driver Configuration) */
 
@@ -398,6 +423,20 @@
 
 #endif
 
+#ifndef EFM8PDL_SMB0_USE_QUEUE
+  #define EFM8PDL_SMB0_USE_QUEUE 0
+#endif
+#ifndef EFM8PDL_SMB0_QUEUE_DEPTH
+  #define EFM8PDL_SMB0_QUEUE_DEPTH 4
+#endif
+
+#if ((EFM8PDL_SMB0_USE_QUEUE == 1) && (EFM8PDL_SMB0_USE_BUFFER == 0))
+#error("EFM8PDL_SMB0_USE_QUEUE requires EFM8PDL_SMB0_USE_BUFFER.")
+#endif
+#if ((EFM8PDL_SMB0_QUEUE_DEPTH & (EFM8PDL_SMB0_QUEUE_DEPTH - 1)) || (EFM8PDL_SMB0_QUEUE_DEPTH > 128))
+#error("EFM8PDL_SMB0_QUEUE_DEPTH must be a power of two no larger than 128.")
+#endif
+
 /***************************************************************************//**
  *  @addtogroup smb0_if Status Flag Enums
  *  @{
@@ -786,6 +825,118 @@ uint8_t SMB0_getCommandLength();
 void SMB0_sendResponse(SI_VARIABLE_SEGMENT_POINTER(dataBuffer, uint8_t, EFM8PDL_SMB0_TX_BUFTYPE),
                       uint8_t length);
 
+#if (EFM8PDL_SMB0_USE_QUEUE == 1) || IS_DOXYGEN
+/***************************************************************************//**
+ * @addtogroup smb0_queue SMB0 Transaction Queue API
+ * @{
+ *
+ * Master transactions described by an @ref SMB0_Transaction_t are queued with
+ * SMB0_queueTransaction() and run back to back from the SMB0 ISR. A
+ * transaction with both a write and a read phase issues a repeated start
+ * between them, which is the usual register read sequence. When a
+ * transaction finishes its status is stored in the descriptor and its
+ * _complete_ callback, if any, is called in interrupt context before the
+ * next queued transaction is started.
+ *
+ * Queued transactions do not call SMB0_transferCompleteCb() or
+ * SMB0_errorCb(). SMB0_transfer() must not be called while queued
+ * transactions are pending.
+ *
+ * The descriptors are owned by the caller and must stay valid until they
+ * have completed.
+ *
+ * __Example__
+ *
+ * ~~~~~~~~.c
+ * SI_SEGMENT_VARIABLE(tempReg, uint8_t, SI_SEG_XDATA) = 0x00;
+ * SI_SEGMENT_VARIABLE(temp[2], uint8_t, SI_SEG_XDATA);
+ * SI_SEGMENT_VARIABLE(humReg, uint8_t, SI_SEG_XDATA) = 0xE5;
+ * SI_SEGMENT_VARIABLE(hum[2], uint8_t, SI_SEG_XDATA);
+ *
+ * SI_SEGMENT_VARIABLE(tempTxn, SMB0_Transaction_t, SI_SEG_XDATA) =
+ *   {0x90, &tempReg, temp, 1, 2, SMB0_TXN_DONE, NULL};
+ * SI_SEGMENT_VARIABLE(humTxn, SMB0_Transaction_t, SI_SEG_XDATA) =
+ *   {0x80, &humReg, hum, 1, 2, SMB0_TXN_DONE, sweepDone};
+ *
+ * // Both sensors are read without waking the foreground
+ * SMB0_queueTransaction(&tempTxn);
+ * SMB0_queueTransaction(&humTxn);
+ * ~~~~~~~~
+ *
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * @brief
+ * Status of a queued transaction.
+ *
+ ******************************************************************************/
+typedef enum
+{
+  SMB0_TXN_PENDING  = 0x00,   ///< Queued or in progress
+  SMB0_TXN_DONE     = 0x01,   ///< All bytes were written and read
+  SMB0_TXN_NACK     = 0x02,   ///< The slave NACKed its address or a written byte
+  SMB0_TXN_ARBLOST  = 0x03,   ///< Arbitration lost on EFM8PDL_SMB0_MASTER_RETRIES consecutive attempts
+  SMB0_TXN_ABORTED  = 0x04,   ///< Discarded by SMB0_abortTransfer()
+} SMB0_TransactionStatus_t;
+
+/***************************************************************************//**
+ * @brief
+ * Description of one queued master transaction.
+ *
+ * At least one of _txLength_ and _rxLength_ must be non-zero. The write phase
+ * runs first, followed by a repeated start and the read phase.
+ *
+ ******************************************************************************/
+typedef struct SMB0_Transaction
+{
+  /// Slave address with the R/W bit cleared.
+  uint8_t address;
+  /// Data to write, or NULL if _txLength_ is 0.
+  SI_VARIABLE_SEGMENT_POINTER(pTxBuffer, uint8_t, EFM8PDL_SMB0_TX_BUFTYPE);
+  /// Buffer for read data, or NULL if _rxLength_ is 0.
+  SI_VARIABLE_SEGMENT_POINTER(pRxBuffer, uint8_t, EFM8PDL_SMB0_RX_BUFTYPE);
+  uint8_t txLength;                 ///< Number of bytes to write.
+  uint8_t rxLength;                 ///< Number of bytes to read.
+  SMB0_TransactionStatus_t status;  ///< Set by the driver.
+  /// Called from the ISR when the transaction has finished, or NULL.
+  void (*complete)(SI_VARIABLE_SEGMENT_POINTER(txn, struct SMB0_Transaction,
+                                               SI_SEG_XDATA));
+} SMB0_Transaction_t;
+
+/***************************************************************************//**
+ * @brief
+ * Queue a master transaction.
+ *
+ * @param txn:
+ * The transaction to run. Its status is set to SMB0_TXN_PENDING.
+ *
+ * @return
+ * True if the transaction was queued, or false if the queue is full.
+ *
+ * The transaction starts immediately if the queue is idle and the bus is
+ * free. Otherwise it starts from the ISR as soon as the transactions ahead
+ * of it, or the slave transfer in progress, have finished.
+ *
+ ******************************************************************************/
+bool SMB0_queueTransaction(SI_VARIABLE_SEGMENT_POINTER(txn, SMB0_Transaction_t,
+                                                       SI_SEG_XDATA));
+
+/***************************************************************************//**
+ * @brief
+ * Get the number of queued transactions that have not finished.
+ *
+ * @return
+ * Count of pending transactions, including the one in progress.
+ *
+ * SMB0_abortTransfer() sets all pending transactions to SMB0_TXN_ABORTED
+ * without calling their callbacks.
+ *
+ ******************************************************************************/
+uint8_t SMB0_getQueueCount();
+
+/**  @} (end addtogroup smb0_queue SMB0 Transaction Queue API) */
+#endif //EFM8PDL_SMB0_USE_QUEUE
+
 #endif //EFM8PDL_SMB0_USE_BUFFER
 /**  @} (end addtogroup smb0_buffered SMB0 Buffered API) */
 
@@ -258,6 +258,78 @@ SI_SEGMENT_VARIABLE(smbReq, bool, SI_SEG_DATA);
 SI_SEGMENT_VARIABLE(smbReceive, bool, SI_SEG_DATA);
 SI_SEGMENT_VARIABLE(mRetries, uint8_t, SI_SEG_XDATA);
 
+#if EFM8PDL_SMB0_USE_QUEUE == 1
+// Pending transactions. The foreground only advances queueHead and the
+// ISR only advances queueTail. The entry at queueTail is the one in
+// progress while txnActive is set.
+SI_SEGMENT_VARIABLE_SEGMENT_POINTER(txnQueue[EFM8PDL_SMB0_QUEUE_DEPTH],
+                                    static SMB0_Transaction_t,
+                                    SI_SEG_XDATA, SI_SEG_XDATA);
+static volatile uint8_t queueHead = 0;
+static volatile uint8_t queueTail = 0;
+SI_SEGMENT_VARIABLE(txnActive, bool, SI_SEG_DATA);
+
+// Finish the transaction at the tail of the queue. Only called from the
+// ISR. Returns true if another transaction is waiting to start.
+static bool SMB0_retireQueued(SMB0_TransactionStatus_t status)
+{
+  SI_VARIABLE_SEGMENT_POINTER(txn, SMB0_Transaction_t, SI_SEG_XDATA);
+
+  txn = txnQueue[queueTail & (EFM8PDL_SMB0_QUEUE_DEPTH - 1)];
+  ++queueTail;
+  txnActive = false;
+
+  txn->status = status;
+  if (txn->complete)
+  {
+    txn->complete(txn);
+  }
+  return queueHead != queueTail;
+}
+
+bool SMB0_queueTransaction(SI_VARIABLE_SEGMENT_POINTER(txn, SMB0_Transaction_t,
+                                                       SI_SEG_XDATA))
+{
+  uint8_t head = queueHead;
+  bool ea;
+  DECL_PAGE;
+
+  if ((uint8_t)(head - queueTail) >= EFM8PDL_SMB0_QUEUE_DEPTH)
+  {
+    return false;
+  }
+
+  txn->status = SMB0_TXN_PENDING;
+  txnQueue[head & (EFM8PDL_SMB0_QUEUE_DEPTH - 1)] = txn;
+
+  // Publish the entry and decide whether the queue needs a kick without
+  // the ISR retiring the last transaction in between.
+  ea = IE_EA;
+  IE_EA = 0;
+  queueHead = head + 1;
+  if (head == queueTail)
+  {
+    SET_PAGE(0x00);
+    if (smbBusy)
+    {
+      smbReq = true;
+    }
+    else
+    {
+      SMB0CN0_STA = 1;
+    }
+    RESTORE_PAGE;
+  }
+  IE_EA = ea;
+  return true;
+}
+
+uint8_t SMB0_getQueueCount()
+{
+  return queueHead - queueTail;
+}
+#endif // EFM8PDL_SMB0_USE_QUEUE
+
 void SMB0_transfer(uint8_t address,
     SI_VARIABLE_SEGMENT_POINTER(txBuffer, uint8_t, EFM8PDL_SMB0_TX_BUFTYPE),
     SI_VARIABLE_SEGMENT_POINTER(rxBuffer, uint8_t, EFM8PDL_SMB0_RX_BUFTYPE),
@@ -290,6 +362,16 @@ void SMB0_abortTransfer(){
   
   smbBusy = false;
   smbReq = false;
+
+#if EFM8PDL_SMB0_USE_QUEUE == 1
+  // Drop all queued transactions. Completion callbacks are not called.
+  while (queueTail != queueHead)
+  {
+    txnQueue[queueTail & (EFM8PDL_SMB0_QUEUE_DEPTH - 1)]->status = SMB0_TXN_ABORTED;
+    ++queueTail;
+  }
+  txnActive = false;
+#endif
 }
 
 uint8_t SMB0_txBytesRemaining() {
@@ -336,6 +418,26 @@ SI_INTERRUPT(SMB0_ISR, SMBUS0_IRQn)
   {
   // Master Transmitter/Receiver: START condition transmitted.
   case SMB0_MASTER_START:
+#if EFM8PDL_SMB0_USE_QUEUE == 1
+    // A start that is not a repeated start begins the transaction at the
+    // tail of the queue, or retries it after an arbitration loss.
+    if (!smbBusy && (queueHead != queueTail))
+    {
+      SI_VARIABLE_SEGMENT_POINTER(txn, SMB0_Transaction_t, SI_SEG_XDATA);
+
+      txn = txnQueue[queueTail & (EFM8PDL_SMB0_QUEUE_DEPTH - 1)];
+      mAddress = txn->address;
+      mTxBuffer = txn->pTxBuffer;
+      mRxBuffer = txn->pRxBuffer;
+      mTxCount = txn->txLength;
+      mRxCount = txn->rxLength;
+      if (!txnActive)
+      {
+        mRetries = EFM8PDL_SMB0_MASTER_RETRIES;
+        txnActive = true;
+      }
+    }
+#endif
     //Send address. If no tx data then initiate read.
     // Must make a single access to SMB0DAT because it's a fifo and
     // = follwed by |= writes to two slots in the fifo.
@@ -390,6 +492,16 @@ SI_INTERRUPT(SMB0_ISR, SMBUS0_IRQn)
           {
             //if tx done and no rx then stop
             //tailchain: stop_seq
+#if EFM8PDL_SMB0_USE_QUEUE == 1
+            if (txnActive)
+            {
+              if (SMB0_retireQueued(SMB0_TXN_DONE))
+              {
+                smbReq = true;
+              }
+            }
+            else
+#endif
             SMB0_transferCompleteCb();
             SMB0CN0_STO = 1;
             SMB0CN0_STA = smbReq;
@@ -402,6 +514,16 @@ SI_INTERRUPT(SMB0_ISR, SMBUS0_IRQn)
     else
     {
       //Error on NAC
+#if EFM8PDL_SMB0_USE_QUEUE == 1
+      if (txnActive)
+      {
+        if (SMB0_retireQueued(SMB0_TXN_NACK))
+        {
+          smbReq = true;
+        }
+      }
+      else
+#endif
       SMB0_errorCb(SMB0_NACK_ERROR);
 
       //tailchain: stop_seq
@@ -433,6 +555,16 @@ SI_INTERRUPT(SMB0_ISR, SMBUS0_IRQn)
 
       // If no bytes remain notify user xfer complete and issue stop.
       //tailchain: stop_seq
+#if EFM8PDL_SMB0_USE_QUEUE == 1
+      if (txnActive)
+      {
+        if (SMB0_retireQueued(SMB0_TXN_DONE))
+        {
+          smbReq = true;
+        }
+      }
+      else
+#endif
       SMB0_transferCompleteCb();
       SMB0CN0_STO = 1;
       SMB0CN0_STA = smbReq;
@@ -464,6 +596,12 @@ SI_INTERRUPT(SMB0_ISR, SMBUS0_IRQn)
       {
         smbReq = true;
       }
+#if EFM8PDL_SMB0_USE_QUEUE == 1
+      else if (txnActive)
+      {
+        smbReq = SMB0_retireQueued(SMB0_TXN_ARBLOST);
+      }
+#endif
       else
       {
         SMB0_errorCb(SMB0_ARBLOST_ERROR);
@@ -302,6 +302,216 @@ void PCA0_resetChannel(PCA0_Channel_t channel)
   RESTORE_PAGE;
 }
 
+#if EFM8PDL_PCA0_USE_CAPTURE == 1
+#define NUM_CAPTURE_CHANNELS 3
+#define CAPTURE_MASK (EFM8PDL_PCA0_CAPTURE_FIFO_SIZE - 1)
+
+// One FIFO per channel. The ISR only advances captureHead and the
+// foreground only advances captureTail.
+SI_SEGMENT_VARIABLE(captureFifo[NUM_CAPTURE_CHANNELS][EFM8PDL_PCA0_CAPTURE_FIFO_SIZE],
+                    static PCA0_Capture_t, SI_SEG_XDATA);
+static volatile uint8_t captureHead[NUM_CAPTURE_CHANNELS];
+static volatile uint8_t captureTail[NUM_CAPTURE_CHANNELS];
+static uint8_t captureDropped[NUM_CAPTURE_CHANNELS];
+
+// Edges captured by each channel, 0 when the channel is not capturing
+static uint8_t captureEdges[NUM_CAPTURE_CHANNELS];
+
+// Bit n set when the next edge of channel n in both-edge mode is falling
+static uint8_t captureFalling;
+
+// Upper 16 bits of the extended counter
+static uint16_t overflowCount;
+
+// Reference edge for PCA0_readPeriod(), valid when bit n of
+// periodValid is set
+SI_SEGMENT_VARIABLE(periodStart[NUM_CAPTURE_CHANNELS], static uint32_t, SI_SEG_XDATA);
+static uint8_t periodValid;
+
+// Store a capture. Only called from the ISR. wrapped is set when a counter
+// overflow is pending that has not yet been added to overflowCount.
+static void PCA0_pushCapture(uint8_t channel, uint16_t value, bool wrapped)
+{
+  SI_VARIABLE_SEGMENT_POINTER(record, PCA0_Capture_t, SI_SEG_XDATA);
+  uint8_t head = captureHead[channel];
+  uint8_t edge = captureEdges[channel];
+  uint16_t high = overflowCount;
+
+  if (edge == PCA0_CAPTURE_BOTH)
+  {
+    edge = (captureFalling & (1 << channel)) ? PCA0_CAPTURE_FALLING
+                                             : PCA0_CAPTURE_RISING;
+    captureFalling ^= (1 << channel);
+  }
+
+  if ((uint8_t)(head - captureTail[channel]) >= EFM8PDL_PCA0_CAPTURE_FIFO_SIZE)
+  {
+    if (captureDropped[channel] != 0xFF)
+    {
+      captureDropped[channel]++;
+    }
+    return;
+  }
+
+  // The pending overflow only applies if the capture was taken after the
+  // counter wrapped, in which case its value is still small
+  if (wrapped && !(value & 0x8000))
+  {
+    high++;
+  }
+
+  record = &captureFifo[channel][head & CAPTURE_MASK];
+  record->timestamp = ((uint32_t)high << 16) | value;
+  record->channel = channel;
+  record->edge = edge;
+  record->dropped = captureDropped[channel];
+  captureDropped[channel] = 0;
+  captureHead[channel] = head + 1;
+}
+
+// Level of a channel's input pin, read through the port pin named in
+// efm8_config.h. A channel without a named pin reads as low.
+static bool PCA0_readCapturePin(uint8_t channel)
+{
+  switch (channel)
+  {
+#ifdef EFM8PDL_PCA0_CEX0_PIN
+  case 0:
+    return EFM8PDL_PCA0_CEX0_PIN;
+#endif
+#ifdef EFM8PDL_PCA0_CEX1_PIN
+  case 1:
+    return EFM8PDL_PCA0_CEX1_PIN;
+#endif
+#ifdef EFM8PDL_PCA0_CEX2_PIN
+  case 2:
+    return EFM8PDL_PCA0_CEX2_PIN;
+#endif
+  default:
+    return false;
+  }
+}
+
+void PCA0_startCapture(PCA0_Channel_t channel, PCA0_CaptureEdge_t edges)
+{
+  uint8_t mode = edges | PCA0CPM0_ECCF__BMASK;
+  DECL_PAGE;
+
+  SLAB_ASSERT(channel < NUM_CAPTURE_CHANNELS);
+
+  SET_PAGE(0x00);
+  PCA0_resetChannel(channel);
+  PCA0CN0 &= ~(PCA0CN0_CCF0__BMASK << channel);
+
+  captureHead[channel] = 0;
+  captureTail[channel] = 0;
+  captureDropped[channel] = 0;
+  captureEdges[channel] = edges;
+  // In both-edge mode the first edge leaves the level the pin has now
+  captureFalling &= ~(1 << channel);
+  if (PCA0_readCapturePin(channel))
+  {
+    captureFalling |= (1 << channel);
+  }
+  periodValid &= ~(1 << channel);
+
+  PCA0MD |= PCA0MD_ECF__BMASK;
+  switch (channel)
+  {
+  case 0:
+    PCA0CPM0 = mode;
+    break;
+  case 1:
+    PCA0CPM1 = mode;
+    break;
+  case 2:
+    PCA0CPM2 = mode;
+    break;
+  }
+  RESTORE_PAGE;
+}
+
+void PCA0_stopCapture(PCA0_Channel_t channel)
+{
+  DECL_PAGE;
+  SET_PAGE(0x00);
+  PCA0_resetChannel(channel);
+  captureEdges[channel] = 0;
+  RESTORE_PAGE;
+}
+
+bool PCA0_readCapture(PCA0_Channel_t channel,
+                      SI_VARIABLE_SEGMENT_POINTER(record, PCA0_Capture_t, SI_SEG_GENERIC))
+{
+  uint8_t tail = captureTail[channel];
+
+  if (tail == captureHead[channel])
+  {
+    return false;
+  }
+  *record = captureFifo[channel][tail & CAPTURE_MASK];
+  captureTail[channel] = tail + 1;
+  return true;
+}
+
+uint8_t PCA0_getCaptureCount(PCA0_Channel_t channel)
+{
+  return captureHead[channel] - captureTail[channel];
+}
+
+bool PCA0_readPeriod(PCA0_Channel_t channel,
+                     SI_VARIABLE_SEGMENT_POINTER(period, uint32_t, SI_SEG_GENERIC))
+{
+  PCA0_Capture_t record;
+  uint32_t start;
+  uint8_t intervals = 0;
+  uint8_t mask = 1 << channel;
+  uint8_t edge = (captureEdges[channel] == PCA0_CAPTURE_FALLING)
+                 ? PCA0_CAPTURE_FALLING : PCA0_CAPTURE_RISING;
+
+  start = periodStart[channel];
+  while (PCA0_readCapture(channel, &record))
+  {
+    if (record.dropped)
+    {
+      // Edges were lost, measure from the next edge instead
+      periodValid &= ~mask;
+      intervals = 0;
+    }
+    if (record.edge != edge)
+    {
+      continue;
+    }
+    if (periodValid & mask)
+    {
+      intervals++;
+    }
+    else
+    {
+      start = record.timestamp;
+      periodValid |= mask;
+    }
+    periodStart[channel] = record.timestamp;
+  }
+
+  if (!intervals)
+  {
+    return false;
+  }
+  *period = (periodStart[channel] - start + (intervals >> 1)) / intervals;
+  return true;
+}
+
+uint32_t PCA0_getFrequency(uint32_t period, uint32_t pcaClock)
+{
+  if (!period)
+  {
+    return 0;
+  }
+  return (pcaClock + (period >> 1)) / period;
+}
+#endif //EFM8PDL_PCA0_USE_CAPTURE
+
 #if EFM8PDL_PCA0_USE_ISR == 1
 
 SI_INTERRUPT(PCA0_ISR, PCA0_IRQn)
@@ -310,11 +520,11 @@ SI_INTERRUPT(PCA0_ISR, PCA0_IRQn)
   uint8_t flags;
   SFRPAGE = 0x00;  //Rely on SI_SFR page stack
 
-  flags = PCA0CN0;
-  PCA0CN0 &= ~(PCA0CN0_CF__BMASK
-              | PCA0CN0_CCF0__BMASK
-              | PCA0CN0_CCF1__BMASK
-              | PCA0CN0_CCF2__BMASK);
+  flags = PCA0CN0 & (PCA0CN0_CF__BMASK
+                     | PCA0CN0_CCF0__BMASK
+                     | PCA0CN0_CCF1__BMASK
+                     | PCA0CN0_CCF2__BMASK);
+  PCA0CN0 &= ~flags;
 
   if( (PCA0PWM & PCA0PWM_COVF__BMASK)
       && (PCA0PWM & PCA0PWM_ECOV__BMASK))
@@ -331,18 +541,48 @@ SI_INTERRUPT(PCA0_ISR, PCA0_IRQn)
   if((flags & PCA0CN0_CCF0__BMASK)
      && (PCA0CPM0 & PCA0CPM0_ECCF__BMASK))
   {
+#if EFM8PDL_PCA0_USE_CAPTURE == 1
+    if (captureEdges[0])
+    {
+      PCA0_pushCapture(0, PCA0CPL0 | (PCA0CPH0 << 8), flags & PCA0CN0_CF__BMASK);
+    }
+    else
+#endif
     PCA0_channel0EventCb();
   }
   if((flags & PCA0CN0_CCF1__BMASK)
     && (PCA0CPM1 & PCA0CPM1_ECCF__BMASK))
   {
+#if EFM8PDL_PCA0_USE_CAPTURE == 1
+    if (captureEdges[1])
+    {
+      PCA0_pushCapture(1, PCA0CPL1 | (PCA0CPH1 << 8), flags & PCA0CN0_CF__BMASK);
+    }
+    else
+#endif
     PCA0_channel1EventCb();
   }
   if((flags & PCA0CN0_CCF2__BMASK)
       && (PCA0CPM2 & PCA0CPM2_ECCF__BMASK))
   {
+#if EFM8PDL_PCA0_USE_CAPTURE == 1
+    if (captureEdges[2])
+    {
+      PCA0_pushCapture(2, PCA0CPL2 | (PCA0CPH2 << 8), flags & PCA0CN0_CF__BMASK);
+    }
+    else
+#endif
     PCA0_channel2EventCb();
   }
+
+#if EFM8PDL_PCA0_USE_CAPTURE == 1
+  // Counted after the captures so they can tell which side of the
+  // overflow they were taken on
+  if (flags & PCA0CN0_CF__BMASK)
+  {
+    overflowCount++;
+  }
+#endif
 }
 
 #endif //EFM8PDL_PCA0_USE_CALLBACKS
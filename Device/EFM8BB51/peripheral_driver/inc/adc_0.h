@@ -422,8 +422,15 @@ void ADC0_init(ADC0_ConversionStart_t convStart,
 *  - \b ADC0_WINDOW_COMPARE_IF - Interrupt flag for when a newly completed
 *    conversion falls outside the set compare window.
 *
+ * @note This function is implemented as a macro if EFM8PDL_ADC0_AUTO_PAGE
+ * is 0.
 ******************************************************************************/
+#if defined(IS_DOXYGEN) || (EFM8PDL_ADC0_AUTO_PAGE == 1)
 uint8_t ADC0_getIntFlags(void);
+#else
+#define ADC0_getIntFlags(x)                                                   \
+            (ADC0CN0 & (ADC0_CONVERSION_COMPLETE_IF | ADC0_WINDOW_COMPARE_IF))
+#endif
 
 /***************************************************************************//**
 * @brief
@@ -437,8 +444,16 @@ uint8_t ADC0_getIntFlags(void);
 *  - \b ADC0_WINDOW_COMPARE_IF - Interrupt flag for when a newly completed
 *    conversion falls outside the set compare window.
 *
+ * @note This function is implemented as a macro if EFM8PDL_ADC0_AUTO_PAGE
+ * is 0.
 ******************************************************************************/
+#if defined(IS_DOXYGEN) || (EFM8PDL_ADC0_AUTO_PAGE == 1)
 void ADC0_clearIntFlags(uint8_t flags);
+#else
+#define ADC0_clearIntFlags(flags)                                             \
+            do {ADC0CN0 &= ~((flags) & (ADC0_CONVERSION_COMPLETE_IF            \
+                                        | ADC0_WINDOW_COMPARE_IF));} while (0)
+#endif
 
 /***************************************************************************//**
 * @brief
@@ -465,8 +480,14 @@ void ADC0_enableInt(uint8_t flags, bool enable);
 *
 * The ADC will be enabled, allowing conversion triggers to start a conversion.
 *
+ * @note This function is implemented as a macro if EFM8PDL_ADC0_AUTO_PAGE
+ * is 0.
 ******************************************************************************/
+#if defined(IS_DOXYGEN) || (EFM8PDL_ADC0_AUTO_PAGE == 1)
 void ADC0_enable(void);
+#else
+#define ADC0_enable(x) do {ADC0CN0_ADEN = 1;} while (0)
+#endif
 
 /***************************************************************************//**
 * @brief
@@ -475,8 +496,14 @@ void ADC0_enable(void);
 * The ADC will be immediately disabled. If an ADC conversion is in progress,
 * it will be aborted.
 *
+ * @note This function is implemented as a macro if EFM8PDL_ADC0_AUTO_PAGE
+ * is 0.
 ******************************************************************************/
+#if defined(IS_DOXYGEN) || (EFM8PDL_ADC0_AUTO_PAGE == 1)
 void ADC0_disable(void);
+#else
+#define ADC0_disable(x) do {ADC0CN0_ADEN = 0;} while (0)
+#endif
 
 /// Positive input selection enums.
 typedef enum {
@@ -538,8 +565,14 @@ void ADC0_startConversion(void);
 *      will cause the function to return **false**, even if a conversion has been 
 *      completed.
 *
+ * @note This function is implemented as a macro if EFM8PDL_ADC0_AUTO_PAGE
+ * is 0.
 ******************************************************************************/
+#if defined(IS_DOXYGEN) || (EFM8PDL_ADC0_AUTO_PAGE == 1)
 bool ADC0_isConversionComplete(void);
+#else
+#define ADC0_isConversionComplete(x) ((bool)ADC0CN0_ADINT)
+#endif
 
 /***************************************************************************//**
 * @brief
@@ -550,8 +583,14 @@ bool ADC0_isConversionComplete(void);
 * This reads from the ADC's result registers. If no conversion was performed
 * since the last call, the previous conversion will be returned.
 *
+ * @note This function is implemented as a macro if EFM8PDL_ADC0_AUTO_PAGE
+ * is 0.
 ******************************************************************************/
+#if defined(IS_DOXYGEN) || (EFM8PDL_ADC0_AUTO_PAGE == 1)
 uint16_t ADC0_getResult(void);
+#else
+#define ADC0_getResult(x) ((uint16_t)ADC0)
+#endif
 
 /***************************************************************************//**
 * @brief
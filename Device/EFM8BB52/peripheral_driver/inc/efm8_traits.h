@@ -0,0 +1,41 @@
+/**************************************************************************//**
+ * Copyright (c) 2015 by Silicon Laboratories Inc. All rights reserved.
+ *
+ * http://developer.silabs.com/legal/version/v11/Silicon_Labs_Software_License_Agreement.txt
+ *****************************************************************************/
+
+#ifndef __EFM8_TRAITS_H__
+#define __EFM8_TRAITS_H__
+
+#include "SI_EFM8BB52_Register_Enums.h"
+
+/**************************************************************************//**
+ * @addtogroup efm8_traits EFM8BB52 Device Traits
+ * @{
+ *
+ * @brief
+ *   Compile-time description of the EFM8BB52 peripheral set.
+ *
+ * Drivers shared by all EFM8 devices (Device/shared/peripheral_driver) use
+ * these values to select SFR pages and code paths with the preprocessor, so
+ * a build only contains the variant the silicon supports.
+ *
+ *****************************************************************************/
+
+// UART1
+#define EFM8_UART1_SFR_PAGE      0x20          ///< UART1 SFR page
+#define EFM8_UART1_HAS_FIFO      1             ///< UART1 has TX/RX FIFOs
+#define EFM8_UART1_FIFO_DEPTH    1             ///< UART1 FIFO depth in bytes
+#define EFM8_UART1_IRQn          UART1_IRQn    ///< UART1 interrupt number
+#define EFM8_UART1_INIT_RXSEL    1             ///< UART1 init functions take an rx pin select
+
+// SPI0
+#define EFM8_SPI0_FIFO_DEPTH     2             ///< SPI0 FIFO depth in bytes
+
+// WDT0
+#define EFM8_WDT0_USES_PCA       0             ///< WDT0 is the dedicated WDTCN timer
+#define EFM8_WDT0_ERRATUM_E102   0             ///< WDT0 needs the WDT_E102 delay
+
+/** @} (end addtogroup efm8_traits EFM8BB52 Device Traits) */
+
+#endif //__EFM8_TRAITS_H__
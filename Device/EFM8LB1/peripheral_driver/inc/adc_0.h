@@ -324,6 +324,32 @@
  * Default setting is '1' and may be overridden by defining in 'efm8_config.h'.
  *
  *****************************************************************************/
+
+ /**************************************************************************//**
+ * @def EFM8PDL_ADC0_USE_STREAM
+ * @brief Controls inclusion of the Autoscan Streaming API.
+ *
+ * When '1', the driver provides the ADC0EOC interrupt handler and the
+ * ADC0_startStream() family of functions, which keep Autoscan running
+ * continuously over a set of buffers. Requires EFM8PDL_ADC0_USE_AUTOSCAN.
+ *
+ * Default setting is '0' and may be overridden by defining in 'efm8_config.h'.
+ *
+ *****************************************************************************/
+
+ /**************************************************************************//**
+ * @def EFM8PDL_ADC0_USE_DECIMATOR
+ * @brief Controls inclusion of the software decimation stage.
+ *
+ * When '1', the driver provides the ADC0EOC interrupt handler, which sums
+ * the hardware accumulated results set up by ADC0_initOversampled() and
+ * passes each decimated result to ADC0_oversampleCompleteCb(). This allows
+ * oversampling factors above the hardware repeat count of 32. Requires
+ * EFM8PDL_ADC0_USE_INIT and cannot be combined with EFM8PDL_ADC0_USE_STREAM.
+ *
+ * Default setting is '0' and may be overridden by defining in 'efm8_config.h'.
+ *
+ *****************************************************************************/
 /**  @} (end addtogroup adc_config Driver Configuration) */
 
 #ifndef IS_DOXYGEN
@@ -342,6 +368,26 @@
  #define EFM8PDL_ADC0_USE_AUTOSCAN 1
 #endif
 
+#ifndef EFM8PDL_ADC0_USE_STREAM
+ #define EFM8PDL_ADC0_USE_STREAM 0
+#endif
+
+#if (EFM8PDL_ADC0_USE_STREAM == 1) && (EFM8PDL_ADC0_USE_AUTOSCAN == 0)
+ #error "EFM8PDL_ADC0_USE_STREAM requires EFM8PDL_ADC0_USE_AUTOSCAN"
+#endif
+
+#ifndef EFM8PDL_ADC0_USE_DECIMATOR
+ #define EFM8PDL_ADC0_USE_DECIMATOR 0
+#endif
+
+#if (EFM8PDL_ADC0_USE_DECIMATOR == 1) && (EFM8PDL_ADC0_USE_INIT == 0)
+ #error "EFM8PDL_ADC0_USE_DECIMATOR requires EFM8PDL_ADC0_USE_INIT"
+#endif
+
+#if (EFM8PDL_ADC0_USE_DECIMATOR == 1) && (EFM8PDL_ADC0_USE_STREAM == 1)
+ #error "EFM8PDL_ADC0_USE_DECIMATOR and EFM8PDL_ADC0_USE_STREAM both use the ADC0EOC interrupt. Disable one."
+#endif
+
 // Initialization API
 /**************************************************************************//**
  * @addtogroup adc0_init ADC0 Initialization API
@@ -423,8 +469,15 @@ void ADC0_init(ADC0_ConversionStart_t convStart,
  *  - \b ADC0_WINDOW_COMPARE_IF - Interrupt flag for when a newly completed
  *    conversion falls outside the set compare window.
  *
+ * @note This function is implemented as a macro if EFM8PDL_ADC0_AUTO_PAGE
+ * is 0.
  ******************************************************************************/
- uint8_t ADC0_getIntFlags(void);
+#if defined(IS_DOXYGEN) || (EFM8PDL_ADC0_AUTO_PAGE == 1)
+uint8_t ADC0_getIntFlags(void);
+#else
+#define ADC0_getIntFlags(x)                                                   \
+            (ADC0CN0 & (ADC0_CONVERSION_COMPLETE_IF | ADC0_WINDOW_COMPARE_IF))
+#endif
 
 /***************************************************************************//**
  * @brief
@@ -438,8 +491,16 @@ void ADC0_init(ADC0_ConversionStart_t convStart,
  *  - \b ADC0_WINDOW_COMPARE_IF - Interrupt flag for when a newly completed
  *    conversion falls outside the set compare window.
  *
+ * @note This function is implemented as a macro if EFM8PDL_ADC0_AUTO_PAGE
+ * is 0.
  ******************************************************************************/
+#if defined(IS_DOXYGEN) || (EFM8PDL_ADC0_AUTO_PAGE == 1)
 void ADC0_clearIntFlags(uint8_t flags);
+#else
+#define ADC0_clearIntFlags(flags)                                             \
+            do {ADC0CN0 &= ~((flags) & (ADC0_CONVERSION_COMPLETE_IF            \
+                                        | ADC0_WINDOW_COMPARE_IF));} while (0)
+#endif
 
 /***************************************************************************//**
  * @brief
@@ -466,8 +527,14 @@ void ADC0_enableInt(uint8_t flags, bool enable);
  *
  * The ADC will be enabled, allowing conversion triggers to start a conversion.
  *
+ * @note This function is implemented as a macro if EFM8PDL_ADC0_AUTO_PAGE
+ * is 0.
  ******************************************************************************/
+#if defined(IS_DOXYGEN) || (EFM8PDL_ADC0_AUTO_PAGE == 1)
 void ADC0_enable(void);
+#else
+#define ADC0_enable(x) do {ADC0CN0_ADEN = 1;} while (0)
+#endif
 
  /***************************************************************************//**
  * @brief
@@ -476,8 +543,14 @@ void ADC0_enable(void);
  * The ADC will be immediately disabled. If an ADC conversion is in progress,
  * it will be aborted.
  *
+ * @note This function is implemented as a macro if EFM8PDL_ADC0_AUTO_PAGE
+ * is 0.
  ******************************************************************************/
+#if defined(IS_DOXYGEN) || (EFM8PDL_ADC0_AUTO_PAGE == 1)
 void ADC0_disable(void);
+#else
+#define ADC0_disable(x) do {ADC0CN0_ADEN = 0;} while (0)
+#endif
 
 /// Positive input selection enums.
 typedef enum {
@@ -546,8 +619,14 @@ void ADC0_startConversion(void);
  *      will cause the function to return **false**, even if a conversion has been 
  *      completed.
  *
+ * @note This function is implemented as a macro if EFM8PDL_ADC0_AUTO_PAGE
+ * is 0.
  ******************************************************************************/
+#if defined(IS_DOXYGEN) || (EFM8PDL_ADC0_AUTO_PAGE == 1)
 bool ADC0_isConversionComplete(void);
+#else
+#define ADC0_isConversionComplete(x) ((bool)ADC0CN0_ADINT)
+#endif
 
  /***************************************************************************//**
  * @brief
@@ -558,8 +637,14 @@ bool ADC0_isConversionComplete(void);
  * This reads from the ADC's result registers. If no conversion was performed
  * since the last call, the previous conversion will be returned.
  *
+ * @note This function is implemented as a macro if EFM8PDL_ADC0_AUTO_PAGE
+ * is 0.
  ******************************************************************************/
+#if defined(IS_DOXYGEN) || (EFM8PDL_ADC0_AUTO_PAGE == 1)
 uint16_t ADC0_getResult(void);
+#else
+#define ADC0_getResult(x) ((uint16_t)ADC0)
+#endif
 
  /***************************************************************************//**
  * @brief
@@ -584,6 +669,77 @@ uint16_t ADC0_getResult(void);
 void ADC0_setWindowCompare(uint16_t lessThan, uint16_t greaterThan);
 /** @} (end adc0_runtime Runtime API) */
 
+// Oversampling API
+/**************************************************************************//**
+ * @addtogroup adc0_oversample_api Oversampling API
+ * @{
+ *****************************************************************************/
+#if (EFM8PDL_ADC0_USE_INIT == 1) || IS_DOXYGEN
+
+ /***************************************************************************//**
+ * @brief
+ * Configure the ADC for hardware accumulated oversampling.
+ *
+ * @param channel:
+ * The input to oversample.
+ * @param factor:
+ * The number of conversions per result. Must be a power of two. Without
+ * EFM8PDL_ADC0_USE_DECIMATOR the valid values are 1, 4, 8, 16 and 32,
+ * otherwise up to 4096.
+ * @param outputBits:
+ * The width of each result, 10 to 16 bits. Each bit above the converter
+ * resolution needs four times as many conversions.
+ *
+ * ADC0_init() must be called first to set the clock and start-of-conversion
+ * source. This function selects the highest converter resolution that does
+ * not exceed outputBits, lets the hardware perform and accumulate up to 32
+ * conversions per trigger, and uses the right-justified accumulator shift to
+ * scale the sum. For example a factor of 16 at 14 bits yields 16-bit results
+ * with no CPU involvement per conversion.
+ *
+ * Without the decimator each trigger produces one result, read with
+ * ADC0_getOversampledResult(). With EFM8PDL_ADC0_USE_DECIMATOR the
+ * conversion complete interrupt is enabled and factors above 32 are summed
+ * in the ISR, which calls ADC0_oversampleCompleteCb() once per result.
+ *
+ ******************************************************************************/
+void ADC0_initOversampled(ADC0_PositiveInput_t channel,
+                          uint16_t factor,
+                          uint8_t outputBits);
+
+ /***************************************************************************//**
+ * @brief
+ * Get the result of an oversampled conversion.
+ *
+ * @return
+ * The accumulated result scaled to the outputBits passed to
+ * ADC0_initOversampled().
+ *
+ * Applies the part of the scaling that the accumulator shift cannot
+ * perform. Not used when EFM8PDL_ADC0_USE_DECIMATOR is '1'.
+ *
+ ******************************************************************************/
+uint16_t ADC0_getOversampledResult(void);
+
+#if (EFM8PDL_ADC0_USE_DECIMATOR == 1) || IS_DOXYGEN
+/***************************************************************************//**
+ * @brief
+ * Callback for a decimated result.
+ * @param result:
+ * The sum of all conversions scaled to outputBits.
+ *
+ * @warning
+ * This function is called from an ISR and should be as short as possible.
+ *
+ * This function is defined by the user and called by the peripheral driver
+ * when EFM8PDL_ADC0_USE_DECIMATOR is '1'.
+ *
+ ******************************************************************************/
+extern void ADC0_oversampleCompleteCb(uint16_t result);
+#endif //EFM8PDL_ADC0_USE_DECIMATOR
+#endif //EFM8PDL_ADC0_USE_INIT
+/** @} (end adc0_oversample_api Oversampling API) */
+
  /***************************************************************************//**
  * @addtogroup adc0_autoscan_api Autoscan API
  * @{
@@ -701,6 +857,131 @@ void ADC0_setNextAutoscanBuffer(const ADC0_AutoscanBuffer_t * buffer,
 void ADC0_disableAutoscan(void);
 
 /** @} (end addtogroup adc0_autoscan_api Autoscan API) */
+
+ /***************************************************************************//**
+ * @addtogroup adc0_stream_api Autoscan Streaming API
+ * @{
+ *
+ * These functions keep Autoscan running continuously over a block of
+ * equally sized buffers. Each time a scan completes the driver arms a free
+ * buffer for the scan after the one that has just started, so the converter
+ * never waits for software. Completed buffers are passed to
+ * ADC0_bufferReadyCb() in order.
+ *
+ * A buffer passed to the application is not reused until it is released.
+ * If no buffer is free when a scan completes, the samples of that scan are
+ * discarded, the buffer is re-armed and the dropped counter is incremented.
+ * Acquisition continues without a gap in either case.
+ *
+ * The Streaming API is available when EFM8PDL_ADC0_USE_STREAM is '1'. The
+ * driver then owns the ADC0EOC interrupt.
+ *
+ * ~~~~~.c
+ * #define SCAN_SAMPLES 32
+ * #define SCAN_BUFFERS 4
+ * ADC0_NEW_AUTOSCAN_BUFFER_ARRAY(streamBuf, SCAN_SAMPLES * SCAN_BUFFERS, 0x0000);
+ *
+ * // Two channels, converted back to back on each Timer 2 overflow
+ * ADC0_setAutoscanInputs(ADC0_POSITIVE_INPUT_P1, 2);
+ * ADC0_startStream(streamBuf, SCAN_BUFFERS, SCAN_SAMPLES);
+ *
+ * bool ADC0_bufferReadyCb(const ADC0_AutoscanBuffer_t * buffer)
+ * {
+ *   pending = buffer;   // processed and released by main()
+ *   return true;
+ * }
+ * ~~~~~
+ *
+ *****************************************************************************/
+#if (EFM8PDL_ADC0_USE_STREAM == 1) || IS_DOXYGEN
+
+/// ADC0 streaming statistics.
+typedef struct
+{
+  uint32_t buffers;  //!< Buffers passed to ADC0_bufferReadyCb().
+  uint32_t dropped;  //!< Completed scans discarded because no buffer was free.
+} ADC0_StreamStats_t;
+
+ /***************************************************************************//**
+ * @brief
+ * Start continuous Autoscan into a block of buffers.
+ * @param buffers:
+ * Start of a block of numBuffers * numElements samples in xdata. Must be
+ * aligned to an even address.
+ * @param numBuffers:
+ * The number of buffers in the block, 3 to 8. One is being filled, one is
+ * armed for the next scan and the rest are available to the application.
+ * @param numElements:
+ * The number of 16-bit samples in each buffer, max 64.
+ *
+ * The inputs and the start-of-conversion source must already be configured.
+ * The first scan fills the first buffer and starts on the next trigger.
+ * All buffers are owned by the driver and the statistics are not cleared.
+ *
+ ******************************************************************************/
+void ADC0_startStream(const ADC0_AutoscanBuffer_t * buffers,
+                      uint8_t numBuffers,
+                      uint8_t numElements);
+
+ /***************************************************************************//**
+ * @brief
+ * Stop streaming.
+ *
+ * Autoscan and the conversion complete interrupt are disabled. The scan in
+ * progress is discarded.
+ *
+ ******************************************************************************/
+void ADC0_stopStream(void);
+
+ /***************************************************************************//**
+ * @brief
+ * Return a buffer to the driver.
+ * @param buffer:
+ * A buffer previously passed to ADC0_bufferReadyCb() and kept by returning
+ * true.
+ *
+ ******************************************************************************/
+void ADC0_releaseStreamBuffer(const ADC0_AutoscanBuffer_t * buffer);
+
+/***************************************************************************//**
+ * @brief
+ * Copy the current streaming statistics.
+ *
+ * @param result:
+ * Structure to receive a snapshot of the counters.
+ *
+ * Interrupts are briefly disabled while the counters are copied.
+ *
+ ******************************************************************************/
+void ADC0_getStreamStats(SI_VARIABLE_SEGMENT_POINTER(result, ADC0_StreamStats_t, SI_SEG_GENERIC));
+
+/***************************************************************************//**
+ * @brief
+ * Clear the streaming statistics.
+ *
+ ******************************************************************************/
+void ADC0_clearStreamStats(void);
+
+/***************************************************************************//**
+ * @brief
+ * Callback for a completed stream buffer.
+ * @param buffer:
+ * The buffer holding the samples of the scan that has just completed.
+ * @return
+ * true to keep the buffer until ADC0_releaseStreamBuffer() is called, or
+ * false if the buffer may be reused immediately.
+ *
+ * @warning
+ * This function is called from an ISR and should be as short as possible.
+ *
+ * This function is defined by the user and called by the peripheral driver
+ * when EFM8PDL_ADC0_USE_STREAM is '1'.
+ *
+ ******************************************************************************/
+extern bool ADC0_bufferReadyCb(const ADC0_AutoscanBuffer_t * buffer);
+
+#endif //EFM8PDL_ADC0_USE_STREAM
+/** @} (end addtogroup adc0_stream_api Autoscan Streaming API) */
 /** @} (end adc0_runtime ADC0 Runtime API) */
 /** @} (end addtogroup adc_0 ADC0 Driver) */
 
@@ -137,6 +137,39 @@
  * Default setting is '1' and may be overridden by defining in 'efm8_config.h'.
  *
  *****************************************************************************/
+/**************************************************************************//**
+ * @def EFM8PDL_PCA0_USE_CAPTURE
+ * @brief Controls inclusion of the extended capture API.
+ *
+ * When '1' the PCA0 ISR extends input captures to 32 bits using the counter
+ * overflow interrupt and stores them in a FIFO for each channel started
+ * with PCA0_startCapture(). Requires EFM8PDL_PCA0_USE_ISR.
+ *
+ * Default setting is '0' and may be overridden by defining in 'efm8_config.h'.
+ *
+ *****************************************************************************/
+
+/**************************************************************************//**
+ * @def EFM8PDL_PCA0_CAPTURE_FIFO_SIZE
+ * @brief Number of captures buffered for each channel.
+ *
+ * Must be a power of two no larger than 128.
+ *
+ * Default setting is 8 and may be overridden by defining in 'efm8_config.h'.
+ *
+ *****************************************************************************/
+/**************************************************************************//**
+ * @def EFM8PDL_PCA0_CEX0_PIN
+ * @brief Port pin the crossbar routes CEX0 to, for example P1_B4.
+ *
+ * PCA0_startCapture() reads this pin to tell whether the first edge in
+ * both-edge mode is rising or falling. EFM8PDL_PCA0_CEX1_PIN and
+ * EFM8PDL_PCA0_CEX2_PIN do the same for channels 1 and 2. A channel
+ * without a named pin is assumed to start low.
+ *
+ * Not defined by default and may be defined in 'efm8_config.h'.
+ *
+ *****************************************************************************/
 /**  @} (end addtogroup pca0_config Driver Configuration) */
 
 //Configuration defaults
@@ -150,6 +183,19 @@
 #ifndef EFM8PDL_PCA0_USE_ISR
   #define EFM8PDL_PCA0_USE_ISR 1
 #endif
+#ifndef EFM8PDL_PCA0_USE_CAPTURE
+  #define EFM8PDL_PCA0_USE_CAPTURE 0
+#endif
+#ifndef EFM8PDL_PCA0_CAPTURE_FIFO_SIZE
+  #define EFM8PDL_PCA0_CAPTURE_FIFO_SIZE 8
+#endif
+
+#if (EFM8PDL_PCA0_USE_CAPTURE == 1) && (EFM8PDL_PCA0_USE_ISR == 0)
+  #error "EFM8PDL_PCA0_USE_CAPTURE requires EFM8PDL_PCA0_USE_ISR"
+#endif
+#if (EFM8PDL_PCA0_CAPTURE_FIFO_SIZE & (EFM8PDL_PCA0_CAPTURE_FIFO_SIZE - 1)) || (EFM8PDL_PCA0_CAPTURE_FIFO_SIZE > 128)
+  #error "EFM8PDL_PCA0_CAPTURE_FIFO_SIZE must be a power of two no larger than 128"
+#endif
 
 // Runtime API
 /**************************************************************************//**
@@ -509,6 +555,158 @@ void PCA0_resetChannel(PCA0_Channel_t channel);
 
 /**  @} (end addtogroup pca0_init PCA0 Initialization API) */
 
+// Extended Capture API
+/**************************************************************************//**
+ * @addtogroup pca0_capture PCA0 Extended Capture API
+ * @{
+ *
+ * These functions measure input edges with 32-bit timestamps. The ISR counts
+ * PCA counter overflows and combines that count with each 16-bit capture.
+ * If an overflow and a capture are pending in the same interrupt, the
+ * overflow is only applied to captures taken after the counter wrapped,
+ * which is correct as long as the ISR runs within half a counter period.
+ *
+ * Each capture is stored as a @ref PCA0_Capture_t record in a FIFO for its
+ * channel, so no edges are lost while the foreground is busy. Captures are
+ * handled by the driver instead of the channel event callbacks.
+ *
+ * The Extended Capture API is available when EFM8PDL_PCA0_USE_CAPTURE is
+ * '1'.
+ *
+ * ~~~~~.c
+ * PCA0_init(PCA0_SYSCLK, PCA0_IDLE_RUN);
+ * PCA0_startCapture(PCA0_CHAN0, PCA0_CAPTURE_RISING);
+ * PCA0_run();
+ *
+ * while (1)
+ * {
+ *   uint32_t period;
+ *   if (PCA0_readPeriod(PCA0_CHAN0, &period))
+ *   {
+ *     hz = PCA0_getFrequency(period, SYSCLK);
+ *   }
+ * }
+ * ~~~~~
+ *
+ *****************************************************************************/
+#if (EFM8PDL_PCA0_USE_CAPTURE == 1) || IS_DOXYGEN
+
+/// @brief Capture edge enum.
+typedef enum
+{
+  PCA0_CAPTURE_RISING  = PCA0CPM0_CAPP__BMASK,  //!< Rising edges
+  PCA0_CAPTURE_FALLING = PCA0CPM0_CAPN__BMASK,  //!< Falling edges
+  PCA0_CAPTURE_BOTH    = PCA0CPM0_CAPP__BMASK
+                         | PCA0CPM0_CAPN__BMASK, //!< Both edges, starting with the edge that leaves the current level
+} PCA0_CaptureEdge_t;
+
+/// @brief Extended capture record.
+typedef struct
+{
+  uint32_t timestamp;       //!< PCA counter value, extended to 32 bits.
+  PCA0_Channel_t channel;   //!< Channel that captured the edge.
+  PCA0_CaptureEdge_t edge;  //!< PCA0_CAPTURE_RISING or PCA0_CAPTURE_FALLING.
+  uint8_t dropped;          //!< Captures lost to a full FIFO just before this one (saturates at 255).
+} PCA0_Capture_t;
+
+/***************************************************************************//**
+ * @brief
+ * Start extended capture on a channel.
+ *
+ * @param channel:
+ * The channel to capture on.
+ * @param edges:
+ * The edges to capture. In both-edge mode the edges are assumed to
+ * alternate, starting with the edge that leaves the level of the pin named
+ * by EFM8PDL_PCA0_CEXn_PIN. Without a named pin the input should be low
+ * when capture starts.
+ *
+ * The channel is put in capture mode with its interrupt enabled, its FIFO is
+ * emptied, and the counter overflow interrupt is enabled. The PCA counter
+ * must be started separately with PCA0_run().
+ *
+ ******************************************************************************/
+void PCA0_startCapture(PCA0_Channel_t channel, PCA0_CaptureEdge_t edges);
+
+/***************************************************************************//**
+ * @brief
+ * Stop extended capture on a channel.
+ *
+ * @param channel:
+ * The channel to stop. Captures already in its FIFO may still be read.
+ *
+ ******************************************************************************/
+void PCA0_stopCapture(PCA0_Channel_t channel);
+
+/***************************************************************************//**
+ * @brief
+ * Read the oldest capture of a channel.
+ *
+ * @param channel:
+ * The channel to read.
+ * @param[out] record:
+ * Receives the capture.
+ *
+ * @return
+ * true if a capture was read, false if the FIFO is empty.
+ *
+ ******************************************************************************/
+bool PCA0_readCapture(PCA0_Channel_t channel,
+                      SI_VARIABLE_SEGMENT_POINTER(record, PCA0_Capture_t, SI_SEG_GENERIC));
+
+/***************************************************************************//**
+ * @brief
+ * Get the number of captures waiting in a channel's FIFO.
+ *
+ * @param channel:
+ * The channel to check.
+ *
+ * @return
+ * Number of captures that can be read.
+ *
+ ******************************************************************************/
+uint8_t PCA0_getCaptureCount(PCA0_Channel_t channel);
+
+/***************************************************************************//**
+ * @brief
+ * Measure the average period of a channel's input.
+ *
+ * @param channel:
+ * The channel to measure.
+ * @param[out] period:
+ * Receives the average period in PCA counts.
+ *
+ * @return
+ * true if at least one full period was measured.
+ *
+ * All captures in the channel's FIFO are consumed. Periods are measured
+ * between falling edges if the channel captures falling edges only, and
+ * between rising edges otherwise. The last edge is kept as the start of the
+ * next measurement, so consecutive calls cover the input without gaps. If
+ * captures were dropped the measurement restarts after the gap.
+ *
+ ******************************************************************************/
+bool PCA0_readPeriod(PCA0_Channel_t channel,
+                     SI_VARIABLE_SEGMENT_POINTER(period, uint32_t, SI_SEG_GENERIC));
+
+/***************************************************************************//**
+ * @brief
+ * Convert a period to a frequency.
+ *
+ * @param period:
+ * Period in PCA counts.
+ * @param pcaClock:
+ * Frequency of the PCA timebase in Hz.
+ *
+ * @return
+ * Frequency in Hz, rounded to nearest, or 0 if period is 0.
+ *
+ ******************************************************************************/
+uint32_t PCA0_getFrequency(uint32_t period, uint32_t pcaClock);
+
+#endif //EFM8PDL_PCA0_USE_CAPTURE
+/**  @} (end addtogroup pca0_capture PCA0 Extended Capture API) */
+
 //=========================================================
 // ISR API
 //=========================================================
@@ -152,6 +152,38 @@
  * }
  * ~~~~~
  *
+ * ### Ring Buffer Api ###
+ *
+ * For continuous streams the driver provides an ISR-driven ring buffer mode.
+ * This functionality is made available by setting EFM8PDL_UART0_USE_RING
+ * to 1, and replaces the Buffered Api since both rely on the UART0 ISR.
+ *
+ * Writes copy as much data as fits into the TX ring and return the number
+ * of bytes accepted without blocking. Received bytes are always moved into
+ * the RX ring by the ISR, so no data is lost between reads as long as the
+ * ring does not fill. Bytes that could not be queued in either direction
+ * are counted and may be queried with UART0_getTxOverrunCount() and
+ * UART0_getRxOverrunCount().
+ *
+ * ~~~~~.c
+ *
+ * SI_SEGMENT_VARIABLE(rxData[16], uint8_t, SI_SEG_XDATA);
+ *
+ * void main()
+ * {
+ *   //other initialization
+ *   UART0_initRing();
+ *
+ *   while(1)
+ *   {
+ *     // Echo whatever has arrived since the last pass
+ *     uint8_t count = UART0_readRing(rxData, sizeof(rxData));
+ *     UART0_writeRing(rxData, count);
+ *   }
+ * }
+ *
+ * ~~~~~
+ *
  * ### STDIO Api ###
  * On of the simplest use cases is using UART 0 to stdio data. The driver
  * provides a standard blocking implementation accessed by setting
@@ -271,6 +303,47 @@
  *****************************************************************************/
 
 /**  @} (end addtogroup uart0_config_buffered Buffered API Optionsn) */
+/**************************************************************************//**
+ * @def EFM8PDL_UART0_USE_RING
+ * @brief Controls inclusion of UART0 Ring Buffer API.
+ *
+ * When '1' the UART0 Ring Buffer API is included in the driver. This option
+ * provides the UART0 ISR and may not be combined with EFM8PDL_UART0_USE_BUFFER.
+ *
+ * Default setting is '0' and may be overridden by defining in 'efm8_config.h'.
+ *
+ *****************************************************************************/
+
+/**************************************************************************//**
+ * @addtogroup uart0_config_ring Ring Buffer API Options
+ * @{
+ *****************************************************************************/
+
+/**************************************************************************//**
+ * @def EFM8PDL_UART0_TX_RING_SIZE
+ * @brief Size of the transmit ring in bytes.
+ *
+ * Must be a power of two no larger than 128. Default setting is 32.
+ *
+ *****************************************************************************/
+
+/**************************************************************************//**
+ * @def EFM8PDL_UART0_RX_RING_SIZE
+ * @brief Size of the receive ring in bytes.
+ *
+ * Must be a power of two no larger than 128. Default setting is 32.
+ *
+ *****************************************************************************/
+
+/**************************************************************************//**
+ * @def EFM8PDL_UART0_RING_SEG
+ * @brief Memory segment holding the TX and RX rings.
+ *
+ * Default setting is SI_SEG_XDATA.
+ *
+ *****************************************************************************/
+
+/** @} (end addtogroup uart0_config_ring Ring Buffer API Options) */
 /**  @} (end addtogroup uart0_config Driver Configuration) */
 
 // Option macro default values
@@ -284,8 +357,11 @@
 #ifndef EFM8PDL_UART0_USE_STDIO
 #define EFM8PDL_UART0_USE_STDIO 0
 #endif
+#ifndef EFM8PDL_UART0_USE_RING
+#define EFM8PDL_UART0_USE_RING 0
+#endif
 #ifndef EFM8PDL_UART0_USE_BUFFER
-  #if (!EFM8PDL_UART0_USE_STDIO)
+  #if (!EFM8PDL_UART0_USE_STDIO && !EFM8PDL_UART0_USE_RING)
     #define EFM8PDL_UART0_USE_BUFFER 1 // buffer mode by default unless user has already selected one of the others
   #else
     #define EFM8PDL_UART0_USE_BUFFER 0 // buffer mode by default unless user has already selected one of the others
@@ -297,6 +373,18 @@
 #ifndef EFM8PDL_UART0_RX_BUFTYPE
 #define EFM8PDL_UART0_RX_BUFTYPE SI_SEG_XDATA
 #endif
+#ifndef EFM8PDL_UART0_TX_RING_SIZE
+#define EFM8PDL_UART0_TX_RING_SIZE 32
+#endif
+#ifndef EFM8PDL_UART0_RX_RING_SIZE
+#define EFM8PDL_UART0_RX_RING_SIZE 32
+#endif
+#ifndef EFM8PDL_UART0_RING_SEG
+#define EFM8PDL_UART0_RING_SEG SI_SEG_XDATA
+#endif
+#if (EFM8PDL_UART0_USE_RING == 1) && (EFM8PDL_UART0_USE_BUFFER == 1)
+#error "EFM8PDL_UART0_USE_RING and EFM8PDL_UART0_USE_BUFFER both provide UART0_ISR"
+#endif
 
 // Runtime API
 /**************************************************************************//**
@@ -341,8 +429,14 @@
  *
  * Valid flags can be found in the Interrupt Flag Enums group.
  *
+ * @note This function is implemented as a macro if EFM8PDL_UART0_AUTO_PAGE
+ * is 0.
  *****************************************************************************/
+#if defined(IS_DOXYGEN) || (EFM8PDL_UART0_AUTO_PAGE == 1)
 uint8_t UART0_getIntFlags();
+#else
+#define UART0_getIntFlags(x) (SCON0 & (UART0_TX_IF | UART0_RX_IF))
+#endif
 
 /***************************************************************************//**
  *  @brief
@@ -353,8 +447,14 @@ uint8_t UART0_getIntFlags();
  *
  * Valid flags can be found in the Interrupt Flag Enums group.
  *
+ * @note This function is implemented as a macro if EFM8PDL_UART0_AUTO_PAGE
+ * is 0.
  ******************************************************************************/
+#if defined(IS_DOXYGEN) || (EFM8PDL_UART0_AUTO_PAGE == 1)
 void UART0_clearIntFlag(uint8_t flag);
+#else
+#define UART0_clearIntFlag(flag) do {SCON0 &= ~(flag);} while (0)
+#endif
 
 /***************************************************************************//**
  * @brief
@@ -377,8 +477,14 @@ void UART0_initTxPolling();
  *
  * If the UART already has data pending transmission it will be overwritten.
  *
+ * @note This function is implemented as a macro if EFM8PDL_UART0_AUTO_PAGE
+ * is 0.
  ******************************************************************************/
+#if defined(IS_DOXYGEN) || (EFM8PDL_UART0_AUTO_PAGE == 1)
 void UART0_write(uint8_t value);
+#else
+#define UART0_write(value) do {SBUF0 = (value);} while (0)
+#endif
 
 /***************************************************************************//**
  * @brief
@@ -387,8 +493,14 @@ void UART0_write(uint8_t value);
  * @return
  * The most recent byte read by the UART.
  *
+ * @note This function is implemented as a macro if EFM8PDL_UART0_AUTO_PAGE
+ * is 0.
  ******************************************************************************/
+#if defined(IS_DOXYGEN) || (EFM8PDL_UART0_AUTO_PAGE == 1)
 uint8_t UART0_read(void);
+#else
+#define UART0_read(x) (SBUF0)
+#endif
 
 /***************************************************************************//**
  * @brief
@@ -555,6 +667,92 @@ uint8_t UART0_rxBytesRemaining();
  *****************************************************************************/
 #endif // EFM8PDL_UART0_USE_BUFFER
 
+// Ring Buffer API
+/**************************************************************************//**
+ * @addtogroup uart0_ring UART0 Ring Buffer API
+ * @{
+ *****************************************************************************/
+#if (EFM8PDL_UART0_USE_RING == 1) || IS_DOXYGEN
+
+/***************************************************************************//**
+ * @brief
+ * Reset the TX and RX rings and the overrun counters.
+ *
+ * Must be called once after the UART has been configured and before any
+ * other ring function. UART0 interrupts should be enabled by the caller.
+ *
+ ******************************************************************************/
+void UART0_initRing();
+
+/***************************************************************************//**
+ * @brief
+ * Queue data for transmission without blocking.
+ *
+ * @param[in] buffer:
+ * Pointer to data to be transmitted.
+ * @param length:
+ * Number of bytes to queue.
+ *
+ * @return
+ * Number of bytes accepted. Bytes that did not fit are added to the TX
+ * overrun count.
+ *
+ ******************************************************************************/
+uint8_t UART0_writeRing(SI_VARIABLE_SEGMENT_POINTER(buffer,
+                                                    uint8_t,
+                                                    EFM8PDL_UART0_TX_BUFTYPE),
+                        uint8_t length);
+
+/***************************************************************************//**
+ * @brief
+ * Copy received data out of the RX ring without blocking.
+ *
+ * @param[out] buffer:
+ * Pointer to destination buffer.
+ * @param length:
+ * Maximum number of bytes to copy.
+ *
+ * @return
+ * Number of bytes copied.
+ *
+ ******************************************************************************/
+uint8_t UART0_readRing(SI_VARIABLE_SEGMENT_POINTER(buffer,
+                                                   uint8_t,
+                                                   EFM8PDL_UART0_RX_BUFTYPE),
+                       uint8_t length);
+
+/***************************************************************************//**
+ * @brief
+ * Return the number of free bytes in the TX ring.
+ *
+ ******************************************************************************/
+uint8_t UART0_txRingFree();
+
+/***************************************************************************//**
+ * @brief
+ * Return the number of received bytes waiting in the RX ring.
+ *
+ ******************************************************************************/
+uint8_t UART0_rxRingCount();
+
+/***************************************************************************//**
+ * @brief
+ * Return the number of bytes rejected by UART0_writeRing() because the TX
+ * ring was full.
+ *
+ ******************************************************************************/
+uint16_t UART0_getTxOverrunCount();
+
+/***************************************************************************//**
+ * @brief
+ * Return the number of received bytes dropped because the RX ring was full.
+ *
+ ******************************************************************************/
+uint16_t UART0_getRxOverrunCount();
+
+#endif // EFM8PDL_UART0_USE_RING
+/** @} (end uart0_ring UART0 Ring Buffer API) */
+
 // Callbacks
 /**************************************************************************//**
  * @addtogroup uart0_callbacks User Callbacks
@@ -65,8 +65,120 @@ void ADC0_init(ADC0_ConversionStart_t convStart,
 	ADC0CN0_ADEN = 1;
 	RESTORE_PAGE;
 }
+
+// Scaling left to software after the accumulator shift, and the number of
+// hardware results summed per decimated result
+static uint8_t oversampleShift = 0;
+#if EFM8PDL_ADC0_USE_DECIMATOR == 1
+static uint8_t decimation;
+static uint8_t decimatorCount;
+static uint32_t decimatorSum;
+#endif
+
+void ADC0_initOversampled(ADC0_PositiveInput_t channel,
+                          uint16_t factor,
+                          uint8_t outputBits)
+{
+  uint8_t resolution;
+  uint8_t factorBits = 0;
+  uint8_t repeatBits;
+  uint8_t shift;
+  uint8_t accShift;
+  DECL_PAGE;
+
+  // Factor must be a power of two
+  SLAB_ASSERT(factor && !(factor & (factor - 1)));
+  while (factor > 1)
+  {
+    factor >>= 1;
+    factorBits++;
+  }
+
+  // Use the highest converter resolution that fits in the output
+  SLAB_ASSERT(outputBits >= 10 && outputBits <= 16);
+  if (outputBits >= 14)
+  {
+    resolution = 14;
+  }
+  else if (outputBits >= 12)
+  {
+    resolution = 12;
+  }
+  else
+  {
+    resolution = 10;
+  }
+
+  // Each extra bit needs four times the conversions
+  SLAB_ASSERT(2 * (outputBits - resolution) <= factorBits);
+  shift = resolution + factorBits - outputBits;
+
+  // The hardware accumulates 1, 4, 8, 16 or 32 conversions and can shift
+  // the sum right by up to 3 bits. Shift no more than the repeat count
+  // adds so no resolution is lost before the software stage.
+  repeatBits = (factorBits > 5) ? 5 : factorBits;
+  if (repeatBits == 1)
+  {
+    repeatBits = 0;
+  }
+  accShift = (shift > 3) ? 3 : shift;
+  if (accShift > repeatBits)
+  {
+    accShift = repeatBits;
+  }
+  oversampleShift = shift - accShift;
+
+#if EFM8PDL_ADC0_USE_DECIMATOR == 1
+  // Up to 128 hardware results are summed in software
+  SLAB_ASSERT(factorBits - repeatBits <= 7);
+
+  ADC0_enableInt(ADC0_CONVERSION_COMPLETE_IF, false);
+  decimation = 1 << (factorBits - repeatBits);
+  decimatorCount = decimation;
+  decimatorSum = 0;
+#else
+  // Factors above 32 (or of 2) need the software decimator
+  SLAB_ASSERT(factorBits == repeatBits);
+#endif
+
+  ADC0_setPositiveInput(channel);
+
+  SET_PAGE(ADC0_SFRPAGE);
+  ADC0CN1 = (((resolution - 10) / 2) << ADC0CN1_ADBITS__SHIFT)
+            | (accShift << ADC0CN1_ADSJST__SHIFT)
+            | (repeatBits ? repeatBits - 1 : ADC0CN1_ADRPT__ACC_1);
+  ADC0CN2 &= ~ADC0CN2_PACEN__BMASK;
+  ADC0CN0_ADINT = 0;
+  RESTORE_PAGE;
+
+#if EFM8PDL_ADC0_USE_DECIMATOR == 1
+  ADC0_enableInt(ADC0_CONVERSION_COMPLETE_IF, true);
+#endif
+}
+
+uint16_t ADC0_getOversampledResult(void)
+{
+  return ADC0_getResult() >> oversampleShift;
+}
+
+#if EFM8PDL_ADC0_USE_DECIMATOR == 1
+SI_INTERRUPT(ADC0EOC_ISR, ADC0EOC_IRQn)
+{
+  SFRPAGE = ADC0_SFRPAGE;  // Rely on page stack to restore
+  ADC0CN0_ADINT = 0;
+
+  decimatorSum += ADC0;
+  if (!--decimatorCount)
+  {
+    decimatorCount = decimation;
+    ADC0_oversampleCompleteCb((uint16_t)(decimatorSum >> oversampleShift));
+    decimatorSum = 0;
+  }
+}
+#endif //EFM8PDL_ADC0_USE_DECIMATOR
 #endif //EFM8PDL_ADC0_USE_INIT
 
+#if (EFM8PDL_ADC0_AUTO_PAGE == 1)
 uint8_t ADC0_getIntFlags()
 {
   uint8_t val;
@@ -76,7 +188,9 @@ uint8_t ADC0_getIntFlags()
   RESTORE_PAGE;
   return val;
 }
+#endif
 
+#if (EFM8PDL_ADC0_AUTO_PAGE == 1)
 void ADC0_clearIntFlags(uint8_t flags)
 {
   DECL_PAGE;
@@ -88,6 +202,7 @@ void ADC0_clearIntFlags(uint8_t flags)
   ADC0CN0 &= ~(flags & (ADC0_CONVERSION_COMPLETE_IF | ADC0_WINDOW_COMPARE_IF));
   RESTORE_PAGE;
 }
+#endif
 
 void ADC0_enableInt(uint8_t flags, bool enable)
 {
@@ -115,6 +230,7 @@ void ADC0_enableInt(uint8_t flags, bool enable)
 }
 
 
+#if (EFM8PDL_ADC0_AUTO_PAGE == 1)
 void ADC0_enable(void)
 {
 	DECL_PAGE;
@@ -122,7 +238,9 @@ void ADC0_enable(void)
 	ADC0CN0_ADEN = 1;
 	RESTORE_PAGE;
 }
+#endif
 
+#if (EFM8PDL_ADC0_AUTO_PAGE == 1)
 void ADC0_disable(void)
 {
 	DECL_PAGE;
@@ -130,6 +248,7 @@ void ADC0_disable(void)
 	ADC0CN0_ADEN = 0;
 	RESTORE_PAGE;
 }
+#endif
 
 void ADC0_setPositiveInput(ADC0_PositiveInput_t input)
 {
@@ -171,6 +290,7 @@ void ADC0_startConversion(void)
 	RESTORE_PAGE;
 }
 
+#if (EFM8PDL_ADC0_AUTO_PAGE == 1)
 bool ADC0_isConversionComplete(void)
 {
 	bool conversionComplete;
@@ -180,7 +300,9 @@ bool ADC0_isConversionComplete(void)
 	RESTORE_PAGE;
 	return conversionComplete;
 }
+#endif
 
+#if (EFM8PDL_ADC0_AUTO_PAGE == 1)
 uint16_t ADC0_getResult(void)
 {
 	uint16_t result;
@@ -190,6 +312,7 @@ uint16_t ADC0_getResult(void)
 	RESTORE_PAGE;
 	return result;
 }
+#endif
 
 void ADC0_setWindowCompare(uint16_t lessThan, uint16_t greaterThan)
 {
@@ -314,3 +437,138 @@ void ADC0_disableAutoscan(void)
 	RESTORE_PAGE;
 }
 #endif //EFM8PDL_ADC0_USE_AUTOSCAN
+
+#if EFM8PDL_ADC0_USE_STREAM == 1
+// The stream is a block of streamCount buffers of streamBytes bytes each.
+// streamFilling is the buffer of the scan in progress and streamArmed the
+// one latched by the next scan. Bit n of streamHeld is set while buffer n
+// is owned by the application.
+static uint16_t streamBase;
+static uint8_t streamBytes;
+static uint8_t streamCount;
+static uint8_t streamFilling;
+static uint8_t streamArmed;
+static volatile uint8_t streamHeld;
+SI_SEGMENT_VARIABLE(streamStats, static ADC0_StreamStats_t, SI_SEG_XDATA) = {0, 0};
+
+// Address of buffer n in the stream block
+#define STREAM_ADDR(n) (streamBase + (uint16_t)(n) * streamBytes)
+
+void ADC0_startStream(const ADC0_AutoscanBuffer_t * buffers,
+                      uint8_t numBuffers,
+                      uint8_t numElements)
+{
+  // Held buffers are tracked in an 8-bit mask, and three are needed to
+  // keep one with the application while the next two scans are queued
+  SLAB_ASSERT(numBuffers >= 3 && numBuffers <= 8);
+
+  ADC0_enableInt(ADC0_CONVERSION_COMPLETE_IF, false);
+
+  streamBase = (uint16_t)buffers;
+  streamBytes = numElements * sizeof(uint16_t);
+  streamCount = numBuffers;
+  streamFilling = 0;
+  streamArmed = 1;
+  streamHeld = 0;
+
+  ADC0_enableAutoscan(buffers, numElements, ADC0_AUTOSCAN_MODE_CONTINUOUS);
+  ADC0_setNextAutoscanBuffer((const ADC0_AutoscanBuffer_t *)STREAM_ADDR(1),
+                             numElements);
+
+  ADC0_clearIntFlags(ADC0_CONVERSION_COMPLETE_IF);
+  ADC0_enableInt(ADC0_CONVERSION_COMPLETE_IF, true);
+}
+
+void ADC0_stopStream(void)
+{
+  ADC0_enableInt(ADC0_CONVERSION_COMPLETE_IF, false);
+  ADC0_disableAutoscan();
+}
+
+void ADC0_releaseStreamBuffer(const ADC0_AutoscanBuffer_t * buffer)
+{
+  uint8_t n = ((uint16_t)buffer - streamBase) / streamBytes;
+  bool ea;
+
+  // Must be a buffer from the stream block
+  SLAB_ASSERT(n < streamCount);
+
+  // streamHeld is also written by the ISR
+  ea = IE_EA;
+  IE_EA = 0;
+  streamHeld &= ~(1 << n);
+  IE_EA = ea;
+}
+
+void ADC0_getStreamStats(SI_VARIABLE_SEGMENT_POINTER(result, ADC0_StreamStats_t, SI_SEG_GENERIC))
+{
+  // Counters are 32-bit and updated by the ISR, copy them atomically
+  bool ea = IE_EA;
+  IE_EA = 0;
+  *result = streamStats;
+  IE_EA = ea;
+}
+
+void ADC0_clearStreamStats(void)
+{
+  bool ea = IE_EA;
+  IE_EA = 0;
+  streamStats.buffers = 0;
+  streamStats.dropped = 0;
+  IE_EA = ea;
+}
+
+SI_INTERRUPT(ADC0EOC_ISR, ADC0EOC_IRQn)
+{
+  uint8_t done;
+  uint8_t next;
+  uint8_t i;
+  uint16_t addr;
+
+  SFRPAGE = ADC0_SFRPAGE;  // Rely on page stack to restore
+  ADC0CN0_ADINT = 0;
+
+  // The armed buffer was latched when the next scan started
+  done = streamFilling;
+  streamFilling = streamArmed;
+
+  // Look for a buffer for the scan after that, oldest first, skipping the
+  // one being filled, the one just completed and any held by the user
+  next = streamFilling;
+  for (i = streamCount - 1; i; i--)
+  {
+    if (++next == streamCount)
+    {
+      next = 0;
+    }
+    if ((next != done) && !(streamHeld & (1 << next)))
+    {
+      break;
+    }
+  }
+
+  // If none is free the completed scan is dropped and its buffer re-armed
+  if (!i)
+  {
+    next = done;
+  }
+
+  streamArmed = next;
+  addr = STREAM_ADDR(next);
+  ADC0ASAH = (ADC0ASAH & ~ADC0ASAH_STADDRH__FMASK) | ((addr >> 8) & ADC0ASAH_STADDRH__FMASK);
+  ADC0ASAL = (ADC0ASAL & ~ADC0ASAL_STADDRL__FMASK) | (addr & ADC0ASAL_STADDRL__FMASK);
+
+  if (i)
+  {
+    streamStats.buffers++;
+    if (ADC0_bufferReadyCb((const ADC0_AutoscanBuffer_t *)STREAM_ADDR(done)))
+    {
+      streamHeld |= (1 << done);
+    }
+  }
+  else
+  {
+    streamStats.dropped++;
+  }
+}
+#endif //EFM8PDL_ADC0_USE_STREAM
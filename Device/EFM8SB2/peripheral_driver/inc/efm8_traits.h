@@ -0,0 +1,34 @@
+/**************************************************************************//**
+ * Copyright (c) 2015 by Silicon Laboratories Inc. All rights reserved.
+ *
+ * http://developer.silabs.com/legal/version/v11/Silicon_Labs_Software_License_Agreement.txt
+ *****************************************************************************/
+
+#ifndef __EFM8_TRAITS_H__
+#define __EFM8_TRAITS_H__
+
+#include "SI_EFM8SB2_Register_Enums.h"
+
+/**************************************************************************//**
+ * @addtogroup efm8_traits EFM8SB2 Device Traits
+ * @{
+ *
+ * @brief
+ *   Compile-time description of the EFM8SB2 peripheral set.
+ *
+ * Drivers shared by all EFM8 devices (Device/shared/peripheral_driver) use
+ * these values to select SFR pages and code paths with the preprocessor, so
+ * a build only contains the variant the silicon supports.
+ *
+ *****************************************************************************/
+
+// WDT0
+#define EFM8_WDT0_USES_PCA       1             ///< WDT0 is the last PCA0 channel
+#define EFM8_WDT0_SFR_PAGE       0x00          ///< WDT0 SFR page
+#define EFM8_WDT0_PCA_CPL        PCA0CPL5      ///< WDT0 interval register
+#define EFM8_WDT0_PCA_CPH        PCA0CPH5      ///< WDT0 reload register
+#define EFM8_WDT0_ERRATUM_E102   0             ///< WDT0 needs the WDT_E102 delay
+
+/** @} (end addtogroup efm8_traits EFM8SB2 Device Traits) */
+
+#endif //__EFM8_TRAITS_H__
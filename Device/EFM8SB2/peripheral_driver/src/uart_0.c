@@ -28,6 +28,7 @@
 #endif
 
 
+#if (EFM8PDL_UART0_AUTO_PAGE == 1)
 uint8_t UART0_getIntFlags()
 {
 	uint8_t flag;
@@ -38,7 +39,9 @@ uint8_t UART0_getIntFlags()
   return flag;
 
 }
+#endif
 
+#if (EFM8PDL_UART0_AUTO_PAGE == 1)
 void UART0_clearIntFlag(uint8_t flag)
 {
   DECL_PAGE;
@@ -46,6 +49,7 @@ void UART0_clearIntFlag(uint8_t flag)
   SCON0 &= ~(flag);
   RESTORE_PAGE;
 }
+#endif
 
 void UART0_initTxPolling()
 {
@@ -55,6 +59,7 @@ void UART0_initTxPolling()
   RESTORE_PAGE;
 }
 
+#if (EFM8PDL_UART0_AUTO_PAGE == 1)
 void UART0_write(uint8_t value)
 {
   DECL_PAGE;
@@ -62,7 +67,9 @@ void UART0_write(uint8_t value)
   SBUF0 = value;
   RESTORE_PAGE;
 }
+#endif
 
+#if (EFM8PDL_UART0_AUTO_PAGE == 1)
 uint8_t UART0_read(void)
 {
   uint8_t value;
@@ -72,6 +79,7 @@ uint8_t UART0_read(void)
   RESTORE_PAGE;
   return value;
 }
+#endif
 void UART0_writeWithExtraBit(uint16_t value)
 {
   DECL_PAGE;
@@ -213,6 +221,181 @@ uint8_t UART0_rxBytesRemaining()
 
 #endif //EFM8PDL_UART0_USE_BUFFER
 
+//=========================================================
+// Ring Buffer API
+//=========================================================
+#if EFM8PDL_UART0_USE_RING == 1
+
+#if (EFM8PDL_UART0_TX_RING_SIZE & (EFM8PDL_UART0_TX_RING_SIZE - 1)) \
+    || (EFM8PDL_UART0_TX_RING_SIZE > 128)
+#error "EFM8PDL_UART0_TX_RING_SIZE must be a power of two no larger than 128"
+#endif
+#if (EFM8PDL_UART0_RX_RING_SIZE & (EFM8PDL_UART0_RX_RING_SIZE - 1)) \
+    || (EFM8PDL_UART0_RX_RING_SIZE > 128)
+#error "EFM8PDL_UART0_RX_RING_SIZE must be a power of two no larger than 128"
+#endif
+
+#define TX_RING_MASK (EFM8PDL_UART0_TX_RING_SIZE - 1)
+#define RX_RING_MASK (EFM8PDL_UART0_RX_RING_SIZE - 1)
+
+/**
+ * Internal ring storage. Indices are free running and masked on access. Each
+ * head is only written by the producer and each tail only by the consumer so
+ * neither side needs to disable interrupts.
+ */
+SI_SEGMENT_VARIABLE(txRing[EFM8PDL_UART0_TX_RING_SIZE], static uint8_t, EFM8PDL_UART0_RING_SEG);
+SI_SEGMENT_VARIABLE(rxRing[EFM8PDL_UART0_RX_RING_SIZE], static uint8_t, EFM8PDL_UART0_RING_SEG);
+SI_SEGMENT_VARIABLE(txHead, static volatile uint8_t, SI_SEG_DATA) = 0;
+SI_SEGMENT_VARIABLE(txTail, static volatile uint8_t, SI_SEG_DATA) = 0;
+SI_SEGMENT_VARIABLE(rxHead, static volatile uint8_t, SI_SEG_DATA) = 0;
+SI_SEGMENT_VARIABLE(rxTail, static volatile uint8_t, SI_SEG_DATA) = 0;
+SI_SEGMENT_VARIABLE(txIdle, static volatile uint8_t, SI_SEG_DATA) = 1;
+SI_SEGMENT_VARIABLE(txOverruns, static uint16_t, SI_SEG_XDATA) = 0;
+SI_SEGMENT_VARIABLE(rxOverruns, static volatile uint16_t, SI_SEG_XDATA) = 0;
+
+SI_INTERRUPT(UART0_ISR, UART0_IRQn)
+{
+  //Buffer and clear flags immediately so we don't miss an interrupt while processing
+  uint8_t flags, value;
+  DECL_PAGE;
+  SET_PAGE(0x00);
+  flags = SCON0 & (UART0_RX_IF | UART0_TX_IF);
+  SCON0 &= ~flags;
+
+  if (flags & SCON0_RI__SET)
+  {
+    // Always read SBUF so the byte is retired even if the ring is full
+    value = SBUF0;
+    if ((uint8_t)(rxHead - rxTail) < EFM8PDL_UART0_RX_RING_SIZE)
+    {
+      rxRing[rxHead & RX_RING_MASK] = value;
+      ++rxHead;
+    }
+    else
+    {
+      ++rxOverruns;
+    }
+  }
+
+  if (flags & SCON0_TI__SET)
+  {
+    if (txHead != txTail)
+    {
+      SBUF0 = txRing[txTail & TX_RING_MASK];
+      ++txTail;
+    }
+    else
+    {
+      txIdle = 1;
+    }
+  }
+  RESTORE_PAGE;
+}
+
+void UART0_initRing()
+{
+  txHead = 0;
+  txTail = 0;
+  rxHead = 0;
+  rxTail = 0;
+  txIdle = 1;
+  txOverruns = 0;
+  rxOverruns = 0;
+}
+
+uint8_t UART0_writeRing(SI_VARIABLE_SEGMENT_POINTER(buffer,
+                                                    uint8_t,
+                                                    EFM8PDL_UART0_TX_BUFTYPE),
+                        uint8_t length)
+{
+  uint8_t head = txHead;
+  uint8_t space = EFM8PDL_UART0_TX_RING_SIZE - (uint8_t)(head - txTail);
+  uint8_t count;
+  uint8_t next;
+  DECL_PAGE;
+
+  if (length > space)
+  {
+    txOverruns += length - space;
+    length = space;
+  }
+
+  for (count = length; count; --count)
+  {
+    txRing[head & TX_RING_MASK] = *buffer;
+    ++buffer;
+    ++head;
+  }
+  txHead = head;
+
+  // Once the ring has drained no further TI will occur, so restart the
+  // transmitter here. The ISR never touches the tail while idle.
+  if (txIdle && (head != txTail))
+  {
+    // Advance the tail before loading SBUF0, so a TI taken as soon as
+    // the byte is sent cannot find it still in the ring
+    next = txRing[txTail & TX_RING_MASK];
+    ++txTail;
+    txIdle = 0;
+    SET_PAGE(0x00);
+    SBUF0 = next;
+    RESTORE_PAGE;
+  }
+  return length;
+}
+
+uint8_t UART0_readRing(SI_VARIABLE_SEGMENT_POINTER(buffer,
+                                                   uint8_t,
+                                                   EFM8PDL_UART0_RX_BUFTYPE),
+                       uint8_t length)
+{
+  uint8_t tail = rxTail;
+  uint8_t count = rxHead - tail;
+
+  if (length > count)
+  {
+    length = count;
+  }
+
+  for (count = length; count; --count)
+  {
+    *buffer = rxRing[tail & RX_RING_MASK];
+    ++buffer;
+    ++tail;
+  }
+  rxTail = tail;
+  return length;
+}
+
+uint8_t UART0_txRingFree()
+{
+  return EFM8PDL_UART0_TX_RING_SIZE - (uint8_t)(txHead - txTail);
+}
+
+uint8_t UART0_rxRingCount()
+{
+  return rxHead - rxTail;
+}
+
+uint16_t UART0_getTxOverrunCount()
+{
+  return txOverruns;
+}
+
+uint16_t UART0_getRxOverrunCount()
+{
+  uint16_t count;
+
+  // The ISR may update the counter between byte reads, so read until stable
+  do
+  {
+    count = rxOverruns;
+  } while (count != rxOverruns);
+  return count;
+}
+
+#endif //EFM8PDL_UART0_USE_RING
+
 #if (EFM8PDL_UART0_USE_STDIO == 1) || IS_DOXYGEN
 
 #if defined __C51__
@@ -80,6 +80,7 @@ void ADC0_init(ADC0_ConversionStart_t convStart,
 }
 #endif //EFM8PDL_ADC0_USE_INIT
 
+#if (EFM8PDL_ADC0_AUTO_PAGE == 1)
 uint8_t ADC0_getIntFlags()
 {
   uint8_t val;
@@ -89,7 +90,9 @@ uint8_t ADC0_getIntFlags()
   RESTORE_PAGE;
   return val;
 }
+#endif
 
+#if (EFM8PDL_ADC0_AUTO_PAGE == 1)
 void ADC0_clearIntFlags(uint8_t flags)
 {
   DECL_PAGE;
@@ -101,6 +104,7 @@ void ADC0_clearIntFlags(uint8_t flags)
   ADC0CN0 &= ~(flags & (ADC0_CONVERSION_COMPLETE_IF | ADC0_WINDOW_COMPARE_IF));
   RESTORE_PAGE;
 }
+#endif
 
 void ADC0_enableInt(uint8_t flags, bool enable)
 {
@@ -128,6 +132,7 @@ void ADC0_enableInt(uint8_t flags, bool enable)
 }
 
 
+#if (EFM8PDL_ADC0_AUTO_PAGE == 1)
 void ADC0_enable(void)
 {
 	DECL_PAGE;
@@ -135,7 +140,9 @@ void ADC0_enable(void)
 	ADC0CN0_ADEN = 1;
 	RESTORE_PAGE;
 }
+#endif
 
+#if (EFM8PDL_ADC0_AUTO_PAGE == 1)
 void ADC0_disable(void)
 {
 	DECL_PAGE;
@@ -143,6 +150,7 @@ void ADC0_disable(void)
 	ADC0CN0_ADEN = 0;
 	RESTORE_PAGE;
 }
+#endif
 
 void ADC0_setPositiveInput(ADC0_PositiveInput_t input)
 {
@@ -184,6 +192,7 @@ void ADC0_startConversion(void)
 	RESTORE_PAGE;
 }
 
+#if (EFM8PDL_ADC0_AUTO_PAGE == 1)
 bool ADC0_isConversionComplete(void)
 {
 	bool conversionComplete;
@@ -193,7 +202,9 @@ bool ADC0_isConversionComplete(void)
 	RESTORE_PAGE;
 	return conversionComplete;
 }
+#endif
 
+#if (EFM8PDL_ADC0_AUTO_PAGE == 1)
 uint16_t ADC0_getResult(void)
 {
 	uint16_t result;
@@ -203,6 +214,7 @@ uint16_t ADC0_getResult(void)
 	RESTORE_PAGE;
 	return result;
 }
+#endif
 
 void ADC0_setWindowCompare(uint16_t lessThan, uint16_t greaterThan)
 {
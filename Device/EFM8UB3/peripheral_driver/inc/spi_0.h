@@ -140,6 +140,47 @@
  * in 'efm8_config.h'.
  *****************************************************************************/
 
+/**************************************************************************//**
+ * @def EFM8PDL_SPI0_USE_BURST
+ * @brief Controls FIFO burst transfers in buffered mode.
+ *
+ * When set to '1', buffered transfers keep several bytes outstanding and
+ * service all of them in a single interrupt instead of taking one interrupt
+ * per byte.  The number of bytes per interrupt is the receive threshold
+ * passed to SPI0_configureFifo() plus one, limited to the FIFO depth.  The
+ * driver never has more bytes outstanding than the receive FIFO can hold,
+ * so unlike @ref EFM8PDL_SPI0_USE_PIPELINE no data is lost if interrupt
+ * latency is high.
+ *
+ * @note The driver reprograms the receive threshold while a transfer is in
+ * progress.
+ *
+ * The default setting is the value of @ref EFM8PDL_SPI0_USE_QUEUE and may be
+ * overridden by defining the value in 'efm8_config.h'.
+ *****************************************************************************/
+
+/**************************************************************************//**
+ * @def EFM8PDL_SPI0_USE_QUEUE
+ * @brief Controls inclusion of the SPI0 transaction queue.
+ *
+ * When set to '1', transactions described by @ref SPI0_Transaction_t can be
+ * queued with SPI0_queueTransaction().  Queued transactions run back to back
+ * from the interrupt handler, each with its own chip select hooks and
+ * completion callback.  This option requires @ref EFM8PDL_SPI0_USE_BUFFER
+ * and @ref EFM8PDL_SPI0_USE_BURST.
+ *
+ * The default setting is '0' and may be overridden by defining the value
+ * in 'efm8_config.h'.
+ *****************************************************************************/
+
+/**************************************************************************//**
+ * @def EFM8PDL_SPI0_QUEUE_DEPTH
+ * @brief Number of transactions that can be queued.
+ *
+ * Must be a power of two.  The default setting is 4 and may be overridden
+ * by defining the value in 'efm8_config.h'.
+ *****************************************************************************/
+
 /**************************************************************************//**
  * @def EFM8PDL_SPI0_AUTO_PAGE
  * @brief Provides automatic SFR paging and restoring.
@@ -215,6 +256,18 @@
 #ifndef EFM8PDL_SPI0_USE_ERR_CALLBACK
 #define EFM8PDL_SPI0_USE_ERR_CALLBACK 0
 #endif
+#ifndef EFM8PDL_SPI0_USE_QUEUE
+#define EFM8PDL_SPI0_USE_QUEUE 0
+#endif
+#ifndef EFM8PDL_SPI0_USE_BURST
+#define EFM8PDL_SPI0_USE_BURST EFM8PDL_SPI0_USE_QUEUE
+#endif
+#ifndef EFM8PDL_SPI0_QUEUE_DEPTH
+#define EFM8PDL_SPI0_QUEUE_DEPTH 4
+#endif
+#if (EFM8PDL_SPI0_USE_QUEUE == 1) && (EFM8PDL_SPI0_USE_BURST == 0)
+#error "EFM8PDL_SPI0_USE_QUEUE requires EFM8PDL_SPI0_USE_BURST"
+#endif
 
 // Runtime API
 
@@ -864,6 +917,90 @@ extern void SPI0_abortTransfer(void);
 extern uint8_t SPI0_bytesRemaining(void);
 
 /** @} spi0_buffer */
+
+#if (EFM8PDL_SPI0_USE_QUEUE == 1) || defined(IS_DOXYGEN)
+/**************************************************************************//**
+ * @addtogroup spi0_queue SPI0 Transaction Queue API
+ *
+ * The following functions queue interrupt driven transfers so that several
+ * transactions, possibly to different slaves, run back to back without any
+ * foreground work between them.  Each transaction is described by a
+ * @ref SPI0_Transaction_t owned by the caller, which must stay valid until
+ * its completion callback has been called.
+ *
+ * The queue API functions are available when @ref EFM8PDL_SPI0_USE_QUEUE
+ * is set to 1 in 'efm8_config.h'.  SPI0_transfer() must not be called while
+ * queued transactions are pending.
+ *
+ * __Example__
+ *
+ * ~~~~~~~~.c
+ * static void flashSelect(void)   { FLASH_CS = 0; }
+ * static void flashDeselect(void) { FLASH_CS = 1; }
+ *
+ * SI_SEGMENT_VARIABLE(readCmd[4], uint8_t, SI_SEG_XDATA) = {0x03, 0, 0, 0};
+ * SI_SEGMENT_VARIABLE(page[64], uint8_t, SI_SEG_XDATA);
+ * SI_SEGMENT_VARIABLE(cmdTxn, SPI0_Transaction_t, SI_SEG_XDATA) =
+ *   {readCmd, NULL, SPI0_TRANSFER_TX, 4, flashSelect, NULL, NULL};
+ * SI_SEGMENT_VARIABLE(dataTxn, SPI0_Transaction_t, SI_SEG_XDATA) =
+ *   {NULL, page, SPI0_TRANSFER_RX, 64, NULL, flashDeselect, pageReady};
+ *
+ * // Chip select stays asserted across both transactions
+ * SPI0_queueTransaction(&cmdTxn);
+ * SPI0_queueTransaction(&dataTxn);
+ * ~~~~~~~~
+ * @{
+ *****************************************************************************/
+
+/**************************************************************************//**
+ * Description of one queued SPI transaction.
+ *
+ * Any of the function pointers may be NULL.  If _csAssert_ or _csDeassert_
+ * is NULL and the driver is a 4-wire master then NSS is driven instead.
+ * The hooks and the completion callback are called in interrupt context.
+ *****************************************************************************/
+typedef struct SPI0_Transaction
+{
+  /// Data to transmit, or NULL if _dir_ does not include SPI0_TRANSFER_TX.
+  SI_VARIABLE_SEGMENT_POINTER(pTxBuffer, uint8_t, EFM8PDL_SPI0_TX_SEGTYPE);
+  /// Buffer for received data, or NULL if _dir_ does not include SPI0_TRANSFER_RX.
+  SI_VARIABLE_SEGMENT_POINTER(pRxBuffer, uint8_t, EFM8PDL_SPI0_RX_SEGTYPE);
+  SPI0_TransferDirection_t dir;  ///< Direction of the transfer.
+  uint8_t xferCount;             ///< Number of bytes to transfer.
+  void (*csAssert)(void);        ///< Called before the first byte is sent.
+  void (*csDeassert)(void);      ///< Called after the last byte is received.
+  /// Called after _csDeassert_ with the completed transaction.
+  void (*complete)(SI_VARIABLE_SEGMENT_POINTER(txn, struct SPI0_Transaction,
+                                               SI_SEG_XDATA));
+} SPI0_Transaction_t;
+
+/**************************************************************************//**
+ * Queue a transaction.
+ *
+ * @param txn The transaction to run.
+ * @return **True** if the transaction was queued, or **false** if the queue
+ * is full or the transaction has no bytes to transfer.
+ *
+ * The transaction starts immediately if the queue is idle, otherwise it
+ * starts from interrupt context as soon as the transactions ahead of it
+ * have completed.
+ *****************************************************************************/
+extern bool SPI0_queueTransaction(SI_VARIABLE_SEGMENT_POINTER(txn, SPI0_Transaction_t,
+                                                              SI_SEG_XDATA));
+
+/**************************************************************************//**
+ * Get the number of queued transactions that have not completed.
+ *
+ * @return Count of pending transactions, including the one in progress.
+ *
+ * SPI0_abortTransfer() discards all pending transactions without calling
+ * their completion callbacks.
+ *****************************************************************************/
+extern uint8_t SPI0_getQueueCount(void);
+
+/** @} spi0_queue */
+#endif // EFM8PDL_SPI0_USE_QUEUE
+
 #endif // EFM8PDL_SPI0_USE_BUFFER
 
 /** @} (end spi_0_group) */
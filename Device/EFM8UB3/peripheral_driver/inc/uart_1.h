@@ -254,6 +254,20 @@
  * in 'efm8_config.h'.
  *****************************************************************************/
 
+ /**************************************************************************//**
+ * @def EFM8PDL_UART1_USE_STATS
+ * @brief Controls whether the buffered API keeps interrupt statistics.
+ *
+ * This option is only meaningful if @ref EFM8PDL_UART1_USE_BUFFER is enabled.
+ * When '1' the UART1 interrupt handler counts the interrupts it services and
+ * the bytes it moves through the fifos. Comparing the two shows how many
+ * bytes are transferred per interrupt for a given fifo threshold and rx
+ * timeout configuration. Use UART1_getStats() to read the counters.
+ *
+ * The default setting is '0' and may be overridden by defining the value
+ * in 'efm8_config.h'.
+ *****************************************************************************/
+
 /**************************************************************************//**
  * @addtogroup uart1_config_buffered Buffered API Options
  * @{
@@ -318,6 +332,9 @@
 #ifndef EFM8PDL_UART1_USE_ERR_CALLBACK
 #define EFM8PDL_UART1_USE_ERR_CALLBACK 0
 #endif
+#ifndef EFM8PDL_UART1_USE_STATS
+#define EFM8PDL_UART1_USE_STATS 0
+#endif
 
 //=========================================================
 // Runtime API
@@ -1158,6 +1175,42 @@ uint8_t UART1_txBytesRemaining(void);
 uint8_t UART1_rxBytesRemaining(void);
 /** @} (end uart1_buffer UART1 Buffer Access API) */
 
+/**************************************************************************//**
+ * @addtogroup uart1_stats UART1 Buffer Statistics API
+ * @{
+ *****************************************************************************/
+#if (EFM8PDL_UART1_USE_STATS == 1) || defined(IS_DOXYGEN)
+
+/// UART1 buffered transfer statistics.
+typedef struct
+{
+  uint32_t interrupts; //!< Number of UART1 interrupts serviced.
+  uint32_t rxBytes;    //!< Bytes read from the rx fifo.
+  uint32_t txBytes;    //!< Bytes written to the tx fifo.
+} UART1_Stats_t;
+
+/***************************************************************************//**
+ * @brief
+ * Copy the current interrupt statistics.
+ *
+ * @param result:
+ * Structure to receive a snapshot of the counters.
+ *
+ * Interrupts are briefly disabled while the counters are copied.
+ *
+ ******************************************************************************/
+void UART1_getStats(SI_VARIABLE_SEGMENT_POINTER(result, UART1_Stats_t, SI_SEG_GENERIC));
+
+/***************************************************************************//**
+ * @brief
+ * Reset all interrupt statistics to zero.
+ *
+ ******************************************************************************/
+void UART1_clearStats(void);
+
+#endif //EFM8PDL_UART1_USE_STATS
+/** @} (end uart1_stats UART1 Buffer Statistics API) */
+
 /**************************************************************************//**
  * @def void UART1_ISR()
  * @brief UART1 Interrupt handler.
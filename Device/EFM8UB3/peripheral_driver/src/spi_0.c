@@ -7,6 +7,7 @@
 #include "efm8_config.h"
 #include "SI_EFM8UB3_Register_Enums.h"
 #include "spi_0.h"
+#include "efm8_traits.h"
 
 #if EFM8PDL_SPI0_AUTO_PAGE == 1
 // declare variable needed for autopage enter/exit
@@ -43,6 +44,12 @@ static bool modeIsMaster = false;
 // not valid then a special one-time init will be called to set them
 static bool initIsValid = false;
 
+#if EFM8PDL_SPI0_USE_BURST == 1
+// Maximum number of bytes the burst engine keeps outstanding on the bus.
+// Taken from the receive threshold passed to SPI0_configureFifo().
+static uint8_t burstSize = EFM8_SPI0_FIFO_DEPTH;
+#endif
+
 // ----------------------------------------------------------------------------
 // Initialize internal state variables.  This is used if init API is
 // not called.
@@ -249,7 +256,7 @@ SPI0_pollTransfer(SI_VARIABLE_SEGMENT_POINTER(pTxBuffer, uint8_t,
       // else there is no RX buffer so just throw away the incoming byte
       else
       {
-        uint8_t dummy = SPI0DAT;
+        SPI0DAT;
       }
 
       --xferCount;
@@ -568,6 +575,16 @@ void SPI0_configureFifo(uint8_t txThreshold, uint8_t rxThreshold,
   }
   SPI0FCN0 = fifoCtrl;
   RESTORE_PAGE();
+
+#if EFM8PDL_SPI0_USE_BURST == 1
+  // The burst engine reprograms RXTH on every interrupt, so remember the
+  // requested level as the number of bytes to move per interrupt
+  burstSize = (rxThreshold & SPI0FCN0_RXTH__FMASK) + 1;
+  if (burstSize > EFM8_SPI0_FIFO_DEPTH)
+  {
+    burstSize = EFM8_SPI0_FIFO_DEPTH;
+  }
+#endif
 }
 
 #if EFM8PDL_SPI0_USE_BUFFER == 1
@@ -584,6 +601,140 @@ static uint8_t bytesRemaining = 0;
 static SI_VARIABLE_SEGMENT_POINTER(pTxBuf, uint8_t, EFM8PDL_SPI0_TX_SEGTYPE) = NULL;
 static SI_VARIABLE_SEGMENT_POINTER(pRxBuf, uint8_t, EFM8PDL_SPI0_RX_SEGTYPE) = NULL;
 
+#if EFM8PDL_SPI0_USE_BURST == 1
+// ----------------------------------------------------------------------------
+// Write bytes until burstSize bytes are outstanding, then set the RX
+// threshold so the next request fires once all of them have been clocked
+// back in.  Limiting the bytes in flight to the FIFO depth means received
+// data cannot be lost no matter how late the interrupt is serviced.
+// SPI0 SFR page must already be selected.
+//
+// This is a macro rather than a function because it is used from both the
+// ISR and SPI0_transfer() and the 8051 compilers do not make functions
+// reentrant by default.
+// ----------------------------------------------------------------------------
+#define SPI0_FILL_TX_WINDOW()                                                 \
+  do                                                                          \
+  {                                                                           \
+    while (txCountRemaining                                                   \
+           && ((uint8_t)(rxCountRemaining - txCountRemaining) < burstSize))   \
+    {                                                                         \
+      if (useTx)                                                              \
+      {                                                                       \
+        SPI0DAT = *pTxBuf;                                                    \
+        ++pTxBuf;                                                             \
+      }                                                                       \
+      else                                                                    \
+      {                                                                       \
+        SPI0DAT = 0;                                                          \
+      }                                                                       \
+      --txCountRemaining;                                                     \
+    }                                                                         \
+    SPI0FCN0 = (SPI0FCN0 & ~SPI0FCN0_RXTH__FMASK)                             \
+               | ((rxCountRemaining - txCountRemaining - 1)                   \
+                  & SPI0FCN0_RXTH__FMASK);                                    \
+  } while (0)
+#endif // EFM8PDL_SPI0_USE_BURST
+
+#if EFM8PDL_SPI0_USE_QUEUE == 1
+
+#if (EFM8PDL_SPI0_QUEUE_DEPTH & (EFM8PDL_SPI0_QUEUE_DEPTH - 1))
+#error "EFM8PDL_SPI0_QUEUE_DEPTH must be a power of two"
+#endif
+
+// Pending transactions.  The foreground only advances queueHead and the
+// ISR only advances queueTail.  The entry at queueTail is the one in
+// progress while activeTxn is not NULL.
+SI_SEGMENT_VARIABLE_SEGMENT_POINTER(txnQueue[EFM8PDL_SPI0_QUEUE_DEPTH],
+                                    static SPI0_Transaction_t,
+                                    SI_SEG_XDATA, SI_SEG_XDATA);
+static volatile uint8_t queueHead = 0;
+static volatile uint8_t queueTail = 0;
+static SPI0_Transaction_t SI_SEG_XDATA * volatile SI_SEG_DATA activeTxn = NULL;
+
+// ----------------------------------------------------------------------------
+// Start the transaction at the tail of the queue.  Only called from the ISR
+// with the SPI0 SFR page selected.
+// ----------------------------------------------------------------------------
+static void SPI0_startQueued(void)
+{
+  SI_VARIABLE_SEGMENT_POINTER(txn, SPI0_Transaction_t, SI_SEG_XDATA);
+
+  txn = txnQueue[queueTail & (EFM8PDL_SPI0_QUEUE_DEPTH - 1)];
+  activeTxn = txn;
+
+  rxCountRemaining = txn->xferCount;
+  txCountRemaining = txn->xferCount;
+  bytesRemaining = txn->xferCount;
+  pTxBuf = txn->pTxBuffer;
+  pRxBuf = txn->pRxBuffer;
+  useRx = txn->dir & SPI0_TRANSFER_RX;
+  useTx = txn->dir & SPI0_TRANSFER_TX;
+
+  SPI0FCN0 |= SPI0FCN0_RFLSH__FLUSH;
+
+  // assert chip select
+  if (txn->csAssert)
+  {
+    txn->csAssert();
+  }
+  else if (modeIsMaster && useNss)
+  {
+    SPI0CN0_NSSMD0 = 0;
+  }
+
+  SPI0_FILL_TX_WINDOW();
+}
+
+// ----------------------------------------------------------------------------
+// Add a transaction to the queue.
+// ----------------------------------------------------------------------------
+bool SPI0_queueTransaction(SI_VARIABLE_SEGMENT_POINTER(txn, SPI0_Transaction_t,
+                                                       SI_SEG_XDATA))
+{
+  uint8_t head = queueHead;
+  uint8_t savedPage;
+
+  // A zero length transaction would never complete
+  if ((txn->xferCount == 0)
+      || ((uint8_t)(head - queueTail) >= EFM8PDL_SPI0_QUEUE_DEPTH))
+  {
+    return false;
+  }
+
+  // Check to see if run-time mode variables have been set up
+  if (!initIsValid)
+  {
+    SPI0_internalInit();
+  }
+
+  txnQueue[head & (EFM8PDL_SPI0_QUEUE_DEPTH - 1)] = txn;
+  queueHead = head + 1;
+
+  // If the engine is idle nothing will pick up the new entry, so use the
+  // TX request (always set while the TX FIFO is empty) to start it from
+  // interrupt context.  If the ISR finished the previous transaction in the
+  // meantime this is a harmless extra interrupt.
+  if (activeTxn == NULL)
+  {
+    savedPage = SFRPAGE;
+    SFRPAGE = SPI_SFR_PAGE;
+    SPI0FCN1 &= ~SPI0FCN1_SPIFEN__BMASK;
+    SPI0FCN0 |= SPI0FCN0_RFRQE__ENABLED | SPI0FCN0_TFRQE__ENABLED;
+    SFRPAGE = savedPage;
+  }
+  return true;
+}
+
+// ----------------------------------------------------------------------------
+// Get the number of transactions that have not yet completed.
+// ----------------------------------------------------------------------------
+uint8_t SPI0_getQueueCount(void)
+{
+  return queueHead - queueTail;
+}
+#endif // EFM8PDL_SPI0_USE_QUEUE
+
 // ----------------------------------------------------------------------------
 // Set up an interrupt driven SPI transfer.
 // ----------------------------------------------------------------------------
@@ -643,7 +794,16 @@ SPI0_transfer(SI_VARIABLE_SEGMENT_POINTER(pTxBuffer, uint8_t,
     SPI0CN0_NSSMD0 = 0;
   }
 
-#if EFM8PDL_SPI0_USE_PIPELINE == 0
+#if EFM8PDL_SPI0_USE_BURST == 1
+  // Fill the first burst.  This touches SPI0FCN0 so the SPI page must be
+  // selected even when auto page is off.
+  {
+    uint8_t savedPage = SFRPAGE;
+    SFRPAGE = SPI_SFR_PAGE;
+    SPI0_FILL_TX_WINDOW();
+    SFRPAGE = savedPage;
+  }
+#elif EFM8PDL_SPI0_USE_PIPELINE == 0
   // Write the first byte to get the transfer started
   if (SPI0CN0_TXNF && txCountRemaining)
   {
@@ -704,6 +864,17 @@ void SPI0_abortTransfer(void)
 
   SET_PAGE(SPI_SFR_PAGE);
 
+#if EFM8PDL_SPI0_USE_QUEUE == 1
+  // Drop all queued transactions.  Completion callbacks are not called.
+  SPI0FCN0 &= ~SPI0FCN0_TFRQE__ENABLED;
+  if (activeTxn && activeTxn->csDeassert)
+  {
+    activeTxn->csDeassert();
+  }
+  activeTxn = NULL;
+  queueTail = queueHead;
+#endif
+
   // drop the chip select if used
   if (modeIsMaster && useNss)
   {
@@ -734,6 +905,9 @@ SI_INTERRUPT(SPI0_ISR, SPI0_IRQn)
 {
   uint8_t intFlags;
   uint8_t fifoFlags;
+#if EFM8PDL_SPI0_USE_QUEUE == 1
+  SI_VARIABLE_SEGMENT_POINTER(txn, SPI0_Transaction_t, SI_SEG_XDATA);
+#endif
 
   // This device has SFRPAGE autosave so we can change page here and
   // it will automatically be restored when interrupt exits
@@ -748,6 +922,84 @@ SI_INTERRUPT(SPI0_ISR, SPI0_IRQn)
   // Get the FIFO request flags
   fifoFlags = SPI0FCN1;
 
+#if EFM8PDL_SPI0_USE_QUEUE == 1
+  // The TX request is only enabled by SPI0_queueTransaction() to start
+  // the queue when the engine is idle
+  if ((fifoFlags & SPI0FCN1_TFRQ__BMASK) && (SPI0FCN0 & SPI0FCN0_TFRQE__BMASK))
+  {
+    SPI0FCN0 &= ~SPI0FCN0_TFRQE__BMASK;
+    if ((activeTxn == NULL) && (queueHead != queueTail))
+    {
+      SPI0_startQueued();
+    }
+  }
+#endif
+
+#if EFM8PDL_SPI0_USE_BURST == 1
+  if (fifoFlags & SPI0FCN1_RFRQ__BMASK)
+  {
+    // Drain the whole RX FIFO.  At most burstSize bytes are outstanding
+    // so this is every byte written since the last interrupt.
+    while (rxCountRemaining && !(SPI0CFG & SPI0CFG_RXE__BMASK))
+    {
+      if (useRx)
+      {
+        *pRxBuf = SPI0DAT;
+        ++pRxBuf;
+      }
+      else
+      {
+        SPI0DAT;
+      }
+      --rxCountRemaining;
+    }
+    bytesRemaining = rxCountRemaining;
+
+    if (rxCountRemaining)
+    {
+      SPI0_FILL_TX_WINDOW();
+    }
+#if EFM8PDL_SPI0_USE_QUEUE == 1
+    else if (activeTxn)
+    {
+      txn = activeTxn;
+      activeTxn = NULL;
+      ++queueTail;
+
+      // deassert chip select
+      if (txn->csDeassert)
+      {
+        txn->csDeassert();
+      }
+      else if (modeIsMaster && useNss)
+      {
+        SPI0CN0_NSSMD0 = 1;
+      }
+
+      if (txn->complete)
+      {
+        txn->complete(txn);
+      }
+
+      // Chain straight into the next transaction
+      if (queueHead != queueTail)
+      {
+        SPI0_startQueued();
+      }
+    }
+#endif // EFM8PDL_SPI0_USE_QUEUE
+    else
+    {
+      // deassert NSS (if used)
+      if (modeIsMaster && useNss)
+      {
+        SPI0CN0_NSSMD0 = 1;
+      }
+      // Tell user that the transfer is complete.
+      SPI0_transferCompleteCb();
+    }
+  }
+#else
   // If either FIFO request flag is set, it means that there is
   // either more data to read or write, or both.  So just try
   // to read and write as much as we can at this time.
@@ -771,7 +1023,7 @@ SI_INTERRUPT(SPI0_ISR, SPI0_IRQn)
       // Else, user does not care about RX data so do a dummy read.
       else
       {
-        uint8_t dummy = SPI0DAT;
+        SPI0DAT;
       }
       --rxCountRemaining;
 
@@ -819,6 +1071,7 @@ SI_INTERRUPT(SPI0_ISR, SPI0_IRQn)
       --txCountRemaining;
     }
   }
+#endif // EFM8PDL_SPI0_USE_BURST
 
 #if EFM8PDL_SPI0_USE_ERR_CALLBACK == 1
   // Check for errors and notify user
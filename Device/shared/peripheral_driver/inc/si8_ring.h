@@ -0,0 +1,255 @@
+/******************************************************************************
+ * Copyright (c) 2015 by Silicon Laboratories Inc. All rights reserved.
+ *
+ * http://developer.silabs.com/legal/version/v11/Silicon_Labs_Software_License_Agreement.txt
+ *****************************************************************************/
+
+#ifndef __SI8_RING_H__
+#define __SI8_RING_H__
+
+#include "efm8_config.h"
+#include "si_toolchain.h"
+
+/**************************************************************************//**
+ * @addtogroup si8_ring Ring Buffer
+ * @{
+ *
+ * @brief
+ *   Lock-free single-producer/single-consumer byte ring buffer.
+ *
+ * # Introduction #
+ *
+ * This module provides a byte queue for handing data between an interrupt
+ * service routine and the main loop. One side (the producer) only writes to
+ * the ring and the other side (the consumer) only reads from it. Because
+ * the head index is only written by the producer and the tail index is only
+ * written by the consumer, and each index is a single byte, no interrupt
+ * disabling is needed.
+ *
+ * The ring size must be a power of two between 2 and 128. Indices run free
+ * and are masked on access, so the full ring capacity is usable and the
+ * count is a single subtraction.
+ *
+ * ### Zero-copy Access ###
+ *
+ * si8_ring_getWriteSpan() and si8_ring_getReadSpan() return a pointer to the
+ * largest contiguous free or filled region of the buffer. A driver can
+ * fill or drain that region directly (for example from a hardware FIFO)
+ * and then call si8_ring_commitWrite() or si8_ring_consume() once for the
+ * whole span.
+ *
+ * ~~~~~.c
+ * // UART RX ISR (producer)
+ * SI_VARIABLE_SEGMENT_POINTER(span, uint8_t, SI8_RING_BUFFER_SEG);
+ * if (si8_ring_getWriteSpan(&rxRing, &span))
+ * {
+ *   *span = SBUF0;
+ *   si8_ring_commitWrite(&rxRing, 1);
+ * }
+ * ~~~~~
+ *
+ * ### Calling Context ###
+ *
+ * Producer functions (push, write, getWriteSpan, commitWrite) must only be
+ * called from one context, and consumer functions (pop, read, getReadSpan,
+ * consume) from one other context. The status queries are macros so they
+ * can be used from either side.
+ *
+ *****************************************************************************/
+
+/**************************************************************************//**
+ * @addtogroup si8_ring_config Driver Configuration
+ * @{
+ *
+ * @brief
+ * Driver configuration constants read from **efm8_config.h**
+ *
+ * This module will look for configuration constants in **efm8_config.h**.
+ * This file is provided/written by the user and should be
+ * located in a directory that is part of the include path.
+ *
+ * @def SI8_RING_BUFFER_SEG
+ * @brief Memory segment of ring data buffers.
+ *
+ * One of SI_SEG_DATA, SI_SEG_IDATA, SI_SEG_PDATA or SI_SEG_XDATA. Every
+ * buffer passed to si8_ring_init() must be located in this segment. Using a
+ * specific segment lets the compiler use 1 or 2 byte pointers instead of
+ * 3 byte generic pointers.
+ *
+ * Default setting is SI_SEG_XDATA and may be overridden by defining in
+ * 'efm8_config.h'.
+ *
+ * @def SI8_RING_STRUCT_SEG
+ * @brief Memory segment of si8Ring_t control structures.
+ *
+ * Placing the control structures in SI_SEG_DATA or SI_SEG_IDATA gives the
+ * fastest index access.
+ *
+ * Default setting is SI_SEG_XDATA and may be overridden by defining in
+ * 'efm8_config.h'.
+ *
+ *****************************************************************************/
+#ifdef IS_DOXYGEN
+#define SI8_RING_BUFFER_SEG SI_SEG_XDATA
+#define SI8_RING_STRUCT_SEG SI_SEG_XDATA
+#endif
+
+/** @} (end addtogroup si8_ring_config Driver Configuration) */
+
+//Configuration defaults
+#ifndef SI8_RING_BUFFER_SEG
+#define SI8_RING_BUFFER_SEG SI_SEG_XDATA
+#endif
+#ifndef SI8_RING_STRUCT_SEG
+#define SI8_RING_STRUCT_SEG SI_SEG_XDATA
+#endif
+
+/**************************************************************************//**
+ * @addtogroup si8_ring_api Ring Buffer API
+ * @{
+ *****************************************************************************/
+
+/// Ring buffer control structure.
+typedef struct si8Ring
+{
+  SI_VARIABLE_SEGMENT_POINTER(buf, uint8_t, SI8_RING_BUFFER_SEG); //!< Data buffer
+  volatile uint8_t head;  //!< Free-running write index, producer only
+  volatile uint8_t tail;  //!< Free-running read index, consumer only
+  uint8_t mask;           //!< Buffer size - 1
+} si8Ring_t;
+
+/***************************************************************************//**
+ * @brief
+ * Initialize a ring buffer.
+ *
+ * @param ring:
+ * Ring to initialize.
+ * @param buffer:
+ * Storage for the ring, located in @ref SI8_RING_BUFFER_SEG.
+ * @param size:
+ * Size of buffer. Must be a power of two between 2 and 128.
+ *
+ * Must not be called while either side is using the ring.
+ *
+ ******************************************************************************/
+void si8_ring_init(SI_VARIABLE_SEGMENT_POINTER(ring, si8Ring_t, SI8_RING_STRUCT_SEG),
+                   SI_VARIABLE_SEGMENT_POINTER(buffer, uint8_t, SI8_RING_BUFFER_SEG),
+                   uint8_t size);
+
+/***************************************************************************//**
+ * @brief
+ * Number of bytes in the ring.
+ ******************************************************************************/
+#define si8_ring_count(ring) ((uint8_t)((ring)->head - (ring)->tail))
+
+/***************************************************************************//**
+ * @brief
+ * Number of bytes that can be written before the ring is full.
+ ******************************************************************************/
+#define si8_ring_space(ring)                                                  \
+            ((uint8_t)((ring)->mask + 1 - si8_ring_count(ring)))
+
+/***************************************************************************//**
+ * @brief
+ * Returns true if the ring is empty.
+ ******************************************************************************/
+#define si8_ring_isEmpty(ring) ((ring)->head == (ring)->tail)
+
+/***************************************************************************//**
+ * @brief
+ * Returns true if the ring is full.
+ ******************************************************************************/
+#define si8_ring_isFull(ring) (si8_ring_count(ring) > (ring)->mask)
+
+/***************************************************************************//**
+ * @brief
+ * Push a single byte into the ring (producer).
+ *
+ * @return
+ * False if the ring is full and the byte was not stored.
+ ******************************************************************************/
+bool si8_ring_push(SI_VARIABLE_SEGMENT_POINTER(ring, si8Ring_t, SI8_RING_STRUCT_SEG), uint8_t value);
+
+/***************************************************************************//**
+ * @brief
+ * Pop a single byte from the ring (consumer).
+ *
+ * @param value:
+ * Location to store the byte.
+ *
+ * @return
+ * False if the ring is empty.
+ ******************************************************************************/
+bool si8_ring_pop(SI_VARIABLE_SEGMENT_POINTER(ring, si8Ring_t, SI8_RING_STRUCT_SEG), uint8_t *value);
+
+/***************************************************************************//**
+ * @brief
+ * Copy up to length bytes into the ring (producer).
+ *
+ * @return
+ * Number of bytes written. Less than length if the ring filled up.
+ ******************************************************************************/
+uint8_t si8_ring_write(SI_VARIABLE_SEGMENT_POINTER(ring, si8Ring_t, SI8_RING_STRUCT_SEG),
+                       uint8_t *buffer,
+                       uint8_t length);
+
+/***************************************************************************//**
+ * @brief
+ * Copy up to length bytes out of the ring (consumer).
+ *
+ * @return
+ * Number of bytes read. Less than length if the ring ran empty.
+ ******************************************************************************/
+uint8_t si8_ring_read(SI_VARIABLE_SEGMENT_POINTER(ring, si8Ring_t, SI8_RING_STRUCT_SEG),
+                      uint8_t *buffer,
+                      uint8_t length);
+
+/***************************************************************************//**
+ * @brief
+ * Get the largest contiguous free region of the ring (producer).
+ *
+ * @param span:
+ * Set to the start of the free region.
+ *
+ * @return
+ * Number of bytes that can be written at span. Zero if the ring is full.
+ *
+ * The bytes are not part of the ring until si8_ring_commitWrite() is
+ * called.
+ ******************************************************************************/
+uint8_t si8_ring_getWriteSpan(SI_VARIABLE_SEGMENT_POINTER(ring, si8Ring_t, SI8_RING_STRUCT_SEG),
+                              SI_VARIABLE_SEGMENT_POINTER(*span, uint8_t, SI8_RING_BUFFER_SEG));
+
+/***************************************************************************//**
+ * @brief
+ * Publish count bytes written to the span from si8_ring_getWriteSpan().
+ ******************************************************************************/
+#define si8_ring_commitWrite(ring, count)                                     \
+            do {(ring)->head += (count);} while (0)
+
+/***************************************************************************//**
+ * @brief
+ * Get the largest contiguous filled region of the ring (consumer).
+ *
+ * @param span:
+ * Set to the oldest byte in the ring.
+ *
+ * @return
+ * Number of bytes that can be read at span. Zero if the ring is empty.
+ *
+ * The bytes stay in the ring until si8_ring_consume() is called.
+ ******************************************************************************/
+uint8_t si8_ring_getReadSpan(SI_VARIABLE_SEGMENT_POINTER(ring, si8Ring_t, SI8_RING_STRUCT_SEG),
+                             SI_VARIABLE_SEGMENT_POINTER(*span, uint8_t, SI8_RING_BUFFER_SEG));
+
+/***************************************************************************//**
+ * @brief
+ * Release count bytes read from the span from si8_ring_getReadSpan().
+ ******************************************************************************/
+#define si8_ring_consume(ring, count)                                         \
+            do {(ring)->tail += (count);} while (0)
+
+/** @} (end addtogroup si8_ring_api Ring Buffer API) */
+/** @} (end addtogroup si8_ring Ring Buffer) */
+
+#endif //__SI8_RING_H__
@@ -0,0 +1,135 @@
+/**************************************************************************//**
+ * Copyright (c) 2015 by Silicon Laboratories Inc. All rights reserved.
+ *
+ * http://developer.silabs.com/legal/version/v11/Silicon_Labs_Software_License_Agreement.txt
+ *****************************************************************************/
+
+#include "si8_ring.h"
+#include "assert.h"
+
+void si8_ring_init(SI_VARIABLE_SEGMENT_POINTER(ring, si8Ring_t, SI8_RING_STRUCT_SEG),
+                   SI_VARIABLE_SEGMENT_POINTER(buffer, uint8_t, SI8_RING_BUFFER_SEG),
+                   uint8_t size)
+{
+  // Size must be a power of two that the free-running indices can count
+  SLAB_ASSERT(size >= 2 && size <= 128 && !(size & (size - 1)));
+
+  ring->buf = buffer;
+  ring->mask = size - 1;
+  ring->head = 0;
+  ring->tail = 0;
+}
+
+bool si8_ring_push(SI_VARIABLE_SEGMENT_POINTER(ring, si8Ring_t, SI8_RING_STRUCT_SEG), uint8_t value)
+{
+  uint8_t head = ring->head;
+
+  if ((uint8_t)(head - ring->tail) > ring->mask)
+  {
+    return false;
+  }
+
+  // Store the data before publishing the new head to the consumer
+  ring->buf[head & ring->mask] = value;
+  ring->head = head + 1;
+  return true;
+}
+
+bool si8_ring_pop(SI_VARIABLE_SEGMENT_POINTER(ring, si8Ring_t, SI8_RING_STRUCT_SEG), uint8_t *value)
+{
+  uint8_t tail = ring->tail;
+
+  if (tail == ring->head)
+  {
+    return false;
+  }
+
+  // Read the data before releasing the slot to the producer
+  *value = ring->buf[tail & ring->mask];
+  ring->tail = tail + 1;
+  return true;
+}
+
+uint8_t si8_ring_getWriteSpan(SI_VARIABLE_SEGMENT_POINTER(ring, si8Ring_t, SI8_RING_STRUCT_SEG),
+                              SI_VARIABLE_SEGMENT_POINTER(*span, uint8_t, SI8_RING_BUFFER_SEG))
+{
+  uint8_t head = ring->head;
+  uint8_t index = head & ring->mask;
+  uint8_t space = ring->mask + 1 - (uint8_t)(head - ring->tail);
+  uint8_t toEnd = ring->mask + 1 - index;
+
+  *span = &ring->buf[index];
+  return (space < toEnd) ? space : toEnd;
+}
+
+uint8_t si8_ring_getReadSpan(SI_VARIABLE_SEGMENT_POINTER(ring, si8Ring_t, SI8_RING_STRUCT_SEG),
+                             SI_VARIABLE_SEGMENT_POINTER(*span, uint8_t, SI8_RING_BUFFER_SEG))
+{
+  uint8_t tail = ring->tail;
+  uint8_t index = tail & ring->mask;
+  uint8_t used = ring->head - tail;
+  uint8_t toEnd = ring->mask + 1 - index;
+
+  *span = &ring->buf[index];
+  return (used < toEnd) ? used : toEnd;
+}
+
+uint8_t si8_ring_write(SI_VARIABLE_SEGMENT_POINTER(ring, si8Ring_t, SI8_RING_STRUCT_SEG),
+                       uint8_t *buffer,
+                       uint8_t length)
+{
+  SI_VARIABLE_SEGMENT_POINTER(span, uint8_t, SI8_RING_BUFFER_SEG);
+  uint8_t written = 0;
+  uint8_t n, i;
+
+  // At most two spans: up to the end of the buffer, then from the start
+  while (written < length)
+  {
+    n = si8_ring_getWriteSpan(ring, &span);
+    if (n == 0)
+    {
+      break;
+    }
+    if (n > length - written)
+    {
+      n = length - written;
+    }
+    for (i = 0; i < n; i++)
+    {
+      span[i] = *buffer++;
+    }
+    si8_ring_commitWrite(ring, n);
+    written += n;
+  }
+  return written;
+}
+
+uint8_t si8_ring_read(SI_VARIABLE_SEGMENT_POINTER(ring, si8Ring_t, SI8_RING_STRUCT_SEG),
+                      uint8_t *buffer,
+                      uint8_t length)
+{
+  SI_VARIABLE_SEGMENT_POINTER(span, uint8_t, SI8_RING_BUFFER_SEG);
+  uint8_t count = 0;
+  uint8_t n, i;
+
+  // At most two spans: up to the end of the buffer, then from the start
+  while (count < length)
+  {
+    n = si8_ring_getReadSpan(ring, &span);
+    if (n == 0)
+    {
+      break;
+    }
+    if (n > length - count)
+    {
+      n = length - count;
+    }
+    for (i = 0; i < n; i++)
+    {
+      *buffer++ = span[i];
+    }
+    si8_ring_consume(ring, n);
+    count += n;
+  }
+  return count;
+}
@@ -0,0 +1,126 @@
+/**************************************************************************//**
+ * Copyright (c) 2015 by Silicon Laboratories Inc. All rights reserved.
+ *
+ * http://developer.silabs.com/legal/version/v11/Silicon_Labs_Software_License_Agreement.txt
+ *****************************************************************************/
+
+// Single-source WDT0 driver for all EFM8 devices. The device is described by
+// efm8_traits.h, which selects between the dedicated WDTCN watchdog and the
+// PCA0-based watchdog at compile time.
+
+#include "wdt_0.h"
+#include "efm8_traits.h"
+#include "assert.h"
+
+#if (EFM8PDL_WDT0_AUTO_PAGE == 1) && EFM8_WDT0_USES_PCA
+// declare variable needed for autopage enter/exit
+#define DECL_PAGE uint8_t savedPage
+// enter autopage section
+#define SET_PAGE(p)     do                                                    \
+                        {                                                     \
+                          savedPage = SFRPAGE;  /* save current SFR page */   \
+                          SFRPAGE = (p);        /* set SFR page */            \
+                        } while(0)
+// exit autopage section
+#define RESTORE_PAGE    do                                                    \
+                        {                                                     \
+                          SFRPAGE = savedPage;  /* restore saved SFR page */  \
+                        } while(0)
+
+#else
+#define DECL_PAGE
+#define SET_PAGE(p)
+#define RESTORE_PAGE
+#endif
+
+#if EFM8_WDT0_USES_PCA
+
+void WDT0_start()
+{
+  DECL_PAGE;
+  SET_PAGE(EFM8_WDT0_SFR_PAGE);
+  PCA0MD |= PCA0MD_WDTE__BMASK;
+  EFM8_WDT0_PCA_CPH = 0x00;
+  RESTORE_PAGE;
+}
+
+void WDT0_stop()
+{
+  DECL_PAGE;
+  SET_PAGE(EFM8_WDT0_SFR_PAGE);
+  PCA0MD &= ~PCA0MD_WDTE__BMASK;
+  RESTORE_PAGE;
+}
+
+void WDT0_feed()
+{
+  DECL_PAGE;
+  SET_PAGE(EFM8_WDT0_SFR_PAGE);
+  EFM8_WDT0_PCA_CPH = 0x00;
+  RESTORE_PAGE;
+}
+
+void WDT0_init(uint8_t interval,
+               WDT0_Timebase_t  timebase,
+               WDT0_IdleState_t idleState)
+{
+  DECL_PAGE;
+  SET_PAGE(EFM8_WDT0_SFR_PAGE);
+  //Counter/Timer can not be modified when WDT enabled
+  SLAB_ASSERT(!(PCA0MD & PCA0MD_WDTE__BMASK));
+  PCA0MD &= ~(PCA0MD_CPS__FMASK | PCA0MD_CIDL__BMASK);
+  PCA0MD |= timebase + idleState;
+
+  //Reload value is interval/256
+  EFM8_WDT0_PCA_CPL = interval;
+
+  RESTORE_PAGE;
+}
+
+#else // EFM8_WDT0_USES_PCA
+
+void WDT0_start(){
+  WDTCN = 0xA5;
+}
+
+void WDT0_stop()
+{
+  bool ea = IE_EA;
+  IE_EA = 0;
+  WDTCN = 0xDE;
+  WDTCN = 0xAD;
+  IE_EA = ea;
+}
+
+void WDT0_feed()
+{
+  WDTCN = 0xA5;
+}
+
+void WDT0_init(uint8_t interval,
+               WDT0_Timebase_t  timebase,
+               WDT0_IdleState_t idleState)
+{
+  // The timebase and idleState parameters are not used by the WDTCN
+  // watchdog but are present for API compatibility.
+  timebase=timebase;
+  idleState=idleState;
+  WDTCN = interval;
+}
+
+#endif // EFM8_WDT0_USES_PCA
+
+#if EFM8_WDT0_ERRATUM_E102
+void WDT0_delay(uint32_t systemClkFreq, uint32_t wdtClkFreq, uint32_t wdtClkCycles) {
+  uint32_t systemClkCycles, i;
+
+  // Calculate how many system clock cycles to wait. This value is divided by 3 corresponding to the minimum cycles required to execute the wait loop
+  systemClkCycles = (wdtClkCycles * systemClkFreq) / (wdtClkFreq * 3);
+
+  // Wait loop
+
+  for(i = 0; i < systemClkCycles; i++) {
+    NOP();
+  }
+}
+#endif // EFM8_WDT0_ERRATUM_E102
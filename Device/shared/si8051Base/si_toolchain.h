@@ -50,6 +50,26 @@
  * |specific       |generic       |@ref SI_SEGMENT_POINTER                 |
  * |specific       |specific      |@ref SI_SEGMENT_VARIABLE_SEGMENT_POINTER|
  *
+ * ## SFR Page Batching ##
+ *
+ * Peripheral drivers built with auto-paging enabled save, set, and restore
+ * `SFRPAGE` around every register access.  When a sequence of driver calls
+ * all target the same page, the driver can be built with auto-paging
+ * disabled and the sequence wrapped in @ref SI_PAGE_BATCH_BEGIN and
+ * @ref SI_PAGE_BATCH_END so the page is set once for the whole sequence:
+ *
+ * ~~~~~.c
+ * SI_PAGE_BATCH_BEGIN(PG4_PAGE)
+ *   ADC0_clearIntFlags(ADC0_CONVERSION_COMPLETE_IF);
+ *   ADC0_startConversion();
+ *   while (!ADC0_isConversionComplete());
+ *   result = ADC0_getResult();
+ * SI_PAGE_BATCH_END()
+ * ~~~~~
+ *
+ * The batch opens a C block, so it must begin and end in the same function
+ * and any local declarations inside the batch must come first.
+ *
  * ## Prior Toolchain Abstraction Header File ##
  *
  * This file supercedes an earlier header file named `compiler_defs.h`.  We
@@ -1312,6 +1332,25 @@ typedef union SI_GEN_PTR
 #error Unrecognized toolchain in si_toolchain.h
 #endif
 
+// -------------------------------
+// SFR page batching (all toolchains)
+//
+
+/// Begins a block of code that runs with `SFRPAGE` set to @p page.  The
+/// previous page is saved and restored by the matching
+/// @ref SI_PAGE_BATCH_END.  Must not be used in interrupt service routines,
+/// which rely on the hardware page stack instead.
+#define SI_PAGE_BATCH_BEGIN(page)                                             \
+          {                                                                   \
+            uint8_t si_batchSavedPage = SFRPAGE;                              \
+            SFRPAGE = (page);
+
+/// Ends a block started with @ref SI_PAGE_BATCH_BEGIN and restores the
+/// `SFRPAGE` value that was active when the batch began.
+#define SI_PAGE_BATCH_END()                                                   \
+            SFRPAGE = si_batchSavedPage;                                      \
+          }
+
 /** @} */
 
 #endif
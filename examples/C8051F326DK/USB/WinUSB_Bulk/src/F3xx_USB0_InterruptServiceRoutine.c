@@ -30,6 +30,7 @@
 //-----------------------------------------------------------------------------
 
 #include "c8051f3xx.h"
+#include "../../../../shared/USB0/F3xx_USB0_Fifo.h"
 #include "F3xx_USB0_Register.h"
 #include "F3xx_USB0_Descriptor.h"
 #include "F3xx_USB0_InterruptServiceRoutine.h"
@@ -65,10 +66,6 @@ static void Handle_Control (void);
 static void Send_Packet_ISR (void);
 static void Handle_Out1 (void);
 static void Receive_Packet (void);
-static void Fifo_Read (uint8_t, uint8_t*, uint16_t);
-static void Fifo_Write_ISR (uint8_t, uint8_t const *, uint16_t);
-static void Fifo_Write_Foreground (uint8_t addr, uint8_t const * buffer,
-				   uint16_t size);
 
 //-----------------------------------------------------------------------------
 // Interrupt Service Routines
@@ -219,7 +216,7 @@ static void Handle_Control (void)
       {
          // Get Setup Packet off of Fifo,
          // it is currently Big-Endian
-         Fifo_Read (FIFO_EP0, (uint8_t*) &Setup, 8);
+         Fifo_Read (FIFO_EP0, 8, (uint8_t*) &Setup);
 
 // If using a big-endian compiler
 #if (MSB == 0)
@@ -300,7 +297,7 @@ static void Handle_Control (void)
             if (DataSize >= EP0_PACKET_SIZE)
             {
                // Break Data into multiple packets if larger than Max Packet
-               Fifo_Write_ISR (FIFO_EP0, (uint8_t*)DataPtr, EP0_PACKET_SIZE);
+               Fifo_Write (FIFO_EP0, EP0_PACKET_SIZE, (uint8_t*)DataPtr);
                // Advance data pointer
                DataPtr  += EP0_PACKET_SIZE;
                // Decrement data size
@@ -311,7 +308,7 @@ static void Handle_Control (void)
             else
             {
                // If data is less than Max Packet size or zero
-               Fifo_Write_ISR (FIFO_EP0, (uint8_t*)DataPtr, DataSize);
+               Fifo_Write (FIFO_EP0, DataSize, (uint8_t*)DataPtr);
                controlReg |= rbDATAEND;// Add Data End bit to bitmask
                EP_Status[0] = EP_IDLE; // Return EP 0 to idle state
             }
@@ -361,7 +358,7 @@ static void Send_Packet_ISR ()
          if (In_Packet_Ready)
          {
             // Write new data to IN FIFO
-            Fifo_Write_ISR (FIFO_EP1, In_Packet, IN_EP1_PACKET_SIZE);
+            Fifo_WriteXdata (FIFO_EP1, In_Packet, IN_EP1_PACKET_SIZE);
 
             // Clear in packet ready
             In_Packet_Ready = 0;
@@ -391,7 +388,7 @@ void Send_Packet_Foreground ()
          if (In_Packet_Ready)
          {
             // Write new data to IN FIFO
-            Fifo_Write_Foreground (FIFO_EP1, In_Packet, IN_EP1_PACKET_SIZE);
+            Fifo_WriteXdata (FIFO_EP1, In_Packet, IN_EP1_PACKET_SIZE);
 
             // Clear in packet ready
             In_Packet_Ready = 0;
@@ -485,7 +482,7 @@ static void Receive_Packet ()
             // Otherwise get the data packet
             else
             {
-               Fifo_Read (FIFO_EP1, (uint8_t*)Out_Packet, OUT_EP1_PACKET_SIZE);
+               Fifo_ReadXdata (FIFO_EP1, Out_Packet, OUT_EP1_PACKET_SIZE);
 
                Out_Packet_Ready = 1;
             }
@@ -497,100 +494,6 @@ static void Receive_Packet ()
    }
 }
 
-//-----------------------------------------------------------------------------
-// Fifo_Read
-//-----------------------------------------------------------------------------
-//
-// Return Value : None
-// Parameters   :
-//                1) uint8_t addr : target address
-//                2) uint8_t* buffer : read data destination
-//                3) uint16_t size : number of bytes to unload
-//
-// Read from the selected endpoint FIFO
-//
-//-----------------------------------------------------------------------------
-static void Fifo_Read (uint8_t addr, uint8_t * buffer, uint16_t size)
-{
-   uint16_t i;
-
-   // Check if >0 bytes requested,
-   if (size)
-   {
-      USB0ADR = addr;                  // Set address
-      USB0ADR |= 0xC0;                 // Set auto-read and initiate
-                                       // first read
-
-      // Unload <size> from the selected FIFO
-      for(i = 0; i < size; i++)
-      {
-         while (USB0ADR & 0x80);       // Wait for BUSY->'0' (data ready)
-         buffer[i] = USB0DAT;          // Copy data byte
-      }
-
-      //while(USB0ADR & 0x80);         // Wait for BUSY->'0' (data ready)
-      USB0ADR = 0;                     // Clear auto-read
-   }
-}
-
-//-----------------------------------------------------------------------------
-// Fifo_Write
-//-----------------------------------------------------------------------------
-//
-// Return Value : None
-// Parameters   :
-//                1) uint8_t addr : target address
-//                2) uint8_t* buffer : location of source data
-//                3) uint16_t size : number of bytes to unload
-//
-// Write to the selected endpoint FIFO
-//
-//-----------------------------------------------------------------------------
-
-// Called from ISR
-static void Fifo_Write_ISR (uint8_t addr, uint8_t const * buffer,
-                            uint16_t size)
-{
-   uint16_t i;
-
-   // If >0 bytes requested,
-   if (size)
-   {
-      while (USB0ADR & 0x80);          // Wait for BUSY->'0'
-                                       // (register available)
-      USB0ADR = addr;                  // Set address (mask out bits7-6)
-
-      // Write <size> to the selected FIFO
-      for (i = 0; i < size; i++)
-      {
-         USB0DAT = buffer[i];
-         while (USB0ADR & 0x80);       // Wait for BUSY->'0' (data ready)
-      }
-   }
-}
-
-// Called from foreground
-static void Fifo_Write_Foreground (uint8_t addr, uint8_t const * buffer,
-                                   uint16_t size)
-{
-   uint16_t i;
-
-   // If >0 bytes requested,
-   if (size)
-   {
-      while (USB0ADR & 0x80);          // Wait for BUSY->'0'
-                                       // (register available)
-      USB0ADR = addr;                  // Set address (mask out bits7-6)
-
-      // Write <size> to the selected FIFO
-      for (i = 0; i < size; i++)
-      {
-         USB0DAT = buffer[i];
-         while (USB0ADR & 0x80);       // Wait for BUSY->'0' (data ready)
-      }
-   }
-}
-
 //-----------------------------------------------------------------------------
 // Global Functions
 //-----------------------------------------------------------------------------
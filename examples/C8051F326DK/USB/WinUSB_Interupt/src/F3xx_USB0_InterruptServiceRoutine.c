@@ -30,6 +30,7 @@
 //-----------------------------------------------------------------------------
 
 #include "c8051f3xx.h"
+#include "../../../../shared/USB0/F3xx_USB0_Fifo.h"
 #include "F3xx_USB0_Register.h"
 #include "F3xx_USB0_InterruptServiceRoutine.h"
 #include "F3xx_USB0_Descriptor.h"
@@ -62,11 +63,6 @@ void Handle_Control (void);            // Handle Setup packet on EP 0
 void Handle_In1 (void);                // Handle in packet on EP 1
 void Handle_Out1 (void);               // Handle out packet on EP 1
 
-void Fifo_Read (uint8_t, uint16_t, uint8_t*);         // Used for multiple byte reads
-                                       // of Endpoint fifos
-void Fifo_Write_InterruptServiceRoutine (uint8_t, uint16_t, uint8_t const *);
-                                       // Used for multiple byte
-                                       // writes of Endpoint fifos
 
 //-----------------------------------------------------------------------------
 // Usb_ISR
@@ -275,8 +271,7 @@ void Handle_Control (void)
             if (DataSize >= EP0_PACKET_SIZE)
             {
                // Break Data into multiple packets if larger than Max Packet
-               Fifo_Write_InterruptServiceRoutine (FIFO_EP0, EP0_PACKET_SIZE,
-                                                                                         (uint8_t*)DataPtr);
+               Fifo_Write (FIFO_EP0, EP0_PACKET_SIZE, (uint8_t*)DataPtr);
                // Advance data pointer
                DataPtr  += EP0_PACKET_SIZE;
                // Decrement data size
@@ -287,8 +282,7 @@ void Handle_Control (void)
             else
             {
                // If data is less than Max Packet size or zero
-               Fifo_Write_InterruptServiceRoutine (FIFO_EP0, DataSize,
-                                                   (uint8_t*)DataPtr);
+               Fifo_Write (FIFO_EP0, DataSize, (uint8_t*)DataPtr);
                controlReg |= rbDATAEND;// Add Data End bit to bitmask
                EP_Status[0] = EP_IDLE; // Return EP 0 to idle state
             }
@@ -340,7 +334,7 @@ void Handle_In1 ()
       }
 
       // Put new data on Fifo
-      Fifo_Write_InterruptServiceRoutine(FIFO_EP1, IN_EP1_PACKET_SIZE, In_Packet);
+      Fifo_WriteXdata (FIFO_EP1, In_Packet, IN_EP1_PACKET_SIZE);
 
       // Set In Packet ready bit, indicating
       POLL_WRITE_BYTE(EINCSR1, rbInINPRDY);
@@ -387,7 +381,7 @@ void Handle_Out1 ()
       // Otherwise get the data packet
       else
       {
-         Fifo_Read(FIFO_EP1, OUT_EP1_PACKET_SIZE, (uint8_t*)Out_Packet);
+         Fifo_ReadXdata (FIFO_EP1, Out_Packet, OUT_EP1_PACKET_SIZE);
       }
 
       // Clear Out Packet ready bit
@@ -395,77 +389,6 @@ void Handle_Out1 ()
    }
 }
 
-//-----------------------------------------------------------------------------
-// Fifo_Read
-//-----------------------------------------------------------------------------
-//
-// Return Value : None
-// Parameters   :
-//                1) uint8_t addr : target address
-//                2) uint16_t uNumBytes : number of bytes to unload
-//                3) uint8_t* pData : read data destination
-//
-// Read from the selected endpoint FIFO
-//
-//-----------------------------------------------------------------------------
-void Fifo_Read (uint8_t addr, uint16_t uNumBytes, uint8_t * pData)
-{
-   uint16_t i;
-
-   if (uNumBytes)                      // Check if >0 bytes requested,
-   {
-      USB0ADR = addr;                  // Set address
-      USB0ADR |= 0xC0;                 // Set auto-read and initiate
-                                       // first read
-
-      // Unload <NumBytes> from the selected FIFO
-      for(i = 0; i < uNumBytes; i++)
-      {
-         while (USB0ADR & 0x80);       // Wait for BUSY->'0' (data ready)
-         pData[i] = USB0DAT;           // Copy data byte
-      }
-
-      //while(USB0ADR & 0x80);         // Wait for BUSY->'0' (data ready)
-      USB0ADR = 0;                     // Clear auto-read
-   }
-}
-
-//-----------------------------------------------------------------------------
-// Fifo_Write_InterruptServiceRoutine
-//-----------------------------------------------------------------------------
-//
-// Return Value : None
-// Parameters   :
-//                1) uint8_t addr : target address
-//                2) uint16_t uNumBytes : number of bytes to unload
-//                3) uint8_t* pData : location of source data
-//
-// Write to the selected endpoint FIFO
-//
-// Fifo_Write_InterruptServiceRoutine is used for calls made in an ISR.
-//
-//-----------------------------------------------------------------------------
-void Fifo_Write_InterruptServiceRoutine (uint8_t addr, uint16_t uNumBytes,
-                                         uint8_t const * pData)
-{
-   uint16_t i;
-
-   // If >0 bytes requested,
-   if (uNumBytes)
-   {
-      while (USB0ADR & 0x80);          // Wait for BUSY->'0'
-                                       // (register available)
-      USB0ADR = addr;                  // Set address (mask out bits7-6)
-
-      // Write <NumBytes> to the selected FIFO
-      for (i = 0; i < uNumBytes; i++)
-      {
-         USB0DAT = pData[i];
-         while (USB0ADR & 0x80);       // Wait for BUSY->'0' (data ready)
-      }
-   }
-}
-
 //-----------------------------------------------------------------------------
 // Force_Stall
 //-----------------------------------------------------------------------------
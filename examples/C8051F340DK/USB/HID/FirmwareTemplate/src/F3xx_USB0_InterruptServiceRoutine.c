@@ -34,6 +34,7 @@
 // Includes
 //-----------------------------------------------------------------------------
 #include "c8051f3xx.h"
+#include "../../../../../shared/USB0/F3xx_USB0_Fifo.h"
 #include "F3xx_USB0_Register.h"
 #include "F3xx_USB0_InterruptServiceRoutine.h"
 #include "F3xx_USB0_Descriptor.h"
@@ -68,16 +69,6 @@ void Handle_In1 (void);                // Handle in packet on EP 1
 void Handle_Out1 (void);               // Handle out packet on EP 1
 void Usb_Suspend (void);               // This routine called when
                                        // Suspend signalling on bus
-void Fifo_Read (unsigned char, unsigned int, unsigned char *);
-                                       // Used for multiple byte reads
-                                       // of Endpoint fifos
-void Fifo_Write_Foreground (unsigned char, unsigned int, unsigned char *);
-                                       // Used for multiple byte writes
-                                       // of Endpoint fifos in foreground
-void Fifo_Write_InterruptServiceRoutine (unsigned char, unsigned int,
-										 unsigned char *);
-                                       // Used for multiple byte
-                                       // writes of Endpoint fifos
 
 
 //-----------------------------------------------------------------------------
@@ -315,8 +306,7 @@ void Handle_Control (void)
             if (DATASIZE >= EP0_PACKET_SIZE)
             {
                // Break Data into multiple packets if larger than Max Packet
-               Fifo_Write_InterruptServiceRoutine (FIFO_EP0, EP0_PACKET_SIZE,
-               									  (unsigned char*)DATAPTR);
+               Fifo_Write (FIFO_EP0, EP0_PACKET_SIZE, (unsigned char*)DATAPTR);
                // Advance data pointer
                DATAPTR  += EP0_PACKET_SIZE;
                // Decrement data size
@@ -327,8 +317,7 @@ void Handle_Control (void)
             else
             {
                // If data is less than Max Packet size or zero
-               Fifo_Write_InterruptServiceRoutine (FIFO_EP0, DATASIZE,
-               									  (unsigned char*)DATAPTR);
+               Fifo_Write (FIFO_EP0, DATASIZE, (unsigned char*)DATAPTR);
                ControlReg |= rbDATAEND;// Add Data End bit to bitmask
                EP_STATUS[0] = EP_IDLE; // Return EP 0 to idle state
             }
@@ -460,102 +449,6 @@ void Usb_Suspend (void)
    k++;
 }
 
-//-----------------------------------------------------------------------------
-// Fifo_Read
-//-----------------------------------------------------------------------------
-//
-// Return Value : None
-// Parameters   :
-//                1) BYTE addr : target address
-//                2) unsigned int uNumBytes : number of bytes to unload
-//                3) BYTE * pData : read data destination
-//
-// Read from the selected endpoint FIFO
-//
-//-----------------------------------------------------------------------------
-void Fifo_Read (unsigned char addr, unsigned int uNumBytes,
-               unsigned char * pData)
-{
-   int i;
-
-   if (uNumBytes)                      // Check if >0 bytes requested,
-   {
-      USB0ADR = (addr);                // Set address
-      USB0ADR |= 0xC0;                 // Set auto-read and initiate
-                                       // first read
-
-      // Unload <NumBytes> from the selected FIFO
-      for(i=0;i< (uNumBytes);i++)
-      {
-         while (USB0ADR & 0x80);       // Wait for BUSY->'0' (data ready)
-         pData[i] = USB0DAT;           // Copy data byte
-      }
-
-      //while(USB0ADR & 0x80);         // Wait for BUSY->'0' (data ready)
-      USB0ADR = 0;                     // Clear auto-read
-   }
-}
-
-//-----------------------------------------------------------------------------
-// Fifo_Write
-//-----------------------------------------------------------------------------
-//
-// Return Value : None
-// Parameters   :
-//                1) BYTE addr : target address
-//                2) unsigned int uNumBytes : number of bytes to unload
-//                3) BYTE * pData : location of source data
-//
-// Write to the selected endpoint FIFO
-//
-// Fifo_Write_Foreground is used for function calls made in the foreground routines,
-// and Fifo_Write_InterruptServiceRoutine is used for calls made in an ISR.
-
-//-----------------------------------------------------------------------------
-
-void Fifo_Write_Foreground (unsigned char addr, unsigned int uNumBytes,
-                    unsigned char * pData)
-{
-   int i;
-
-   // If >0 bytes requested,
-   if (uNumBytes)
-   {
-      while (USB0ADR & 0x80);          // Wait for BUSY->'0'
-                                       // (register available)
-      USB0ADR = (addr);                // Set address (mask out bits7-6)
-
-      // Write <NumBytes> to the selected FIFO
-      for(i=0;i<uNumBytes;i++)
-      {
-         USB0DAT = pData[i];
-         while (USB0ADR & 0x80);       // Wait for BUSY->'0' (data ready)
-      }
-   }
-}
-
-void Fifo_Write_InterruptServiceRoutine (unsigned char addr,
-                                         unsigned int uNumBytes,
-                                         unsigned char * pData)
-{
-   int i;
-
-   // If >0 bytes requested,
-   if (uNumBytes)
-   {
-      while (USB0ADR & 0x80);          // Wait for BUSY->'0'
-                                       // (register available)
-      USB0ADR = (addr);                // Set address (mask out bits7-6)
-
-      // Write <NumBytes> to the selected FIFO
-      for (i=0; i<uNumBytes; i++)
-      {
-         USB0DAT = pData[i];
-         while (USB0ADR & 0x80);       // Wait for BUSY->'0' (data ready)
-      }
-   }
-}
-
 //-----------------------------------------------------------------------------
 // Force_Stall
 //-----------------------------------------------------------------------------
@@ -625,8 +518,7 @@ void SendPacket (unsigned char ReportID)
       ReportHandler_IN_Foreground (ReportID);
 
       // Put new data on Fifo
-      Fifo_Write_Foreground (FIFO_EP1, IN_BUFFER.Length,
-                    (unsigned char *)IN_BUFFER.Ptr);
+      Fifo_Write (FIFO_EP1, IN_BUFFER.Length, (unsigned char *)IN_BUFFER.Ptr);
       POLL_WRITE_BYTE (EINCSR1, rbInINPRDY);
                                        // Set In Packet ready bit,
    }                                   // indicating fresh data on FIFO 1
@@ -116,8 +116,8 @@ void System_Init (void)
 void USB0_Init (void)
 {
    POLL_WRITE_BYTE (POWER,  0x08);     // Force Asynchronous USB Reset
-   POLL_WRITE_BYTE (IN1IE,  0x03);     // Enable Endpoint 0-1 in interrupts
-   POLL_WRITE_BYTE (OUT1IE, 0x02);     // Enable Endpoint 1 out interrupts
+   POLL_WRITE_BYTE (IN1IE,  0x05);     // Enable Endpoint 0, 2 in interrupts
+   POLL_WRITE_BYTE (OUT1IE, 0x04);     // Enable Endpoint 2 out interrupts
    POLL_WRITE_BYTE (CMIE,   0x0F);     // Enable SOF, Reset, Resume, and
                                        // Suspend interrupts
 
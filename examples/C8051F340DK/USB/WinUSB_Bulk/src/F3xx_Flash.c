@@ -151,28 +151,3 @@ void WriteFlashPage(uint16_t address, uint8_t * buffer, uint16_t size)
    // Restore interrupts
    IE_EA = EA_Save;
 }
-
-//-----------------------------------------------------------------------------
-// ReadFlashPage
-//-----------------------------------------------------------------------------
-//
-// Return Value : None
-// Parameters   :
-//                1) uint16_t address : the address of the flash page to read
-//                2) uint8_t buffer[] : a buffer to read from the flash page starting
-//                                 at the specified page address
-//                3) uint16_t size : the number of bytes to read into the buffer
-//
-// Read the specified number of bytes from flash and store in the buffer.
-//
-//-----------------------------------------------------------------------------
-void ReadFlashPage(uint16_t address, uint8_t * buffer, uint16_t size)
-{
-   SI_VARIABLE_SEGMENT_POINTER(pAddr, uint8_t, SI_SEG_CODE) = (uint8_t SI_SEG_CODE *) address;
-   uint16_t i;
-
-   for (i = 0; i < size; i++)
-   {
-      buffer[i] = pAddr[i];
-   }
-}
@@ -37,6 +37,5 @@
 void SetFlashKey(uint8_t key[2]);
 void EraseFlashPage(uint16_t pageAddress);
 void WriteFlashPage(uint16_t address, uint8_t * buffer, uint16_t size);
-void ReadFlashPage(uint16_t address, uint8_t * buffer, uint16_t size);
 
 #endif // _F3XX_FLASH_H_
@@ -88,23 +88,23 @@ SI_SEGMENT_VARIABLE(INTERFACE_DESC, const Interface_Descriptor, SI_SEG_CODE) =
    0x00                 // iInterface
 };
 
-SI_SEGMENT_VARIABLE(IN_EP1_DESC, const Endpoint_Descriptor, SI_SEG_CODE) = 
+SI_SEGMENT_VARIABLE(IN_EP2_DESC, const Endpoint_Descriptor, SI_SEG_CODE) = 
 {
    0x07,                // bLength
    0x05,                // bDescriptorType
-   0x81,                // bEndpointAddress (IN EP1)
+   0x82,                // bEndpointAddress (IN EP2)
    0x02,                // bmAttributes (Bulk)
-   LE_ARRAY(IN_EP1_PACKET_SIZE), // MaxPacketSize
+   LE_ARRAY(IN_EP2_PACKET_SIZE), // MaxPacketSize
    1                    // bInterval (Unused)
 };
 
-SI_SEGMENT_VARIABLE(OUT_EP1_DESC, const Endpoint_Descriptor, SI_SEG_CODE) = 
+SI_SEGMENT_VARIABLE(OUT_EP2_DESC, const Endpoint_Descriptor, SI_SEG_CODE) = 
 {
    0x07,                // bLength
    0x05,                // bDescriptorType
-   0x01,                // bEndpointAddress (OUT EP1)
+   0x02,                // bEndpointAddress (OUT EP2)
    0x02,                // bmAttributes (Bulk)
-   LE_ARRAY(OUT_EP1_PACKET_SIZE), // MaxPacketSize
+   LE_ARRAY(OUT_EP2_PACKET_SIZE), // MaxPacketSize
    1                    // bInterval (Unused)
 };
 
@@ -131,8 +131,8 @@ typedef struct Setup_Buffer
 extern SI_SEGMENT_VARIABLE(DEVICE_DESC, const Device_Descriptor, SI_SEG_CODE);
 extern SI_SEGMENT_VARIABLE(CONFIG_DESC, const Configuration_Descriptor, SI_SEG_CODE);
 extern SI_SEGMENT_VARIABLE(INTERFACE_DESC, const Interface_Descriptor, SI_SEG_CODE);
-extern SI_SEGMENT_VARIABLE(IN_EP1_DESC, const Endpoint_Descriptor, SI_SEG_CODE);
-extern SI_SEGMENT_VARIABLE(OUT_EP1_DESC, const Endpoint_Descriptor, SI_SEG_CODE);
+extern SI_SEGMENT_VARIABLE(IN_EP2_DESC, const Endpoint_Descriptor, SI_SEG_CODE);
+extern SI_SEGMENT_VARIABLE(OUT_EP2_DESC, const Endpoint_Descriptor, SI_SEG_CODE);
 extern SI_SEGMENT_VARIABLE_SEGMENT_POINTER(STRING_DESC_TABLE[], uint8_t,
 					const SI_SEG_CODE, const SI_SEG_CODE);
 
@@ -36,6 +36,7 @@
 //-----------------------------------------------------------------------------
 
 #include "c8051f3xx.h"
+#include "../../../../shared/USB0/F3xx_USB0_Fifo.h"
 #include "F3xx_USB0_Register.h"
 #include "F3xx_USB0_Descriptor.h"
 #include "F3xx_USB0_InterruptServiceRoutine.h"
@@ -58,7 +59,7 @@ uint16_t DataSent;               // Amount of data sent so far
 uint8_t const * DataPtr;         // Pointer to data to return
 
 // Holds the status for each endpoint:
-// EP0, IN_EP1, OUT_EP1
+// EP0, IN_EP2, OUT_EP2
 uint8_t EP_Status[3] = {EP_IDLE, EP_HALT, EP_HALT};
 
 //-----------------------------------------------------------------------------
@@ -68,13 +69,7 @@ uint8_t EP_Status[3] = {EP_IDLE, EP_HALT, EP_HALT};
 static void Usb_Resume (void);
 static void Usb_Reset (void);
 static void Handle_Control (void);
-static void Send_Packet_ISR (void);
-static void Handle_Out1 (void);
-static void Receive_Packet (void);
-static void Fifo_Read (uint8_t, uint8_t*, uint16_t);
-static void Fifo_Write_ISR (uint8_t, uint8_t const *, uint16_t);
-static void Fifo_Write_Foreground (uint8_t addr, uint8_t const * buffer,
-				   uint16_t size);
+static void Handle_Out2 (void);
 
 //-----------------------------------------------------------------------------
 // Interrupt Service Routines
@@ -110,13 +105,13 @@ SI_INTERRUPT(Usb_ISR, USB0_IRQn)
    {                                // or packet transmitted if Endpoint 0
       Handle_Control();             // is in transmit mode
    }
-   if (bIn & rbIN1)                 // Handle In Packet sent, put new data
-   {                                // on endpoint 1 fifo
-      Handle_In1 ();
+   if (bIn & rbIN2)                 // Handle In Packet sent, put new data
+   {                                // on endpoint 2 fifo
+      Handle_In2 ();
    }
-   if (bOut & rbOUT1)               // Handle Out packet received, take
-   {                                // data off endpoint 1 fifo
-      Handle_Out1 ();
+   if (bOut & rbOUT2)               // Handle Out packet received, take
+   {                                // data off endpoint 2 fifo
+      Handle_Out2 ();
    }
    if (bCommon & rbSUSINT)          // Handle Suspend interrupt
    {
@@ -124,7 +119,7 @@ SI_INTERRUPT(Usb_ISR, USB0_IRQn)
    }
    if (bCommon & rbSOF)             // Preload the IN/OUT FIFOs after a SOF
    {
-      Send_Packet_ISR ();
+      Send_Packet ();
       Receive_Packet ();
    }
 }
@@ -225,7 +220,7 @@ static void Handle_Control (void)
       {
          // Get Setup Packet off of Fifo,
          // it is currently Big-Endian
-         Fifo_Read (FIFO_EP0, (uint8_t*) &Setup, 8);
+         Fifo_Read (FIFO_EP0, 8, (uint8_t*) &Setup);
 
 // If using a big-endian compiler
 #if (MSB == 0)
@@ -306,7 +301,7 @@ static void Handle_Control (void)
             if (DataSize >= EP0_PACKET_SIZE)
             {
                // Break Data into multiple packets if larger than Max Packet
-               Fifo_Write_ISR (FIFO_EP0, (uint8_t*)DataPtr, EP0_PACKET_SIZE);
+               Fifo_Write (FIFO_EP0, EP0_PACKET_SIZE, (uint8_t*)DataPtr);
                // Advance data pointer
                DataPtr  += EP0_PACKET_SIZE;
                // Decrement data size
@@ -317,7 +312,7 @@ static void Handle_Control (void)
             else
             {
                // If data is less than Max Packet size or zero
-               Fifo_Write_ISR (FIFO_EP0, (uint8_t*)DataPtr, DataSize);
+               Fifo_Write (FIFO_EP0, DataSize, (uint8_t*)DataPtr);
                controlReg |= rbDATAEND;// Add Data End bit to bitmask
                EP_Status[0] = EP_IDLE; // Return EP 0 to idle state
             }
@@ -337,81 +332,46 @@ static void Handle_Control (void)
 }
 
 //-----------------------------------------------------------------------------
-// Send_Packet
+// Send_Block_Foreground
 //-----------------------------------------------------------------------------
 //
-// Return Value : None
-// Parameters   : None
+// Return Value : 1 if the block was loaded into the IN FIFO, 0 otherwise
+// Parameters   :
+//                1) uint8_t const * block : IN_EP2_PACKET_SIZE bytes to send,
+//                   in any memory space
 //
-// Send the packet in In_Packet using the USB IN FIFO if available.
+// Copy a packet straight into the IN FIFO, skipping In_Packet. The IN FIFO
+// holds two packets, so the foreground can load the next flash block while
+// the previous one is still waiting for the host.
 //
-// - Copy a packet from In_Packet to IN FIFO if available and not halted
-//   and set IN packet ready to eventually transmit the packet to the host
+// In_Packet must be empty, so that packets are sent in order. Called from
+// foreground with interrupts disabled.
 //
 //-----------------------------------------------------------------------------
-
-// Called from ISR
-static void Send_Packet_ISR ()
+uint8_t Send_Block_Foreground (uint8_t const * block)
 {
    uint8_t controlReg;
 
-   POLL_WRITE_BYTE(INDEX, 1);           // Set index to endpoint 1 registers
-   POLL_READ_BYTE(EINCSR1, controlReg); // Read contol register for IN_EP1
+   POLL_WRITE_BYTE(INDEX, 2);           // Set index to endpoint 2 registers
+   POLL_READ_BYTE(EINCSR1, controlReg); // Read contol register for IN_EP2
 
-   if (EP_Status[1] != EP_HALT)
+   // If the endpoint is enabled and the IN FIFO has room for a packet
+   if ((EP_Status[1] != EP_HALT) && !(controlReg & rbInINPRDY))
    {
-      // If the IN FIFO has room for a packet
-      if (!(controlReg & rbInINPRDY))
-      {
-         // If In_Packet has data, then write to the IN FIFO
-         if (In_Packet_Ready)
-         {
-            // Write new data to IN FIFO
-            Fifo_Write_ISR (FIFO_EP1, In_Packet, IN_EP1_PACKET_SIZE);
-
-            // Clear in packet ready
-            In_Packet_Ready = 0;
-      
-            // Set In Packet ready bit, indicating a packet is ready
-            // to send to the host
-            POLL_WRITE_BYTE (EINCSR1, rbInINPRDY);
-         }
-      }
-   }
-}
+      Fifo_Write (FIFO_EP2, IN_EP2_PACKET_SIZE, block);
 
-// Called from foreground
-void Send_Packet_Foreground ()
-{
-   uint8_t controlReg;
-
-   POLL_WRITE_BYTE(INDEX, 1);           // Set index to endpoint 1 registers
-   POLL_READ_BYTE(EINCSR1, controlReg); // Read contol register for IN_EP1
-
-   if (EP_Status[1] != EP_HALT)
-   {
-      // If the IN FIFO has room for a packet
-      if (!(controlReg & rbInINPRDY))
-      {
-         // If In_Packet has data, then write to the IN FIFO
-         if (In_Packet_Ready)
-         {
-            // Write new data to IN FIFO
-            Fifo_Write_Foreground (FIFO_EP1, In_Packet, IN_EP1_PACKET_SIZE);
+      // Set In Packet ready bit. With double buffering, the hardware
+      // clears it again at once if the other packet buffer is free.
+      POLL_WRITE_BYTE (EINCSR1, rbInINPRDY);
 
-            // Clear in packet ready
-            In_Packet_Ready = 0;
-      
-            // Set In Packet ready bit, indicating a packet is ready
-            // to send to the host
-            POLL_WRITE_BYTE (EINCSR1, rbInINPRDY);
-         }
-      }
+      return 1;
    }
+
+   return 0;
 }
 
 //-----------------------------------------------------------------------------
-// Handle_Out1
+// Handle_Out2
 //-----------------------------------------------------------------------------
 //
 // Return Value : None
@@ -426,12 +386,12 @@ void Send_Packet_Foreground ()
 //   and set IN packet ready to eventually transmit the packet to the host
 //
 //-----------------------------------------------------------------------------
-static void Handle_Out1 ()
+static void Handle_Out2 ()
 {
    uint8_t controlReg;
 
-   POLL_WRITE_BYTE (INDEX, 1);             // Set index to endpoint 1 registers
-   POLL_READ_BYTE (EOUTCSR1, controlReg);  // Read contol register for OUT_EP1
+   POLL_WRITE_BYTE (INDEX, 2);             // Set index to endpoint 2 registers
+   POLL_READ_BYTE (EOUTCSR1, controlReg);  // Read contol register for OUT_EP2
 
    // If endpoint is halted, send a stall
    if (EP_Status[2] == EP_HALT)
@@ -452,208 +412,163 @@ static void Handle_Out1 ()
 }
 
 //-----------------------------------------------------------------------------
-// Receive_Packet
+// Global Functions
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Force_Stall
 //-----------------------------------------------------------------------------
 //
 // Return Value : None
 // Parameters   : None
 //
-// Receive the packet from the USB OUT FIFO and copy to Out_Packet if
-// available.
-//
-// - Copy a packet from In_Packet to IN FIFO if available and not halted
-//   and set IN packet ready to eventually transmit the packet to the host
+// Force a procedural stall to be sent to the host
 //
 //-----------------------------------------------------------------------------
-static void Receive_Packet ()
+void Force_Stall (void)
 {
-   uint8_t count = 0;
-   uint8_t controlReg;
-
-   POLL_WRITE_BYTE (INDEX, 1);             // Set index to endpoint 1 registers
-   POLL_READ_BYTE (EOUTCSR1, controlReg);  // Read contol register for OUT_EP1
-
-   if (EP_Status[2] != EP_HALT)
-   {
-      // If the OUT FIFO has data
-      if (controlReg & rbOutOPRDY)
-      {
-         // If Out_Packet has room for a packet
-         if (!Out_Packet_Ready)
-         {
-            POLL_READ_BYTE (EOUTCNTL, count);
-
-            // If host did not send correct packet size, flush buffer
-            if (count != OUT_EP1_PACKET_SIZE)
-            {
-               POLL_WRITE_BYTE (EOUTCSR1, rbOutFLUSH);
-            }
-            // Otherwise get the data packet
-            else
-            {
-               Fifo_Read (FIFO_EP1, (uint8_t*)Out_Packet, OUT_EP1_PACKET_SIZE);
-
-               Out_Packet_Ready = 1;
-            }
-
-            // Clear Out Packet ready bit
-            POLL_WRITE_BYTE (EOUTCSR1, 0);
-         }
-      }
-   }
+   POLL_WRITE_BYTE (INDEX, 0);
+   POLL_WRITE_BYTE (E0CSR, rbSDSTL);   // Set the send stall bit
+   EP_Status[0] = EP_STALL;            // Put the endpoint in stall status
 }
 
 //-----------------------------------------------------------------------------
-// Fifo_Read
+// Handle_In2
 //-----------------------------------------------------------------------------
 //
 // Return Value : None
-// Parameters   :
-//                1) uint8_t addr : target address
-//                2) uint8_t* buffer : read data destination
-//                3) uint16_t size : number of bytes to unload
+// Parameters   : None
 //
-// Read from the selected endpoint FIFO
+// Send the packet in In_Packet using the USB IN FIFO if available.
+//
+// - Send a STALL if the endpoint is halted
+// - Clear a sent STALL when the endpoint is unhalted
+// - Copy a packet from In_Packet to IN FIFO if available and not halted
+//   and set IN packet ready to eventually transmit the packet to the host
 //
 //-----------------------------------------------------------------------------
-static void Fifo_Read (uint8_t addr, uint8_t * buffer, uint16_t size)
+void Handle_In2 (void)
 {
-   uint16_t i;
+   uint8_t controlReg;
 
-   // Check if >0 bytes requested,
-   if (size)
-   {
-      USB0ADR = addr;                  // Set address
-      USB0ADR |= 0xC0;                 // Set auto-read and initiate
-                                       // first read
+   POLL_WRITE_BYTE (INDEX, 2);           // Set index to endpoint 2 registers
+   POLL_READ_BYTE (EINCSR1, controlReg); // Read contol register for IN_EP2
 
-      // Unload <size> from the selected FIFO
-      for(i = 0; i < size; i++)
+   // If endpoint is currently halted, send a stall
+   if (EP_Status[1] == EP_HALT)
+   {
+      POLL_WRITE_BYTE (EINCSR1, rbInSDSTL);
+   }
+   // Otherwise send last updated
+   else
+   {
+      // Clear sent stall if last packet returned a stall
+      if (controlReg & rbInSTSTL)
       {
-         while (USB0ADR & 0x80);       // Wait for BUSY->'0' (data ready)
-         buffer[i] = USB0DAT;          // Copy data byte
+         POLL_WRITE_BYTE (EINCSR1, rbInCLRDT);
       }
-
-      //while(USB0ADR & 0x80);         // Wait for BUSY->'0' (data ready)
-      USB0ADR = 0;                     // Clear auto-read
    }
+
+   Send_Packet ();
 }
 
 //-----------------------------------------------------------------------------
-// Fifo_Write
+// Send_Packet
 //-----------------------------------------------------------------------------
 //
 // Return Value : None
-// Parameters   :
-//                1) uint8_t addr : target address
-//                2) uint8_t* buffer : location of source data
-//                3) uint16_t size : number of bytes to unload
+// Parameters   : None
 //
-// Write to the selected endpoint FIFO
+// Send the packet in In_Packet using the USB IN FIFO if available.
+//
+// - Copy a packet from In_Packet to IN FIFO if available and not halted
+//   and set IN packet ready to eventually transmit the packet to the host
+//
+// Called from the ISR and from foreground with interrupts disabled. The
+// locals fit in registers, so one copy serves both, as for the FIFO
+// routines.
 //
 //-----------------------------------------------------------------------------
-
-// Called from ISR
-static void Fifo_Write_ISR (uint8_t addr, uint8_t const * buffer,
-                            uint16_t size)
+void Send_Packet (void)
 {
-   uint16_t i;
-
-   // If >0 bytes requested,
-   if (size)
-   {
-      while (USB0ADR & 0x80);          // Wait for BUSY->'0'
-                                       // (register available)
-      USB0ADR = addr;                  // Set address (mask out bits7-6)
-
-      // Write <size> to the selected FIFO
-      for (i = 0; i < size; i++)
-      {
-         USB0DAT = buffer[i];
-         while (USB0ADR & 0x80);       // Wait for BUSY->'0' (data ready)
-      }
-   }
-}
+   uint8_t controlReg;
 
-// Called from foreground
-static void Fifo_Write_Foreground (uint8_t addr, uint8_t const * buffer,
-                                   uint16_t size)
-{
-   uint16_t i;
+   POLL_WRITE_BYTE(INDEX, 2);           // Set index to endpoint 2 registers
+   POLL_READ_BYTE(EINCSR1, controlReg); // Read contol register for IN_EP2
 
-   // If >0 bytes requested,
-   if (size)
+   if (EP_Status[1] != EP_HALT)
    {
-      while (USB0ADR & 0x80);          // Wait for BUSY->'0'
-                                       // (register available)
-      USB0ADR = addr;                  // Set address (mask out bits7-6)
-
-      // Write <size> to the selected FIFO
-      for (i = 0; i < size; i++)
+      // If the IN FIFO has room for a packet
+      if (!(controlReg & rbInINPRDY))
       {
-         USB0DAT = buffer[i];
-         while (USB0ADR & 0x80);       // Wait for BUSY->'0' (data ready)
+         // If In_Packet has data, then write to the IN FIFO
+         if (In_Packet_Ready)
+         {
+            // Write new data to IN FIFO
+            Fifo_WriteXdata (FIFO_EP2, In_Packet, IN_EP2_PACKET_SIZE);
+
+            // Clear in packet ready
+            In_Packet_Ready = 0;
+      
+            // Set In Packet ready bit, indicating a packet is ready
+            // to send to the host
+            POLL_WRITE_BYTE (EINCSR1, rbInINPRDY);
+         }
       }
    }
 }
 
 //-----------------------------------------------------------------------------
-// Global Functions
-//-----------------------------------------------------------------------------
-
-//-----------------------------------------------------------------------------
-// Force_Stall
+// Receive_Packet
 //-----------------------------------------------------------------------------
 //
 // Return Value : None
 // Parameters   : None
 //
-// Force a procedural stall to be sent to the host
-//
-//-----------------------------------------------------------------------------
-void Force_Stall (void)
-{
-   POLL_WRITE_BYTE (INDEX, 0);
-   POLL_WRITE_BYTE (E0CSR, rbSDSTL);   // Set the send stall bit
-   EP_Status[0] = EP_STALL;            // Put the endpoint in stall status
-}
-
-//-----------------------------------------------------------------------------
-// Handle_In1
-//-----------------------------------------------------------------------------
+// Receive the packet from the USB OUT FIFO and copy to Out_Packet if
+// available.
 //
-// Return Value : None
-// Parameters   : None
+// The OUT FIFO holds two packets. After the foreground empties Out_Packet,
+// it takes the next packet at once instead of waiting for the next SOF.
 //
-// Send the packet in In_Packet using the USB IN FIFO if available.
-//
-// - Send a STALL if the endpoint is halted
-// - Clear a sent STALL when the endpoint is unhalted
-// - Copy a packet from In_Packet to IN FIFO if available and not halted
-//   and set IN packet ready to eventually transmit the packet to the host
+// Called from the ISR and from foreground with interrupts disabled, like
+// Send_Packet.
 //
 //-----------------------------------------------------------------------------
-void Handle_In1 (void)
+void Receive_Packet (void)
 {
+   uint8_t count = 0;
    uint8_t controlReg;
 
-   POLL_WRITE_BYTE (INDEX, 1);           // Set index to endpoint 1 registers
-   POLL_READ_BYTE (EINCSR1, controlReg); // Read contol register for IN_EP1
+   POLL_WRITE_BYTE (INDEX, 2);             // Set index to endpoint 2 registers
+   POLL_READ_BYTE (EOUTCSR1, controlReg);  // Read contol register for OUT_EP2
 
-   // If endpoint is currently halted, send a stall
-   if (EP_Status[1] == EP_HALT)
-   {
-      POLL_WRITE_BYTE (EINCSR1, rbInSDSTL);
-   }
-   // Otherwise send last updated
-   else
+   if (EP_Status[2] != EP_HALT)
    {
-      // Clear sent stall if last packet returned a stall
-      if (controlReg & rbInSTSTL)
+      // If the OUT FIFO has data
+      if (controlReg & rbOutOPRDY)
       {
-         POLL_WRITE_BYTE (EINCSR1, rbInCLRDT);
+         // If Out_Packet has room for a packet
+         if (!Out_Packet_Ready)
+         {
+            POLL_READ_BYTE (EOUTCNTL, count);
+
+            // If host did not send correct packet size, flush buffer
+            if (count != OUT_EP2_PACKET_SIZE)
+            {
+               POLL_WRITE_BYTE (EOUTCSR1, rbOutFLUSH);
+            }
+            // Otherwise get the data packet
+            else
+            {
+               Fifo_ReadXdata (FIFO_EP2, Out_Packet, OUT_EP2_PACKET_SIZE);
+
+               Out_Packet_Ready = 1;
+            }
+
+            // Clear Out Packet ready bit
+            POLL_WRITE_BYTE (EOUTCSR1, 0);
+         }
       }
    }
-
-   Send_Packet_ISR ();
 }
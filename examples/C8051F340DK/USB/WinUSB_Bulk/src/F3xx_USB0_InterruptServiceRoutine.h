@@ -40,8 +40,8 @@
 
 // Endpoint Packet Sizes
 #define  EP0_PACKET_SIZE         0x40     // Control endpoint 0 size
-#define  IN_EP1_PACKET_SIZE      0x0040   // Bulk IN endpoint 1 size
-#define  OUT_EP1_PACKET_SIZE     0x0040   // Bulk OUT endpoint 1 size
+#define  IN_EP2_PACKET_SIZE      0x0040   // Bulk IN endpoint 2 size
+#define  OUT_EP2_PACKET_SIZE     0x0040   // Bulk OUT endpoint 2 size
 
 // Standard Descriptor Types
 #define  DSC_DEVICE              0x01  // Device Descriptor
@@ -105,8 +105,8 @@
                                        // direction is OUT
 
 // wIndex bitmaps
-#define  IN_EP1                  0x81
-#define  OUT_EP1                 0x01
+#define  IN_EP2                  0x82
+#define  OUT_EP2                 0x02
 
 // wValue bitmaps for Standard Feature Selectors
 #define  DEVICE_REMOTE_WAKEUP    0x01  // Remote wakeup feature(not used)
@@ -127,8 +127,10 @@
 //-----------------------------------------------------------------------------
 
 void Force_Stall (void);
-void Handle_In1 (void);
-void Send_Packet_Foreground (void);
+void Handle_In2 (void);
+void Send_Packet (void);
+uint8_t Send_Block_Foreground (uint8_t const * block);
+void Receive_Packet (void);
 
 //-----------------------------------------------------------------------------
 // External Global Variables
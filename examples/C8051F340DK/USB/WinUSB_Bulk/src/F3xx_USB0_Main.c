@@ -59,11 +59,13 @@ SI_INTERRUPT_PROTO(Usb_ISR, INTERRUPT_USB0);
 
 // Buffer used to transmit a USB packet to the host
 // In_Packet (Foreground) => USB IN FIFO (ISR) => Host
-SI_SEGMENT_VARIABLE(In_Packet[IN_EP1_PACKET_SIZE], uint8_t, SI_SEG_XDATA);
+//
+// Read page blocks skip In_Packet: Flash => USB IN FIFO (Foreground) => Host
+SI_SEGMENT_VARIABLE(In_Packet[IN_EP2_PACKET_SIZE], uint8_t, SI_SEG_XDATA);
 
 // Buffer used to receive a USB packet from the host
 // Host => USB OUT FIFO (ISR) => Out_Packet (Foreground)
-SI_SEGMENT_VARIABLE(Out_Packet[OUT_EP1_PACKET_SIZE], uint8_t, SI_SEG_XDATA);
+SI_SEGMENT_VARIABLE(Out_Packet[OUT_EP2_PACKET_SIZE], uint8_t, SI_SEG_XDATA);
 
 // State of the In_Packet buffer used to transmit a USB packet to the host:
 //
@@ -240,23 +242,32 @@ static void StateTxBlock (void)
          State = ST_TX_INVALID;
    }
    // Data stage:
-   // If able to send an IN packet
+   // If no response is waiting in In_Packet
    else if (!In_Packet_Ready)
    {
       // Calculate the flash address based on current page and block number
-      uint16_t address = FLASH_START + (FLASH_PAGE_SIZE * TxPage) + (IN_EP1_PACKET_SIZE * TxBlock);
+      uint16_t address = FLASH_START + (FLASH_PAGE_SIZE * TxPage) + (IN_EP2_PACKET_SIZE * TxBlock);
+      uint8_t const * block;
+      uint8_t EA_Save;
+      uint8_t sent;
 
       // Only read from flash if the flash page is valid.
       // Otherwise, send whatever dummy data is left in In_Packet
       if (TxValid)
-      {
-         ReadFlashPage (address, In_Packet, IN_EP1_PACKET_SIZE);
-      }
+         block = (uint8_t SI_SEG_CODE *) address;
+      else
+         block = In_Packet;
 
-      // Ready to send IN packet
-      In_Packet_Ready = 1;
+      // Copy the block from flash straight into the IN FIFO if it has
+      // room. The FIFO holds two packets, so the next block is read while
+      // this one is sent to the host.
+      EA_Save = IE_EA;
+      IE_EA = 0;
+      sent = Send_Block_Foreground (block);
+      IE_EA = EA_Save;
 
-      TxBlock++;
+      if (sent)
+         TxBlock++;
    }
 }
 
@@ -318,11 +329,11 @@ static void StateRxBlock (void)
    // If received an OUT packet
    else if (Out_Packet_Ready)
    {
-      uint16_t address = FLASH_START + (FLASH_PAGE_SIZE * RxPage) + (OUT_EP1_PACKET_SIZE * RxBlock);
+      uint16_t address = FLASH_START + (FLASH_PAGE_SIZE * RxPage) + (OUT_EP2_PACKET_SIZE * RxBlock);
 
       if (RxValid)
       {
-         WriteFlashPage (address, Out_Packet, OUT_EP1_PACKET_SIZE);
+         WriteFlashPage (address, Out_Packet, OUT_EP2_PACKET_SIZE);
       }
 
       // Finished processing OUT packet
@@ -377,12 +388,15 @@ static void StateMachine (void)
       EA_Save = IE_EA;
       IE_EA = 0;
 
-      // Set index to endpoint 1 registers
-      POLL_WRITE_BYTE(INDEX, 1);
+      // Set index to endpoint 2 registers
+      POLL_WRITE_BYTE(INDEX, 2);
 
-      // Flush IN/OUT FIFOs
+      // Flush IN/OUT FIFOs. Each flush drops one packet, and each
+      // double-buffered FIFO can hold two.
+      POLL_WRITE_BYTE(EINCSR1, rbInFLUSH);
       POLL_WRITE_BYTE(EINCSR1, rbInFLUSH);
       POLL_WRITE_BYTE(EOUTCSR1, rbOutFLUSH);
+      POLL_WRITE_BYTE(EOUTCSR1, rbOutFLUSH);
 
       // Flush software In_Packet/Out_Packet buffers
       In_Packet_Ready = 0;
@@ -478,7 +492,8 @@ void main (void)
 
       EA_Save = IE_EA;
       IE_EA = 0;
-      Send_Packet_Foreground ();
+      Send_Packet ();
+      Receive_Packet ();
       IE_EA = EA_Save;
    }
 }
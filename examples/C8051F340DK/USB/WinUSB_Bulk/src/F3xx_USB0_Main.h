@@ -73,8 +73,8 @@
 // External Global Variables
 //-----------------------------------------------------------------------------
 
-extern SI_SEGMENT_VARIABLE(In_Packet[IN_EP1_PACKET_SIZE], uint8_t, SI_SEG_XDATA);
-extern SI_SEGMENT_VARIABLE(Out_Packet[OUT_EP1_PACKET_SIZE], uint8_t, SI_SEG_XDATA);
+extern SI_SEGMENT_VARIABLE(In_Packet[IN_EP2_PACKET_SIZE], uint8_t, SI_SEG_XDATA);
+extern SI_SEGMENT_VARIABLE(Out_Packet[OUT_EP2_PACKET_SIZE], uint8_t, SI_SEG_XDATA);
 extern uint8_t In_Packet_Ready;
 extern uint8_t Out_Packet_Ready;
 extern uint8_t AsyncResetState;
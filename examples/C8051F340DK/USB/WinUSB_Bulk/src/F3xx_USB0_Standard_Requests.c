@@ -117,8 +117,8 @@ void Get_Status (void)
          }
          else
          {
-            // Handle case if request is directed to IN_EP1
-            if (Setup.wIndex.u8[LSB] == IN_EP1)
+            // Handle case if request is directed to IN_EP2
+            if (Setup.wIndex.u8[LSB] == IN_EP2)
             {
                // If endpoint is halted, return 0x01,0x00
                if (EP_Status[1] == EP_HALT)
@@ -133,8 +133,8 @@ void Get_Status (void)
                   DataSize = 2;
                }
             }
-            // Handle case if request is directed to OUT_EP1
-            else if (Setup.wIndex.u8[LSB] == OUT_EP1)
+            // Handle case if request is directed to OUT_EP2
+            else if (Setup.wIndex.u8[LSB] == OUT_EP2)
             {
                // If endpoint is halted, return 0x01,0x00
                if (EP_Status[2] == EP_HALT)
@@ -181,7 +181,7 @@ void Get_Status (void)
 //
 // Standard request that should not change in custom HID designs.
 //
-// This routine can clear Halt Endpoint features on endpoint 1
+// This routine can clear Halt Endpoint features on endpoint 2
 //
 //-----------------------------------------------------------------------------
 void Clear_Feature (void)
@@ -203,25 +203,25 @@ void Clear_Feature (void)
    {
       // Verify that packet was directed at an endpoint
       // The feature selected was HALT_ENDPOINT
-      // And that the request was directed at IN_EP1 in
+      // And that the request was directed at IN_EP2 in
       if ((Setup.bmRequestType == IN_ENDPOINT) &&
           (Setup.wValue.u8[LSB] == ENDPOINT_HALT) &&
-          (Setup.wIndex.u8[LSB] == IN_EP1))
+          (Setup.wIndex.u8[LSB] == IN_EP2))
       {
-         // Clear feature endpoint 1 halt
-         POLL_WRITE_BYTE (INDEX, 1);
+         // Clear feature endpoint 2 halt
+         POLL_WRITE_BYTE (INDEX, 2);
          POLL_WRITE_BYTE (EINCSR1, rbInCLRDT);
          EP_Status[1] = EP_IDLE;
       }
       // Verify that packet was directed at an endpoint
       // The feature selected was HALT_ENDPOINT
-      // And that the request was directed at OUT_EP1 in
+      // And that the request was directed at OUT_EP2 in
       else if ((Setup.bmRequestType == IN_ENDPOINT) &&
                (Setup.wValue.u8[LSB] == ENDPOINT_HALT) &&
-               (Setup.wIndex.u8[LSB] == OUT_EP1))
+               (Setup.wIndex.u8[LSB] == OUT_EP2))
       {
-         // Clear feature endpoint 1 halt
-         POLL_WRITE_BYTE (INDEX, 1);
+         // Clear feature endpoint 2 halt
+         POLL_WRITE_BYTE (INDEX, 2);
          POLL_WRITE_BYTE (EOUTCSR1, rbOutCLRDT);
          EP_Status[2] = EP_IDLE;
       }
@@ -253,7 +253,7 @@ void Clear_Feature (void)
 //
 // Standard request that should not change in custom HID designs.
 //
-// This routine will set the EP Halt feature for endpoint 1
+// This routine will set the EP Halt feature for endpoint 2
 //
 //-----------------------------------------------------------------------------
 void Set_Feature (void)
@@ -275,10 +275,10 @@ void Set_Feature (void)
       // endpoint feature is selected
       if ((Setup.bmRequestType == IN_ENDPOINT) &&
           (Setup.wValue.u8[LSB] == ENDPOINT_HALT) &&
-          (Setup.wIndex.u8[LSB] == IN_EP1))
+          (Setup.wIndex.u8[LSB] == IN_EP2))
       {
-         // Set feature endpoint 1 halt
-         POLL_WRITE_BYTE (INDEX, 1);
+         // Set feature endpoint 2 halt
+         POLL_WRITE_BYTE (INDEX, 2);
          POLL_WRITE_BYTE (EINCSR1, rbInSDSTL);
          EP_Status[1] = EP_HALT;
       }
@@ -286,10 +286,10 @@ void Set_Feature (void)
       // endpoint feature is selected
       else if ((Setup.bmRequestType == IN_ENDPOINT) &&
                (Setup.wValue.u8[LSB] == ENDPOINT_HALT) &&
-               (Setup.wIndex.u8[LSB] == OUT_EP1))
+               (Setup.wIndex.u8[LSB] == OUT_EP2))
       {
-         // Set feature endpoint 1 halt
-         POLL_WRITE_BYTE (INDEX, 1);
+         // Set feature endpoint 2 halt
+         POLL_WRITE_BYTE (INDEX, 2);
          POLL_WRITE_BYTE (EOUTCSR1, rbOutSDSTL);
          EP_Status[2] = EP_HALT;
       }
@@ -408,18 +408,18 @@ void Get_Descriptor (void)
          break;
 
       case DSC_ENDPOINT:
-         if ((Setup.wValue.u8[LSB] == IN_EP1) ||
-             (Setup.wValue.u8[LSB] == OUT_EP1))
+         if ((Setup.wValue.u8[LSB] == IN_EP2) ||
+             (Setup.wValue.u8[LSB] == OUT_EP2))
          {
-            if (Setup.wValue.u8[LSB] == IN_EP1)
+            if (Setup.wValue.u8[LSB] == IN_EP2)
             {
-               DataPtr = (uint8_t*) &IN_EP1_DESC;
-               DataSize = IN_EP1_DESC.bLength;
+               DataPtr = (uint8_t*) &IN_EP2_DESC;
+               DataSize = IN_EP2_DESC.bLength;
             }
             else
             {
-               DataPtr = (uint8_t*) &OUT_EP1_DESC;
-               DataSize = OUT_EP1_DESC.bLength;
+               DataPtr = (uint8_t*) &OUT_EP2_DESC;
+               DataSize = OUT_EP2_DESC.bLength;
             }
          }
          else
@@ -552,13 +552,17 @@ void Set_Configuration (void)
          EP_Status[1] = EP_IDLE;
          EP_Status[2] = EP_IDLE;
 
-         // Change index to endpoint 1
-         POLL_WRITE_BYTE (INDEX, 1);
+         // Change index to endpoint 2
+         POLL_WRITE_BYTE (INDEX, 2);
 
-         // Set DIRSEL to indicate endpoint 1 is IN/OUT
-         POLL_WRITE_BYTE (EINCSR2, rbInSPLIT);
+         // Split the 256-byte endpoint 2 FIFO into IN and OUT halves,
+         // and double buffer each half so that it holds two 64-byte
+         // packets. The firmware can then load or unload one packet
+         // while the other one is on the bus.
+         POLL_WRITE_BYTE (EINCSR2, rbInSPLIT | rbInDBIEN);
+         POLL_WRITE_BYTE (EOUTCSR2, rbOutDBOEN);
 
-         Handle_In1();
+         Handle_In2();
 
          // Set index back to endpoint 0
          POLL_WRITE_BYTE (INDEX, 0);
@@ -566,8 +570,8 @@ void Set_Configuration (void)
       else
       {
          USB0_State = DEV_ADDRESS;     // Unconfigures device by setting state
-         EP_Status[1] = EP_HALT;       // to address, and changing IN_EP1
-         EP_Status[2] = EP_HALT;       // to address, and changing OUT_EP1
+         EP_Status[1] = EP_HALT;       // to address, and changing IN_EP2
+         EP_Status[2] = EP_HALT;       // to address, and changing OUT_EP2
       }
    }
 
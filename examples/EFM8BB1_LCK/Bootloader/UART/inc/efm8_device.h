@@ -59,4 +59,11 @@
 // Defines for managing SFR pages (used for porting between devices)
 #define SET_SFRPAGE(p)
 
+// Largest flash page size. Pages of this size that are already blank are not
+// erased again; remove this define to always erase.
+#define BL_ERASE_PSIZE 512
+
+// Flash block size of the CRC0 automatic flash scan
+#define BL_CRC_BLOCK_SIZE 256
+
 #endif // __EFM8_DEVICE_H__
@@ -5,6 +5,7 @@
  *****************************************************************************/
 
 #include "efm8_device.h"
+#include "boot.h"
 #include "flash.h"
 
 // Holds the flash keys received in the prefix command
@@ -28,11 +29,40 @@ void writeByte(uint16_t addr, uint8_t byte)
   PSCTL &= ~(PSCTL_PSEE__ERASE_ENABLED|PSCTL_PSWE__WRITE_ENABLED);
 }
 
+#ifdef BL_ERASE_PSIZE
+// ----------------------------------------------------------------------------
+// Check if the flash page that contains addr is blank.
+// ----------------------------------------------------------------------------
+static bool isPageBlank(uint16_t addr)
+{
+  uint8_t SI_SEG_CODE * pread =
+    (uint8_t SI_SEG_CODE *) (addr & ~(BL_ERASE_PSIZE - 1));
+  uint16_t count;
+
+  for (count = BL_ERASE_PSIZE; count; count--)
+  {
+    if (*pread++ != 0xFF)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+#endif // BL_ERASE_PSIZE
+
 // ----------------------------------------------------------------------------
 // Erases one page of flash memory.
 // ----------------------------------------------------------------------------
 void flash_erasePage(uint16_t addr)
 {
+#ifdef BL_ERASE_PSIZE
+  // An erase takes milliseconds; skip it if the page is already blank
+  if (isPageBlank(addr))
+  {
+    return;
+  }
+#endif
+
   // Enable flash erasing, then start a write cycle on the selected page
   PSCTL |= PSCTL_PSEE__ERASE_ENABLED;
   writeByte(addr, 0);
@@ -50,6 +80,32 @@ void flash_writeByte(uint16_t addr, uint8_t byte)
   }
 }
 
+// ----------------------------------------------------------------------------
+// Writes the next bytes of the boot record to flash memory.
+// ----------------------------------------------------------------------------
+void flash_writeBlock(uint16_t addr, uint8_t len)
+{
+  uint8_t SI_SEG_XDATA * pwrite = (uint8_t SI_SEG_XDATA *) addr;
+  uint8_t byte;
+
+  for (; len; len--)
+  {
+    // Get the byte before enabling writes, since the transport may use MOVX
+    byte = boot_getByte();
+
+    // Don't bother writing the erased value to flash
+    if (byte != 0xFF)
+    {
+      FLKEY = flash_key1;
+      FLKEY = flash_key2;
+      PSCTL |= PSCTL_PSWE__WRITE_ENABLED;
+      *pwrite = byte;
+      PSCTL &= ~PSCTL_PSWE__WRITE_ENABLED;
+    }
+    pwrite++;
+  }
+}
+
 // ----------------------------------------------------------------------------
 // Check if flash address range may be erased or written.
 // ----------------------------------------------------------------------------
@@ -66,6 +122,45 @@ bool flash_isValidRange(uint16_t addr, uint8_t size)
   }
 }
 
+// ----------------------------------------------------------------------------
+// Updates the CRC with a range of flash bytes.
+// ----------------------------------------------------------------------------
+void flash_updateCRCRange(uint16_t addr, uint16_t limit)
+{
+  uint16_t blocks;
+
+  // Feed single bytes up to the first CRC block boundary
+  while ((addr <= limit) && (addr & (BL_CRC_BLOCK_SIZE - 1)))
+  {
+    flash_updateCRC(flash_readByte(addr));
+    addr++;
+  }
+
+  // Let CRC0 scan the whole blocks. The CPU stalls until the scan is done,
+  // and the scan continues from the current CRC value.
+  if (addr <= limit)
+  {
+    blocks = (limit - addr + 1) / BL_CRC_BLOCK_SIZE;
+    if (blocks)
+    {
+      CRC0AUTO = addr / BL_CRC_BLOCK_SIZE;
+      CRC0CNT = blocks;
+      CRC0AUTO |= CRC0AUTO_AUTOEN__ENABLED;
+      CRC0CN0 &= ~CRC0CN0_CRCPNT__BMASK;
+      CRC0FLIP = 0xFF;    // benign 3-byte opcode must follow the scan
+      CRC0AUTO &= ~CRC0AUTO_AUTOEN__ENABLED;
+      addr += blocks * BL_CRC_BLOCK_SIZE;
+    }
+  }
+
+  // Feed the bytes after the last whole block
+  while (addr <= limit)
+  {
+    flash_updateCRC(flash_readByte(addr));
+    addr++;
+  }
+}
+
 // ----------------------------------------------------------------------------
 // Return the CRC register value.
 // ----------------------------------------------------------------------------
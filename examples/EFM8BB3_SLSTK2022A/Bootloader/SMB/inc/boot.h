@@ -7,9 +7,50 @@
 #ifndef __BOOT_H__
 #define __BOOT_H__
 
+/// Enables block record reception with a busy status (requires 256 bytes
+/// of XRAM)
+#ifndef BOOT_USE_BLOCK
+#define BOOT_USE_BLOCK 0
+#endif
+
+/// Enables the packed write command, BOOT_CMD_ZWRITE
+#ifndef BOOT_USE_ZWRITE
+#define BOOT_USE_ZWRITE 0
+#endif
+
+/// Enables the page CRC table command, BOOT_CMD_PAGECRC
+#ifndef BOOT_USE_PAGECRC
+#define BOOT_USE_PAGECRC 0
+#endif
+
+/// Enables the write CRC command, BOOT_CMD_WCRC
+#ifndef BOOT_USE_WCRC
+#define BOOT_USE_WCRC 0
+#endif
+
 /// Defines the boot frame start byte
 #define BOOT_FRAME_START  '$'
 
+// Block protocol (BOOT_USE_BLOCK = 1)
+//
+// Each write transfer carries one whole frame. The frame is buffered as it
+// arrives; SMB0 acknowledges in hardware and the firmware empties the
+// receive FIFO, so SCL is only held between bytes for as long as it takes
+// to store one. The bus is released as soon as the frame is complete, and
+// further writes are NAK'd until the reply has been read. A one byte read
+// returns BOOT_BUSY_REPLY while the record executes, then the reply. Each
+// byte of a multi-byte reply takes one read, with BOOT_BUSY_REPLY between
+// bytes, so a reply byte of that value cannot be told from busy; read
+// PAGECRC and WCRC results after a delay instead of polling. A read during
+// a page erase or a CRC scan is held until the CPU resumes.
+//
+// Multi-drop: a target built with BL_SMB_NODE = 1-7 is read and written at
+// its node address, BL_SMB_SLAVE_ADDRESS + 2 * node, and matches no other
+// address. It also receives frames written to the general call address (0),
+// which every node on the bus takes in at once; the replies are then read
+// from each node address.
+// See examples/shared/Bootloader/scripts/boot_smb.py for a host.
+
 /// Bootloader command byte definitions
 #define BOOT_CMD_IDENT    '0'
 #define BOOT_CMD_SETUP    '1'
@@ -18,6 +59,27 @@
 #define BOOT_CMD_VERIFY   '4'
 #define BOOT_CMD_LOCK     '5'
 #define BOOT_CMD_RUNAPP   '6'
+#define BOOT_CMD_ZWRITE   '7'
+#define BOOT_CMD_PAGECRC  '8'
+#define BOOT_CMD_WCRC     '9'
+
+// Packed write record: '7', addr (2 bytes), size, stream. The stream unpacks
+// to size bytes at addr. Copy tokens read back flash that is already
+// programmed. A stream that does not unpack to exactly size bytes from this
+// record is answered with BOOT_ERR_FRAME, so the host sends it again. See
+// examples/shared/Bootloader/scripts/boot_pack.py for the stream format and
+// the host packer.
+
+// Page CRC record: '8', addr (2 bytes), count. The reply is the CRC16 of
+// each of count BL_FLASH0_PSIZE pages starting at the page containing addr
+// (one boot_sendWord() each), followed by the usual reply byte. Pages that
+// reach BL_FLASH0_LIMIT are refused with BOOT_ERR_RANGE.
+
+// Write CRC record: '9' [, crc (2 bytes)]. Each ERASE, WRITE and ZWRITE
+// range is read back right after it is programmed and its CRC16 is added to
+// a 16-bit sum that the SETUP command clears. With crc, the sum is compared
+// and a mismatch is answered with BOOT_ERR_CRC; without, the sum is
+// returned with boot_sendWord() before the usual reply byte.
 
 /// Bootloader response byte definitions
 #define BOOT_ACK_REPLY    '@'
@@ -25,12 +87,18 @@
 #define BOOT_ERR_BADID    'B'
 #define BOOT_ERR_CRC      'C'
 #define BOOT_ERR_FRAME    'D'
+#define BOOT_BUSY_REPLY   '#'
 
 /// This array provides access to the bootloader signature and lock byte.
 ///   boot_otp[0] = bootloader signature byte
 ///   boot_otp[1] = flash lock byte
 extern uint8_t SI_SEG_CODE boot_otp[];
 
+/// Flash address of boot_otp[i]. A host build defines fixed addresses.
+#ifndef BOOT_OTP_ADDRESS
+#define BOOT_OTP_ADDRESS(i) ((uint16_t)&boot_otp[i])
+#endif
+
 // Used to implement boot_hasRemaining() macro below
 extern uint8_t boot_rxRemain;
 
@@ -76,6 +144,19 @@ extern uint8_t boot_hasRemaining(void);
  *****************************************************************************/
 extern void boot_sendReply(uint8_t reply);
 
+/**************************************************************************//**
+ * Send a 16-bit value to the host, MSB first, ahead of the reply byte.
+ *
+ * @param value The value to send.
+ *****************************************************************************/
+#if defined(IS_DOXYGEN)
+extern void boot_sendWord(uint16_t value);
+#else
+#define boot_sendWord(value) do { \
+  boot_sendReply((value) >> 8); \
+  boot_sendReply((value) & 0xFF); } while(0)
+#endif
+
 /**************************************************************************//**
  * Exit bootloader and start the user application.
  *****************************************************************************/
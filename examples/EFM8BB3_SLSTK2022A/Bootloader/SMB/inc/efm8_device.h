@@ -22,6 +22,16 @@
 // Bootloader SMB0 (byte-aligned) slave address
 #define BL_SMB_SLAVE_ADDRESS 0xF0
 
+// Multi-drop node number, 0-7 (see BOOT_USE_BLOCK in boot.h). Node n
+// answers at BL_SMB_SLAVE_ADDRESS + 2 * n and also receives general call
+// writes; node 0 is a single target.
+#ifndef BL_SMB_NODE
+#define BL_SMB_NODE 0
+#endif
+
+// Address this target answers at
+#define BL_SMB_NODE_ADDRESS (BL_SMB_SLAVE_ADDRESS + 2 * BL_SMB_NODE)
+
 // Bootloader firmware revision number
 #define BL_REVISION 0x90
 
@@ -44,6 +54,7 @@
 #define BL_PIN_LOW_CYCLES (50 * 25 / 8)
 
 // Parameters that describe the flash memory geometry
+#define BL_FLASH0_PSIZE 512
 #define BL_FLASH1_START 0xFA00
 #define BL_FLASH1_LIMIT 0xFC00
 #define BL_FLASH1_PSIZE 512
@@ -63,4 +74,11 @@
 // Defines for managing SFR pages (used for porting between devices)
 #define SET_SFRPAGE(p)  SFRPAGE = (p)
 
+// Largest flash page size. Pages of this size that are already blank are not
+// erased again; remove this define to always erase.
+#define BL_ERASE_PSIZE 512
+
+// Flash block size of the CRC0 automatic flash scan
+#define BL_CRC_BLOCK_SIZE 256
+
 #endif // __EFM8_DEVICE_H__
@@ -17,6 +17,25 @@ static uint8_t opcode;
 // Holds reply to the current command
 static uint8_t reply;
 
+#if (BOOT_USE_WCRC == 1)
+// Sum of the CRC16 of each range written since the last setup command
+static uint16_t writeCrc;
+
+// ----------------------------------------------------------------------------
+// Add a range that was just written to the write CRC.
+// ----------------------------------------------------------------------------
+void addWriteCrc(uint16_t address, uint8_t size)
+{
+  // Read back what was programmed, so a bad write changes the sum
+  if (size)
+  {
+    flash_initCRC();
+    flash_updateCRCRange(address, address + (size - 1));
+    writeCrc += flash_readCRC();
+  }
+}
+
+#endif // BOOT_USE_WCRC
 // ----------------------------------------------------------------------------
 // Perform the bootloader erase or write commands.
 // ----------------------------------------------------------------------------
@@ -24,6 +43,9 @@ void doEraseWriteCmd(void)
 {
   // Get the starting address from the boot record
   uint16_t address = boot_getWord();
+#if (BOOT_USE_WCRC == 1)
+  uint8_t size;
+#endif
 
   // Check if bootloader is allowed to modify this address range
   if (flash_isValidRange(address, boot_hasRemaining()))
@@ -33,12 +55,14 @@ void doEraseWriteCmd(void)
     {
       flash_erasePage(address);
     }
-    // Write data from boot record to flash one byte at a time
-    while (boot_hasRemaining())
-    {
-      flash_writeByte(address, boot_getByte());
-      address++;
-    }
+    // Write data from boot record to flash
+#if (BOOT_USE_WCRC == 1)
+    size = boot_hasRemaining();
+    flash_writeBlock(address, size);
+    addWriteCrc(address, size);
+#else
+    flash_writeBlock(address, boot_hasRemaining());
+#endif
   }
   else
   {
@@ -47,6 +71,150 @@ void doEraseWriteCmd(void)
   }
 }
 
+#if (BOOT_USE_ZWRITE == 1)
+// ----------------------------------------------------------------------------
+// Perform the bootloader packed write command.
+// ----------------------------------------------------------------------------
+void doPackedWriteCmd(void)
+{
+  // Get the starting address and unpacked size from the boot record
+  uint16_t address = boot_getWord();
+  uint8_t size = boot_getByte();
+#if (BOOT_USE_WCRC == 1)
+  uint16_t start = address;
+#endif
+  uint16_t source;
+  uint8_t token;
+  uint8_t count;
+
+  // Check if bootloader is allowed to modify this address range
+  if (!flash_isValidRange(address, size))
+  {
+    reply = BOOT_ERR_RANGE;
+    return;
+  }
+
+  while (boot_hasRemaining())
+  {
+    // Literal tokens carry 1-128 bytes, copy tokens 3-130 bytes
+    token = boot_getByte();
+    count = (token & 0x7F) + ((token & 0x80) ? 3 : 1);
+
+    // Never write past the range that was checked
+    if (count > size)
+    {
+      reply = BOOT_ERR_RANGE;
+      return;
+    }
+    size -= count;
+
+    // A token's operands must all be in this record
+    if (boot_hasRemaining() < ((token & 0x80) ? 1 : count))
+    {
+      reply = BOOT_ERR_FRAME;
+      return;
+    }
+
+    if (token & 0x80)
+    {
+      // Copy from flash; distance back is one byte, or two if bit 7 is set
+      source = boot_getByte();
+      if (source & 0x80)
+      {
+        if (!boot_hasRemaining())
+        {
+          reply = BOOT_ERR_FRAME;
+          return;
+        }
+        source = ((source & 0x7F) << 8) | boot_getByte();
+      }
+      // Never read before address 0 or past the range the host may write
+      if ((source >= address) || !flash_isValidRange(address - source - 1, count))
+      {
+        reply = BOOT_ERR_RANGE;
+        return;
+      }
+      source = address - source - 1;
+      for (; count; count--)
+      {
+        flash_writeByte(address, flash_readByte(source));
+        address++;
+        source++;
+      }
+    }
+    else
+    {
+      // Write literal bytes from the boot record
+      flash_writeBlock(address, count);
+      address += count;
+    }
+  }
+
+  // The stream must unpack to exactly the size that was checked
+  if (size)
+  {
+    reply = BOOT_ERR_FRAME;
+    return;
+  }
+#if (BOOT_USE_WCRC == 1)
+  addWriteCrc(start, address - start);
+#endif
+}
+#endif // BOOT_USE_ZWRITE
+
+#if (BOOT_USE_PAGECRC == 1)
+// ----------------------------------------------------------------------------
+// Perform the bootloader page CRC command.
+// ----------------------------------------------------------------------------
+void doPageCrcCmd(void)
+{
+  // Get the first page address and the number of pages from the boot record
+  uint16_t address = boot_getWord() & ~(BL_FLASH0_PSIZE - 1);
+  uint8_t count = boot_getByte();
+
+  // Every page must lie below the flash limit. Comparing page counts
+  // instead of end addresses cannot wrap past 0xFFFF.
+  if ((address >= BL_FLASH0_LIMIT)
+      || (count > (BL_FLASH0_LIMIT - address) / BL_FLASH0_PSIZE))
+  {
+    reply = BOOT_ERR_RANGE;
+    return;
+  }
+
+  // Reply with an Xmodem CRC16 of each page so the host can skip pages
+  // that already hold the new image
+  for (; count; count--)
+  {
+    flash_initCRC();
+    flash_updateCRCRange(address, address + (BL_FLASH0_PSIZE - 1));
+    address += BL_FLASH0_PSIZE;
+    boot_sendWord(flash_readCRC());
+  }
+}
+#endif // BOOT_USE_PAGECRC
+
+#if (BOOT_USE_WCRC == 1)
+// ----------------------------------------------------------------------------
+// Perform the bootloader write CRC command.
+// ----------------------------------------------------------------------------
+void doWriteCrcCmd(void)
+{
+  if (boot_hasRemaining())
+  {
+    // Compare with the expected result
+    if (writeCrc != boot_getWord())
+    {
+      reply = BOOT_ERR_CRC;
+    }
+  }
+  else
+  {
+    // Return the sum so the host can compare it
+    boot_sendWord(writeCrc);
+  }
+}
+#endif // BOOT_USE_WCRC
+
 // ----------------------------------------------------------------------------
 // Perform the bootloader verify command.
 // ----------------------------------------------------------------------------
@@ -59,11 +227,7 @@ void doVerifyCmd(void)
 
   // Compute an Xmodem CRC16 over the indicated flash range
   flash_initCRC();
-  while (address <= limit)
-  {
-    flash_updateCRC(flash_readByte(address));
-    address++;
-  }
+  flash_updateCRCRange(address, limit);
   // Compare with the expected result
   if (flash_readCRC() != expect)
   {
@@ -122,6 +286,17 @@ void main(void)
         // Save flash keys and select the requested flash bank
         flash_setKeys(boot_getByte(), boot_getByte());
         flash_setBank(boot_getByte());
+#if (BOOT_USE_WCRC == 1)
+        // Start a new write CRC
+        writeCrc = 0;
+#endif
+#if (BOOT_USE_BAUD == 1)
+        // Optional fourth byte requests a faster baud rate
+        if (boot_hasRemaining() && !boot_setBaud(boot_getByte()))
+        {
+          reply = BOOT_ERR_RANGE;
+        }
+#endif
         break;
 
       case OPCODE(BOOT_CMD_ERASE):
@@ -129,6 +304,24 @@ void main(void)
         doEraseWriteCmd();
         break;
 
+#if (BOOT_USE_ZWRITE == 1)
+      case OPCODE(BOOT_CMD_ZWRITE):
+        doPackedWriteCmd();
+        break;
+
+#endif
+#if (BOOT_USE_PAGECRC == 1)
+      case OPCODE(BOOT_CMD_PAGECRC):
+        doPageCrcCmd();
+        break;
+
+#endif
+#if (BOOT_USE_WCRC == 1)
+      case OPCODE(BOOT_CMD_WCRC):
+        doWriteCrcCmd();
+        break;
+
+#endif
       case OPCODE(BOOT_CMD_VERIFY):
         doVerifyCmd();
         break;
@@ -136,8 +329,8 @@ void main(void)
       case OPCODE(BOOT_CMD_LOCK):
         // Write the boot signature and flash lock bytes
         flash_setBank(0);
-        flash_writeByte((uint16_t)&boot_otp[0], boot_getByte());
-        flash_writeByte((uint16_t)&boot_otp[1], boot_getByte());
+        flash_writeByte(BOOT_OTP_ADDRESS(0), boot_getByte());
+        flash_writeByte(BOOT_OTP_ADDRESS(1), boot_getByte());
         break;
 
       case OPCODE(BOOT_CMD_RUNAPP):
@@ -7,6 +7,301 @@
 #include "efm8_device.h"
 #include "boot.h"
 
+#if (BOOT_USE_BAUD == 1)
+// Timer1 reload value to apply after the next reply (0 for none)
+uint8_t boot_baudReload;
+
+// ----------------------------------------------------------------------------
+// Request factor times the current baud rate.
+// ----------------------------------------------------------------------------
+bool boot_setBaud(uint8_t factor)
+{
+  // Timer1 overflows every half bit; the reload is minus the SYSCLK count
+  uint16_t current = (uint8_t)(0 - TH1);
+  uint16_t divisor;
+  int16_t error;
+
+  if (!factor || !current)
+  {
+    return false;
+  }
+  divisor = (current + (factor >> 1)) / factor;
+
+  // Refuse rates that would be off by more than 1/32
+  error = current - divisor * factor;
+  if (error < 0)
+  {
+    error = -error;
+  }
+  if (!divisor || ((uint16_t)error << 5) > current)
+  {
+    return false;
+  }
+  boot_baudReload = 0 - (uint8_t)divisor;
+  return true;
+}
+
+// ----------------------------------------------------------------------------
+// Switch to a requested baud rate once the last reply has been sent.
+// ----------------------------------------------------------------------------
+static void applyBaud(void)
+{
+  uint8_t halfBits;
+
+  if (!boot_baudReload)
+  {
+    return;
+  }
+
+  // TI is set at the start of the stop bit. Let it finish at the old rate.
+  for (halfBits = 2; halfBits; halfBits--)
+  {
+    TCON_TF1 = 0;
+    while (!TCON_TF1)
+      ;
+  }
+  TH1 = boot_baudReload;
+  boot_baudReload = 0;
+}
+#endif // BOOT_USE_BAUD
+
+#if (BOOT_USE_PIPELINE == 1)
+#if (DEVICE_XRAM_SIZE < 512)
+#error Pipelined boot protocol requires 512 bytes of XRAM
+#endif
+
+// Two full-size receive pages. One holds the record being executed while the
+// next record is received into the other.
+#define BOOT_RXBUF_SIZE 256
+
+// Buffer pages hold data received from the host (must be located at 0)
+uint8_t SI_SEG_XDATA boot_rxBuf[2 * BOOT_RXBUF_SIZE] _at_ 0x00;
+
+// Cloaks XDATA buffer access to reduce code size.
+// CAUTION: For this to work properly, the buffer must be located at address 0x0.
+#define BOOT_RXBUF(page, i) *((uint8_t SI_SEG_XDATA *)(((uint16_t)(page) << 8) | (i)))
+
+// Frame receiver states
+#define RX_IDLE   0
+#define RX_SEQ    1
+#define RX_LENGTH 2
+#define RX_DATA   3
+#define RX_CHECK  4
+#define RX_DONE   5
+
+// Frame receiver state. The bootloader has no interrupt vectors, so the
+// receiver is polled while waiting and between flash byte writes.
+static uint8_t rxState;
+static uint8_t rxPage;
+static uint8_t rxCount;
+static uint8_t rxLength;
+static uint8_t rxSeq;
+static uint8_t rxSum;
+static bool rxPiped;
+static bool rxBad;
+
+// Page, sequence number and frame type of the record being executed
+static uint8_t curPage;
+static uint8_t curSeq;
+static bool curPiped;
+
+// Set once a pipelined frame has been received. Legacy frames carry no
+// checksum, so from then on only a legacy setup record is accepted.
+static bool pipedOnly;
+
+// Counts the number of bytes remaining in the current record. Also acts as
+// the index for the next byte to get from the current page.
+uint8_t boot_rxNext;
+
+// ----------------------------------------------------------------------------
+// Reset the frame receiver.
+// ----------------------------------------------------------------------------
+void boot_initReceiver(void)
+{
+  rxState = RX_IDLE;
+  rxPage = 0;
+  curPage = 1;
+  curPiped = false;
+  pipedOnly = false;
+  boot_rxNext = 0;
+}
+
+// ----------------------------------------------------------------------------
+// Move one received byte (if any) into the frame receiver.
+// ----------------------------------------------------------------------------
+static void pollRx(void)
+{
+  uint8_t next;
+
+  if (!SCON0_RI)
+  {
+    return;
+  }
+  SCON0_RI = 0;
+  next = SBUF0;
+
+  switch (rxState)
+  {
+    case RX_IDLE:
+      // Wait for either frame start character
+      if (next == BOOT_FRAME_PIPED)
+      {
+        rxPiped = true;
+        rxState = RX_SEQ;
+      }
+      else if (next == BOOT_FRAME_START)
+      {
+        rxPiped = false;
+        rxSeq = 0;
+        rxSum = 0;
+        rxState = RX_LENGTH;
+      }
+      break;
+
+    case RX_SEQ:
+      rxSeq = next;
+      rxSum = next;
+      rxState = RX_LENGTH;
+      break;
+
+    case RX_LENGTH:
+      rxLength = next;
+      rxCount = next;
+      rxSum += next;
+      rxState = RX_DATA;
+      break;
+
+    case RX_DATA:
+      // Data is stored in reverse order, as for legacy frames
+      BOOT_RXBUF(rxPage, rxCount) = next;
+      rxSum += next;
+      rxCount--;
+      break;
+
+    case RX_CHECK:
+      rxBad = (next != rxSum);
+      rxState = RX_DONE;
+      break;
+
+    default:
+      // Both pages are full; the host has overrun its window
+      break;
+  }
+
+  // Finish the frame once all data has arrived
+  if ((rxState == RX_DATA) && !rxCount)
+  {
+    rxBad = false;
+    rxState = rxPiped ? RX_CHECK : RX_DONE;
+  }
+}
+
+// ----------------------------------------------------------------------------
+// Wait for the next boot record to arrive.
+// ----------------------------------------------------------------------------
+void boot_nextRecord(void)
+{
+  while (true)
+  {
+    while (rxState != RX_DONE)
+    {
+      pollRx();
+    }
+
+    // Execute from the received page and receive into the released one
+    curPage = rxPage;
+    curSeq = rxSeq;
+    curPiped = rxPiped;
+    boot_rxNext = rxLength;
+    rxPage ^= 1;
+    rxState = RX_IDLE;
+
+    // Drop a legacy frame found while resynchronizing to pipelined frames
+    // unless it starts a new session. The first data byte is the command.
+    if (curPiped)
+    {
+      pipedOnly = true;
+    }
+    else if (pipedOnly)
+    {
+      if (!rxLength || (BOOT_RXBUF(curPage, rxLength) != BOOT_CMD_SETUP))
+      {
+        continue;
+      }
+      pipedOnly = false;
+    }
+
+    if (!rxBad)
+    {
+      return;
+    }
+    // Ask the host to resend a corrupted record
+    boot_sendReply(BOOT_NAK_REPLY);
+  }
+}
+
+// ----------------------------------------------------------------------------
+// Get the next byte in the boot record.
+// ----------------------------------------------------------------------------
+uint8_t boot_getByte(void)
+{
+  uint8_t next = BOOT_RXBUF(curPage, boot_rxNext);
+  boot_rxNext--;
+
+  // Keep receiving the next record while this one is executed
+  pollRx();
+  return next;
+}
+
+// ----------------------------------------------------------------------------
+// Send one byte to the host.
+// ----------------------------------------------------------------------------
+static void sendByte(uint8_t value)
+{
+  SCON0_TI = 0;
+  SBUF0 = value;
+
+  // Wait for the byte to be transmitted before returning
+  while (!SCON0_TI)
+  {
+    pollRx();
+  }
+}
+
+// ----------------------------------------------------------------------------
+// Send a reply to the host. Pipelined records are answered with the record
+// sequence number followed by the reply byte.
+// ----------------------------------------------------------------------------
+void boot_sendReply(uint8_t reply)
+{
+  if (curPiped)
+  {
+    sendByte(curSeq);
+  }
+  sendByte(reply);
+#if (BOOT_USE_BAUD == 1)
+  applyBaud();
+#endif
+}
+
+#if (BOOT_USE_PAGECRC == 1) || (BOOT_USE_WCRC == 1)
+// ----------------------------------------------------------------------------
+// Send a 16-bit value to the host as one reply, so a pipelined host sees a
+// single sequence number ahead of both bytes.
+// ----------------------------------------------------------------------------
+void boot_sendWord(uint16_t value)
+{
+  if (curPiped)
+  {
+    sendByte(curSeq);
+  }
+  sendByte(value >> 8);
+  sendByte(value & 0xFF);
+}
+#endif // BOOT_USE_PAGECRC || BOOT_USE_WCRC
+
+#else // BOOT_USE_PIPELINE
+
 // If the device does not have XRAM, use IDATA to hold a small receive buffer;
 // otherwise, use XRAM to hold a full-size receive buffer.
 
@@ -83,19 +378,6 @@ uint8_t boot_getByte(void)
   return next;
 }
 
-// ----------------------------------------------------------------------------
-// Get the next word in the boot record.
-// ----------------------------------------------------------------------------
-uint16_t boot_getWord(void)
-{
-  SI_UU16_t word;
-
-  // 16-bit words are received in big-endian order
-  word.u8[0] = boot_getByte();
-  word.u8[1] = boot_getByte();
-  return word.u16;
-}
-
 // ----------------------------------------------------------------------------
 // Send a one byte reply to the host.
 // ----------------------------------------------------------------------------
@@ -107,4 +389,22 @@ void boot_sendReply(uint8_t reply)
   // Wait for the byte to be transmitted before returning
   while (!SCON0_TI)
     ;
+#if (BOOT_USE_BAUD == 1)
+  applyBaud();
+#endif
+}
+
+#endif // BOOT_USE_PIPELINE
+
+// ----------------------------------------------------------------------------
+// Get the next word in the boot record.
+// ----------------------------------------------------------------------------
+uint16_t boot_getWord(void)
+{
+  SI_UU16_t word;
+
+  // 16-bit words are received in big-endian order
+  word.u8[0] = boot_getByte();
+  word.u8[1] = boot_getByte();
+  return word.u16;
 }
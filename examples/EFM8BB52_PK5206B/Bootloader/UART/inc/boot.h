@@ -7,9 +7,57 @@
 #ifndef __BOOT_H__
 #define __BOOT_H__
 
+/// Enables the pipelined record protocol (requires 512 bytes of XRAM)
+#ifndef BOOT_USE_PIPELINE
+#define BOOT_USE_PIPELINE 0
+#endif
+
+/// Enables the packed write command, BOOT_CMD_ZWRITE
+#ifndef BOOT_USE_ZWRITE
+#define BOOT_USE_ZWRITE 0
+#endif
+
+/// Enables the page CRC table command, BOOT_CMD_PAGECRC
+#ifndef BOOT_USE_PAGECRC
+#define BOOT_USE_PAGECRC 0
+#endif
+
+/// Enables the write CRC command, BOOT_CMD_WCRC
+#ifndef BOOT_USE_WCRC
+#define BOOT_USE_WCRC 0
+#endif
+
+/// Enables baud rate requests through the SETUP command
+#ifndef BOOT_USE_BAUD
+#define BOOT_USE_BAUD 0
+#endif
+
 /// Defines the boot frame start byte
 #define BOOT_FRAME_START  '$'
 
+/// Defines the pipelined boot frame start byte
+#define BOOT_FRAME_PIPED  '%'
+
+// Pipelined protocol (BOOT_USE_PIPELINE = 1)
+//
+// A pipelined frame is '%', seq, len, data[len], cksum, where cksum is the
+// low byte of seq + len + the sum of the data bytes. The reply to a
+// pipelined frame is two bytes: seq followed by the reply code. A frame with
+// a bad checksum is answered with seq and BOOT_NAK_REPLY and is not executed;
+// the host resends only that record.
+//
+// The bootloader receives the next frame while the current record is being
+// programmed, so the host may have two records outstanding. Records are
+// self-addressed, so a resent write may complete after a later one. ERASE,
+// VERIFY, PAGECRC, WCRC, SETUP, LOCK and ZWRITE stall the receiver or change
+// state and must be the only outstanding record. Each 16-bit value in a reply
+// is sent as seq, MSB, LSB. Legacy '$' frames are still accepted and answered
+// with a single reply byte. Once a pipelined frame has been received, legacy
+// frames other than SETUP are dropped without a reply, since a '$' found
+// while resynchronizing is more likely noise than an unchecked record.
+// examples/shared/Bootloader/scripts/boot_uart.py is a host that keeps to
+// these rules.
+
 /// Bootloader command byte definitions
 #define BOOT_CMD_IDENT    '0'
 #define BOOT_CMD_SETUP    '1'
@@ -18,18 +66,57 @@
 #define BOOT_CMD_VERIFY   '4'
 #define BOOT_CMD_LOCK     '5'
 #define BOOT_CMD_RUNAPP   '6'
+#define BOOT_CMD_ZWRITE   '7'
+#define BOOT_CMD_PAGECRC  '8'
+#define BOOT_CMD_WCRC     '9'
+
+// Packed write record: '7', addr (2 bytes), size, stream. The stream unpacks
+// to size bytes at addr. Copy tokens read back flash that is already
+// programmed. A stream that does not unpack to exactly size bytes from this
+// record is answered with BOOT_ERR_FRAME, so the host sends it again. See
+// examples/shared/Bootloader/scripts/boot_pack.py for the stream format and
+// the host packer.
+
+// Page CRC record: '8', addr (2 bytes), count. The reply is the CRC16 of
+// each of count BL_FLASH0_PSIZE pages starting at the page containing addr
+// (one boot_sendWord() each), followed by the usual reply byte. Pages that
+// reach BL_FLASH0_LIMIT are refused with BOOT_ERR_RANGE.
+
+// Write CRC record: '9' [, crc (2 bytes)]. Each ERASE, WRITE and ZWRITE
+// range is read back right after it is programmed and its CRC16 is added to
+// a 16-bit sum that the SETUP command clears. With crc, the sum is compared
+// and a mismatch is answered with BOOT_ERR_CRC; without, the sum is
+// returned with boot_sendWord() before the usual reply byte.
+
+// Baud rate request (BOOT_USE_BAUD = 1): a SETUP record may carry a fourth
+// byte, factor. The reply is sent at the current rate; the bootloader then
+// runs at factor times that rate (nearest Timer1 reload value). The rate is
+// refused with BOOT_ERR_RANGE if it would be off by more than 3%.
+//
+// With BOOT_USE_PIPELINE set, the next record is received while flash is
+// written, and the receiver is only polled between byte writes. A byte must
+// therefore take longer than one flash byte write (tWRITE, about 20 us), which
+// holds up to 460800 baud. boot_uart.py sends one record at a time above that
+// rate.
 
 /// Bootloader response byte definitions
 #define BOOT_ACK_REPLY    '@'
 #define BOOT_ERR_RANGE    'A'
 #define BOOT_ERR_BADID    'B'
 #define BOOT_ERR_CRC      'C'
+#define BOOT_NAK_REPLY    'D'
+#define BOOT_ERR_FRAME    BOOT_NAK_REPLY
 
 /// This array provides access to the bootloader signature and lock byte.
 ///   boot_otp[0] = bootloader signature byte
 ///   boot_otp[1] = flash lock byte
 extern uint8_t SI_SEG_CODE boot_otp[];
 
+/// Flash address of boot_otp[i]. A host build defines fixed addresses.
+#ifndef BOOT_OTP_ADDRESS
+#define BOOT_OTP_ADDRESS(i) ((uint16_t)&boot_otp[i])
+#endif
+
 // Used to implement boot_hasRemaining() macro below
 extern uint8_t boot_rxNext;
 
@@ -38,6 +125,27 @@ extern uint8_t boot_rxNext;
  *****************************************************************************/
 extern void boot_initDevice(void);
 
+#if (BOOT_USE_PIPELINE == 1)
+/**************************************************************************//**
+ * Reset the pipelined frame receiver. Called by boot_initDevice().
+ *****************************************************************************/
+extern void boot_initReceiver(void);
+#endif
+
+#if (BOOT_USE_BAUD == 1)
+// Baud rate reload value to apply after the next reply (0 for none). Cleared
+// by boot_initDevice().
+extern uint8_t boot_baudReload;
+
+/**************************************************************************//**
+ * Switch to factor times the current baud rate after the next reply.
+ *
+ * @param factor Rate multiplier requested by the host
+ * @return **False** if the rate cannot be generated
+ *****************************************************************************/
+extern bool boot_setBaud(uint8_t factor);
+#endif
+
 /**************************************************************************//**
  * Wait for the next boot record to arrive.
  *****************************************************************************/
@@ -75,6 +183,20 @@ extern uint8_t boot_hasRemaining(void);
  *****************************************************************************/
 extern void boot_sendReply(uint8_t reply);
 
+/**************************************************************************//**
+ * Send a 16-bit value to the host, MSB first, ahead of the reply byte. A pipelined
+ * reply sends the sequence number once, then both bytes.
+ *
+ * @param value The value to send.
+ *****************************************************************************/
+#if defined(IS_DOXYGEN) || (BOOT_USE_PIPELINE == 1)
+extern void boot_sendWord(uint16_t value);
+#else
+#define boot_sendWord(value) do { \
+  boot_sendReply((value) >> 8); \
+  boot_sendReply((value) & 0xFF); } while(0)
+#endif
+
 /**************************************************************************//**
  * Exit bootloader and start the user application.
  *****************************************************************************/
@@ -41,6 +41,7 @@
 #define BL_PIN_LOW_CYCLES (50 * 25 / 8)
 
 // Parameters that describe the flash memory geometry
+#define BL_FLASH0_PSIZE 2048
 #define BL_FLASH1_START 0xF000
 #define BL_FLASH1_LIMIT 0xF800
 #define BL_FLASH1_PSIZE 2048
@@ -60,4 +61,11 @@
 // Defines for managing SFR pages (used for porting between devices)
 #define SET_SFRPAGE(p)  SFRPAGE = (p)
 
+// Largest flash page size. Pages of this size that are already blank are not
+// erased again; remove this define to always erase.
+#define BL_ERASE_PSIZE 2048
+
+// Flash block size of the CRC0 automatic flash scan
+#define BL_CRC_BLOCK_SIZE 256
+
 #endif // __EFM8_DEVICE_H__
@@ -24,18 +24,159 @@
 #define SMB_STSTO 0x50  // (ST) STOp detected during transfer (bus error)
 
 // Local function prototypes
-static uint8_t readByte(void);
 static uint8_t smb_pollModule(void);
 
 // Counts the number of bytes remaining in the boot frame 
 uint8_t boot_rxRemain;
 
-// Local buffer holds byte received from SMB
-static uint8_t smb_rxByte;
-
 // Local buffer holds byte to send on SMB
 static uint8_t smb_txByte;
 
+#if (BOOT_USE_BLOCK == 1)
+#if (DEVICE_XRAM_SIZE < 256)
+#error Block boot protocol requires 256 bytes of XRAM
+#endif
+
+#if (BL_SMB_NODE > 7)
+#error BL_SMB_NODE must be 0-7
+#endif
+
+// Address byte of a general call write
+#define SMB_GENERAL_CALL 0x00
+
+// One full-size receive buffer
+#define BOOT_RXBUF_SIZE 256
+
+// Buffer holds the frame received from the host (must be located at 0)
+uint8_t SI_SEG_XDATA boot_rxBuf[BOOT_RXBUF_SIZE] _at_ 0x00;
+
+// Cloaks XDATA buffer access to reduce code size.
+// CAUTION: For this to work properly, the buffer must be located at address 0x0.
+#define BOOT_RXBUF(i) *((uint8_t SI_SEG_XDATA *)(i))
+
+// Frame receiver states
+#define RX_IDLE   0
+#define RX_LENGTH 1
+#define RX_DATA   2
+#define RX_DONE   3
+
+// Frame receiver state. The bootloader has no interrupt vectors, so the
+// bus is polled while waiting and between flash byte writes.
+static uint8_t rxState;
+static uint8_t rxCount;
+static uint8_t rxLength;
+
+// Set while a write transfer cannot be taken in
+static bool smb_ignore;
+
+// Set when smb_txByte holds a reply, and when that reply has been loaded
+static bool smb_txReady;
+static bool smb_txLoaded;
+
+// ----------------------------------------------------------------------------
+// Move one received byte into the frame receiver.
+// ----------------------------------------------------------------------------
+static void receiveByte(uint8_t next)
+{
+  switch (rxState)
+  {
+    case RX_IDLE:
+      // Wait for the frame start character
+      if (next == BOOT_FRAME_START)
+      {
+        rxState = RX_LENGTH;
+      }
+      break;
+
+    case RX_LENGTH:
+      rxLength = next;
+      rxCount = next;
+      rxState = RX_DATA;
+      break;
+
+    case RX_DATA:
+      // Data is stored in reverse order, as for the UART pipeline
+      BOOT_RXBUF(rxCount) = next;
+      rxCount--;
+      break;
+
+    default:
+      // The frame is complete; further bytes are NAK'd and dropped
+      break;
+  }
+
+  // Release the bus once all data has arrived. Status reads return busy
+  // until the record has been executed.
+  if ((rxState == RX_DATA) && !rxCount)
+  {
+    rxState = RX_DONE;
+    smb_txByte = BOOT_BUSY_REPLY;
+    SMB0CN0_ACK = 0;
+  }
+}
+
+// ----------------------------------------------------------------------------
+// Wait for the next boot record to arrive.
+// ----------------------------------------------------------------------------
+void boot_nextRecord(void)
+{
+  // Return frame error if master reads reply before sending a complete frame
+  smb_txByte = BOOT_ERR_FRAME;
+  smb_txReady = false;
+
+  // Receive the whole frame; each write transfer starts a new one
+  rxState = RX_IDLE;
+  while (rxState != RX_DONE)
+  {
+    smb_pollModule();
+  }
+  boot_rxRemain = rxLength;
+}
+
+// ----------------------------------------------------------------------------
+// Get the next byte in the boot record.
+// ----------------------------------------------------------------------------
+uint8_t boot_getByte(void)
+{
+  uint8_t next = BOOT_RXBUF(boot_rxRemain);
+  boot_rxRemain--;
+
+  // Answer status reads while the record is executed
+  if (SMB0CN0_SI)
+  {
+    smb_pollModule();
+  }
+  return next;
+}
+
+// ----------------------------------------------------------------------------
+// Send a one byte reply to the host.
+//
+// Waits indefinitely for the reply to be read from the node address.
+// ----------------------------------------------------------------------------
+void boot_sendReply(uint8_t reply)
+{
+  // Store status reply in local buffer
+  smb_txByte = reply;
+  smb_txReady = true;
+
+  // Wait indefinitely for the reply to transfer. A status read that began
+  // before the reply was ready does not count.
+  while (smb_pollModule() != SMB_STDAT)
+    ;
+}
+
+#else // BOOT_USE_BLOCK
+#if (BL_SMB_NODE != 0)
+#error Multi-drop node addresses require BOOT_USE_BLOCK
+#endif
+
+// Local function prototypes
+static uint8_t readByte(void);
+
+// Local buffer holds byte received from SMB
+static uint8_t smb_rxByte;
+
 // ----------------------------------------------------------------------------
 // Wait for the next boot record to arrive.
 // ----------------------------------------------------------------------------
@@ -71,19 +212,6 @@ uint8_t boot_getByte(void)
   return next;
 }
 
-// ----------------------------------------------------------------------------
-// Get the next word in the boot record.
-// ----------------------------------------------------------------------------
-uint16_t boot_getWord(void)
-{
-  SI_UU16_t word;
-
-  // 16-bit words are received in big-endian order
-  word.u8[0] = boot_getByte();
-  word.u8[1] = boot_getByte();
-  return word.u16;
-}
-
 // ----------------------------------------------------------------------------
 // Send a one byte reply to the host.
 //
@@ -114,6 +242,20 @@ static uint8_t readByte(void)
   // Retrieve received byte from local buffer
   return smb_rxByte;
 }
+#endif // BOOT_USE_BLOCK
+
+// ----------------------------------------------------------------------------
+// Get the next word in the boot record.
+// ----------------------------------------------------------------------------
+uint16_t boot_getWord(void)
+{
+  SI_UU16_t word;
+
+  // 16-bit words are received in big-endian order
+  word.u8[0] = boot_getByte();
+  word.u8[1] = boot_getByte();
+  return word.u16;
+}
 
 // -----------------------------------------------------------------------------
 // Polls and handles all SMB bus events.
@@ -123,10 +265,16 @@ static uint8_t readByte(void)
 // either reading or writing the SMB data register. Bus errors are treated
 // like a stop condition. Data is exchanged through one byte buffers
 // smb_rxByte and smb_txByte. Returns the event status vector.
+//
+// With BOOT_USE_BLOCK, received bytes go to the frame receiver instead, and
+// writes that arrive while a frame waits to be executed are ignored.
 // -----------------------------------------------------------------------------
 static uint8_t smb_pollModule(void)
 {
   uint8_t status;
+#if (BOOT_USE_BLOCK == 1)
+  uint8_t target;
+#endif
 
   // Wait indefinitely for SMB event to occur
   while (!SMB0CN0_SI)
@@ -141,6 +289,36 @@ static uint8_t smb_pollModule(void)
       // Firmware must clear the start status
       SMB0CN0_STA = 0;
 
+#if (BOOT_USE_BLOCK == 1)
+      // The hardware only matches the node address and, for multi-drop
+      // nodes, the general call address
+      target = SMB0DAT & ~SMB0DAT_RW__BMASK;
+      if ((SMB0DAT & SMB0DAT_RW__BMASK) == SMB0DAT_RW__WRITE)
+      {
+        // Accept a new frame for this node or the group, unless a complete
+        // frame is still waiting to be executed
+        smb_ignore = (rxState == RX_DONE)
+                     || ((target != BL_SMB_NODE_ADDRESS)
+                         && (target != SMB_GENERAL_CALL));
+        if (!smb_ignore)
+        {
+          rxState = RX_IDLE;
+        }
+        SMB0CN0_ACK = !smb_ignore;
+      }
+      else
+      {
+        SMB0DAT = smb_txByte;
+
+        // Each reply is read once; report busy until the next one is ready
+        smb_txLoaded = smb_txReady;
+        if (smb_txLoaded)
+        {
+          smb_txReady = false;
+          smb_txByte = BOOT_BUSY_REPLY;
+        }
+      }
+#else
       // Check if this is a read or write transfer
       if ((SMB0DAT & SMB0DAT_RW__BMASK) == SMB0DAT_RW__WRITE)
       {
@@ -152,17 +330,38 @@ static uint8_t smb_pollModule(void)
         // Its a master read, send the response byte
         SMB0DAT = smb_txByte;
       }
+#endif
       break;
 
     // Slave Receiver: Data byte received
     case SMB_SRDAT:
+#if (BOOT_USE_BLOCK == 1)
+      // Empty the receive FIFO; the hardware ACKs ahead of the firmware
+      while (!(SMB0FCN1 & SMB0FCN1_RXE__BMASK))
+      {
+        target = SMB0DAT;
+        if (!smb_ignore)
+        {
+          receiveByte(target);
+        }
+      }
+#else
       // Store received data byte in local buffer
       smb_rxByte = SMB0DAT;
+#endif
       break;
 
     // Slave Transmitter: Data byte sent
     case SMB_STDAT:
       // Do nothing, master will receive 0xFF if it continues to read more bytes
+#if (BOOT_USE_BLOCK == 1)
+      // Only a read that loaded the reply completes boot_sendReply()
+      if (!smb_txLoaded)
+      {
+        status = SMB_SRSTO;
+      }
+      smb_txLoaded = false;
+#endif
       break;
 
     // Default: STOP condition or bus error will land here
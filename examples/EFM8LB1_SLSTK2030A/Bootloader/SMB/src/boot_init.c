@@ -57,9 +57,15 @@ void boot_initDevice(void)
   XBR2 = XBR2_WEAKPUD__PULL_UPS_ENABLED | XBR2_XBARE__ENABLED;
 
   // SMB0ADR - SMBus 0 Slave Address
-  // GC (General Call Address Enable) = IGNORED (General Call Address is ignored.)
   // SLV (SMBus Hardware Slave Address)
-  SMB0ADR = SMB0ADR_GC__IGNORED | (BL_SMB_SLAVE_ADDRESS & SMB0ADR_SLV__FMASK);
+#if (BL_SMB_NODE != 0)
+  // GC (General Call Address Enable) = RECOGNIZED. Multi-drop nodes receive
+  // group frames through the general call address.
+  SMB0ADR = SMB0ADR_GC__RECOGNIZED | (BL_SMB_NODE_ADDRESS & SMB0ADR_SLV__FMASK);
+#else
+  // GC (General Call Address Enable) = IGNORED (General Call Address is ignored.)
+  SMB0ADR = SMB0ADR_GC__IGNORED | (BL_SMB_NODE_ADDRESS & SMB0ADR_SLV__FMASK);
+#endif
 
   // SMB0ADM - SMBus 0 Slave Address Mask
   // EHACK (Hardware Acknowledge Enable) = ADR_ACK_AUTOMATIC (Automatic
@@ -71,5 +77,11 @@ void boot_initDevice(void)
   // ENSMB (SMBus Enable) = ENABLED (Enable the SMBus module.)
   // EXTHOLD (SMBus Setup and Hold Time Extension Enable) = ENABLED (Enable
   //     SDA extended setup and hold times.)
+#if (BOOT_USE_BLOCK == 1)
+  // The extended hold time is longer than the Fast-mode Plus (1 MHz) data
+  // valid time, so the block protocol runs with standard hold times
+  SMB0CF = SMB0CF_ENSMB__ENABLED;
+#else
   SMB0CF = SMB0CF_ENSMB__ENABLED | SMB0CF_EXTHOLD__ENABLED;
+#endif
 }
@@ -66,6 +66,16 @@ void boot_initDevice(void)
   TMOD = TMOD_T1M__MODE2;       // 8-bit timer with auto-reload
   TCON_TR1 = 1;
 
+#if (BOOT_USE_BAUD == 1)
+  // Start at the detected rate
+  boot_baudReload = 0;
+#endif
+
+#if (BOOT_USE_PIPELINE == 1)
+  // Start with an idle frame receiver
+  boot_initReceiver();
+#endif
+
   // Enable UART0 receiver
   SCON0_REN = 1;
 }
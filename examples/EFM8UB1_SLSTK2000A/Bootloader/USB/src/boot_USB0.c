@@ -14,6 +14,28 @@ uint8_t boot_rxSize;
 // Index of the next byte to get from the receive buffer
 uint8_t boot_rxTail;
 
+#if (BOOT_USE_STREAM == 1)
+// ----------------------------------------------------------------------------
+// Wait for the next boot record to arrive.
+// ----------------------------------------------------------------------------
+void boot_nextRecord(void)
+{
+  // Skip any part of the last record that the command did not use
+  while (boot_rxSize)
+  {
+    boot_getByte();
+  }
+
+  // Records follow each other in the receive buffer, so keep it intact and
+  // skip the padding up to the next frame start character
+  while (BOOT_FRAME_START != boot_getByte())
+    ;
+
+  // Receive and save the frame length
+  boot_rxSize = boot_getByte();
+}
+
+#else
 // ----------------------------------------------------------------------------
 // Wait for the next boot record to arrive.
 // ----------------------------------------------------------------------------
@@ -32,6 +54,7 @@ void boot_nextRecord(void)
   // Receive and save the frame length
   boot_rxSize = boot_getByte();
 }
+#endif // BOOT_USE_STREAM
 
 // ----------------------------------------------------------------------------
 // Get the next byte in the boot record.
@@ -43,6 +66,13 @@ uint8_t boot_getByte(void)
   // If the USB receive buffer is empty, wait for more data
   while (boot_rxTail == usb_rxHead)
   {
+#if (BOOT_USE_STREAM == 1)
+    // Send any replies still waiting for the EP1 FIFO
+    if (usb_txCount)
+    {
+      USB_sendReport();
+    }
+#endif
     USB_pollModule();
   } 
 
@@ -67,6 +97,48 @@ uint16_t boot_getWord(void)
   return word.u16;
 }
 
+#if (BOOT_USE_STREAM == 1)
+// ----------------------------------------------------------------------------
+// Add a one byte reply to the pending INPUT report.
+// ----------------------------------------------------------------------------
+void boot_sendReply(uint8_t reply)
+{
+  // Merge with the last reply in the pending report if it is the same.
+  // usb_txBuf holds reply0, count0, reply1, count1.
+  if (usb_txCount && usb_txBuf[3] && (usb_txBuf[2] == reply) && (usb_txBuf[3] != 0xFF))
+  {
+    usb_txBuf[3]++;
+  }
+  else if (usb_txCount && !usb_txBuf[3] && (usb_txBuf[0] == reply) && (usb_txBuf[1] != 0xFF))
+  {
+    usb_txBuf[1]++;
+  }
+  else if (usb_txCount && !usb_txBuf[3])
+  {
+    usb_txBuf[2] = reply;
+    usb_txBuf[3] = 1;
+  }
+  else
+  {
+    // Wait for the pending report to be loaded into the FIFO
+    while (usb_txCount != 0)
+    {
+      USB_sendReport();
+      USB_pollModule();
+    }
+    usb_txBuf[0] = reply;
+    usb_txBuf[1] = 1;
+    usb_txBuf[2] = 0;
+    usb_txBuf[3] = 0;
+    usb_txCount = USB_HID_IN_SIZE;
+  }
+
+  // Load the report now if the FIFO is free; otherwise it goes out from
+  // boot_getByte() while waiting for data
+  USB_sendReport();
+}
+
+#else
 // ----------------------------------------------------------------------------
 // Send a one byte reply to the host.
 // ----------------------------------------------------------------------------
@@ -83,6 +155,7 @@ void boot_sendReply(uint8_t reply)
     USB_pollModule();
   }
 }
+#endif // BOOT_USE_STREAM
 
 // ----------------------------------------------------------------------------
 // Exit bootloader and start the user application.
@@ -94,6 +167,12 @@ void boot_runApp(void)
   usb_tick = 255-100;
   do
   {
+#if (BOOT_USE_STREAM == 1)
+    if (usb_txCount)
+    {
+      USB_sendReport();
+    }
+#endif
     USB_pollModule();
   }
   while (usb_tick);
@@ -40,6 +40,14 @@ void boot_initDevice(void)
   SET_SFRPAGE(USB0_PAGE);
   USB0CF = USB0CF_USBCLK__HFOSC1;
 
+#if (BOOT_USE_STREAM == 1)
+  // Start with empty receive and transmit buffers
+  usb_rxHead = 0;
+  boot_rxTail = 0;
+  boot_rxSize = 0;
+  usb_txCount = 0;
+#endif
+
   // Initialize the USB driver
   USB_initModule();
 }
@@ -13,56 +13,72 @@
 #ifndef BUFFERS_H_
 #define BUFFERS_H_
 
+#include <SI_EFM8UB1_Register_Enums.h>
 #include <VCPXpress.h>
 #include <stdint.h>
+#include "si8_ring.h"
 
 //-----------------------------------------------------------------------------
 // Definitions
 //-----------------------------------------------------------------------------
 #define USB_BLOCK_SIZE  0x40 //!< Size of USB packst
+#define RING_SIZE       0x80 //!< Size of each bridge ring (power of two)
+
+#define RTS_OFF_SPACE   16   //!< Deassert RTS when less than this many bytes
+                             //   are free in the UART Rx ring. Leaves room
+                             //   for the bytes the remote sends before it
+                             //   sees RTS.
+#define RTS_ON_SPACE    64   //!< Reassert RTS when this many bytes are free.
+
+#define RTS_ASSERTED    0    //!< RTS/CTS are active low
+#define RTS_DEASSERTED  1
+#define CTS_ASSERTED    0
+
+/// Bridge throughput and loss counters
+typedef struct
+{
+  uint32_t usbToUart;     //!< Bytes received from host and queued for UART
+  uint32_t uartToUsb;     //!< Bytes received on UART and sent to host
+  uint16_t uartRxDropped; //!< UART bytes lost because the Rx ring was full
+  uint16_t rtsHolds;      //!< Times RTS was deasserted to pause the remote
+  uint16_t ctsStalls;     //!< Times UART Tx paused because CTS was deasserted
+  uint16_t usbRxHolds;    //!< Times the host was NAKed because the UART Tx
+                          //   ring had no room for a packet
+} BridgeStats_t;
 
 //-----------------------------------------------------------------------------
 // External Global Variables
 //-----------------------------------------------------------------------------
-//Data buffers
-extern SI_SEGMENT_VARIABLE(uartRxBuf_A[USB_BLOCK_SIZE], uint8_t, SI_SEG_XDATA); 
-extern SI_SEGMENT_VARIABLE(uartRxBuf_B[USB_BLOCK_SIZE], uint8_t, SI_SEG_XDATA);
-extern SI_SEGMENT_VARIABLE(uartTxBuf_A[USB_BLOCK_SIZE], uint8_t, SI_SEG_XDATA);
-extern SI_SEGMENT_VARIABLE(uartTxBuf_B[USB_BLOCK_SIZE], uint8_t, SI_SEG_XDATA);
-
-//Data buffer status
-extern SI_SEGMENT_VARIABLE(uartRxLen_A, uint16_t, SI_SEG_XDATA);
-extern SI_SEGMENT_VARIABLE(uartRxLen_B, uint16_t, SI_SEG_XDATA);
-extern SI_SEGMENT_VARIABLE(uartTxLen_A, uint16_t, SI_SEG_XDATA);
-extern SI_SEGMENT_VARIABLE(uartTxLen_B, uint16_t, SI_SEG_XDATA);
+//Bridge rings
+extern SI_SEGMENT_VARIABLE(uartRxRing, si8Ring_t, SI8_RING_STRUCT_SEG);
+extern SI_SEGMENT_VARIABLE(uartTxRing, si8Ring_t, SI8_RING_STRUCT_SEG);
 
-extern bool usbTxReady;
-extern bool usbRxReady;
-extern bool uartTxReady;
-extern bool uartRxReady;
+//USB receive bounce buffer
+extern SI_SEGMENT_VARIABLE(usbRxBuf[USB_BLOCK_SIZE], uint8_t, SI_SEG_XDATA);
+extern SI_SEGMENT_VARIABLE(usbRxLen, uint16_t, SI_SEG_XDATA);
 
-//USB Side active buffers
-extern SI_SEGMENT_VARIABLE_SEGMENT_POINTER(usbTxBuf, uint8_t, SI_SEG_XDATA, SI_SEG_XDATA);
-extern SI_SEGMENT_VARIABLE_SEGMENT_POINTER(usbTxLen, uint16_t, SI_SEG_XDATA, SI_SEG_XDATA);
-extern SI_SEGMENT_VARIABLE_SEGMENT_POINTER(usbRxBuf, uint8_t, SI_SEG_XDATA, SI_SEG_XDATA);
-extern SI_SEGMENT_VARIABLE_SEGMENT_POINTER(usbRxLen, uint16_t, SI_SEG_XDATA, SI_SEG_XDATA);
+//USB transmit in flight (points into uartRxRing)
+extern SI_SEGMENT_VARIABLE(usbTxLen, uint16_t, SI_SEG_XDATA);
+extern SI_SEGMENT_VARIABLE(usbTxCount, uint16_t, SI_SEG_XDATA);
+extern SI_SEGMENT_VARIABLE(usbTxConsumed, uint16_t, SI_SEG_XDATA);
 
+extern SI_SEGMENT_VARIABLE(hostBaudRate, uint32_t, SI_SEG_XDATA);
+extern SI_SEGMENT_VARIABLE(bridgeStats, BridgeStats_t, SI_SEG_XDATA);
 
-//UART Side active buffers
-//=========================================
-extern SI_SEGMENT_VARIABLE_SEGMENT_POINTER(uartTxBuf, uint8_t, SI_SEG_XDATA, SI_SEG_XDATA);
-extern SI_SEGMENT_VARIABLE_SEGMENT_POINTER(uartTxLen, uint16_t, SI_SEG_XDATA, SI_SEG_XDATA);
-extern SI_SEGMENT_VARIABLE_SEGMENT_POINTER(uartRxBuf, uint8_t, SI_SEG_XDATA, SI_SEG_XDATA);
-extern SI_SEGMENT_VARIABLE_SEGMENT_POINTER(uartRxLen, uint16_t, SI_SEG_XDATA, SI_SEG_XDATA);
+extern bool usbTxReady;
+extern bool usbRxReady;
+extern bool uartTxBusy;
+extern bool ctsFlow;
+extern bool rtsFlow;
+extern bool baudRateChanged;
+extern bool statsRefresh;
 
+SI_SBIT(UART_RTS, SFR_P1, 2);          //!< RTS output, active low
+SI_SBIT(UART_CTS, SFR_P1, 3);          //!< CTS input, active low
 
 //-----------------------------------------------------------------------------
 // Function PROTOTYPES
 //-----------------------------------------------------------------------------
 void resetState();
-void switchRxBuffer();
-void switchTxBuffer();
-void usbSwitchTxbuffer();
-void usbSwitchRxbuffer();
 
 #endif /* BUFFERS_H_ */
@@ -12,8 +12,13 @@
 #define EFM8PDL_SPI0_USE_FIFO             0
 #define EFM8PDL_SPI0_TX_SEGTYPE           SI_SEG_PDATA
 
-//Select UART driver options
+//Select UART driver options. The bridge has its own UART0 ISR
+// (callbacks.c) so the driver's buffer mode is not used.
 #define EFM8PDL_UART0_USE 1
-#define EFM8PDL_UART0_USE_BUFFER 1
+#define EFM8PDL_UART0_USE_BUFFER 0
+
+//Ring buffer options. Control structures in DATA keep the UART ISR short.
+#define SI8_RING_BUFFER_SEG               SI_SEG_XDATA
+#define SI8_RING_STRUCT_SEG               SI_SEG_DATA
 
 #endif // __EFM8_CONFIG_H__
@@ -1,9 +1,16 @@
 
-
 extern void initDisplay();
-extern void printTx(uint8_t val);
-extern void printRx(uint8_t val);
+extern void printStat(uint8_t stat, uint32_t value);
 extern void refreshLcd(void);
 extern SI_SEGMENT_VARIABLE(txCharReady, bool, SI_SEG_IDATA);
 extern SI_SEGMENT_VARIABLE(txChar, uint8_t, SI_SEG_XDATA);
 
+//Counters shown by printStat()
+#define STAT_BAUD        0
+#define STAT_USB_TO_UART 1
+#define STAT_UART_TO_USB 2
+#define STAT_RX_DROPPED  3
+#define STAT_RTS_HOLDS   4
+#define STAT_CTS_STALLS  5
+#define STAT_USB_HOLDS   6
+#define STAT_COUNT       7
@@ -25,7 +25,8 @@
 //-----------------------------------------------------------------------------
 
 #define SYSCLK       48000000          //!< SYSCLK frequency in Hz
-#define BAUDRATE       115200          //!< Baud rate of UART in bps
+#define BAUDRATE       115200          //!< Baud rate of UART in bps until the
+                                       //   host sets one
 
 
 //-----------------------------------------------------------------------------
@@ -35,6 +36,7 @@ void System_Init (void);
 void SYSCLK_Init (void);
 void PORT_Init (void);
 void UART0_Init (void);
+bool UART0_setBaudRate (uint32_t baud);
 void SPI0_Init (void);
 void TIMER2_Init (void);
 void TIMER3_Init (void);
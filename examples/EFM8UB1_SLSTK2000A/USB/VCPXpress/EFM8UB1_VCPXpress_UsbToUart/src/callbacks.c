@@ -12,31 +12,32 @@
  *
  * Definitions and external declarations for VCPXpress_callback.c
  * We also place the UART and TIMER ISR here.
- * 
+ *
  *****************************************************************************/
 
 #include <SI_EFM8UB1_Register_Enums.h>                // SI_SFR declarations
+#include <endian.h>
 #include "buffers.h"
 #include "initialization.h"
-#include "uart_0.h"
 
-//Here we say if we are idle for 10 flush.
-#define RX_FLUSH_TIME 10   //<! Number of milliseconds the uart needs 
-                           //   to be idle before we flush whatever
-                           //   data we have.
-static uint16_t rxIdleTime;   //!< Number of bit times since last byte
-                              //   received.
+#define STATS_REFRESH_TIME 100 //<! Number of milliseconds between LCD
+                               //   counter row updates.
+
+/** Data returned by VCP_Get_Baudrate and VCP_Get_FlowControl */
+static SI_SEGMENT_VARIABLE(hostData[18], uint8_t, SI_SEG_XDATA);
 
 /**************************************************************************//**
  *  @brief
  *    VCPXpress callback
- *    
- *  Called by VCPXpresss. We only need to handle TX/RX compelte and device_open
- *   
+ *
+ *  Called by VCPXpresss. Handles TX/RX complete, device_open and the
+ *  baud rate and flow control requests.
+ *
  *****************************************************************************/
 void VCP_Callback(void)
 {
    uint32_t INTVAL = Get_Callback_Source();
+   uint16_t numBytes;
 
    // Device was opened so reset
    if (INTVAL & DEVICE_OPEN)
@@ -44,122 +45,142 @@ void VCP_Callback(void)
 
      //Reset variable state
      resetState();
-     rxIdleTime = 0;
 
    }// if DEVICE_OPEN
 
-   // Rx compete ready for next RX buffer.
+   // Host set the baud rate. Timer1 is reprogrammed from main.
+   if (INTVAL & VCP_CB_SET_BAUDRATE)
+   {
+     VCP_Get_Baudrate(hostData);
+     hostBaudRate = le32toh(*((uint32_t*) hostData));
+     baudRateChanged = 1;
+   }
+
+   // Host set flow control. Only hardware handshaking is supported:
+   //  ulControlHandshake bit 3 enables CTS handshake and ulFlowReplace
+   //  bits 7:6 = 10b enable RTS handshake (see AN571).
+   if (INTVAL & VCP_CB_SET_FLOW)
+   {
+     VCP_Get_FlowControl(hostData);
+     ctsFlow = (hostData[0] & 0x08) ? 1 : 0;
+     rtsFlow = ((hostData[4] & 0xC0) == 0x80) ? 1 : 0;
+     if (!rtsFlow)
+     {
+       UART_RTS = RTS_ASSERTED;
+     }
+   }
+
+   // Rx complete. Move the packet into the UART ring.
    if (INTVAL & RX_COMPLETE)
    {
-  	 if(*usbRxLen != 0)
-  	 {
-  		 //if we received a packet of non-zero length switch to next
-  		 // buffer. *usbRxLen is already set by usb library.
-       usbSwitchRxbuffer();
-  	 }
-
-  	 // Flag main that next transfer can start
-  	 // in the case of a zlp this will restart the receive.
-  	 usbRxReady = 1;
+     // Main only starts a read when the ring has room for a full packet
+     // so this never drops data.
+     if (usbRxLen != 0)
+     {
+       si8_ring_write(&uartTxRing, usbRxBuf, (uint8_t) usbRxLen);
+       bridgeStats.usbToUart += usbRxLen;
+       usbRxLen = 0;
+     }
+
+     // Flag main that next transfer can start
+     // in the case of a zlp this will restart the receive.
+     usbRxReady = 1;
 
    }// if RX_COMPLETE
 
-   // Rx compete ready for next TX buffer.
+   // Tx complete. Release the bytes sent from the ring.
    if (INTVAL & TX_COMPLETE)
    {
-  	 //Only switch buffer if we completed a packet of non-zero length
-  	 if(*usbTxLen != 0)
-  	 {
-    	 // When TX complete perform buffer switch
-       *usbTxLen = 0;       // mark current buffer empty now that TX is done
-       usbSwitchTxbuffer(); // switch usb buffer
-  	 }
-
-  	 // Flag main while loop that it can send data up
-  	 usbTxReady = 1;
-   
+     numBytes = usbTxCount - usbTxConsumed;
+     si8_ring_consume(&uartRxRing, (uint8_t) numBytes);
+     bridgeStats.uartToUsb += numBytes;
+     usbTxConsumed = usbTxCount;
+
+     // Flag main while loop that it can send data up
+     if (usbTxCount >= usbTxLen)
+     {
+       usbTxReady = 1;
+     }
+
    }// if TX_COMPLETE
 }//VCPXpress_API_CALLBACK()
 
-void UART0_receiveCompleteCb()
+/**************************************************************************//**
+ *  @brief
+ *    UART0 Interrupt Service Routine
+ *
+ *  Runs at high priority so that no byte is lost at 1 Mbaud. Received bytes
+ *  go into uartRxRing and RTS is deasserted as the ring nears full. Bytes
+ *  from uartTxRing are sent while CTS is asserted. When the ring runs empty
+ *  or CTS is deasserted the transmitter goes idle and main restarts it by
+ *  setting TI.
+ *
+ *****************************************************************************/
+SI_INTERRUPT(UART0_ISR, UART0_IRQn)
 {
+  uint8_t value;
 
-	// When Rx completes (full) perform buffer switch
-	*uartRxLen  = USB_BLOCK_SIZE; // mark current buffer full
-  switchRxBuffer();             // switch to next buffer
-	uartRxReady = 1;              // Flag main that next Read can start
-}
+  if (SCON0_RI)
+  {
+    SCON0_RI = 0;
+
+    if (!si8_ring_push(&uartRxRing, SBUF0))
+    {
+      bridgeStats.uartRxDropped++;
+    }
+
+    if (rtsFlow
+        && (UART_RTS == RTS_ASSERTED)
+        && (si8_ring_space(&uartRxRing) < RTS_OFF_SPACE))
+    {
+      UART_RTS = RTS_DEASSERTED;
+      bridgeStats.rtsHolds++;
+    }
+  }
 
-void UART0_transmitCompleteCb()
-{
-    // When TX complete perform buffer switch
-	*uartTxLen = 0;   // mark current buffer empty
-	switchTxBuffer(); // Switch to next buffer
-	uartTxReady = 1;  // Flag main while loop that it can start transfer
+  if (SCON0_TI)
+  {
+    SCON0_TI = 0;
+
+    if (ctsFlow && (UART_CTS != CTS_ASSERTED))
+    {
+      if (!si8_ring_isEmpty(&uartTxRing))
+      {
+        bridgeStats.ctsStalls++;
+      }
+      uartTxBusy = 0;
+    }
+    else if (si8_ring_pop(&uartTxRing, &value))
+    {
+      SBUF0 = value;
+    }
+    else
+    {
+      uartTxBusy = 0;
+    }
+  }
 }
 
 /**************************************************************************//**
  *  @brief
  *    TIMER0 Interrupt Service Routine
- *    
- *  The UART ISR only causes data to be sent to the host on a buffeer
- *  overflow. If a small number of bytes is received followed by a long
- *  pause we want to flush those bytes in a reasonable time frame. This 
- *  ISR measures the time since the last bye received. If that time exceeds
- *  a preset limit then the rx buffer is flushed imediatly. 
- *  
- *  Here we use TIMER0 to setup a static timeout. However for lower baud rates
- *  we could turn on the TIMER0 (baud rate generation) interrupt and make our 
- *  timeout in terms of uart bit widths. For high baud rates this does not work
- *  since the timer fires often and the ISR ends up eating a lot of cpu cycles.
- *   
+ *
+ *  1 ms tick. The bridge no longer needs an Rx flush timeout since main
+ *  hands whatever is in uartRxRing to USB as soon as the endpoint is free,
+ *  so the tick only paces the LCD counter updates.
+ *
  *****************************************************************************/
 SI_INTERRUPT(TIMER0_ISR, TIMER0_IRQn)
 {
-  static uint8_t previousBytes;  //!< Previous number of bytes remaining
-  uint8_t numBytes;              //!< Num bytes in the uartRx buffer
+  static uint8_t ticks;
 
   //Reload time for next 1ms.
   TH0 = -(SYSCLK/1000)>>8;
   TL0 = -(SYSCLK/1000) & 0x0FF;
 
-  numBytes = USB_BLOCK_SIZE - UART0_rxBytesRemaining();
-
-  //If the Rx buffer is empty we don't need to do anything (bail)
-  if (!numBytes)
+  if (++ticks >= STATS_REFRESH_TIME)
   {
-	  return;
+    ticks = 0;
+    statsRefresh = 1;
   }
-
-  //if the buffer isn't empty but has received a new
-  // byte then reset our idle time
-  if (previousBytes != numBytes)
-  {
-	  rxIdleTime = 0;
-	  previousBytes = numBytes;
-  }
-
-  //if timeout occurs then flush RX buffer.
-  if(rxIdleTime > RX_FLUSH_TIME)
-  {
-	  //Block UART (and lower priority) interrupts
-	  IE_EA = 0;
-	  *uartRxLen = numBytes; //Set length of current rxBuffer
-      switchRxBuffer();      //Switch buffer
-      //Prime next read
-      UART0_readBuffer(uartRxBuf, USB_BLOCK_SIZE);
-	  IE_EA = 1;
-
-	  //reset timeout
-	  rxIdleTime = 0;
-  }
-  else
-  {
-    //Increment idle time
-    rxIdleTime++;
-  }
-
-
 }// timer0 IST
-
-
@@ -18,22 +18,29 @@
  *
  *****************************************************************************/
 
-#define TX_START 3
-#define RX_START 10
+#define STAT_START 3   //!< First row of the counter list
+#define STAT_COL   11  //!< First column of the counter values
 
 //One row of pixels
 SI_SEGMENT_VARIABLE(lineBuf[DISP_BUF_SIZE], uint8_t, RENDER_LINE_SEG);
 
 //Text line variables
-SI_SEGMENT_VARIABLE(txText[21], uint8_t, SI_SEG_XDATA);
-SI_SEGMENT_VARIABLE(rxText[21], uint8_t, SI_SEG_XDATA);
-SI_SEGMENT_VARIABLE(txPosition, uint8_t, SI_SEG_XDATA);
-SI_SEGMENT_VARIABLE(rxPosition, uint8_t, SI_SEG_XDATA);
-SI_SEGMENT_VARIABLE(txRow, uint8_t, SI_SEG_XDATA);
-SI_SEGMENT_VARIABLE(rxRow, uint8_t, SI_SEG_XDATA);
+SI_SEGMENT_VARIABLE(statText[22], uint8_t, SI_SEG_XDATA);
 SI_SEGMENT_VARIABLE(cRow, uint8_t, SI_SEG_XDATA);
 SI_SEGMENT_VARIABLE(cCol, uint8_t, SI_SEG_XDATA);
 
+//Counter labels, indexed by STAT_xxx
+SI_SEGMENT_VARIABLE(statLabel[STAT_COUNT][STAT_COL], const char, SI_SEG_CODE) =
+{
+  "Baud",
+  "To UART",
+  "To USB",
+  "RX drops",
+  "RTS holds",
+  "CTS stalls",
+  "USB holds",
+};
+
 //Write line of text
 void printStr(uint8_t row, uint8_t col, uint8_t* txt)
 {
@@ -56,119 +63,47 @@ void printStr(uint8_t row, uint8_t col, uint8_t* txt)
   SFRPAGE = 0x00;
 }
 
-//Clear a line of text
-void clearText(SI_VARIABLE_SEGMENT_POINTER(buffer, uint8_t, SI_SEG_XDATA))
-{
-	uint8_t i;
-	for(i=0; i<21; i++){
-		*buffer = 0x00;
-		buffer++;
-	}
-}
-
 //Initialize the display
 void initDisplay()
 {
+  uint8_t stat;
+
   DISP_Init();
   RENDER_ClrLine(lineBuf);
-  txPosition = 0;
-  rxPosition = 0;
-  txRow      = TX_START;
-  rxRow      = RX_START;
-	clearText(txText);
-	clearText(rxText);
-
 
-  printStr(0, 2, "Usb <--> Uart Demo");
+  printStr(0, 1, "Usb <--> Uart Bridge");
   printStr(1, 0, "---------------------");
-  printStr(2, 0, "TX Data:");
-  printStr(8, 0, "---------------------");
-  printStr(9, 0, "RX Data:");
-}
 
-//Clear the log window for tx or rx log.
-void clearLog(uint8_t start)
-{
-	uint8_t y;
-
-  for (y = start*8; y < (start+5)*8; y++)
-	{
-		DISP_ClearLine(y, 0x00);
-	}
+  for (stat = 0; stat < STAT_COUNT; stat++)
+  {
+    printStat(stat, 0);
+  }
 }
 
-//Increment Tx to next line of display
-void newLineTx()
+//Print a counter and its label. Each call redraws one text row so the
+// USB interrupt is only held off for a short time.
+void printStat(uint8_t stat, uint32_t value)
 {
-	//Increment to next line and clear line buffer
-  txRow++;
-	txPosition = 0;
-	clearText(txText);
-
-  //If we rollover clear line and
-	if(txRow > TX_START + 4)
-	{
-		clearLog(TX_START);
-		txRow = TX_START;
-	}
-}
-
-//Increment Tx to next line of display
-void newLineRx()
-{
-	//Increment to next line and clear line buffer
-  rxRow++;
-	rxPosition = 0;
-	clearText(rxText);
+	uint8_t i;
 
-  //If we rollover clear line and
-	if(rxRow > RX_START + 4)
+	//Label, padded with spaces
+	for (i = 0; (i < STAT_COL) && statLabel[stat][i]; i++)
 	{
-		clearLog(RX_START);
-		rxRow = RX_START;
+		statText[i] = statLabel[stat][i];
 	}
-}
-
-//Print a new character to the Tx Display
-void printTx(uint8_t val)
-{
-	//if CR then go to next line
-	if(val == 0x0D)
+	for (; i < 21; i++)
 	{
-		newLineTx();
-		return;
+		statText[i] = ' ';
 	}
+	statText[21] = 0x00;
 
-	//print character and
-	txText[txPosition] = val;
-	txPosition++;
-  printStr(txRow, 0, txText);
-
-  //If we are out of space on this line increment to the next line.
-	if(txPosition > 19)
+	//Value, right aligned
+	i = 20;
+	do
 	{
-		newLineTx();
-	}
-}
-
-//Print a new character to the Tx Display
-void printRx(uint8_t val)
-{
-	//if CR then go to next line
-	if(val == 0x0D)
-	{
-		newLineRx();
-		return;
-	}
-
-	//print character and
-	rxText[rxPosition] = val;
-	rxPosition++;
-  printStr(rxRow, 0, rxText);
+		statText[i--] = '0' + (value % 10);
+		value /= 10;
+	} while (value && (i >= STAT_COL));
 
-  //If we are out of space on this line increment to the next line.
-	if(rxPosition > 19)
-	{
-		newLineRx();
-	}
+	printStr(STAT_START + stat, 0, statText);
 }
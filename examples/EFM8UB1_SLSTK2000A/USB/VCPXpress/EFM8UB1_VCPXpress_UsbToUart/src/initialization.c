@@ -75,7 +75,12 @@ void SYSCLK_Init (void)
  *  Configure the Crossbar and GPIO ports.
  *    * P0.4 - UART TX (push-pull)
  *    * P0.5 - UART RX
- *   
+ *    * P1.2 - UART RTS (push-pull, active low)
+ *    * P1.3 - UART CTS (input, active low)
+ *
+ *  RTS and CTS are GPIO handled by the UART ISR since UART0 has no hardware
+ *  handshake. They are defined in buffers.h and may be moved to any free pin.
+ *
  *****************************************************************************/
 void PORT_Init (void)
 {
@@ -85,11 +90,13 @@ void PORT_Init (void)
   XBR2     = XBR2_XBARE__ENABLED      // Enable crossbar and disable weak pull-ups
              | XBR2_WEAKPUD__PULL_UPS_DISABLED;
   P0MDOUT |= 0x52;                    // Set TX + SCK + NSS pin to push-pull.
-  P1MDOUT |= 0x01;                    // Set MOSI pin to push-pull.
+  P1MDOUT |= 0x05;                    // Set MOSI + RTS pin to push-pull.
   P2MDOUT |= 0x09;                    // BC_EN to push-pull
 
   P0SKIP  = 0x0F;                     //Place SPI @ P06
+  P1SKIP  = 0x0C;                     //Keep RTS + CTS off the crossbar
 
+  P1 &= ~0x04;                        // Assert RTS
   P2 |= 0x09;                         // BC enable and display power
 
 }
@@ -113,28 +120,9 @@ void UART0_Init (void)
            | SCON0_RI__NOT_SET
            | SCON0_TI__NOT_SET;
 
-  CKCON0 &= ~CKCON0_T1M__BMASK; //select prescaler
-
-  if (SYSCLK/BAUDRATE/2/256 < 1) {
-    TH1 = -(SYSCLK/BAUDRATE/2/1);
-    CKCON0 |=  CKCON0_T1M__SYSCLK;                 // T1M = 1;
-  }else if (SYSCLK/BAUDRATE/2/256 < 4) {
-    TH1 = -(SYSCLK/BAUDRATE/2/4);
-    CKCON0 &= ~CKCON0_SCA__FMASK;                  // T1M = 0; SCA1:0 = 01
-    CKCON0 |=  CKCON0_SCA__SYSCLK_DIV_4;
-  } else if (SYSCLK/BAUDRATE/2/256 < 12) {
-    TH1 = -(SYSCLK/BAUDRATE/2/12);
-    CKCON0 &= ~CKCON0_SCA__FMASK;                  // T1M = 0; SCA1:0 = 01
-  } else if (SYSCLK/BAUDRATE/2/256 < 48) {
-    TH1 = -(SYSCLK/BAUDRATE/2/48);
-    CKCON0 &= ~CKCON0_SCA__FMASK;                  // T1M = 0; SCA1:0 = 01
-    CKCON0 |=  CKCON0_SCA__SYSCLK_DIV_48;
-  } else {
-     while (1);                       // Error.  Unsupported baud rate
-  }
-  TL1 = TH1;                          // init Timer1 reload
+  UART0_setBaudRate(BAUDRATE);
 
-   //Setup timer 0 as 1ms tick for timeout.
+   //Setup timer 0 as 1ms tick for the LCD counters.
    CKCON0 |=  CKCON0_T0M__SYSCLK; // T0M = 1;
    TH0 = -(SYSCLK/1000)>>8;     
    TL0 = -(SYSCLK/1000) & 0x00FF;
@@ -153,6 +141,51 @@ void UART0_Init (void)
    IE_ET0 = 1;                         // Enable TIMER0 interrupts;
 }
 
+/**************************************************************************//**
+ *  @brief
+ *    Set the UART baud rate.
+ *
+ *  @param baud
+ *    Baud rate in bps.
+ *
+ *  @returns
+ *    False if Timer1 cannot generate the rate. The current rate is kept.
+ *
+ *  Timer1 overflows twice per bit. The smallest prescaler that fits the
+ *  reload in 8 bits is used, so 1 Mbaud runs from SYSCLK with TH1 = -24.
+ *
+ *****************************************************************************/
+bool UART0_setBaudRate (uint32_t baud)
+{
+  uint16_t reload;
+
+  if ((baud == 0) || (SYSCLK/baud/2 == 0) || (SYSCLK/baud/2/256 >= 48))
+  {
+    return false;                     // Unsupported baud rate
+  }
+  reload = SYSCLK/baud/2;
+
+  TCON_TR1 = 0;
+  CKCON0 &= ~(CKCON0_T1M__BMASK | CKCON0_SCA__FMASK); //select prescaler
+
+  if (reload/256 < 1) {
+    TH1 = -reload;
+    CKCON0 |=  CKCON0_T1M__SYSCLK;                 // T1M = 1;
+  } else if (reload/256 < 4) {
+    TH1 = -(reload/4);
+    CKCON0 |=  CKCON0_SCA__SYSCLK_DIV_4;           // T1M = 0; SCA1:0 = 01
+  } else if (reload/256 < 12) {
+    TH1 = -(reload/12);                            // T1M = 0; SCA1:0 = 00
+  } else {
+    TH1 = -(reload/48);
+    CKCON0 |=  CKCON0_SCA__SYSCLK_DIV_48;          // T1M = 0; SCA1:0 = 10
+  }
+  TL1 = TH1;                          // init Timer1 reload
+  TCON_TR1 = 1;                       // START Timer1
+
+  return true;
+}
+
 void SPI0_Init(void) {
 	SPI0CKR = (23 << SPI0CKR_SPI0CKR__SHIFT); //SYSCLK/24*2 = 12Mhz
 
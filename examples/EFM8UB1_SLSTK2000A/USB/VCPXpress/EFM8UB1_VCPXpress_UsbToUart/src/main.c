@@ -10,21 +10,26 @@
 #include <SI_EFM8UB1_Register_Enums.h>                // SI_SFR declarations
 #include "initialization.h"
 #include "buffers.h"
-#include "uart_0.h"
 #include "display.h"
 
 /**************************************************************************//**
  *
  * Main thread for VCPXpress UART demo.
  * 
- * This example implements a USB to uart bridge using a ping-pong buffering 
- * scheme for both Rx and Tx paths. It includes no flow control and has a 
- * fixed baud-rate of 115200 baud (ignores change requests from the host).
+ * This example implements a USB to uart bridge using a ring buffer for
+ * each direction. Data received on the UART is handed to USB as soon as
+ * the IN endpoint is free, in packets of whatever length has arrived, so
+ * there is no flush timeout. Data from the host is only accepted when the
+ * UART ring has room for a whole packet; until then the host is NAKed.
+ *
+ * When the host enables hardware handshaking, RTS is deasserted as the
+ * UART receive ring fills and UART transmit pauses while CTS is deasserted.
+ * The baud rate follows the host, up to 1 Mbaud full-duplex.
  *
  * The MCU enumerates as a COM port and connects to the board controllers COM port providing
  * bidirectional communication between the two COM ports.
  *
- * This example also displays characters received and transmitted on the LCD of the STK.
+ * This example also displays the bridge counters (bridgeStats) on the LCD of the STK.
  *
  *****************************************************************************/
 
@@ -51,42 +56,53 @@ void SiLabs_Startup (void)
  *****************************************************************************/
 int main (void)
 {  
-   uint8_t i;
-   uint8_t result = VCP_STATUS_OK;
+   SI_VARIABLE_SEGMENT_POINTER(span, uint8_t, SI8_RING_BUFFER_SEG);
+   SI_SEGMENT_VARIABLE(stats, BridgeStats_t, SI_SEG_XDATA);
+   uint32_t baudRate = BAUDRATE;
+   uint8_t len;
+   uint8_t stat = 0;
+   bool usbRxHeld = 0;
+   int8_t result;
 
    // Disable watchdog timer
    
    System_Init ();   // Call top-level initialization routine
-   resetState();     // reset buffer statues and init uart
-   UART0_readBuffer(uartRxBuf, USB_BLOCK_SIZE);// init first uart receive
+   ctsFlow = 0;      // no handshake until the host asks for it
+   rtsFlow = 0;
+   resetState();     // reset buffer statues
 
    IE_EA = 1;        // enable global interrupts
 
    initDisplay();    //initialize display
 
 
-   //Main Thread. Here we monitor the current buffer for each
-   //  transfer and kick the transfer when appropriate.
+   //Main Thread. Here we monitor the rings and kick each transfer
+   //  when appropriate.
    while(1)
    {
-     // if usb is ready for the next Tx packet and the current Tx
-     // buffer has data then send the current buffer.
-     if(usbTxReady && *usbTxLen){
-
-       //Copy data to display
-    	 // This must happen first to get data on the LCD before
-    	 // USB flushe's it.
-       for (i=0; i<*usbTxLen; i++){
-       	 printRx(usbTxBuf[i]);
+     // if usb is ready for the next Tx transfer and the UART has
+     // received data then send it straight out of the ring.
+     if(usbTxReady && !si8_ring_isEmpty(&uartRxRing)){
+
+       // Send what is there now, up to the end of the ring buffer. A
+       // multiple of the packet size would end with a ZLP so leave the
+       // last byte for the next transfer instead.
+       len = si8_ring_getReadSpan(&uartRxRing, &span);
+       if (!(len & (USB_BLOCK_SIZE - 1)))
+       {
+         len--;
        }
 
-    	 //VCPXpress library is not reentrant so we disable
+       //VCPXpress library is not reentrant so we disable
        //  the USB interrupt to ensure it doesn't fire during
        //  the block write call
        SFRPAGE = 0x10;
        EIE2 &= ~EIE2_EUSB0__BMASK;
-       usbTxReady = 0;
-       result = Block_Write(usbTxBuf, *usbTxLen, usbTxLen);
+       usbTxReady    = 0;
+       usbTxLen      = len;
+       usbTxCount    = 0;
+       usbTxConsumed = 0;
+       result = Block_Write(span, len, &usbTxCount);
        EIE2 |= EIE2_EUSB0__BMASK;
        SFRPAGE = 0x00;
 
@@ -96,67 +112,96 @@ int main (void)
       	 usbTxReady = 1;
        }
 
-       //Buffer will be switched by callback when transfer completes
+       //Bytes are released from the ring by the callback as
+       //  each packet completes.
 
      }
       
-      //If USB receive has completed and the current buffer
-      // is empty. Prime for next receive.
-      if(usbRxReady && !*usbRxLen)
+      //If USB receive has completed and the UART ring has room for
+      // a full packet, prime for next receive. Otherwise leave the
+      // endpoint unarmed so the host is NAKed until the UART catches up.
+      if(usbRxReady)
       {
-        //VCPXpress library is not reentrant so we disable
-        //  the USB interrupt to ensure it doesn't fire during
-        //  the block read call
-      	SFRPAGE = 0x10;
-      	EIE2 &= ~EIE2_EUSB0__BMASK;
-        usbRxReady = 0;
-        Block_Read(usbRxBuf, USB_BLOCK_SIZE, usbRxLen);
-        EIE2 |= EIE2_EUSB0__BMASK;
-      	SFRPAGE = 0x00;
-
-        //If our read request failed retry
-        if(result != VCP_STATUS_OK)
+        if(si8_ring_space(&uartTxRing) >= USB_BLOCK_SIZE)
         {
-        	usbRxReady = 1;
+          //VCPXpress library is not reentrant so we disable
+          //  the USB interrupt to ensure it doesn't fire during
+          //  the block read call
+      	  SFRPAGE = 0x10;
+      	  EIE2 &= ~EIE2_EUSB0__BMASK;
+          usbRxReady = 0;
+          result = Block_Read(usbRxBuf, USB_BLOCK_SIZE, &usbRxLen);
+          EIE2 |= EIE2_EUSB0__BMASK;
+      	  SFRPAGE = 0x00;
+
+          //If our read request failed retry
+          if(result != VCP_STATUS_OK)
+          {
+        	  usbRxReady = 1;
+          }
+          usbRxHeld = 0;
+
+          //Data is moved to the ring by the callback when the
+          //  transfer completes.
+        }
+        else if(!usbRxHeld)
+        {
+          usbRxHeld = 1;
+          bridgeStats.usbRxHolds++;
         }
-
-        //Buffer will be switched by callback when transfer completes.
 
       }// If usb ready for next receive
 
-      //If uart tx has completed and the current buffer
-      // has data then start next uart transmit
-      if(uartTxReady && *uartTxLen)
+      //If uart tx is idle and the ring has data then restart it. Setting
+      // TI enters the ISR, which sends the first byte.
+      if(!uartTxBusy
+         && !si8_ring_isEmpty(&uartTxRing)
+         && (!ctsFlow || (UART_CTS == CTS_ASSERTED)))
       {
-    	  //Copy data to display
-      	// Do this first so UART doesn't flush data before
-      	// display update is finished.
-      	for (i=0; i<*uartTxLen; i++){
-    	  	printTx(uartTxBuf[i]);
-    	  }
-
-      	//We need to avoid having the UART ISR fire when we are
-    	  // modifying the library. However we also don't want lower
-    	  // priority interrupts to fire so we turn off all interrupts
-    	  IE_EA = 0;
-    	  UART0_writeBuffer(uartTxBuf, *uartTxLen);
-    	  uartTxReady = 0;
-    	  IE_EA = 1;
-
-     	  //Buffer will be switched by callback when transfer completes.
+        uartTxBusy = 1;
+        SCON0_TI = 1;
       }
 
-      //If uart rx has completed and the current buffer
-      // is empty then start receiving new data.
-      if(uartRxReady && !*uartRxLen)
+      //Let the remote send again once USB has drained the receive ring.
+      if(UART_RTS == RTS_DEASSERTED
+         && (!rtsFlow || (si8_ring_space(&uartRxRing) >= RTS_ON_SPACE)))
       {
-    	  //Block UART (and lower priority) interrupts
-    	  IE_EA = 0;
-    	  UART0_readBuffer(uartRxBuf, USB_BLOCK_SIZE);
-    	  uartRxReady = 0;
-    	  IE_EA = 1;
+        UART_RTS = RTS_ASSERTED;
+      }
 
-    	  //Buffer will be switched by callback when transfer completes.
+      //Apply a baud rate sent by the host
+      if(baudRateChanged)
+      {
+        baudRateChanged = 0;
+        if(UART0_setBaudRate(hostBaudRate))
+        {
+          baudRate = hostBaudRate;
+        }
+      }
+
+      //Redraw one counter per tick. Copy the counters with interrupts
+      // off since the ISRs update them a byte at a time.
+      if(statsRefresh)
+      {
+        statsRefresh = 0;
+        IE_EA = 0;
+        stats = bridgeStats;
+        IE_EA = 1;
+
+        switch(stat)
+        {
+          case STAT_BAUD:        printStat(stat, baudRate);            break;
+          case STAT_USB_TO_UART: printStat(stat, stats.usbToUart);     break;
+          case STAT_UART_TO_USB: printStat(stat, stats.uartToUsb);     break;
+          case STAT_RX_DROPPED:  printStat(stat, stats.uartRxDropped); break;
+          case STAT_RTS_HOLDS:   printStat(stat, stats.rtsHolds);      break;
+          case STAT_CTS_STALLS:  printStat(stat, stats.ctsStalls);     break;
+          default:               printStat(stat, stats.usbRxHolds);    break;
+        }
+        if(++stat >= STAT_COUNT)
+        {
+          stat = 0;
+        }
       }
 
    }// while(forever)
@@ -7,6 +7,21 @@
 #ifndef __BOOT_H__
 #define __BOOT_H__
 
+/// Enables the packed write command, BOOT_CMD_ZWRITE
+#ifndef BOOT_USE_ZWRITE
+#define BOOT_USE_ZWRITE 0
+#endif
+
+/// Enables the page CRC table command, BOOT_CMD_PAGECRC
+#ifndef BOOT_USE_PAGECRC
+#define BOOT_USE_PAGECRC 0
+#endif
+
+/// Enables the write CRC command, BOOT_CMD_WCRC
+#ifndef BOOT_USE_WCRC
+#define BOOT_USE_WCRC 0
+#endif
+
 /// Defines the boot frame start byte
 #define BOOT_FRAME_START  '$'
 
@@ -18,18 +33,45 @@
 #define BOOT_CMD_VERIFY   '4'
 #define BOOT_CMD_LOCK     '5'
 #define BOOT_CMD_RUNAPP   '6'
+#define BOOT_CMD_ZWRITE   '7'
+#define BOOT_CMD_PAGECRC  '8'
+#define BOOT_CMD_WCRC     '9'
+
+// Packed write record: '7', addr (2 bytes), size, stream. The stream unpacks
+// to size bytes at addr. Copy tokens read back flash that is already
+// programmed. A stream that does not unpack to exactly size bytes from this
+// record is answered with BOOT_ERR_FRAME, so the host sends it again. See
+// examples/shared/Bootloader/scripts/boot_pack.py for the stream format and
+// the host packer.
+
+// Page CRC record: '8', addr (2 bytes), count. The reply is the CRC16 of
+// each of count BL_FLASH0_PSIZE pages starting at the page containing addr
+// (one boot_sendWord() each), followed by the usual reply byte. Pages that
+// reach BL_FLASH0_LIMIT are refused with BOOT_ERR_RANGE.
+
+// Write CRC record: '9' [, crc (2 bytes)]. Each ERASE, WRITE and ZWRITE
+// range is read back right after it is programmed and its CRC16 is added to
+// a 16-bit sum that the SETUP command clears. With crc, the sum is compared
+// and a mismatch is answered with BOOT_ERR_CRC; without, the sum is
+// returned with boot_sendWord() before the usual reply byte.
 
 /// Bootloader response byte definitions
 #define BOOT_ACK_REPLY    '@'
 #define BOOT_ERR_RANGE    'A'
 #define BOOT_ERR_BADID    'B'
 #define BOOT_ERR_CRC      'C'
+#define BOOT_ERR_FRAME    'D'
 
 /// This array provides access to the bootloader signature and lock byte.
 ///   boot_otp[0] = bootloader signature byte
 ///   boot_otp[1] = flash lock byte
 extern uint8_t SI_SEG_CODE boot_otp[];
 
+/// Flash address of boot_otp[i]. A host build defines fixed addresses.
+#ifndef BOOT_OTP_ADDRESS
+#define BOOT_OTP_ADDRESS(i) ((uint16_t)&boot_otp[i])
+#endif
+
 // Used to implement boot_hasRemaining() macro below
 extern uint8_t boot_rxNext;
 
@@ -75,6 +117,19 @@ extern uint8_t boot_hasRemaining(void);
  *****************************************************************************/
 extern void boot_sendReply(uint8_t reply);
 
+/**************************************************************************//**
+ * Send a 16-bit value to the host, MSB first, ahead of the reply byte.
+ *
+ * @param value The value to send.
+ *****************************************************************************/
+#if defined(IS_DOXYGEN)
+extern void boot_sendWord(uint16_t value);
+#else
+#define boot_sendWord(value) do { \
+  boot_sendReply((value) >> 8); \
+  boot_sendReply((value) & 0xFF); } while(0)
+#endif
+
 /**************************************************************************//**
  * Exit bootloader and start the user application.
  *****************************************************************************/
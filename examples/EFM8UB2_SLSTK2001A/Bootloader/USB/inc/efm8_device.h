@@ -60,4 +60,8 @@
 // Defines for managing SFR pages (used for porting between devices)
 #define SET_SFRPAGE(p)
 
+// Largest flash page size. Pages of this size that are already blank are not
+// erased again; remove this define to always erase.
+#define BL_ERASE_PSIZE 512
+
 #endif // __EFM8_DEVICE_H__
@@ -39,6 +39,17 @@ extern uint16_t flash_readCRC(void);
 #define flash_readCRC(x) (flash_crc)
 #endif
 
+/**************************************************************************//**
+ * Update the CRC with a range of flash bytes.
+ *
+ * @param addr First flash address to include.
+ * @param limit Last flash address to include.
+ *
+ * This device has no CRC0 peripheral, so every byte is fed to the
+ * software CRC.
+ *****************************************************************************/
+extern void flash_updateCRCRange(uint16_t addr, uint16_t limit);
+
 /**************************************************************************//**
  * Set the flash key codes.
  *
@@ -77,6 +88,9 @@ extern bool flash_isValidRange(uint16_t addr, uint8_t size);
  * Erase the flash page the contains the specified address.
  *
  * @param addr Flash address that lies within the page to erase.
+ *
+ * If BL_ERASE_PSIZE is defined, the erase is skipped when the page is
+ * already blank.
  *****************************************************************************/
 extern void flash_erasePage(uint16_t addr);
 
@@ -96,4 +110,15 @@ extern uint8_t flash_readByte(uint16_t addr);
  *****************************************************************************/
 extern void flash_writeByte(uint16_t addr, uint8_t byte);
 
+/**************************************************************************//**
+ * Write the next bytes of the current boot record to flash.
+ *
+ * @param addr Flash address of the first byte to write.
+ * @param len Number of boot record bytes to write.
+ *
+ * Bytes are taken from the boot record with boot_getByte(). Erased values
+ * (0xFF) are skipped.
+ *****************************************************************************/
+extern void flash_writeBlock(uint16_t addr, uint8_t len);
+
 #endif // __FLASH_H__
@@ -7,6 +7,7 @@
 #include "efm8_device.h"
 #include "USB_main.h"
 #include "USB_descriptor.h"
+#include "boot.h"
 
 // -----------------------------------------------------------------------------
 // Global Variable Definitions
@@ -150,6 +151,13 @@ void USB_pollModule(void)
   {
     handleUsbEp0();
   }
+#if (BOOT_USE_STREAM == 1)
+  // EP0 is holding an OUTPUT report until the receive buffer has room
+  else if (usb_ep0_state == EP0_RX)
+  {
+    handleUsbEp0();
+  }
+#endif
   // Suspend signaling detected (not supported)
   // if (reg_cmint & CMINT_SUSINT__SET) {}
 }
@@ -287,6 +295,15 @@ static void handleUsbEp0(void)
     // If data is waiting in the FIFO
     if (reg_e0csr & E0CSR_OPRDY__SET)
     {
+#if (BOOT_USE_STREAM == 1)
+      // Leave the report in the FIFO (the host is NAKed) until it fits in
+      // the receive buffer. One byte stays free so a full buffer is not
+      // mistaken for an empty one.
+      if ((uint8_t)(usb_rxHead - boot_rxTail) >= (uint8_t)(256 - USB_HID_OUT_SIZE))
+      {
+        return;
+      }
+#endif
       readReportData(FIFO0, USB_readIndirectReg(E0CNT));
 
       // Indicate data stage is complete and return to idle state
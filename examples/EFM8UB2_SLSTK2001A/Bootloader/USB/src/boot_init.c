@@ -29,6 +29,14 @@ void boot_initDevice(void)
   //     derived from the Internal High-Frequency Oscillator.)
   CLKSEL = CLKSEL_CLKSL__HFOSC | CLKSEL_USBCLK__HFOSC;
 
+#if (BOOT_USE_STREAM == 1)
+  // Start with empty receive and transmit buffers
+  usb_rxHead = 0;
+  boot_rxTail = 0;
+  boot_rxSize = 0;
+  usb_txCount = 0;
+#endif
+
   // Initialize the USB driver
   USB_initModule();
 }
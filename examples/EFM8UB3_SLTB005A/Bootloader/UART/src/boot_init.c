@@ -12,7 +12,9 @@
 // ----------------------------------------------------------------------------
 void boot_initDevice(void) 
 {
+#if (BOOT_USE_BAUD == 0)
   uint16_t count;
+#endif
 
   //Disable Watchdog with key sequence
   WDTCN = 0xDE;
@@ -42,6 +44,23 @@ void boot_initDevice(void)
   // XBARE (Crossbar Enable) = ENABLED (Crossbar enabled.)
   XBR2 = XBR2_WEAKPUD__PULL_UPS_ENABLED | XBR2_XBARE__ENABLED;
 
+#if (BOOT_USE_BAUD == 1)
+  // Use the UART1 hardware autobaud detector on the 0x55 sync byte that the
+  // host sends before its first frame
+  boot_baudReload = 0;
+  SET_SFRPAGE(UART1_SFR_PAGE);
+  SMOD1 = SMOD1_SDL__8_BITS;
+  UART1LIN = UART1LIN_AUTOBDE__ENABLED;
+  SBCON1 = SBCON1_BREN__ENABLED | SBCON1_BPS__DIV_BY_1;
+  SCON1_REN = 1;
+  while (!(UART1LIN & UART1LIN_SYNCD__BMASK))
+    ;
+
+  // Keep the detected rate
+  UART1LIN = UART1LIN_AUTOBDE__DISABLED;
+  SET_SFRPAGE(0x00);
+
+#else
   // Auto Baud starts here ...
   // INT1 => active high, level sensitive interrupt on P0.5
   IT01CF = IT01CF_IN1PL__ACTIVE_HIGH | IT01CF_IN1SL__P0_5;
@@ -65,6 +84,12 @@ void boot_initDevice(void)
   TH1 = 0x00 - (uint8_t)count;  // Timer counts up
   TMOD = TMOD_T1M__MODE2;       // 8-bit timer with auto-reload
   TCON_TR1 = 1;
+#endif // BOOT_USE_BAUD
+
+#if (BOOT_USE_PIPELINE == 1)
+  // Start with an idle frame receiver
+  boot_initReceiver();
+#endif
 
   // Enable UART1 receiver
   SCON1_REN = 1;
@@ -0,0 +1,18 @@
+//-----------------------------------------------------------------------------
+// F342DC_USB0_Fifo.c
+//-----------------------------------------------------------------------------
+// Copyright 2014 Silicon Laboratories, Inc.
+// http://developer.silabs.com/legal/version/v11/Silicon_Labs_Software_License_Agreement.txt
+//
+// Program Description:
+//
+// USB0 endpoint FIFO copy routines. The source is shared by the C8051F3xx
+// USB examples; see shared/USB0/F3xx_USB0_Fifo.h.
+//
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+
+#include "SI_C8051F340_Register_Enums.h"
+#include "../../../shared/USB0/F3xx_USB0_Fifo.c"
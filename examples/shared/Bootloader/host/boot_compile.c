@@ -0,0 +1,117 @@
+/******************************************************************************
+ * Copyright (c) 2021 by Silicon Laboratories Inc. All rights reserved.
+ *
+ * http://developer.silabs.com/legal/version/v11/Silicon_Labs_Software_License_Agreement.txt
+ *****************************************************************************/
+
+// Compiles an Intel HEX image into an EFM8 boot record file (.efm8).
+//
+// usage: boot_compile [options] image.hex output.efm8
+//
+//   -i ID    add an ident record for derivative ID (e.g. 0x3441)
+//   -p SIZE  flash erase page size (default 512)
+//   -s       limit records to 128 data bytes (132 byte IDATA receive buffer)
+//   -n       do not add verify records
+//   -c       add a write CRC record (bootloader built with BOOT_USE_WCRC)
+//   -r       add a run application record
+//
+// See readme.txt for the build command and the record ordering rules.
+
+// getopt() is POSIX
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "boot_records.h"
+
+// ----------------------------------------------------------------------------
+// Print the command line help.
+// ----------------------------------------------------------------------------
+static void usage(void)
+{
+  fprintf(stderr, "usage: boot_compile [-i ID] [-p SIZE] [-s] [-n] [-c] [-r] image.hex output.efm8\n");
+}
+
+int main(int argc, char *argv[])
+{
+  static BootImage_t image;
+  BootStream_t stream;
+  BootOptions_t options;
+  FILE *f;
+  int opt;
+
+  memset(&stream, 0, sizeof(stream));
+  options.pageSize = 512;
+  options.maxData = BOOT_MAX_DATA;
+  options.derivativeId = -1;
+  options.verify = true;
+  options.writeCrc = false;
+  options.runApp = false;
+
+  while ((opt = getopt(argc, argv, "i:p:sncr")) != -1)
+  {
+    switch (opt)
+    {
+      case 'i':
+        options.derivativeId = (int32_t)(strtol(optarg, NULL, 0) & 0xFFFF);
+        break;
+      case 'p':
+        options.pageSize = (uint16_t)strtol(optarg, NULL, 0);
+        break;
+      case 's':
+        options.maxData = BOOT_SMALL_DATA;
+        break;
+      case 'n':
+        options.verify = false;
+        break;
+      case 'c':
+        options.writeCrc = true;
+        break;
+      case 'r':
+        options.runApp = true;
+        break;
+      default:
+        usage();
+        return 1;
+    }
+  }
+  if (argc - optind != 2)
+  {
+    usage();
+    return 1;
+  }
+  if (!options.pageSize || (options.pageSize & (options.pageSize - 1)))
+  {
+    fprintf(stderr, "Page size must be a power of two\n");
+    return 1;
+  }
+
+  if (!boot_readHex(argv[optind], &image))
+  {
+    return 1;
+  }
+  if (!boot_compile(&image, &options, &stream))
+  {
+    fprintf(stderr, "Out of memory\n");
+    return 1;
+  }
+
+  f = fopen(argv[optind + 1], "wb");
+  if (!f || (fwrite(stream.data, 1, stream.size, f) != stream.size) || fclose(f))
+  {
+    perror(argv[optind + 1]);
+    return 1;
+  }
+
+  // Every record is answered with one reply byte
+  printf("Records:           %u\n", stream.records);
+  printf("Pages erased:      %u\n", stream.erases);
+  printf("Verify ranges:     %u\n", stream.verifies);
+  printf("Data bytes:        %lu\n", stream.dataBytes);
+  printf("Bytes on the wire: %lu\n", (unsigned long)(stream.size + stream.records));
+
+  boot_freeStream(&stream);
+  return 0;
+}
@@ -0,0 +1,408 @@
+/******************************************************************************
+ * Copyright (c) 2021 by Silicon Laboratories Inc. All rights reserved.
+ *
+ * http://developer.silabs.com/legal/version/v11/Silicon_Labs_Software_License_Agreement.txt
+ *****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "boot_records.h"
+
+// ----------------------------------------------------------------------------
+// Convert two hex characters to a byte; returns -1 if they are not hex.
+// ----------------------------------------------------------------------------
+static int hexByte(const char *text)
+{
+  int value = 0;
+  int i;
+
+  for (i = 0; i < 2; i++)
+  {
+    char c = text[i];
+    value <<= 4;
+    if (c >= '0' && c <= '9')
+    {
+      value |= c - '0';
+    }
+    else if (c >= 'A' && c <= 'F')
+    {
+      value |= c - 'A' + 10;
+    }
+    else if (c >= 'a' && c <= 'f')
+    {
+      value |= c - 'a' + 10;
+    }
+    else
+    {
+      return -1;
+    }
+  }
+  return value;
+}
+
+// ----------------------------------------------------------------------------
+// Read an Intel HEX file.
+// ----------------------------------------------------------------------------
+bool boot_readHex(const char *path, BootImage_t *image)
+{
+  char line[600];
+  uint8_t rec[256 + 5];
+  uint32_t base = 0;
+  unsigned lineNo = 0;
+  FILE *f = fopen(path, "r");
+
+  if (!f)
+  {
+    perror(path);
+    return false;
+  }
+
+  memset(image->data, 0xFF, sizeof(image->data));
+  memset(image->defined, 0, sizeof(image->defined));
+
+  while (fgets(line, sizeof(line), f))
+  {
+    size_t len = strcspn(line, "\r\n");
+    size_t count, i;
+    uint8_t sum = 0;
+    uint32_t addr;
+
+    lineNo++;
+    if (line[0] != ':')
+    {
+      continue;
+    }
+
+    // Decode the whole line and check its length and checksum
+    count = (len - 1) / 2;
+    if ((len < 11) || !(len & 1) || (count > sizeof(rec)))
+    {
+      fprintf(stderr, "%s:%u: malformed record\n", path, lineNo);
+      fclose(f);
+      return false;
+    }
+    for (i = 0; i < count; i++)
+    {
+      int value = hexByte(&line[1 + 2 * i]);
+      if (value < 0)
+      {
+        fprintf(stderr, "%s:%u: bad hex digit\n", path, lineNo);
+        fclose(f);
+        return false;
+      }
+      rec[i] = (uint8_t)value;
+      sum += rec[i];
+    }
+    if (sum || (rec[0] + 5u != count))
+    {
+      fprintf(stderr, "%s:%u: bad checksum or length\n", path, lineNo);
+      fclose(f);
+      return false;
+    }
+
+    addr = (rec[1] << 8) | rec[2];
+    switch (rec[3])
+    {
+      case 0x00:
+        for (i = 0; i < rec[0]; i++)
+        {
+          if (base + addr + i >= BOOT_IMAGE_SIZE)
+          {
+            fprintf(stderr, "%s:%u: data above 64 kB\n", path, lineNo);
+            fclose(f);
+            return false;
+          }
+          image->data[base + addr + i] = rec[4 + i];
+          image->defined[base + addr + i] = true;
+        }
+        break;
+
+      case 0x01:
+        fclose(f);
+        return true;
+
+      case 0x02:
+        base = ((rec[4] << 8) | rec[5]) << 4;
+        break;
+
+      case 0x04:
+        base = (uint32_t)((rec[4] << 8) | rec[5]) << 16;
+        break;
+
+      default:
+        // Start address records do not affect the image
+        break;
+    }
+  }
+
+  fclose(f);
+  return true;
+}
+
+// ----------------------------------------------------------------------------
+// Compute the Xmodem CRC16 used by the bootloader verify command.
+// ----------------------------------------------------------------------------
+uint16_t boot_crc16(uint16_t crc, const uint8_t *data, size_t size)
+{
+  int i;
+
+  while (size--)
+  {
+    crc ^= (uint16_t)(*data++ << 8);
+    for (i = 0; i < 8; i++)
+    {
+      crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+    }
+  }
+  return crc;
+}
+
+// ----------------------------------------------------------------------------
+// Append one boot record to a stream.
+// ----------------------------------------------------------------------------
+bool boot_addRecord(BootStream_t *stream, uint8_t cmd,
+                    const uint8_t *payload, uint8_t size)
+{
+  size_t need = stream->size + size + 3;
+
+  if (need > stream->capacity)
+  {
+    size_t capacity = stream->capacity ? stream->capacity * 2 : 4096;
+    uint8_t *data;
+
+    while (capacity < need)
+    {
+      capacity *= 2;
+    }
+    data = realloc(stream->data, capacity);
+    if (!data)
+    {
+      return false;
+    }
+    stream->data = data;
+    stream->capacity = capacity;
+  }
+
+  stream->data[stream->size++] = BOOT_FRAME_START;
+  stream->data[stream->size++] = (uint8_t)(size + 1);
+  stream->data[stream->size++] = cmd;
+  memcpy(&stream->data[stream->size], payload, size);
+  stream->size += size;
+  stream->records++;
+  return true;
+}
+
+// ----------------------------------------------------------------------------
+// Free the memory held by a stream.
+// ----------------------------------------------------------------------------
+void boot_freeStream(BootStream_t *stream)
+{
+  free(stream->data);
+  memset(stream, 0, sizeof(*stream));
+}
+
+// ----------------------------------------------------------------------------
+// Returns true if addr must be programmed after its page is erased.
+// ----------------------------------------------------------------------------
+static bool isNeeded(const BootImage_t *image, uint32_t addr)
+{
+  return image->defined[addr] && (image->data[addr] != 0xFF);
+}
+
+// ----------------------------------------------------------------------------
+// Returns true if the page holds any image bytes.
+// ----------------------------------------------------------------------------
+static bool isPageUsed(const BootImage_t *image, uint32_t base, uint16_t size)
+{
+  uint32_t addr;
+
+  for (addr = base; addr < base + size; addr++)
+  {
+    if (image->defined[addr])
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+// ----------------------------------------------------------------------------
+// Emit one erase or write record for image data at addr.
+// ----------------------------------------------------------------------------
+static bool addData(BootStream_t *stream, uint8_t cmd,
+                    const BootImage_t *image, uint32_t addr, uint8_t size)
+{
+  uint8_t payload[2 + 255];
+
+  payload[0] = (uint8_t)(addr >> 8);
+  payload[1] = (uint8_t)addr;
+  memcpy(&payload[2], &image->data[addr], size);
+  stream->dataBytes += size;
+  stream->writeCrc += boot_crc16(0, &image->data[addr], size);
+  if (cmd == BOOT_CMD_ERASE)
+  {
+    stream->erases++;
+  }
+  return boot_addRecord(stream, cmd, payload, (uint8_t)(size + 2));
+}
+
+// ----------------------------------------------------------------------------
+// Split the page into runs of data. A gap of erased bytes is sent as part of
+// the run when that is cheaper than starting a new record. Returns the
+// number of runs; starts and sizes are stored in the arrays.
+// ----------------------------------------------------------------------------
+static unsigned pageRuns(const BootImage_t *image, uint32_t base,
+                         const BootOptions_t *options,
+                         uint32_t *starts, uint8_t *sizes)
+{
+  uint32_t end = base + options->pageSize;
+  uint32_t addr = base;
+  uint32_t start, last;
+  unsigned runs = 0;
+
+  while (addr < end)
+  {
+    if (!isNeeded(image, addr))
+    {
+      addr++;
+      continue;
+    }
+
+    // Extend the run up to the record size limit. Stop at a gap longer
+    // than the record overhead.
+    start = addr;
+    last = addr;
+    for (addr++; (addr < end) && (addr - start < options->maxData); addr++)
+    {
+      if (isNeeded(image, addr))
+      {
+        last = addr;
+      }
+      else if (addr - last > BOOT_RECORD_OVERHEAD)
+      {
+        break;
+      }
+    }
+
+    starts[runs] = start;
+    sizes[runs] = (uint8_t)(last - start + 1);
+    runs++;
+    addr = last + 1;
+  }
+  return runs;
+}
+
+// ----------------------------------------------------------------------------
+// Compile an image into an ordered boot record stream.
+// ----------------------------------------------------------------------------
+bool boot_compile(const BootImage_t *image, const BootOptions_t *options,
+                  BootStream_t *stream)
+{
+  uint16_t pageSize = options->pageSize;
+  unsigned pages = BOOT_IMAGE_SIZE / pageSize;
+  uint32_t *starts = malloc(pageSize * sizeof(*starts));
+  uint8_t *sizes = malloc(pageSize);
+  uint8_t payload[6];
+  unsigned page, runs, i;
+  bool ok = (starts != NULL) && (sizes != NULL);
+
+  if (ok && (options->derivativeId >= 0))
+  {
+    payload[0] = (uint8_t)(options->derivativeId >> 8);
+    payload[1] = (uint8_t)options->derivativeId;
+    ok = boot_addRecord(stream, BOOT_CMD_IDENT, payload, 2);
+  }
+
+  // Default flash keys, bank 0
+  payload[0] = 0xA5;
+  payload[1] = 0xF1;
+  payload[2] = 0x00;
+  ok = ok && boot_addRecord(stream, BOOT_CMD_SETUP, payload, 3);
+
+  // Erase the reset vector page first, so the bootloader runs at the next
+  // reset until the update has completed
+  if (ok && isPageUsed(image, 0, pageSize))
+  {
+    ok = addData(stream, BOOT_CMD_ERASE, image, 0, 0);
+  }
+
+  // Erase and fill the other pages in address order. The first run of a
+  // page rides in the erase record.
+  for (page = 1; ok && (page < pages); page++)
+  {
+    uint32_t base = page * pageSize;
+
+    if (!isPageUsed(image, base, pageSize))
+    {
+      continue;
+    }
+    runs = pageRuns(image, base, options, starts, sizes);
+    if (!runs)
+    {
+      // Only erased values: the page still has to be erased
+      ok = addData(stream, BOOT_CMD_ERASE, image, base, 0);
+      continue;
+    }
+    for (i = 0; ok && (i < runs); i++)
+    {
+      ok = addData(stream, i ? BOOT_CMD_WRITE : BOOT_CMD_ERASE,
+                   image, starts[i], sizes[i]);
+    }
+  }
+
+  // Fill the reset vector page last, ending with the reset vector itself
+  if (ok && isPageUsed(image, 0, pageSize))
+  {
+    runs = pageRuns(image, 0, options, starts, sizes);
+    while (ok && runs--)
+    {
+      ok = addData(stream, BOOT_CMD_WRITE, image, starts[runs], sizes[runs]);
+    }
+  }
+
+  // Verify each range of consecutive written pages with one CRC
+  for (page = 0; ok && options->verify && (page < pages); page++)
+  {
+    uint32_t first, limit;
+    uint16_t crc;
+
+    if (!isPageUsed(image, page * pageSize, pageSize))
+    {
+      continue;
+    }
+    first = page * pageSize;
+    while ((page + 1 < pages) && isPageUsed(image, (page + 1) * pageSize, pageSize))
+    {
+      page++;
+    }
+    limit = (page + 1) * pageSize - 1;
+    crc = boot_crc16(0, &image->data[first], limit - first + 1);
+
+    payload[0] = (uint8_t)(first >> 8);
+    payload[1] = (uint8_t)first;
+    payload[2] = (uint8_t)(limit >> 8);
+    payload[3] = (uint8_t)limit;
+    payload[4] = (uint8_t)(crc >> 8);
+    payload[5] = (uint8_t)crc;
+    ok = boot_addRecord(stream, BOOT_CMD_VERIFY, payload, 6);
+    stream->verifies++;
+  }
+
+  // Check the write CRC the bootloader summed while programming
+  if (ok && options->writeCrc)
+  {
+    payload[0] = (uint8_t)(stream->writeCrc >> 8);
+    payload[1] = (uint8_t)stream->writeCrc;
+    ok = boot_addRecord(stream, BOOT_CMD_WCRC, payload, 2);
+  }
+
+  if (ok && options->runApp)
+  {
+    ok = boot_addRecord(stream, BOOT_CMD_RUNAPP, NULL, 0);
+  }
+
+  free(starts);
+  free(sizes);
+  return ok;
+}
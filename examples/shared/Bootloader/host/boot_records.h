@@ -0,0 +1,128 @@
+/******************************************************************************
+ * Copyright (c) 2021 by Silicon Laboratories Inc. All rights reserved.
+ *
+ * http://developer.silabs.com/legal/version/v11/Silicon_Labs_Software_License_Agreement.txt
+ *****************************************************************************/
+
+#ifndef __BOOT_RECORDS_H__
+#define __BOOT_RECORDS_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/// Size of the 8051 code address space
+#define BOOT_IMAGE_SIZE 0x10000
+
+/// Boot record framing and command bytes (see the bootloader boot.h)
+#define BOOT_FRAME_START  '$'
+#define BOOT_CMD_IDENT    '0'
+#define BOOT_CMD_SETUP    '1'
+#define BOOT_CMD_ERASE    '2'
+#define BOOT_CMD_WRITE    '3'
+#define BOOT_CMD_VERIFY   '4'
+#define BOOT_CMD_LOCK     '5'
+#define BOOT_CMD_RUNAPP   '6'
+#define BOOT_CMD_WCRC     '9'
+
+/// Bootloader response byte definitions
+#define BOOT_ACK_REPLY    '@'
+
+/// Bytes a record adds on top of its write data: '$', length, command and
+/// the two address bytes
+#define BOOT_RECORD_OVERHEAD 5
+
+/// Largest write payload: the frame length byte covers the command, the
+/// address and the data
+#define BOOT_MAX_DATA 252
+
+/// Write payload that fits the 132 byte IDATA receive buffer of parts
+/// without XRAM
+#define BOOT_SMALL_DATA 128
+
+/// Firmware image read from an Intel HEX file
+typedef struct
+{
+  uint8_t data[BOOT_IMAGE_SIZE];    ///< Image bytes, 0xFF where not defined
+  bool defined[BOOT_IMAGE_SIZE];    ///< True where the HEX file sets a byte
+} BootImage_t;
+
+/// Record compiler options
+typedef struct
+{
+  uint16_t pageSize;        ///< Flash erase page size (power of two)
+  uint8_t maxData;          ///< Largest write payload per record
+  int32_t derivativeId;     ///< Ident record value, or -1 for none
+  bool verify;              ///< Add verify records for every written range
+  bool writeCrc;            ///< Add a write CRC record (BOOT_USE_WCRC)
+  bool runApp;              ///< Add a run application record
+} BootOptions_t;
+
+/// Growable buffer of encoded boot records
+typedef struct
+{
+  uint8_t *data;            ///< Encoded records, back to back
+  size_t size;              ///< Bytes used in data
+  size_t capacity;          ///< Bytes allocated for data
+  unsigned records;         ///< Number of records in data
+  unsigned erases;          ///< Number of erase records
+  unsigned verifies;        ///< Number of verify records
+  unsigned long dataBytes;  ///< Write data bytes in all records
+  uint16_t writeCrc;        ///< Sum of the CRC16 of each written range
+} BootStream_t;
+
+/**************************************************************************//**
+ * Read an Intel HEX file.
+ *
+ * @param path HEX file to read.
+ * @param image Filled with the image. Bytes beyond 64 kB are an error.
+ * @return **False** if the file cannot be read or is malformed.
+ *****************************************************************************/
+bool boot_readHex(const char *path, BootImage_t *image);
+
+/**************************************************************************//**
+ * Compute the Xmodem CRC16 used by the bootloader verify command.
+ *
+ * @param crc Starting value (0 for a new CRC).
+ * @param data Bytes to add.
+ * @param size Number of bytes to add.
+ * @return The updated CRC.
+ *****************************************************************************/
+uint16_t boot_crc16(uint16_t crc, const uint8_t *data, size_t size);
+
+/**************************************************************************//**
+ * Append one boot record to a stream.
+ *
+ * @param stream Stream to append to.
+ * @param cmd Command byte.
+ * @param payload Bytes that follow the command byte.
+ * @param size Number of payload bytes (at most 254).
+ * @return **False** if memory could not be allocated.
+ *****************************************************************************/
+bool boot_addRecord(BootStream_t *stream, uint8_t cmd,
+                    const uint8_t *payload, uint8_t size);
+
+/**************************************************************************//**
+ * Compile an image into an ordered boot record stream.
+ *
+ * Each page that holds image data is erased exactly once, by an erase
+ * record that also carries the first data of the page. Runs of data are
+ * merged into the largest records the receive buffer allows; erased (0xFF)
+ * bytes are not sent unless that saves a record. The page holding the
+ * reset vector is erased first and written last, so an interrupted update
+ * always restarts in the bootloader.
+ *
+ * @param image Image to compile.
+ * @param options Compiler options.
+ * @param stream Receives the records. Must be zero initialized.
+ * @return **False** if memory could not be allocated.
+ *****************************************************************************/
+bool boot_compile(const BootImage_t *image, const BootOptions_t *options,
+                  BootStream_t *stream);
+
+/**************************************************************************//**
+ * Free the memory held by a stream.
+ *****************************************************************************/
+void boot_freeStream(BootStream_t *stream);
+
+#endif // __BOOT_RECORDS_H__
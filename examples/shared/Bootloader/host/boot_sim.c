@@ -0,0 +1,499 @@
+/******************************************************************************
+ * Copyright (c) 2021 by Silicon Laboratories Inc. All rights reserved.
+ *
+ * http://developer.silabs.com/legal/version/v11/Silicon_Labs_Software_License_Agreement.txt
+ *****************************************************************************/
+
+// Loopback simulator for the EFM8 UART bootloader command interpreter.
+//
+// usage: boot_sim [options] records.efm8
+//
+//   -x FILE  check the final flash contents against an Intel HEX image
+//   -b       start from blank flash (default: flash holds an old image)
+//   -B BAUD  baud rate for the time estimate (default 115200)
+//   -w US    flash byte write time in microseconds (default 20)
+//   -e MS    flash page erase time in milliseconds (default 5.5)
+//
+// The bootloader main.c is linked against a fake flash and a fake UART that
+// plays back the record file. Each record is executed by the real command
+// interpreter, and flash misuse (writes to bytes that were not erased, wrong
+// flash keys, reads past the end of a record) is reported. See readme.txt
+// for the build command.
+
+// getopt() is POSIX
+#define _POSIX_C_SOURCE 200809L
+
+#include <setjmp.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "efm8_device.h"
+#include "boot.h"
+#include "flash.h"
+#include "boot_records.h"
+
+// The bootloader main() is built as boot_main()
+#undef main
+extern void boot_main(void);
+
+// Reasons for leaving the command interpreter
+#define SIM_END_OF_RECORDS 1
+#define SIM_RUN_APP        2
+#define SIM_FLASH_ERROR    3
+
+// Returns to the simulator from inside the command interpreter
+static jmp_buf simExit;
+
+// Simulated flash and the bootloader signature and lock bytes
+static uint8_t flash[BOOT_IMAGE_SIZE];
+uint8_t SI_SEG_CODE boot_otp[2];
+
+// Record file being played back
+static const uint8_t *input;
+static size_t inputSize;
+static size_t inputPos;
+
+// Current record
+static uint8_t record[256];
+static uint8_t recordSize;
+static size_t recordOffset;
+static unsigned recordCount;
+static uint8_t lastReply;
+
+// Running CRC
+static uint16_t crc;
+
+// Counters for the report
+static unsigned long replies;
+static unsigned long errors;
+static unsigned long byteWrites;
+static unsigned long pageErases;
+static unsigned long skippedErases;
+static double wireSeconds;
+static double baud = 115200;
+
+// Baud rate factor requested by the last setup record
+static double baudFactor = 1;
+
+// Counts the number of bytes remaining in the current record
+uint8_t boot_rxNext;
+
+// Holds the flash keys received in the setup command
+uint8_t flash_key1;
+uint8_t flash_key2;
+
+// ----------------------------------------------------------------------------
+// Report a protocol or flash usage error in the current record.
+// ----------------------------------------------------------------------------
+static void simError(const char *text, uint16_t addr)
+{
+  fprintf(stderr, "record %u (offset %lu, cmd '%c'): %s at 0x%04X\n",
+          recordCount, (unsigned long)recordOffset, record[0], text, addr);
+  errors++;
+}
+
+// ----------------------------------------------------------------------------
+// Check the final reply of the record that just completed.
+// ----------------------------------------------------------------------------
+static void endRecord(void)
+{
+  if (recordCount && (lastReply != BOOT_ACK_REPLY))
+  {
+    fprintf(stderr, "record %u (offset %lu, cmd '%c'): reply '%c'\n",
+            recordCount, (unsigned long)recordOffset, record[0], lastReply);
+    errors++;
+  }
+}
+
+// ----------------------------------------------------------------------------
+// Bootloader transport: play back the record file.
+// ----------------------------------------------------------------------------
+void boot_initDevice(void)
+{
+}
+
+void boot_nextRecord(void)
+{
+  endRecord();
+
+  // Frames start with '$'; anything else is skipped as on the device
+  while ((inputPos < inputSize) && (input[inputPos] != BOOT_FRAME_START))
+  {
+    inputPos++;
+  }
+  if (inputPos + 2 > inputSize)
+  {
+    longjmp(simExit, SIM_END_OF_RECORDS);
+  }
+
+  recordOffset = inputPos;
+  recordSize = input[inputPos + 1];
+  if (inputPos + 2 + recordSize > inputSize)
+  {
+    fprintf(stderr, "record at offset %lu is truncated\n", (unsigned long)inputPos);
+    errors++;
+    longjmp(simExit, SIM_END_OF_RECORDS);
+  }
+  memcpy(record, &input[inputPos + 2], recordSize);
+  inputPos += 2 + recordSize;
+  wireSeconds += (2 + recordSize) * 10.0 / baud;
+
+  recordCount++;
+  lastReply = BOOT_ACK_REPLY;
+  boot_rxNext = recordSize;
+}
+
+uint8_t boot_getByte(void)
+{
+  // The device would return stale buffer contents
+  if (!boot_rxNext)
+  {
+    simError("read past the end of the record", 0);
+    return 0xFF;
+  }
+  return record[recordSize - boot_rxNext--];
+}
+
+uint16_t boot_getWord(void)
+{
+  uint16_t word = (uint16_t)(boot_getByte() << 8);
+  return word | boot_getByte();
+}
+
+uint8_t boot_hasRemaining(void)
+{
+  return boot_rxNext;
+}
+
+void boot_sendReply(uint8_t reply)
+{
+  lastReply = reply;
+  replies++;
+  wireSeconds += 10.0 / baud;
+
+  // A requested baud rate takes effect after the reply
+  baud *= baudFactor;
+  baudFactor = 1;
+}
+
+void boot_sendWord(uint16_t value)
+{
+  (void)value;
+  wireSeconds += 2 * 10.0 / baud;
+}
+
+void boot_runApp(void)
+{
+  endRecord();
+  longjmp(simExit, SIM_RUN_APP);
+}
+
+#if (BOOT_USE_BAUD == 1)
+bool boot_setBaud(uint8_t factor)
+{
+  if (!factor)
+  {
+    return false;
+  }
+  baudFactor = factor;
+  return true;
+}
+#endif
+
+// ----------------------------------------------------------------------------
+// Fake flash.
+// ----------------------------------------------------------------------------
+void flash_initCRC(void)
+{
+  crc = 0;
+}
+
+void flash_updateCRC(uint8_t byte)
+{
+  crc = boot_crc16(crc, &byte, 1);
+}
+
+uint16_t flash_readCRC(void)
+{
+  return crc;
+}
+
+void flash_updateCRCRange(uint16_t addr, uint16_t limit)
+{
+  if (addr <= limit)
+  {
+    crc = boot_crc16(crc, &flash[addr], (size_t)limit - addr + 1);
+  }
+}
+
+void flash_setBank(uint8_t bank)
+{
+  (void)bank;
+}
+
+bool flash_isValidRange(uint16_t addr, uint8_t size)
+{
+  return (addr < BL_FLASH0_LIMIT) && (addr + size <= BL_FLASH0_LIMIT);
+}
+
+uint8_t flash_readByte(uint16_t addr)
+{
+  return flash[addr];
+}
+
+// ----------------------------------------------------------------------------
+// Check the flash keys before a write or erase. The device resets on a bad
+// key, so the simulation stops.
+// ----------------------------------------------------------------------------
+static void checkKeys(uint16_t addr)
+{
+  if ((flash_key1 != 0xA5) || (flash_key2 != 0xF1))
+  {
+    simError("flash access with bad keys", addr);
+    longjmp(simExit, SIM_FLASH_ERROR);
+  }
+}
+
+// ----------------------------------------------------------------------------
+// Program one byte. Programming can only clear bits.
+// ----------------------------------------------------------------------------
+static void programByte(uint16_t addr, uint8_t byte)
+{
+  checkKeys(addr);
+  if (addr >= BL_FLASH0_LIMIT)
+  {
+    simError("write to the bootloader", addr);
+    return;
+  }
+  if ((flash[addr] & byte) != byte)
+  {
+    simError("write to a byte that is not erased", addr);
+  }
+  flash[addr] &= byte;
+  byteWrites++;
+}
+
+void flash_erasePage(uint16_t addr)
+{
+  uint16_t base = addr & ~(BL_ERASE_PSIZE - 1);
+  uint16_t i;
+
+  // The bootloader skips pages that are already blank
+  for (i = 0; (i < BL_ERASE_PSIZE) && (flash[base + i] == 0xFF); i++)
+    ;
+  if (i == BL_ERASE_PSIZE)
+  {
+    skippedErases++;
+    return;
+  }
+
+  checkKeys(addr);
+  memset(&flash[base], 0xFF, BL_ERASE_PSIZE);
+  pageErases++;
+}
+
+void flash_writeByte(uint16_t addr, uint8_t byte)
+{
+  // The lock command writes the signature and lock bytes by address
+  if (addr == BOOT_OTP_ADDRESS(0))
+  {
+    checkKeys(addr);
+    boot_otp[0] = byte;
+    return;
+  }
+  if (addr == BOOT_OTP_ADDRESS(1))
+  {
+    checkKeys(addr);
+    boot_otp[1] = byte;
+    return;
+  }
+  if (byte != 0xFF)
+  {
+    programByte(addr, byte);
+  }
+}
+
+void flash_writeBlock(uint16_t addr, uint8_t len)
+{
+  uint8_t byte;
+
+  for (; len; len--)
+  {
+    byte = boot_getByte();
+    if (byte != 0xFF)
+    {
+      programByte(addr, byte);
+    }
+    addr++;
+  }
+}
+
+// ----------------------------------------------------------------------------
+// Read a whole file into memory.
+// ----------------------------------------------------------------------------
+static uint8_t *readFile(const char *path, size_t *size)
+{
+  FILE *f = fopen(path, "rb");
+  uint8_t *data = NULL;
+  long length;
+
+  if (f && !fseek(f, 0, SEEK_END) && ((length = ftell(f)) >= 0) && !fseek(f, 0, SEEK_SET))
+  {
+    data = malloc(length ? (size_t)length : 1);
+    if (data && (fread(data, 1, (size_t)length, f) == (size_t)length))
+    {
+      *size = (size_t)length;
+    }
+    else
+    {
+      free(data);
+      data = NULL;
+    }
+  }
+  if (f)
+  {
+    fclose(f);
+  }
+  if (!data)
+  {
+    perror(path);
+  }
+  return data;
+}
+
+// ----------------------------------------------------------------------------
+// Compare the flash contents with the image. Pages that hold image data must
+// match it, with 0xFF where the image does not define a byte.
+// ----------------------------------------------------------------------------
+static unsigned long checkImage(const BootImage_t *image)
+{
+  unsigned long mismatches = 0;
+  uint32_t page, addr;
+
+  for (page = 0; page < BOOT_IMAGE_SIZE; page += BL_ERASE_PSIZE)
+  {
+    bool used = false;
+
+    for (addr = page; addr < page + BL_ERASE_PSIZE; addr++)
+    {
+      used |= image->defined[addr];
+    }
+    for (addr = page; used && (addr < page + BL_ERASE_PSIZE); addr++)
+    {
+      if (flash[addr] != image->data[addr])
+      {
+        if (!mismatches)
+        {
+          fprintf(stderr, "flash mismatch at 0x%04X: 0x%02X, expected 0x%02X\n",
+                  (unsigned)addr, flash[addr], image->data[addr]);
+        }
+        mismatches++;
+      }
+    }
+  }
+  return mismatches;
+}
+
+int main(int argc, char *argv[])
+{
+  // Locals that live across setjmp() are static, so longjmp() cannot leave
+  // them with stale register copies
+  static BootImage_t image;
+  static const char *hexPath = NULL;
+  static double writeUs = 20.0;
+  static double eraseMs = 5.5;
+  static unsigned long mismatches = 0;
+  bool blank = false;
+  double flashSeconds;
+  uint32_t seed = 1;
+  uint32_t addr;
+  clock_t start, cpu;
+  int opt, result;
+
+  while ((opt = getopt(argc, argv, "x:bB:w:e:")) != -1)
+  {
+    switch (opt)
+    {
+      case 'x':
+        hexPath = optarg;
+        break;
+      case 'b':
+        blank = true;
+        break;
+      case 'B':
+        baud = atof(optarg);
+        break;
+      case 'w':
+        writeUs = atof(optarg);
+        break;
+      case 'e':
+        eraseMs = atof(optarg);
+        break;
+      default:
+        fprintf(stderr, "usage: boot_sim [-x image.hex] [-b] [-B BAUD] [-w US] [-e MS] records.efm8\n");
+        return 1;
+    }
+  }
+  if (argc - optind != 1)
+  {
+    fprintf(stderr, "usage: boot_sim [-x image.hex] [-b] [-B BAUD] [-w US] [-e MS] records.efm8\n");
+    return 1;
+  }
+  if (hexPath && !boot_readHex(hexPath, &image))
+  {
+    return 1;
+  }
+  input = readFile(argv[optind], &inputSize);
+  if (!input)
+  {
+    return 1;
+  }
+
+  // Unless blank flash was asked for, fill the application area with an old
+  // image so missing erases show up
+  memset(flash, 0xFF, sizeof(flash));
+  for (addr = 0; !blank && (addr < BL_FLASH0_LIMIT); addr++)
+  {
+    seed = seed * 1103515245u + 12345u;
+    flash[addr] = (uint8_t)(seed >> 16);
+  }
+
+  start = clock();
+  result = setjmp(simExit);
+  if (!result)
+  {
+    boot_main();
+  }
+  cpu = clock() - start;
+
+  if (hexPath)
+  {
+    mismatches = checkImage(&image);
+  }
+
+  flashSeconds = byteWrites * writeUs * 1e-6 + pageErases * eraseMs * 1e-3;
+  printf("Records:          %u\n", recordCount);
+  printf("Replies:          %lu\n", replies);
+  printf("Page erases:      %lu (%lu blank pages skipped)\n", pageErases, skippedErases);
+  printf("Byte writes:      %lu\n", byteWrites);
+  printf("Wire time:        %.3f s\n", wireSeconds);
+  printf("Flash time:       %.3f s\n", flashSeconds);
+  printf("Total time:       %.3f s\n", wireSeconds + flashSeconds);
+  printf("Interpreter:      %.0f records/s host CPU\n",
+         cpu ? recordCount / ((double)cpu / CLOCKS_PER_SEC) : 0.0);
+  if (result == SIM_RUN_APP)
+  {
+    printf("Ended with run application\n");
+  }
+  if (hexPath)
+  {
+    printf("Flash mismatches: %lu\n", mismatches);
+  }
+  printf("Errors:           %lu\n", errors);
+
+  free((void *)input);
+  return (errors || mismatches || (result == SIM_FLASH_ERROR)) ? 1 : 0;
+}
@@ -0,0 +1,62 @@
+/******************************************************************************
+ * Copyright (c) 2021 by Silicon Laboratories Inc. All rights reserved.
+ *
+ * http://developer.silabs.com/legal/version/v11/Silicon_Labs_Software_License_Agreement.txt
+ *****************************************************************************/
+
+#ifndef __EFM8_DEVICE_H__
+#define __EFM8_DEVICE_H__
+
+// Host stand-in for the bootloader device header, used to build a UART
+// bootloader main.c into boot_sim. The bootloader boot.h is included with
+// IS_DOXYGEN defined, which declares its transport macros as functions;
+// boot_sim.c provides those functions and the fake flash behind flash.h.
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifndef IS_DOXYGEN
+#error Build the simulator with IS_DOXYGEN defined
+#endif
+
+// Memory segments have no meaning on the host
+#define SI_SEG_CODE
+#define SI_SEG_DATA
+#define SI_SEG_IDATA
+#define SI_SEG_XDATA
+
+// Bootloader firmware revision number
+#define BL_REVISION 0x90
+
+// Device specific ID is checked by the prefix command (EFM8LB12F64E_QFN32 by
+// default; override on the compiler command line)
+#ifndef BL_DERIVATIVE_ID
+#define BL_DERIVATIVE_ID 0x3441
+#endif
+
+// Upper limit of the flash the bootloader may write
+#ifndef BL_FLASH0_LIMIT
+#define BL_FLASH0_LIMIT 0xFA00
+#endif
+
+// Address of the flash lock byte. The bootloader signature byte is just
+// below it.
+#ifndef BL_LOCK_ADDRESS
+#define BL_LOCK_ADDRESS 0xFBFF
+#endif
+
+// The host has no 16-bit address for boot_otp, so the lock command writes
+// the signature and lock bytes at these fixed addresses
+#define BOOT_OTP_ADDRESS(i) (BL_LOCK_ADDRESS - 1 + (i))
+
+// Flash page size below BL_FLASH0_LIMIT
+#ifndef BL_FLASH0_PSIZE
+#define BL_FLASH0_PSIZE 512
+#endif
+
+// Largest flash page size
+#ifndef BL_ERASE_PSIZE
+#define BL_ERASE_PSIZE 512
+#endif
+
+#endif // __EFM8_DEVICE_H__
@@ -0,0 +1,35 @@
+/******************************************************************************
+ * Copyright (c) 2021 by Silicon Laboratories Inc. All rights reserved.
+ *
+ * http://developer.silabs.com/legal/version/v11/Silicon_Labs_Software_License_Agreement.txt
+ *****************************************************************************/
+
+#ifndef __FLASH_H__
+#define __FLASH_H__
+
+// Host stand-in for the bootloader flash.h. The device versions use SFR
+// macros; here every operation is a function of the fake flash in
+// boot_sim.c.
+
+extern uint8_t flash_key1;
+extern uint8_t flash_key2;
+
+extern void flash_initCRC(void);
+extern void flash_updateCRC(uint8_t byte);
+extern uint16_t flash_readCRC(void);
+extern void flash_updateCRCRange(uint16_t addr, uint16_t limit);
+
+// Must stay a macro as on the device: main.c passes two boot_getByte()
+// calls, and only the statement order of the macro makes key1 the first
+// byte of the record.
+#define flash_setKeys(key1, key2) \
+  do { flash_key1=(key1); flash_key2=(key2); } while(0)
+
+extern void flash_setBank(uint8_t bank);
+extern bool flash_isValidRange(uint16_t addr, uint8_t size);
+extern void flash_erasePage(uint16_t addr);
+extern uint8_t flash_readByte(uint16_t addr);
+extern void flash_writeByte(uint16_t addr, uint8_t byte);
+extern void flash_writeBlock(uint16_t addr, uint8_t len);
+
+#endif // __FLASH_H__
@@ -0,0 +1,156 @@
+#!/usr/bin/env python3
+# Copyright (c) 2021 by Silicon Laboratories Inc. All rights reserved.
+#
+# http://developer.silabs.com/legal/version/v11/Silicon_Labs_Software_License_Agreement.txt
+#
+# Sends an EFM8 boot record file (.efm8) to a USB HID bootloader built with
+# BOOT_USE_STREAM set to 1, through a Linux hidraw device.
+#
+#   boot_hid.py --device /dev/hidraw0 app.efm8
+#
+# Records are sent back to back in 64 byte OUTPUT reports, the last one
+# padded with zeros. The bootloader holds a report back (NAK) until its
+# receive buffer has room, so the host never waits for a reply before
+# sending the next report.
+#
+# Each INPUT report holds two (reply, count) pairs: reply0 repeated count0
+# times, then reply1 repeated count1 times. The pairs are expanded into the
+# reply bytes of the records in order. Page CRC and write CRC values come
+# ahead of their record's reply byte, MSB first; they are printed, or saved
+# with --crcs for boot_pack.py --device-crcs. The first reply other than
+# BOOT_ACK_REPLY stops the transfer.
+
+import argparse
+import os
+import select
+import sys
+import time
+
+# Boot record framing and command bytes (see boot.h)
+FRAME_START = ord('$')
+CMD_PAGECRC = ord('8')
+CMD_WCRC = ord('9')
+
+# Bootloader response bytes
+ACK_REPLY = ord('@')
+
+# HID report sizes (USB_HID_OUT_SIZE and USB_HID_IN_SIZE in USB_main.h)
+OUT_REPORT_SIZE = 64
+IN_REPORT_SIZE = 4
+
+# Seconds to wait for a reply once every record has been sent
+REPLY_TIMEOUT = 2.0
+
+class Device:
+    def __init__(self, path):
+        self.fd = os.open(path, os.O_RDWR)
+
+    # The reports have no report ID, so hidraw takes a leading zero
+    def write(self, report):
+        os.write(self.fd, bytes([0]) + report)
+
+    # Returns None if no report arrives in time
+    def read(self, timeout):
+        if not select.select([self.fd], [], [], timeout)[0]:
+            return None
+        return os.read(self.fd, IN_REPORT_SIZE)
+
+def readRecords(path):
+    with open(path, "rb") as f:
+        data = f.read()
+    records = []
+    pos = 0
+    while pos < len(data):
+        if data[pos] != FRAME_START or pos + 2 > len(data):
+            raise ValueError("%s: bad frame at offset %d" % (path, pos))
+        end = pos + 2 + data[pos + 1]
+        records.append(data[pos + 2:end])
+        pos = end
+    return records
+
+# Number of 16-bit values sent before the reply code
+def valueWords(body):
+    if body[0] == CMD_PAGECRC:
+        return body[3]
+    if body[0] == CMD_WCRC and len(body) == 1:
+        return 1
+    return 0
+
+class Sender:
+    def __init__(self, device, records):
+        self.device = device
+        self.records = records
+        self.replies = bytearray()
+        self.answered = 0
+        self.values = bytearray()
+        self.error = None
+
+    # Expand an INPUT report into reply bytes and match them to records
+    def receive(self, report):
+        for i in range(0, IN_REPORT_SIZE, 2):
+            self.replies.extend(bytes([report[i]]) * report[i + 1])
+        while self.error is None and self.answered < len(self.records):
+            body = self.records[self.answered]
+            words = valueWords(body)
+            if len(self.replies) < 2 * words + 1:
+                break
+            self.values.extend(self.replies[:2 * words])
+            reply = self.replies[2 * words]
+            del self.replies[:2 * words + 1]
+            if reply != ACK_REPLY:
+                self.error = "record %d (cmd '%c'): reply %r" % (self.answered, body[0], chr(reply))
+            self.answered += 1
+
+    def poll(self, timeout):
+        report = self.device.read(timeout)
+        if report is None:
+            return False
+        self.receive(report)
+        return True
+
+    def run(self):
+        stream = b''.join(bytes([FRAME_START, len(r)]) + r for r in self.records)
+        stream += bytes(-len(stream) % OUT_REPORT_SIZE)
+
+        # Collect the replies that have arrived before each report, so an
+        # error stops the transfer early
+        for pos in range(0, len(stream), OUT_REPORT_SIZE):
+            while self.poll(0):
+                pass
+            if self.error is not None:
+                return False
+            self.device.write(stream[pos:pos + OUT_REPORT_SIZE])
+
+        while self.error is None and self.answered < len(self.records):
+            if not self.poll(REPLY_TIMEOUT):
+                self.error = "no reply to record %d" % self.answered
+        return self.error is None
+
+def main():
+    parser = argparse.ArgumentParser(description="Stream EFM8 boot records to a USB HID bootloader")
+    parser.add_argument("records", help="Boot record file (.efm8)")
+    parser.add_argument("--device", default="/dev/hidraw0",
+                        help="hidraw device (default /dev/hidraw0)")
+    parser.add_argument("--crcs", metavar="FILE",
+                        help="Save page CRC and write CRC reply values to FILE")
+    args = parser.parse_args()
+
+    records = readRecords(args.records)
+    sender = Sender(Device(args.device), records)
+    start = time.time()
+    ok = sender.run()
+    seconds = time.time() - start
+
+    if args.crcs:
+        with open(args.crcs, "wb") as f:
+            f.write(sender.values)
+    elif sender.values:
+        print("Values: " + sender.values.hex())
+    if not ok:
+        print(sender.error)
+        return 1
+    print("Records: %d in %.2f s" % (len(records), seconds))
+    return 0
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,429 @@
+#!/usr/bin/env python3
+# Copyright (c) 2021 by Silicon Laboratories Inc. All rights reserved.
+#
+# http://developer.silabs.com/legal/version/v11/Silicon_Labs_Software_License_Agreement.txt
+#
+# Converts an Intel HEX image into an EFM8 boot record file (.efm8) that uses
+# the packed write command (BOOT_CMD_ZWRITE). The bootloader must be built
+# with BOOT_USE_ZWRITE set to 1.
+#
+# Packed stream format (one stream per boot record, at most 255 output bytes):
+#
+#   0x00-0x7F  t+1 literal bytes follow
+#   0x80-0xFF  copy (t & 0x7F) + 3 bytes from flash, starting d + 1 bytes
+#              before the current address. d is the next stream byte if it
+#              is below 0x80, otherwise the low 15 bits of the next two
+#              bytes (big-endian).
+#
+# Copies read back flash that is already programmed, so no RAM window is
+# needed. By default they may reach into earlier records of the same run of
+# pages; those records must complete first. With --record-window copies stay
+# within the record, so any record can be resent on its own.
+#
+# Records are ordered as by boot_compile: the reset vector page is erased
+# first and written last, ending with the record at address 0, so an
+# interrupted update leaves the bootloader in charge at the next reset.
+#
+# Differential updates: write a page CRC query with --crc-query, send it to
+# the bootloader and save the reply bytes. Passing that file with
+# --device-crcs skips every page whose CRC already matches the new image.
+# The reset vector page is still rewritten if any other page changes.
+#
+# Baud rate requests: --speedup N adds a fourth byte to the setup record, so
+# a UART bootloader built with BOOT_USE_BAUD set to 1 switches to N times the
+# starting rate after replying to it. --bench prints the estimated transfer
+# and flash programming time at several baud rates for the image.
+#
+# Write CRC: --write-crc appends one record that checks the sum of the
+# CRC16 of every written range, which a bootloader built with BOOT_USE_WCRC
+# set to 1 computes while programming. It replaces the read-back pass of
+# --verify.
+#
+# USB HID: --hid compares sending one record per OUTPUT report exchange with
+# streaming records back to back (BOOT_USE_STREAM set to 1), assuming one
+# 64 byte report per 1 ms frame. boot_hid.py sends the streamed records.
+#
+# usage: boot_pack.py [options] image.hex output.efm8
+
+import argparse
+import sys
+
+# Boot record framing and command bytes (see boot.h)
+FRAME_START = ord('$')
+CMD_IDENT = ord('0')
+CMD_SETUP = ord('1')
+CMD_ERASE = ord('2')
+CMD_WRITE = ord('3')
+CMD_VERIFY = ord('4')
+CMD_RUNAPP = ord('6')
+CMD_ZWRITE = ord('7')
+CMD_PAGECRC = ord('8')
+CMD_WCRC = ord('9')
+
+# Baud rates compared by --bench
+BENCH_RATES = [115200, 230400, 460800, 921600]
+
+# USB HID OUTPUT report size
+HID_REPORT_SIZE = 64
+
+# Packed stream limits
+MAX_LITERALS = 128
+MIN_MATCH = 3
+MAX_MATCH = 130
+MAX_OFFSET = 0x8000
+MAX_CHAIN = 64
+MAX_OUTPUT = 255
+
+# Read an Intel HEX file into a dictionary of address -> byte
+def readHex(path):
+    image = {}
+    base = 0
+    with open(path) as f:
+        for line in f:
+            line = line.strip()
+            if not line.startswith(':'):
+                continue
+            rec = bytes.fromhex(line[1:])
+            if sum(rec) & 0xFF:
+                raise ValueError("Bad checksum in " + line)
+            length, addr, kind = rec[0], (rec[1] << 8) | rec[2], rec[3]
+            data = rec[4:4 + length]
+            if kind == 0x00:
+                for i, value in enumerate(data):
+                    image[base + addr + i] = value
+            elif kind == 0x01:
+                break
+            elif kind == 0x02:
+                base = ((data[0] << 8) | data[1]) << 4
+            elif kind == 0x04:
+                base = ((data[0] << 8) | data[1]) << 16
+    return image
+
+# Xmodem CRC16, as computed by the bootloader verify command
+def crc16(data):
+    crc = 0
+    for value in data:
+        crc ^= value << 8
+        for i in range(8):
+            crc = ((crc << 1) ^ 0x1021) if (crc & 0x8000) else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+# Build one boot record
+def record(cmd, payload=b''):
+    body = bytes([cmd]) + bytes(payload)
+    return bytes([FRAME_START, len(body)]) + body
+
+# Index of earlier positions by their first three bytes
+class MatchFinder:
+    def __init__(self, data):
+        self.data = data
+        self.chains = {}
+        self.next = 0
+
+    # Add all positions before pos to the index
+    def advance(self, pos):
+        while self.next < pos:
+            key = self.data[self.next:self.next + MIN_MATCH]
+            self.chains.setdefault(key, []).append(self.next)
+            self.next += 1
+
+    # Find the longest match for data[pos:end] starting at or after first
+    def find(self, first, pos, end):
+        data = self.data
+        self.advance(pos)
+        best, bestOffset = 0, 0
+        limit = min(MAX_MATCH, end - pos)
+        first = max(first, pos - MAX_OFFSET)
+        for src in reversed(self.chains.get(data[pos:pos + MIN_MATCH], [])[-MAX_CHAIN:]):
+            if src < first:
+                break
+            n = 0
+            # Overlapping copies are allowed (the source runs ahead into output)
+            while n < limit and data[src + n] == data[pos + n]:
+                n += 1
+            if n > best:
+                best, bestOffset = n, pos - src
+                if n == limit:
+                    break
+        return best, bestOffset
+
+# Pack data[pos:end] into one stream of at most maxPayload bytes. Copies may
+# reach back to data[first]. Returns the stream and the number of bytes it
+# produces.
+def packRecord(finder, first, pos, end, maxPayload):
+    data = finder.data
+    out = bytearray()
+    literals = bytearray()
+    start = pos
+    end = min(end, pos + MAX_OUTPUT)
+
+    def flush():
+        if literals:
+            out.append(len(literals) - 1)
+            out.extend(literals)
+            literals.clear()
+
+    while pos < end:
+        size = len(out) + (len(literals) + 1 if literals else 0)
+        length, offset = finder.find(first, pos, end)
+        cost = 2 if offset <= 0x80 else 3
+        if length >= MIN_MATCH + cost - 2:
+            if size + cost > maxPayload:
+                break
+            flush()
+            out.append(0x80 | (length - MIN_MATCH))
+            if cost == 2:
+                out.append(offset - 1)
+            else:
+                out.append(0x80 | ((offset - 1) >> 8))
+                out.append((offset - 1) & 0xFF)
+            pos += length
+        else:
+            # A new literal run also costs its token byte
+            if size + (1 if literals else 2) > maxPayload:
+                break
+            literals.append(data[pos])
+            pos += 1
+            if len(literals) == MAX_LITERALS:
+                flush()
+    flush()
+    return bytes(out), pos - start
+
+# Reference decoder, used to check every packed record. flash holds the
+# contents below the record start address.
+def unpack(flash, stream, size):
+    out = bytearray(flash)
+    i = 0
+    while i < len(stream):
+        token = stream[i]
+        i += 1
+        if token < 0x80:
+            out.extend(stream[i:i + token + 1])
+            i += token + 1
+        else:
+            dist = stream[i]
+            i += 1
+            if dist & 0x80:
+                dist = ((dist & 0x7F) << 8) | stream[i]
+                i += 1
+            src = len(out) - dist - 1
+            for n in range((token & 0x7F) + MIN_MATCH):
+                out.append(out[src + n])
+    if len(out) - len(flash) != size:
+        raise ValueError("Packed record size mismatch")
+    return bytes(out[len(flash):])
+
+# Split the image into runs of consecutive erase pages. Each run is the base
+# address and the full page contents, with unused bytes left erased (0xFF).
+def imageRuns(image, pageSize):
+    runs = []
+    for page in sorted({a // pageSize for a in image}):
+        base = page * pageSize
+        data = bytearray(0xFF for i in range(pageSize))
+        for a in range(base, base + pageSize):
+            if a in image:
+                data[a - base] = image[a]
+        if runs and runs[-1][0] + len(runs[-1][1]) == base:
+            runs[-1][1].extend(data)
+        else:
+            runs.append((base, data))
+    return runs
+
+def main():
+    parser = argparse.ArgumentParser(description="Pack an Intel HEX image into EFM8 boot records")
+    parser.add_argument("hexfile")
+    parser.add_argument("output")
+    parser.add_argument("--id", type=lambda x: int(x, 0),
+                        help="Derivative ID for the ident record (e.g. 0x3400)")
+    parser.add_argument("--page-size", type=int, default=512,
+                        help="Flash erase page size (default 512)")
+    parser.add_argument("--small-buffer", action="store_true",
+                        help="Limit records to the 132-byte IDATA receive buffer")
+    parser.add_argument("--record-window", action="store_true",
+                        help="Only copy from bytes written by the same record")
+    parser.add_argument("--plain", action="store_true",
+                        help="Emit uncompressed write records")
+    parser.add_argument("--verify", action="store_true",
+                        help="Append a verify record for each page")
+    parser.add_argument("--write-crc", action="store_true",
+                        help="Append a write CRC record (BOOT_USE_WCRC)")
+    parser.add_argument("--run", action="store_true",
+                        help="Append a run application record")
+    parser.add_argument("--crc-query", type=int, metavar="PAGES",
+                        help="Only write a page CRC query for PAGES pages from address 0")
+    parser.add_argument("--device-crcs", metavar="FILE",
+                        help="Reply to the page CRC query; matching pages are skipped")
+    parser.add_argument("--baud", type=int, default=115200,
+                        help="Baud rate for the transfer time estimate")
+    parser.add_argument("--speedup", type=int, metavar="N",
+                        help="Ask the bootloader to run at N times the starting baud rate")
+    parser.add_argument("--bench", action="store_true",
+                        help="Compare transfer and flash time at several baud rates")
+    parser.add_argument("--hid", action="store_true",
+                        help="Compare per-record and streamed USB HID transfer")
+    parser.add_argument("--write-us", type=float, default=20.0,
+                        help="Flash byte write time in microseconds (default 20)")
+    parser.add_argument("--erase-ms", type=float, default=5.5,
+                        help="Flash page erase time in milliseconds (default 5.5)")
+    args = parser.parse_args()
+
+    if args.speedup is not None and not 1 <= args.speedup <= 255:
+        print("Speedup must be between 1 and 255")
+        return 1
+
+    if args.crc_query:
+        with open(args.output, "wb") as f:
+            f.write(record(CMD_PAGECRC, [0, 0, args.crc_query]))
+        return 0
+
+    # Two bytes per page from address 0, MSB first; the final reply byte
+    # is ignored
+    deviceCrcs = []
+    if args.device_crcs:
+        with open(args.device_crcs, "rb") as f:
+            table = f.read()
+        deviceCrcs = [(table[i] << 8) | table[i + 1] for i in range(0, len(table) - 1, 2)]
+
+    image = readHex(args.hexfile)
+    if not any(v != 0xFF for v in image.values()):
+        print("No data in " + args.hexfile)
+        return 1
+
+    # Frame length byte covers the command, address, size and stream
+    maxFrame = 131 if args.small_buffer else 255
+    records = []
+    if args.id is not None:
+        records.append(record(CMD_IDENT, [args.id >> 8, args.id & 0xFF]))
+    setup = [0xA5, 0xF1, 0x00]
+    if args.speedup:
+        setup.append(args.speedup)
+    records.append(record(CMD_SETUP, setup))
+
+    # A page is skipped if the device already holds it
+    def isCurrent(addr, data):
+        index = addr // args.page_size
+        return index < len(deviceCrcs) and deviceCrcs[index] == crc16(data)
+
+    runs = [(base, bytes(run)) for base, run in imageRuns(image, args.page_size)]
+
+    # As with boot_compile, the reset vector page is erased first and written
+    # last, ending with address 0, so the bootloader runs at every reset until
+    # the update has completed. It is rewritten whenever any page changes.
+    resetPage = runs[0][0] == 0 and not all(
+        isCurrent(base + page, run[page:page + args.page_size])
+        for base, run in runs for page in range(0, len(run), args.page_size))
+    if resetPage:
+        records.append(record(CMD_ERASE, [0, 0]))
+    resetRecords = []
+    resetVerify = []
+
+    programmed = 0
+    skipped = 0
+    erased = 0
+    writeCrc = 0
+    for base, run in runs:
+        finder = MatchFinder(run)
+        for page in range(0, len(run), args.page_size):
+            # Skip the page if the device already holds it. It stays in the
+            # match window, since its flash contents are the same.
+            addr = base + page
+            isReset = resetPage and addr == 0
+            if not isReset and isCurrent(addr, run[page:page + args.page_size]):
+                skipped += 1
+                continue
+
+            # The reset vector page was erased above and is written after the
+            # other pages, in reverse record order, so its records only copy
+            # within themselves and no other page copies from it. Other pages
+            # are erased with an empty erase record, then filled.
+            window = args.page_size if resetPage and base == 0 else 0
+            if isReset:
+                pageRecords = resetRecords
+            else:
+                pageRecords = records
+                pageRecords.append(record(CMD_ERASE, [addr >> 8, addr & 0xFF]))
+            erased += 1
+
+            # Trailing erased bytes are not sent
+            end = page + len(run[page:page + args.page_size].rstrip(b'\xff'))
+            pos = page
+            while pos < end:
+                addr = base + pos
+                if args.plain:
+                    n = min(maxFrame - 3, end - pos)
+                    pageRecords.append(record(CMD_WRITE, bytes([addr >> 8, addr & 0xFF]) + run[pos:pos + n]))
+                else:
+                    first = pos if args.record_window or isReset else window
+                    stream, n = packRecord(finder, first, pos, end, maxFrame - 4)
+                    if unpack(run[first:pos], stream, n) != run[pos:pos + n]:
+                        raise ValueError("Packed record at 0x%04X does not decode" % addr)
+                    pageRecords.append(record(CMD_ZWRITE, bytes([addr >> 8, addr & 0xFF, n]) + stream))
+                writeCrc = (writeCrc + crc16(run[pos:pos + n])) & 0xFFFF
+                pos += n
+            programmed += end - page
+            if args.verify and end > page:
+                first, last = base + page, base + end - 1
+                crc = crc16(run[page:end])
+                verify = record(CMD_VERIFY, [first >> 8, first & 0xFF, last >> 8, last & 0xFF,
+                                             crc >> 8, crc & 0xFF])
+                (resetVerify if isReset else records).append(verify)
+
+    # Fill the reset vector page, ending with the record at address 0
+    records.extend(reversed(resetRecords))
+    records.extend(resetVerify)
+    if resetPage:
+        writes = [r for r in records if r[2] in (CMD_WRITE, CMD_ZWRITE)]
+        assert writes[-1][3:5] == b'\x00\x00', "Reset vector is not written last"
+    if args.write_crc:
+        records.append(record(CMD_WCRC, [writeCrc >> 8, writeCrc & 0xFF]))
+    if args.run:
+        records.append(record(CMD_RUNAPP))
+
+    with open(args.output, "wb") as f:
+        for r in records:
+            f.write(r)
+
+    # Every record is answered with one reply byte
+    wire = sum(len(r) for r in records) + len(records)
+    seconds = wire * 10.0 / args.baud
+    print("Records:              %d" % len(records))
+    print("Pages skipped:        %d" % skipped)
+    print("Bytes programmed:     %d" % programmed)
+    print("Bytes on the wire:    %d" % wire)
+    print("Wire/programmed byte: %.3f" % (float(wire) / max(programmed, 1)))
+    print("Transfer at %d baud: %.2f s" % (args.baud, seconds))
+
+    # Each record is sent, programmed and answered before the next is sent,
+    # so the flash time adds to the wire time. The pipelined protocol
+    # (boot_uart.py) only overlaps WRITE records with the one before them;
+    # erase and ZWRITE records are sent alone, so their time still adds.
+    if args.bench:
+        flash = programmed * args.write_us * 1e-6 + erased * args.erase_ms * 1e-3
+        overlapped = [r for r in records if r[2] == CMD_WRITE]
+        overlappedWire = sum(len(r) + 1 for r in overlapped)
+        overlappedFlash = sum(len(r) - 5 for r in overlapped) * args.write_us * 1e-6
+        print("")
+        print("Image %d bytes, %d pages erased, flash time %.2f s" % (programmed, erased, flash))
+        print("%8s %8s %10s %10s" % ("Baud", "Wire s", "Serial s", "Piped s"))
+        for rate in BENCH_RATES:
+            wireTime = wire * 10.0 / rate
+            # Pipelined frames add a sequence and a checksum byte each way
+            pipedWire = (wire + 3 * len(records)) * 10.0 / rate
+            overlapTime = (overlappedWire + 3 * len(overlapped)) * 10.0 / rate
+            piped = pipedWire - overlapTime + flash - overlappedFlash + max(overlapTime, overlappedFlash)
+            print("%8d %8.2f %10.2f %10.2f" % (rate, wireTime, wireTime + flash, piped))
+
+    # Per record, the host sends the record padded to whole reports and then
+    # waits at least one frame for the INPUT report with the reply. Streamed
+    # records fill every report and replies are not waited for.
+    if args.hid:
+        single = sum((len(r) + HID_REPORT_SIZE - 1) // HID_REPORT_SIZE + 1 for r in records)
+        streamed = (sum(len(r) for r in records) + HID_REPORT_SIZE - 1) // HID_REPORT_SIZE
+        print("")
+        print("USB HID per record:   %d frames (%.2f s)" % (single, single * 1e-3))
+        print("USB HID streamed:     %d frames (%.2f s)" % (streamed, streamed * 1e-3))
+    return 0
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,213 @@
+#!/usr/bin/env python3
+# Copyright (c) 2021 by Silicon Laboratories Inc. All rights reserved.
+#
+# http://developer.silabs.com/legal/version/v11/Silicon_Labs_Software_License_Agreement.txt
+#
+# Sends EFM8 boot record files (.efm8) to one or more SMBus bootloaders
+# built with BOOT_USE_BLOCK set to 1, through a Linux i2c-dev adapter.
+#
+# Each record is one write transfer. The target releases the bus as soon as
+# the record has arrived, and a one byte read returns BOOT_BUSY_REPLY until
+# the record has executed. While one target programs flash, the bus carries
+# records to the others.
+#
+#   boot_smb.py --bus 1 1:app_a.efm8 2:app_b.efm8 3:app_a.efm8
+#
+# sends a file to each node (BL_SMB_NODE), interleaving their records.
+#
+#   boot_smb.py --bus 1 --group app.efm8 --nodes 1,2,3
+#
+# writes each record once to the general call address, which every node
+# (1-7) receives, then collects a reply from each node. A node that missed
+# the record answers BOOT_ERR_FRAME and is sent the record again on its own.
+#
+# Records with multi-byte replies (PAGECRC, and WCRC without a value) are
+# not supported, since their reply bytes may equal BOOT_BUSY_REPLY.
+
+import argparse
+import ctypes
+import fcntl
+import os
+import sys
+import time
+
+# 7-bit SMBus address of BL_SMB_SLAVE_ADDRESS (0xF0); node n is at + n
+NODE_ADDRESS = 0x78
+
+# Group records go to the general call address
+GENERAL_CALL = 0x00
+
+# Boot record framing and command bytes (see boot.h)
+FRAME_START = ord('$')
+CMD_RUNAPP = ord('6')
+CMD_PAGECRC = ord('8')
+CMD_WCRC = ord('9')
+
+# Bootloader response bytes
+ACK_REPLY = ord('@')
+ERR_FRAME = ord('D')
+BUSY_REPLY = ord('#')
+
+# Linux i2c-dev ioctls that select the target address and run a combined
+# transfer. I2C_SLAVE refuses the general call address; I2C_RDWR does not.
+I2C_SLAVE = 0x0703
+I2C_RDWR = 0x0707
+
+class I2cMsg(ctypes.Structure):
+    _fields_ = [("addr", ctypes.c_uint16), ("flags", ctypes.c_uint16),
+                ("len", ctypes.c_uint16), ("buf", ctypes.c_char_p)]
+
+class I2cRdwrData(ctypes.Structure):
+    _fields_ = [("msgs", ctypes.POINTER(I2cMsg)), ("nmsgs", ctypes.c_uint32)]
+
+class Bus:
+    def __init__(self, number):
+        self.fd = os.open("/dev/i2c-%d" % number, os.O_RDWR)
+        self.address = None
+
+    def select(self, address):
+        if address != self.address:
+            fcntl.ioctl(self.fd, I2C_SLAVE, address)
+            self.address = address
+
+    # Returns False if the target NAK'd the transfer
+    def write(self, address, data):
+        self.select(address)
+        try:
+            return os.write(self.fd, data) == len(data)
+        except OSError:
+            return False
+
+    # Write to every node at once. Returns False if no node ACK'd.
+    def writeGroup(self, data):
+        msg = I2cMsg(GENERAL_CALL, 0, len(data), data)
+        request = I2cRdwrData(ctypes.pointer(msg), 1)
+        try:
+            fcntl.ioctl(self.fd, I2C_RDWR, request)
+            return True
+        except OSError:
+            return False
+
+    # Returns None if the target NAK'd its address
+    def read(self, address):
+        self.select(address)
+        try:
+            return os.read(self.fd, 1)[0]
+        except OSError:
+            return None
+
+def readRecords(path):
+    with open(path, "rb") as f:
+        data = f.read()
+    records = []
+    pos = 0
+    while pos < len(data):
+        if data[pos] != FRAME_START or pos + 2 > len(data):
+            raise ValueError("%s: bad frame at offset %d" % (path, pos))
+        end = pos + 2 + data[pos + 1]
+        record = data[pos:end]
+        if record[2] == CMD_PAGECRC or (record[2] == CMD_WCRC and record[1] == 1):
+            raise ValueError("%s: record at offset %d has a multi-byte reply" % (path, pos))
+        records.append(record)
+        pos = end
+    return records
+
+class Target:
+    def __init__(self, node, records):
+        self.node = node
+        self.address = NODE_ADDRESS + node
+        self.records = records
+        self.index = 0
+        self.sent = False
+        self.error = None
+
+    def done(self):
+        return self.error is not None or self.index == len(self.records)
+
+    # Handle one reply; returns False while the record is still running
+    def reply(self, value):
+        if value is None or value == BUSY_REPLY:
+            return False
+        self.sent = False
+        if value == ACK_REPLY:
+            self.index += 1
+        elif value != ERR_FRAME:
+            # A frame error is resent; anything else stops this node
+            self.error = "record %d: reply %r" % (self.index, chr(value))
+        return True
+
+def sendEach(bus, targets):
+    # Keep every node busy: send its next record as soon as it has replied
+    while not all(t.done() for t in targets):
+        for t in targets:
+            if t.done():
+                continue
+            if not t.sent:
+                t.sent = bus.write(t.address, t.records[t.index])
+            else:
+                t.reply(bus.read(t.address))
+
+def sendGroup(bus, targets, records):
+    for index, record in enumerate(records):
+        # One write reaches every node that is waiting for a record
+        while not bus.writeGroup(record):
+            pass
+        for t in targets:
+            t.sent = True
+        waiting = [t for t in targets if not t.done()]
+        while waiting:
+            for t in waiting:
+                if t.sent:
+                    t.reply(bus.read(t.address))
+                else:
+                    # The node missed the group write
+                    t.sent = bus.write(t.address, record)
+            waiting = [t for t in waiting if t.index == index and not t.done()]
+        if not any(t.index > index for t in targets):
+            break
+
+def main():
+    parser = argparse.ArgumentParser(description="Send EFM8 boot records to SMBus bootloaders")
+    parser.add_argument("targets", nargs="*", metavar="NODE:FILE",
+                        help="Boot record file for each node (1-7, or 0 for a single target)")
+    parser.add_argument("--bus", type=int, default=1,
+                        help="Linux I2C adapter number (default 1)")
+    parser.add_argument("--group", metavar="FILE",
+                        help="Boot record file written once to all --nodes")
+    parser.add_argument("--nodes", default="",
+                        help="Comma-separated node numbers for --group")
+    args = parser.parse_args()
+
+    if args.group:
+        records = readRecords(args.group)
+        targets = [Target(int(n), records) for n in args.nodes.split(",") if n]
+    else:
+        targets = []
+        for spec in args.targets:
+            node, path = spec.split(":", 1)
+            targets.append(Target(int(node), readRecords(path)))
+    if not targets or any(t.node not in range(8) for t in targets):
+        parser.error("give one or more targets with nodes 0-7")
+    if args.group and any(t.node == 0 for t in targets):
+        parser.error("node 0 does not receive general call writes")
+
+    bus = Bus(args.bus)
+    start = time.time()
+    if args.group:
+        sendGroup(bus, targets, records)
+    else:
+        sendEach(bus, targets)
+    seconds = time.time() - start
+
+    failed = 0
+    for t in targets:
+        if t.error:
+            failed += 1
+            print("Node %d: %s" % (t.node, t.error))
+        else:
+            print("Node %d: %d records" % (t.node, t.index))
+    print("Total time: %.2f s" % seconds)
+    return 1 if failed else 0
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,255 @@
+#!/usr/bin/env python3
+# Copyright (c) 2021 by Silicon Laboratories Inc. All rights reserved.
+#
+# http://developer.silabs.com/legal/version/v11/Silicon_Labs_Software_License_Agreement.txt
+#
+# Sends an EFM8 boot record file (.efm8) to a UART bootloader built with
+# BOOT_USE_PIPELINE set to 1, through a Linux serial port.
+#
+#   boot_uart.py --port /dev/ttyACM0 app.efm8
+#
+# Each '$' record in the file is sent as a pipelined '%' frame. A WRITE
+# record is sent while the one before it is still being programmed, so at
+# most two records are outstanding. The bootloader polls its one-byte UART
+# receive buffer and owns no interrupt vectors, so it cannot receive while
+# it erases a page, scans flash with CRC0, copies flash for a ZWRITE or
+# changes state. Those records are only sent when no other record is
+# outstanding, and the next record is held back until they are answered.
+#
+# A record answered with BOOT_NAK_REPLY (bad checksum) is sent again. Page
+# CRC and write CRC values are printed, or saved with --crcs for
+# boot_pack.py --device-crcs. A setup record that asks for a faster baud
+# rate switches the port once it has been acknowledged.
+#
+# The bootloader only polls the receiver between flash byte writes, so a
+# WRITE is only overlapped while a byte takes longer than one flash byte
+# write (--write-us). Faster rates send one record at a time.
+#
+# --sync sends the 0x55 byte that the UART1 hardware autobaud detector (UB3
+# bootloader) measures, after opening the port and after each baud switch.
+
+import argparse
+import os
+import select
+import sys
+import termios
+import time
+
+# Boot record framing and command bytes (see boot.h)
+FRAME_START = ord('$')
+FRAME_PIPED = ord('%')
+CMD_SETUP = ord('1')
+CMD_WRITE = ord('3')
+CMD_PAGECRC = ord('8')
+CMD_WCRC = ord('9')
+
+# Bootloader response bytes
+ACK_REPLY = ord('@')
+NAK_REPLY = ord('D')
+
+# Records the bootloader receives while it executes the one before them
+OVERLAPPED = (CMD_WRITE,)
+
+# Autobaud sync byte
+SYNC_BYTE = 0x55
+
+# Most records outstanding at once (one executing, one being received)
+WINDOW = 2
+
+# Seconds to wait for a reply before giving up
+REPLY_TIMEOUT = 2.0
+
+class Port:
+    def __init__(self, path, baud):
+        self.fd = os.open(path, os.O_RDWR | os.O_NOCTTY)
+        self.pending = []
+        self.setBaud(baud)
+        termios.tcflush(self.fd, termios.TCIOFLUSH)
+
+    # Raw 8N1 at the given rate
+    def setBaud(self, baud):
+        speed = getattr(termios, "B%d" % baud, None)
+        if speed is None:
+            raise ValueError("Unsupported baud rate %d" % baud)
+        attr = termios.tcgetattr(self.fd)
+        attr[0] = 0
+        attr[1] = 0
+        attr[2] = termios.CS8 | termios.CREAD | termios.CLOCAL
+        attr[3] = 0
+        attr[4] = speed
+        attr[5] = speed
+        termios.tcsetattr(self.fd, termios.TCSADRAIN, attr)
+        self.baud = baud
+
+    def byteTime(self):
+        return 10.0 / self.baud
+
+    def unread(self, value):
+        self.pending.append(value)
+
+    def write(self, data):
+        while data:
+            data = data[os.write(self.fd, data):]
+
+    # Returns None if no byte arrives in time
+    def read(self, timeout=REPLY_TIMEOUT):
+        if self.pending:
+            return self.pending.pop()
+        if not select.select([self.fd], [], [], timeout)[0]:
+            return None
+        return os.read(self.fd, 1)[0]
+
+def readRecords(path):
+    with open(path, "rb") as f:
+        data = f.read()
+    records = []
+    pos = 0
+    while pos < len(data):
+        if data[pos] != FRAME_START or pos + 2 > len(data):
+            raise ValueError("%s: bad frame at offset %d" % (path, pos))
+        end = pos + 2 + data[pos + 1]
+        records.append(data[pos + 2:end])
+        pos = end
+    return records
+
+# Pipelined frame: '%', seq, len, data, cksum
+def frame(seq, body):
+    return bytes([FRAME_PIPED, seq, len(body)]) + body + bytes([(seq + len(body) + sum(body)) & 0xFF])
+
+# Number of 16-bit values sent before the reply code
+def valueWords(body):
+    if body[0] == CMD_PAGECRC:
+        return body[3]
+    if body[0] == CMD_WCRC and len(body) == 1:
+        return 1
+    return 0
+
+class Sender:
+    def __init__(self, port, records, writeTime, sync):
+        self.port = port
+        self.records = records
+        self.writeTime = writeTime
+        self.sync = sync
+        self.next = 0
+        self.outstanding = {}
+        self.values = bytearray()
+        self.error = None
+
+    def send(self, index):
+        seq = index & 0xFF
+        self.outstanding[seq] = index
+        self.port.write(frame(seq, self.records[index]))
+
+    # Records outstanding at once. A byte received during a flash byte write
+    # is overwritten by the next one if it arrives first.
+    def window(self):
+        return WINDOW if self.port.byteTime() > self.writeTime else 1
+
+    def switchBaud(self, baud):
+        self.port.setBaud(baud)
+        if self.sync:
+            self.port.write(bytes([SYNC_BYTE]))
+
+    # Whether the next record may go out now
+    def canSend(self):
+        if self.next == len(self.records) or len(self.outstanding) >= self.window():
+            return False
+        if not self.outstanding:
+            return True
+        # Only a WRITE may follow a WRITE that is still executing
+        last = self.records[max(self.outstanding.values())]
+        return last[0] in OVERLAPPED and self.records[self.next][0] in OVERLAPPED
+
+    def readByte(self):
+        value = self.port.read()
+        if value is None:
+            raise IOError("no reply to record %d" % min(self.outstanding.values()))
+        return value
+
+    # Read one seq, byte pair
+    def readPair(self):
+        seq = self.readByte()
+        value = self.readByte()
+        if seq not in self.outstanding:
+            raise IOError("reply for unknown sequence %d" % seq)
+        return seq, value
+
+    def receive(self):
+        seq, value = self.readPair()
+        index = self.outstanding[seq]
+        body = self.records[index]
+
+        # Values come first, each sent as seq, MSB, LSB. Records with values
+        # are never overlapped, so nothing else is in flight. An MSB is
+        # followed at once by its LSB; a NAK is not.
+        words = valueWords(body)
+        if words and value == NAK_REPLY:
+            following = self.port.read(self.port.byteTime() * 20 + 0.01)
+            if following is None:
+                words = 0
+            else:
+                self.port.unread(following)
+        for i in range(words):
+            self.values.append(value)
+            self.values.append(self.readByte())
+            seq, value = self.readPair()
+
+        del self.outstanding[seq]
+        if value == NAK_REPLY:
+            self.send(index)
+        elif value != ACK_REPLY:
+            self.error = "record %d (cmd '%c'): reply %r" % (index, body[0], chr(value))
+        elif body[0] == CMD_SETUP and len(body) > 4:
+            # The bootloader changes rate after the reply has been sent
+            self.switchBaud(self.port.baud * body[4])
+
+    def run(self):
+        while self.error is None and (self.outstanding or self.next < len(self.records)):
+            if self.canSend():
+                self.send(self.next)
+                self.next += 1
+            else:
+                self.receive()
+        return self.error is None
+
+def main():
+    parser = argparse.ArgumentParser(description="Send EFM8 boot records to a pipelined UART bootloader")
+    parser.add_argument("records", help="Boot record file (.efm8)")
+    parser.add_argument("--port", default="/dev/ttyACM0",
+                        help="Serial port (default /dev/ttyACM0)")
+    parser.add_argument("--baud", type=int, default=115200,
+                        help="Starting baud rate (default 115200)")
+    parser.add_argument("--crcs", metavar="FILE",
+                        help="Save page CRC and write CRC reply values to FILE")
+    parser.add_argument("--write-us", type=float, default=20.0,
+                        help="Flash byte write time in microseconds (default 20)")
+    parser.add_argument("--sync", action="store_true",
+                        help="Send 0x55 for UART1 autobaud at the start and after each baud switch")
+    args = parser.parse_args()
+
+    records = readRecords(args.records)
+    port = Port(args.port, args.baud)
+    if args.sync:
+        port.write(bytes([SYNC_BYTE]))
+    sender = Sender(port, records, args.write_us * 1e-6, args.sync)
+    start = time.time()
+    try:
+        ok = sender.run()
+    except IOError as e:
+        sender.error = str(e)
+        ok = False
+    seconds = time.time() - start
+
+    if args.crcs:
+        with open(args.crcs, "wb") as f:
+            f.write(sender.values)
+    elif sender.values:
+        print("Values: " + sender.values.hex())
+    if not ok:
+        print(sender.error)
+        return 1
+    print("Records: %d in %.2f s" % (len(records), seconds))
+    return 0
+
+if __name__ == "__main__":
+    sys.exit(main())
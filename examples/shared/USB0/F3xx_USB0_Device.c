@@ -0,0 +1,1434 @@
+/**************************************************************************//**
+ * Copyright (c) 2015 by Silicon Laboratories Inc. All rights reserved.
+ *
+ * http://developer.silabs.com/legal/version/v11/Silicon_Labs_Software_License_Agreement.txt
+ *****************************************************************************/
+
+// USB device core for the C8051F32x, F34x and F38x. See F3xx_USB0_Device.h.
+// Each project builds this file through its own F3xx_USB0_Device.c, which
+// includes the device header first.
+
+#include "F3xx_USB0_Device.h"
+#include "F3xx_USB0_Fifo.h"
+
+#ifndef FIFO2
+#error "F3xx_USB0_Device: the C8051F326/7 (endpoint 1 only) is not supported"
+#endif
+
+// -----------------------------------------------------------------------------
+// Endpoint configuration
+
+// FIFO size of endpoint n: 128, 256 and 512 bytes for endpoints 1 to 3
+#define EP_FIFO_SIZE(n)     (64 << (n))
+
+// An endpoint used in both directions splits its FIFO between them
+#define EP_SPLIT(n)         (SLAB_USB_EP##n##IN_USED && SLAB_USB_EP##n##OUT_USED)
+
+// Largest packet that fits each direction's share of the FIFO
+#define EP_IN_LIMIT(n)      (EP_FIFO_SIZE(n) >> (EP_SPLIT(n) ? 1 : 0)          \
+                             >> (SLAB_USB_EP##n##IN_DOUBLE_BUFFERED ? 1 : 0))
+#define EP_OUT_LIMIT(n)     (EP_FIFO_SIZE(n) >> (EP_SPLIT(n) ? 1 : 0)          \
+                             >> (SLAB_USB_EP##n##OUT_DOUBLE_BUFFERED ? 1 : 0))
+
+#if SLAB_USB_EP1IN_USED && (SLAB_USB_EP1IN_MAX_PACKET_SIZE > EP_IN_LIMIT(1))
+#error "SLAB_USB_EP1IN_MAX_PACKET_SIZE does not fit the endpoint 1 FIFO"
+#endif
+#if SLAB_USB_EP1OUT_USED && (SLAB_USB_EP1OUT_MAX_PACKET_SIZE > EP_OUT_LIMIT(1))
+#error "SLAB_USB_EP1OUT_MAX_PACKET_SIZE does not fit the endpoint 1 FIFO"
+#endif
+#if SLAB_USB_EP2IN_USED && (SLAB_USB_EP2IN_MAX_PACKET_SIZE > EP_IN_LIMIT(2))
+#error "SLAB_USB_EP2IN_MAX_PACKET_SIZE does not fit the endpoint 2 FIFO"
+#endif
+#if SLAB_USB_EP2OUT_USED && (SLAB_USB_EP2OUT_MAX_PACKET_SIZE > EP_OUT_LIMIT(2))
+#error "SLAB_USB_EP2OUT_MAX_PACKET_SIZE does not fit the endpoint 2 FIFO"
+#endif
+#if SLAB_USB_EP3IN_USED && (SLAB_USB_EP3IN_MAX_PACKET_SIZE > EP_IN_LIMIT(3))
+#error "SLAB_USB_EP3IN_MAX_PACKET_SIZE does not fit the endpoint 3 FIFO"
+#endif
+#if SLAB_USB_EP3OUT_USED && (SLAB_USB_EP3OUT_MAX_PACKET_SIZE > EP_OUT_LIMIT(3))
+#error "SLAB_USB_EP3OUT_MAX_PACKET_SIZE does not fit the endpoint 3 FIFO"
+#endif
+
+// EINCSRH and EOUTCSRH values of endpoint n once configured
+#define EP_EINCSRH(n)                                                         \
+  ((EP_SPLIT(n) ? EINCSRH_SPLIT__ENABLED : 0)                                 \
+   | (SLAB_USB_EP##n##IN_USED ? EINCSRH_DIRSEL__IN : EINCSRH_DIRSEL__OUT)     \
+   | ((SLAB_USB_EP##n##IN_USED                                                \
+       && (SLAB_USB_EP##n##IN_TRANSFER_TYPE == USB_EPTYPE_ISOC))              \
+      ? EINCSRH_ISO__ENABLED : 0)                                             \
+   | ((SLAB_USB_EP##n##IN_USED && SLAB_USB_EP##n##IN_DOUBLE_BUFFERED)         \
+      ? EINCSRH_DBIEN__ENABLED : 0))
+
+#define EP_EOUTCSRH(n)                                                        \
+  (((SLAB_USB_EP##n##OUT_USED                                                 \
+     && (SLAB_USB_EP##n##OUT_TRANSFER_TYPE == USB_EPTYPE_ISOC))               \
+    ? EOUTCSRH_ISO__ENABLED : 0)                                              \
+   | ((SLAB_USB_EP##n##OUT_USED && SLAB_USB_EP##n##OUT_DOUBLE_BUFFERED)       \
+      ? EOUTCSRH_DBOEN__ENABLED : 0))
+
+#define IN_EP_INTERRUPTS                                                      \
+  (IN1IE_EP0E__ENABLED                                                        \
+   | (SLAB_USB_EP1IN_USED ? IN1IE_IN1E__ENABLED : 0)                          \
+   | (SLAB_USB_EP2IN_USED ? IN1IE_IN2E__ENABLED : 0)                          \
+   | (SLAB_USB_EP3IN_USED ? IN1IE_IN3E__ENABLED : 0))
+
+#define OUT_EP_INTERRUPTS                                                     \
+  ((SLAB_USB_EP1OUT_USED ? OUT1IE_OUT1E__ENABLED : 0)                         \
+   | (SLAB_USB_EP2OUT_USED ? OUT1IE_OUT2E__ENABLED : 0)                       \
+   | (SLAB_USB_EP3OUT_USED ? OUT1IE_OUT3E__ENABLED : 0))
+
+// Start of frame also services OUT transfers started while a packet was
+// already waiting, since no OUT interrupt will come for it
+#define SOF_USED            (SLAB_USB_SOF_CB || OUT_EP_INTERRUPTS)
+
+#define COMMON_INTERRUPTS                                                     \
+  (CMIE_SUSINTE__ENABLED | CMIE_RSUINTE__ENABLED | CMIE_RSTINTE__ENABLED      \
+   | (SOF_USED ? CMIE_SOFE__ENABLED : 0))
+
+// CLKREC bits 4-0 must be written as 01001b
+#define CLKREC_RESERVED     0x09
+
+#if SLAB_USB_FULL_SPEED
+#define USB0XCN_SPEED       USB0XCN_SPEED__FULL_SPEED
+#define CLKREC_SPEED        CLKREC_CRLOW__FULL_SPEED
+#else
+#define USB0XCN_SPEED       USB0XCN_SPEED__LOW_SPEED
+#define CLKREC_SPEED        CLKREC_CRLOW__LOW_SPEED
+#endif
+
+#if SLAB_USB_CLOCK_RECOVERY_ENABLED
+#define CLKREC_VALUE        (CLKREC_CRE__ENABLED | CLKREC_SPEED | CLKREC_RESERVED)
+#else
+#define CLKREC_VALUE        (CLKREC_SPEED | CLKREC_RESERVED)
+#endif
+
+// -----------------------------------------------------------------------------
+// Types and variables
+
+// USBD_Ep_TypeDef.flags
+#define EP_CALLBACK         0x01  // Call USBD_XferCompleteCb() when done
+#define EP_LOADED           0x02  // IN: the last packet is in the FIFO
+#define EP_ZLP              0x04  // EP0 IN: end a full last packet with a ZLP
+#define EP_PACKED           0x08  // EP0 IN: sending a packed string
+
+typedef struct
+{
+  SI_VARIABLE_SEGMENT_POINTER(buf, uint8_t, SI_SEG_GENERIC);
+  uint16_t remaining;                   // Bytes not yet moved
+  uint16_t xferred;                     // Bytes moved so far
+  uint8_t state;                        // USBD_EpState_TypeDef
+  uint8_t flags;                        // EP_* flags
+} USBD_Ep_TypeDef;
+
+typedef struct
+{
+  SI_VARIABLE_SEGMENT_POINTER(init, const USBD_Init_TypeDef, SI_SEG_GENERIC);
+  USBD_Ep_TypeDef ep0;
+#if SLAB_USB_EP1IN_USED
+  USBD_Ep_TypeDef ep1in;
+#endif
+#if SLAB_USB_EP1OUT_USED
+  USBD_Ep_TypeDef ep1out;
+#endif
+#if SLAB_USB_EP2IN_USED
+  USBD_Ep_TypeDef ep2in;
+#endif
+#if SLAB_USB_EP2OUT_USED
+  USBD_Ep_TypeDef ep2out;
+#endif
+#if SLAB_USB_EP3IN_USED
+  USBD_Ep_TypeDef ep3in;
+#endif
+#if SLAB_USB_EP3OUT_USED
+  USBD_Ep_TypeDef ep3out;
+#endif
+  uint8_t state;                        // USBD_State_TypeDef
+  uint8_t savedState;                   // State to restore on resume
+  uint8_t configurationValue;
+  bool remoteWakeupEnabled;
+#if SLAB_USB_SUPPORT_ALT_INTERFACES
+  uint8_t altSetting[SLAB_USB_NUM_INTERFACES];
+#endif
+  uint8_t ep0Buf[2];                    // GET_STATUS/CONFIGURATION reply
+} USBD_Device_TypeDef;
+
+typedef USBD_Ep_TypeDef SI_SEG_XDATA * EpPointer;
+
+// Endpoint state is kept in XRAM; only the setup packet, which is passed to
+// USBD_SetupCmdCb(), is in the memory model's default space.
+static SI_SEGMENT_VARIABLE(myUsbDevice, USBD_Device_TypeDef, SI_SEG_XDATA);
+static SI_SEGMENT_VARIABLE(setup, USB_Setup_TypeDef, MEM_MODEL_SEG);
+
+// -----------------------------------------------------------------------------
+// Register access
+
+// Neither routine uses memory, so both serve the ISR and the foreground
+static uint8_t readReg(uint8_t addr)
+{
+  while (USB0ADR & USB0ADR_BUSY__BMASK);
+  USB0ADR = USB0ADR_BUSY__BMASK | addr;
+  while (USB0ADR & USB0ADR_BUSY__BMASK);
+  return USB0DAT;
+}
+
+static void writeReg(uint8_t addr, uint8_t value)
+{
+  while (USB0ADR & USB0ADR_BUSY__BMASK);
+  USB0ADR = addr;
+  USB0DAT = value;
+}
+
+// Copies one packet, which may be larger than the 255 bytes one FIFO
+// routine call moves (isochronous endpoint 3)
+static void writeFifo(uint8_t fifo,
+                      SI_VARIABLE_SEGMENT_POINTER(dat, const uint8_t,
+                                                  SI_SEG_GENERIC),
+                      uint16_t count)
+{
+  while (count > 255)
+  {
+    Fifo_Write(fifo, 255, dat);
+    dat += 255;
+    count -= 255;
+  }
+  Fifo_Write(fifo, (uint8_t)count, dat);
+}
+
+#if OUT_EP_INTERRUPTS
+static void readFifo(uint8_t fifo,
+                     SI_VARIABLE_SEGMENT_POINTER(dat, uint8_t, SI_SEG_GENERIC),
+                     uint16_t count)
+{
+  while (count > 255)
+  {
+    Fifo_Read(fifo, 255, dat);
+    dat += 255;
+    count -= 255;
+  }
+  Fifo_Read(fifo, (uint8_t)count, dat);
+}
+#endif
+
+// -----------------------------------------------------------------------------
+// Endpoint helpers
+
+static EpPointer getEp(uint8_t epAddr)
+{
+  switch (epAddr)
+  {
+    case EP0:
+    case EP0 | USB_EP_DIR_IN:
+      return &myUsbDevice.ep0;
+#if SLAB_USB_EP1IN_USED
+    case EP1IN:
+      return &myUsbDevice.ep1in;
+#endif
+#if SLAB_USB_EP1OUT_USED
+    case EP1OUT:
+      return &myUsbDevice.ep1out;
+#endif
+#if SLAB_USB_EP2IN_USED
+    case EP2IN:
+      return &myUsbDevice.ep2in;
+#endif
+#if SLAB_USB_EP2OUT_USED
+    case EP2OUT:
+      return &myUsbDevice.ep2out;
+#endif
+#if SLAB_USB_EP3IN_USED
+    case EP3IN:
+      return &myUsbDevice.ep3in;
+#endif
+#if SLAB_USB_EP3OUT_USED
+    case EP3OUT:
+      return &myUsbDevice.ep3out;
+#endif
+    default:
+      return 0;
+  }
+}
+
+static uint16_t getMaxPacketSize(uint8_t epAddr)
+{
+  switch (epAddr)
+  {
+    case EP1IN:
+      return SLAB_USB_EP1IN_MAX_PACKET_SIZE;
+    case EP1OUT:
+      return SLAB_USB_EP1OUT_MAX_PACKET_SIZE;
+    case EP2IN:
+      return SLAB_USB_EP2IN_MAX_PACKET_SIZE;
+    case EP2OUT:
+      return SLAB_USB_EP2OUT_MAX_PACKET_SIZE;
+    case EP3IN:
+      return SLAB_USB_EP3IN_MAX_PACKET_SIZE;
+    case EP3OUT:
+      return SLAB_USB_EP3OUT_MAX_PACKET_SIZE;
+    default:
+      return USB_EP0_SIZE;
+  }
+}
+
+static void setUsbState(uint8_t newState)
+{
+  uint8_t oldState = myUsbDevice.state;
+
+  if (newState != oldState)
+  {
+    myUsbDevice.state = newState;
+#if SLAB_USB_STATE_CHANGE_CB
+    USBD_DeviceStateChangeCb(oldState, newState);
+#endif
+  }
+}
+
+// Ends the transfer on an endpoint. This is the last thing each handler
+// does, since the callback may start a transfer on any endpoint.
+static void completeTransfer(uint8_t epAddr, EpPointer ep, int8_t status)
+{
+  uint8_t flags = ep->flags;
+
+  ep->state = D_EP_IDLE;
+  ep->flags = 0;
+  if (flags & EP_CALLBACK)
+  {
+    USBD_XferCompleteCb(epAddr, status, ep->xferred, ep->remaining);
+  }
+}
+
+// Empties an IN FIFO, both halves if double buffered. INDEX is selected.
+static void flushInFifo(void)
+{
+  writeReg(EINCSRL, EINCSRL_FLUSH__SET);
+  writeReg(EINCSRL, EINCSRL_FLUSH__SET);
+}
+
+#if OUT_EP_INTERRUPTS
+// Empties an OUT FIFO and resets the data toggle. INDEX is selected.
+static void flushOutFifo(void)
+{
+  writeReg(EOUTCSRL, EOUTCSRL_FLUSH__SET);
+  writeReg(EOUTCSRL, EOUTCSRL_FLUSH__SET | EOUTCSRL_CLRDT__BMASK);
+}
+#endif
+
+// -----------------------------------------------------------------------------
+// Endpoint 0
+
+// Loads the next packet of an EP0 IN data stage. INDEX is 0.
+static void loadEp0Fifo(void)
+{
+  EpPointer ep = &myUsbDevice.ep0;
+  uint8_t count = (uint8_t)EFM8_MIN(ep->remaining, USB_EP0_SIZE);
+  uint8_t csr = E0CSR_INPRDY__SET;
+  uint8_t i, k;
+
+  if (ep->flags & EP_PACKED)
+  {
+    // bLength, the descriptor type, then each character as UTF-16LE
+    k = (uint8_t)ep->xferred;
+    for (i = count; i; i--, k++)
+    {
+      if (k == 0)
+      {
+        writeReg(FIFO0, ep->buf[0]);
+      }
+      else if (k == 1)
+      {
+        writeReg(FIFO0, USB_STRING_DESCRIPTOR);
+      }
+      else
+      {
+        writeReg(FIFO0, (k & 1) ? 0 : ep->buf[1 + (k >> 1)]);
+      }
+    }
+  }
+  else
+  {
+    Fifo_Write(FIFO0, count, ep->buf);
+    ep->buf += count;
+  }
+  ep->remaining -= count;
+  ep->xferred += count;
+
+  if ((count < USB_EP0_SIZE)
+      || ((ep->remaining == 0) && !(ep->flags & EP_ZLP)))
+  {
+    writeReg(E0CSR, csr | E0CSR_DATAEND__SET);
+    completeTransfer(EP0, ep, USB_STATUS_OK);
+  }
+  else
+  {
+    writeReg(E0CSR, csr);
+  }
+}
+
+// Unloads a packet of an EP0 OUT data stage. INDEX is 0.
+static void unloadEp0Fifo(void)
+{
+  EpPointer ep = &myUsbDevice.ep0;
+  uint8_t count = readReg(E0CNT);
+  uint8_t n = (uint8_t)EFM8_MIN(count, ep->remaining);
+
+  Fifo_Read(FIFO0, n, ep->buf);
+  ep->buf += n;
+  ep->remaining -= n;
+  ep->xferred += n;
+
+  if ((ep->remaining == 0) || (count < USB_EP0_SIZE))
+  {
+    writeReg(E0CSR, E0CSR_SOPRDY__SET | E0CSR_DATAEND__SET);
+    completeTransfer(EP0, ep, USB_STATUS_OK);
+  }
+  else
+  {
+    writeReg(E0CSR, E0CSR_SOPRDY__SET);
+  }
+}
+
+static int8_t handleStandardRequest(void);
+
+static void handleSetup(void)
+{
+  EpPointer ep = &myUsbDevice.ep0;
+  int8_t status = USB_STATUS_REQ_UNHANDLED;
+
+  Fifo_Read(FIFO0, USB_SETUP_PKT_SIZE, (uint8_t *)&setup);
+  setup.wValue = le16toh(setup.wValue);
+  setup.wIndex = le16toh(setup.wIndex);
+  setup.wLength = le16toh(setup.wLength);
+
+#if SLAB_USB_SETUP_CMD_CB
+  status = USBD_SetupCmdCb(&setup);
+#endif
+  if ((status == USB_STATUS_REQ_UNHANDLED)
+      && (setup.bmRequestType.Type == USB_SETUP_TYPE_STANDARD))
+  {
+    status = handleStandardRequest();
+  }
+
+  // The handlers may have selected another endpoint
+  writeReg(INDEX, 0);
+
+  if (status != USB_STATUS_OK)
+  {
+    // Abandon a data stage the handler started before failing
+    ep->state = D_EP_IDLE;
+    ep->flags = 0;
+    writeReg(E0CSR, E0CSR_SOPRDY__SET | E0CSR_SDSTL__SET);
+  }
+  else if (setup.wLength == 0)
+  {
+    writeReg(E0CSR, E0CSR_SOPRDY__SET | E0CSR_DATAEND__SET);
+    if (ep->state != D_EP_IDLE)
+    {
+      completeTransfer(EP0, ep, USB_STATUS_OK);
+    }
+  }
+  else if (ep->state == D_EP_TRANSMITTING)
+  {
+    writeReg(E0CSR, E0CSR_SOPRDY__SET);
+    loadEp0Fifo();
+  }
+  else if (ep->state == D_EP_RECEIVING)
+  {
+    writeReg(E0CSR, E0CSR_SOPRDY__SET);
+  }
+  else
+  {
+    // The request has a data stage, but the handler did not start it
+    writeReg(E0CSR, E0CSR_SOPRDY__SET | E0CSR_SDSTL__SET);
+  }
+}
+
+static void handleEp0(void)
+{
+  EpPointer ep = &myUsbDevice.ep0;
+  uint8_t csr;
+
+  writeReg(INDEX, 0);
+  csr = readReg(E0CSR);
+
+  if (csr & E0CSR_STSTL__SET)
+  {
+    // A stall was sent; the control transfer is over
+    writeReg(E0CSR, 0);
+    ep->state = D_EP_IDLE;
+    ep->flags = 0;
+    return;
+  }
+
+  if (csr & E0CSR_SUEND__SET)
+  {
+    // The host ended the control transfer early
+    writeReg(E0CSR, E0CSR_SSUEND__SET);
+    if (ep->state != D_EP_IDLE)
+    {
+      completeTransfer(EP0, ep, USB_STATUS_EP_ABORTED);
+      writeReg(INDEX, 0);
+    }
+  }
+
+  if (ep->state == D_EP_TRANSMITTING)
+  {
+    if (!(csr & E0CSR_INPRDY__SET))
+    {
+      loadEp0Fifo();
+    }
+  }
+  else if (csr & E0CSR_OPRDY__SET)
+  {
+    if (ep->state == D_EP_RECEIVING)
+    {
+      unloadEp0Fifo();
+    }
+    else
+    {
+      handleSetup();
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Endpoints 1-3
+
+// Loads IN packets while the FIFO has room: one packet, or two if double
+// buffered. INDEX is selected.
+static void loadInFifo(uint8_t epAddr, EpPointer ep)
+{
+  uint16_t maxPacketSize = getMaxPacketSize(epAddr);
+  uint16_t count;
+
+  while (!(ep->flags & EP_LOADED)
+         && !(readReg(EINCSRL) & EINCSRL_INPRDY__SET))
+  {
+    count = EFM8_MIN(ep->remaining, maxPacketSize);
+    writeFifo(FIFO0 + (epAddr & 0x7F), ep->buf, count);
+    ep->buf += count;
+    ep->remaining -= count;
+    ep->xferred += count;
+    if (ep->remaining == 0)
+    {
+      ep->flags |= EP_LOADED;
+    }
+    writeReg(EINCSRL, EINCSRL_INPRDY__SET);
+  }
+}
+
+static void handleInEp(uint8_t epAddr)
+{
+  EpPointer ep = getEp(epAddr);
+  uint8_t csr;
+
+  writeReg(INDEX, epAddr & 0x7F);
+  csr = readReg(EINCSRL);
+
+  if (csr & EINCSRL_STSTL__SET)
+  {
+    // Clear the flag and keep stalling
+    writeReg(EINCSRL, EINCSRL_SDSTL__SET);
+    return;
+  }
+
+  if (ep->state != D_EP_TRANSMITTING)
+  {
+    return;
+  }
+
+  if (!(ep->flags & EP_LOADED))
+  {
+    loadInFifo(epAddr, ep);
+  }
+  else if (!(csr & (EINCSRL_INPRDY__SET | EINCSRL_FIFONE__NOT_EMPTY)))
+  {
+    // The host has taken the last packet
+    completeTransfer(epAddr, ep, USB_STATUS_OK);
+  }
+}
+
+#if OUT_EP_INTERRUPTS
+// Unloads received packets into the transfer buffer: one packet, or two if
+// double buffered. The transfer ends on a short packet or a full buffer.
+// Bytes of a packet that do not fit the buffer are dropped.
+static void handleOutEp(uint8_t epAddr)
+{
+  EpPointer ep = getEp(epAddr);
+  uint16_t maxPacketSize = getMaxPacketSize(epAddr);
+  uint16_t count, n;
+  uint8_t csr;
+
+  writeReg(INDEX, epAddr);
+  csr = readReg(EOUTCSRL);
+
+  if (csr & EOUTCSRL_STSTL__SET)
+  {
+    writeReg(EOUTCSRL, EOUTCSRL_SDSTL__SET);
+    return;
+  }
+
+  while ((csr & EOUTCSRL_OPRDY__SET) && (ep->state == D_EP_RECEIVING))
+  {
+    count = readReg(EOUTCNTL) | ((uint16_t)readReg(EOUTCNTH) << 8);
+    n = EFM8_MIN(count, ep->remaining);
+    readFifo(FIFO0 + epAddr, ep->buf, n);
+    ep->buf += n;
+    ep->remaining -= n;
+    ep->xferred += n;
+
+    // Release the packet
+    writeReg(EOUTCSRL, 0);
+
+    if ((count < maxPacketSize) || (ep->remaining == 0))
+    {
+      completeTransfer(epAddr, ep, (count > n)
+                                   ? USB_STATUS_EP_RX_BUFFER_OVERRUN
+                                   : USB_STATUS_OK);
+
+      // The callback may have started the next transfer, and selected
+      // another endpoint
+      writeReg(INDEX, epAddr);
+    }
+    csr = readReg(EOUTCSRL);
+  }
+}
+#endif
+
+// Resets endpoints 1-3 to their configured mode. In the addressed state
+// they are left disabled.
+static void resetEndpoints(bool enable)
+{
+  uint8_t state = enable ? D_EP_IDLE : D_EP_DISABLED;
+
+  UNREFERENCED_ARGUMENT(state);
+
+#if SLAB_USB_EP1IN_USED || SLAB_USB_EP1OUT_USED
+  writeReg(INDEX, 1);
+  writeReg(EINCSRH, EP_EINCSRH(1));
+  writeReg(EOUTCSRH, EP_EOUTCSRH(1));
+#if SLAB_USB_EP1IN_USED
+  flushInFifo();
+  writeReg(EINCSRL, EINCSRL_CLRDT__BMASK);
+  myUsbDevice.ep1in.state = state;
+#endif
+#if SLAB_USB_EP1OUT_USED
+  flushOutFifo();
+  myUsbDevice.ep1out.state = state;
+#endif
+#endif
+
+#if SLAB_USB_EP2IN_USED || SLAB_USB_EP2OUT_USED
+  writeReg(INDEX, 2);
+  writeReg(EINCSRH, EP_EINCSRH(2));
+  writeReg(EOUTCSRH, EP_EOUTCSRH(2));
+#if SLAB_USB_EP2IN_USED
+  flushInFifo();
+  writeReg(EINCSRL, EINCSRL_CLRDT__BMASK);
+  myUsbDevice.ep2in.state = state;
+#endif
+#if SLAB_USB_EP2OUT_USED
+  flushOutFifo();
+  myUsbDevice.ep2out.state = state;
+#endif
+#endif
+
+#if SLAB_USB_EP3IN_USED || SLAB_USB_EP3OUT_USED
+  writeReg(INDEX, 3);
+  writeReg(EINCSRH, EP_EINCSRH(3));
+  writeReg(EOUTCSRH, EP_EOUTCSRH(3));
+#if SLAB_USB_EP3IN_USED
+  flushInFifo();
+  writeReg(EINCSRL, EINCSRL_CLRDT__BMASK);
+  myUsbDevice.ep3in.state = state;
+#endif
+#if SLAB_USB_EP3OUT_USED
+  flushOutFifo();
+  myUsbDevice.ep3out.state = state;
+#endif
+#endif
+}
+
+// -----------------------------------------------------------------------------
+// Standard requests
+
+static bool isSelfPowered(void)
+{
+#if SLAB_USB_IS_SELF_POWERED_CB
+  return USBD_IsSelfPoweredCb();
+#else
+  return !SLAB_USB_BUS_POWERED;
+#endif
+}
+
+static int8_t getStatus(void)
+{
+  EpPointer ep;
+  int8_t status = USB_STATUS_REQ_ERR;
+
+  if ((setup.wValue != 0) || (setup.wLength != 2)
+      || (setup.bmRequestType.Direction != USB_SETUP_DIR_IN))
+  {
+    return status;
+  }
+
+  myUsbDevice.ep0Buf[0] = 0;
+  myUsbDevice.ep0Buf[1] = 0;
+
+  switch (setup.bmRequestType.Recipient)
+  {
+    case USB_SETUP_RECIPIENT_DEVICE:
+      if (setup.wIndex == 0)
+      {
+        if (isSelfPowered())
+        {
+          myUsbDevice.ep0Buf[0] |= 0x01;
+        }
+        if (myUsbDevice.remoteWakeupEnabled)
+        {
+          myUsbDevice.ep0Buf[0] |= 0x02;
+        }
+        status = USB_STATUS_OK;
+      }
+      break;
+
+    case USB_SETUP_RECIPIENT_INTERFACE:
+      if ((myUsbDevice.state == USBD_STATE_CONFIGURED)
+          && (setup.wIndex < SLAB_USB_NUM_INTERFACES))
+      {
+        status = USB_STATUS_OK;
+      }
+      break;
+
+    case USB_SETUP_RECIPIENT_ENDPOINT:
+      ep = getEp((uint8_t)setup.wIndex);
+      if ((ep != 0) && (setup.wIndex < 0x100)
+          && (((setup.wIndex & 0x7F) == 0)
+              || (myUsbDevice.state == USBD_STATE_CONFIGURED)))
+      {
+        if (ep->state == D_EP_HALT)
+        {
+          myUsbDevice.ep0Buf[0] = 0x01;
+        }
+        status = USB_STATUS_OK;
+      }
+      break;
+  }
+
+  if (status == USB_STATUS_OK)
+  {
+    USBD_Write(EP0, myUsbDevice.ep0Buf, 2, false);
+  }
+  return status;
+}
+
+static int8_t setClearFeature(bool set)
+{
+  uint8_t epAddr = (uint8_t)setup.wIndex;
+
+  if ((setup.wLength != 0)
+      || (setup.bmRequestType.Direction != USB_SETUP_DIR_OUT))
+  {
+    return USB_STATUS_REQ_ERR;
+  }
+
+  switch (setup.bmRequestType.Recipient)
+  {
+#if SLAB_USB_REMOTE_WAKEUP_ENABLED
+    case USB_SETUP_RECIPIENT_DEVICE:
+      if ((setup.wValue == USB_FEATURE_DEVICE_REMOTE_WAKEUP)
+          && (setup.wIndex == 0))
+      {
+        myUsbDevice.remoteWakeupEnabled = set;
+        return USB_STATUS_OK;
+      }
+      break;
+#endif
+
+    case USB_SETUP_RECIPIENT_ENDPOINT:
+      if ((setup.wValue == USB_FEATURE_ENDPOINT_HALT)
+          && (setup.wIndex < 0x100)
+          && ((epAddr & 0x7F) != 0)
+          && (myUsbDevice.state == USBD_STATE_CONFIGURED))
+      {
+        return set ? USBD_StallEp(epAddr) : USBD_UnStallEp(epAddr);
+      }
+      break;
+  }
+
+  return USB_STATUS_REQ_ERR;
+}
+
+static int8_t setAddress(void)
+{
+  if ((setup.bmRequestType.Recipient != USB_SETUP_RECIPIENT_DEVICE)
+      || (setup.wValue >= 128) || (setup.wIndex != 0) || (setup.wLength != 0)
+      || (myUsbDevice.state > USBD_STATE_ADDRESSED)
+      || (myUsbDevice.state < USBD_STATE_DEFAULT))
+  {
+    return USB_STATUS_REQ_ERR;
+  }
+
+  // USB0 applies the new address once the status stage is over
+  writeReg(FADDR, (uint8_t)setup.wValue);
+  setUsbState(setup.wValue ? USBD_STATE_ADDRESSED : USBD_STATE_DEFAULT);
+  return USB_STATUS_OK;
+}
+
+static int8_t getDescriptor(void)
+{
+  SI_VARIABLE_SEGMENT_POINTER(dat, const uint8_t, SI_SEG_GENERIC) = 0;
+  uint8_t index = (uint8_t)setup.wValue;
+  uint16_t length = 0;
+  bool packed = false;
+
+  if (setup.bmRequestType.Direction != USB_SETUP_DIR_IN)
+  {
+    return USB_STATUS_REQ_ERR;
+  }
+
+  switch (setup.wValue >> 8)
+  {
+    case USB_DEVICE_DESCRIPTOR:
+      if (index == 0)
+      {
+        dat = (const uint8_t *)myUsbDevice.init->deviceDescriptor;
+        length = USB_DEVICE_DESCSIZE;
+      }
+      break;
+
+    case USB_CONFIG_DESCRIPTOR:
+      if (index == 0)
+      {
+        dat = myUsbDevice.init->configDescriptor;
+        length = dat[2] | ((uint16_t)dat[3] << 8);
+      }
+      break;
+
+    case USB_STRING_DESCRIPTOR:
+      if (index < myUsbDevice.init->numberOfStrings)
+      {
+        dat = myUsbDevice.init->stringDescriptors[index];
+        length = dat[0];
+        packed = (dat[1] == USB_STRING_DESCRIPTOR_UTF16LE_PACKED);
+      }
+      break;
+  }
+
+  if (dat == 0)
+  {
+    return USB_STATUS_REQ_ERR;
+  }
+
+  USBD_Write(EP0, dat, length, false);
+  if (packed)
+  {
+    myUsbDevice.ep0.flags |= EP_PACKED;
+  }
+  return USB_STATUS_OK;
+}
+
+static int8_t getConfiguration(void)
+{
+  if ((setup.bmRequestType.Recipient != USB_SETUP_RECIPIENT_DEVICE)
+      || (setup.wValue != 0) || (setup.wIndex != 0) || (setup.wLength != 1)
+      || (setup.bmRequestType.Direction != USB_SETUP_DIR_IN)
+      || (myUsbDevice.state < USBD_STATE_ADDRESSED))
+  {
+    return USB_STATUS_REQ_ERR;
+  }
+
+  myUsbDevice.ep0Buf[0] = myUsbDevice.configurationValue;
+  USBD_Write(EP0, myUsbDevice.ep0Buf, 1, false);
+  return USB_STATUS_OK;
+}
+
+static int8_t setConfiguration(void)
+{
+  uint8_t value = (uint8_t)setup.wValue;
+
+  if ((setup.bmRequestType.Recipient != USB_SETUP_RECIPIENT_DEVICE)
+      || (setup.wIndex != 0) || (setup.wLength != 0)
+      || (myUsbDevice.state < USBD_STATE_ADDRESSED))
+  {
+    return USB_STATUS_REQ_ERR;
+  }
+
+  if (value == 0)
+  {
+    USBD_AbortAllTransfers();
+    resetEndpoints(false);
+    myUsbDevice.configurationValue = 0;
+    setUsbState(USBD_STATE_ADDRESSED);
+    return USB_STATUS_OK;
+  }
+
+  // bConfigurationValue of the one configuration
+  if (value == myUsbDevice.init->configDescriptor[5])
+  {
+    USBD_AbortAllTransfers();
+    resetEndpoints(true);
+    myUsbDevice.configurationValue = value;
+#if SLAB_USB_SUPPORT_ALT_INTERFACES
+    for (value = 0; value < SLAB_USB_NUM_INTERFACES; value++)
+    {
+      myUsbDevice.altSetting[value] = 0;
+    }
+#endif
+    setUsbState(USBD_STATE_CONFIGURED);
+    return USB_STATUS_OK;
+  }
+
+  return USB_STATUS_REQ_ERR;
+}
+
+static int8_t getInterface(void)
+{
+  if ((setup.bmRequestType.Recipient != USB_SETUP_RECIPIENT_INTERFACE)
+      || (setup.wValue != 0) || (setup.wLength != 1)
+      || (setup.wIndex >= SLAB_USB_NUM_INTERFACES)
+      || (setup.bmRequestType.Direction != USB_SETUP_DIR_IN)
+      || (myUsbDevice.state != USBD_STATE_CONFIGURED))
+  {
+    return USB_STATUS_REQ_ERR;
+  }
+
+#if SLAB_USB_SUPPORT_ALT_INTERFACES
+  myUsbDevice.ep0Buf[0] = myUsbDevice.altSetting[setup.wIndex];
+#else
+  myUsbDevice.ep0Buf[0] = 0;
+#endif
+  USBD_Write(EP0, myUsbDevice.ep0Buf, 1, false);
+  return USB_STATUS_OK;
+}
+
+static int8_t setInterface(void)
+{
+  int8_t status = USB_STATUS_REQ_ERR;
+
+  if ((setup.bmRequestType.Recipient != USB_SETUP_RECIPIENT_INTERFACE)
+      || (setup.wLength != 0) || (setup.wValue >= 0x100)
+      || (setup.wIndex >= SLAB_USB_NUM_INTERFACES)
+      || (myUsbDevice.state != USBD_STATE_CONFIGURED))
+  {
+    return status;
+  }
+
+#if SLAB_USB_SUPPORT_ALT_INTERFACES
+  status = USBD_SetInterfaceCb((uint8_t)setup.wIndex, (uint8_t)setup.wValue);
+  if (status == USB_STATUS_OK)
+  {
+    myUsbDevice.altSetting[setup.wIndex] = (uint8_t)setup.wValue;
+  }
+#else
+  if (setup.wValue == 0)
+  {
+    status = USB_STATUS_OK;
+  }
+#endif
+  return status;
+}
+
+static int8_t handleStandardRequest(void)
+{
+  switch (setup.bRequest)
+  {
+    case GET_STATUS:
+      return getStatus();
+
+    case CLEAR_FEATURE:
+      return setClearFeature(false);
+
+    case SET_FEATURE:
+      return setClearFeature(true);
+
+    case SET_ADDRESS:
+      return setAddress();
+
+    case GET_DESCRIPTOR:
+      return getDescriptor();
+
+    case GET_CONFIGURATION:
+      return getConfiguration();
+
+    case SET_CONFIGURATION:
+      return setConfiguration();
+
+    case GET_INTERFACE:
+      return getInterface();
+
+    case SET_INTERFACE:
+      return setInterface();
+
+    default:
+      return USB_STATUS_REQ_ERR;
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Bus events
+
+static void handleReset(void)
+{
+  USBD_AbortAllTransfers();
+  resetEndpoints(false);
+  myUsbDevice.configurationValue = 0;
+  myUsbDevice.remoteWakeupEnabled = false;
+
+  // A bus reset enables every endpoint interrupt and disables the suspend
+  // interrupt; restore the configured set, and keep suspend detection on
+  writeReg(IN1IE, IN_EP_INTERRUPTS);
+  writeReg(OUT1IE, OUT_EP_INTERRUPTS);
+  writeReg(CMIE, COMMON_INTERRUPTS);
+  writeReg(POWER, POWER_SUSEN__ENABLED);
+
+#if SLAB_USB_RESET_CB
+  USBD_ResetCb();
+#endif
+  setUsbState(USBD_STATE_DEFAULT);
+}
+
+static void handleSuspend(void)
+{
+  if (myUsbDevice.state != USBD_STATE_SUSPENDED)
+  {
+    myUsbDevice.savedState = myUsbDevice.state;
+    setUsbState(USBD_STATE_SUSPENDED);
+  }
+}
+
+static void handleResume(void)
+{
+  if (myUsbDevice.state == USBD_STATE_SUSPENDED)
+  {
+    setUsbState(myUsbDevice.savedState);
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Interrupt handler
+
+SI_INTERRUPT(usbIrqHandler, USB0_IRQn)
+{
+  uint8_t cmint, in1int;
+#if OUT_EP_INTERRUPTS
+  uint8_t out1int;
+#endif
+
+#if SLAB_USB_HANDLER_CB
+  USBD_EnterHandler();
+#endif
+
+  // Reading the flags clears them
+  cmint = readReg(CMINT);
+  in1int = readReg(IN1INT);
+#if OUT_EP_INTERRUPTS
+  out1int = readReg(OUT1INT);
+#endif
+
+  if (cmint & CMINT_RSUINT__SET)
+  {
+    handleResume();
+  }
+
+  if (cmint & CMINT_RSTINT__SET)
+  {
+    // A reset cancels any endpoint events read with it
+    handleReset();
+    in1int = 0;
+#if OUT_EP_INTERRUPTS
+    out1int = 0;
+#endif
+  }
+
+#if SOF_USED
+  if (cmint & CMINT_SOF__SET)
+  {
+#if SLAB_USB_SOF_CB
+    USBD_SofCb(readReg(FRAMEL) | ((uint16_t)readReg(FRAMEH) << 8));
+#endif
+#if SLAB_USB_EP1OUT_USED
+    if (myUsbDevice.ep1out.state == D_EP_RECEIVING)
+    {
+      handleOutEp(EP1OUT);
+    }
+#endif
+#if SLAB_USB_EP2OUT_USED
+    if (myUsbDevice.ep2out.state == D_EP_RECEIVING)
+    {
+      handleOutEp(EP2OUT);
+    }
+#endif
+#if SLAB_USB_EP3OUT_USED
+    if (myUsbDevice.ep3out.state == D_EP_RECEIVING)
+    {
+      handleOutEp(EP3OUT);
+    }
+#endif
+  }
+#endif
+
+  if (in1int & IN1INT_EP0__SET)
+  {
+    handleEp0();
+  }
+
+#if SLAB_USB_EP1IN_USED
+  if (in1int & IN1INT_IN1__SET)
+  {
+    handleInEp(EP1IN);
+  }
+#endif
+#if SLAB_USB_EP2IN_USED
+  if (in1int & IN1INT_IN2__SET)
+  {
+    handleInEp(EP2IN);
+  }
+#endif
+#if SLAB_USB_EP3IN_USED
+  if (in1int & IN1INT_IN3__SET)
+  {
+    handleInEp(EP3IN);
+  }
+#endif
+
+#if SLAB_USB_EP1OUT_USED
+  if (out1int & OUT1INT_OUT1__SET)
+  {
+    handleOutEp(EP1OUT);
+  }
+#endif
+#if SLAB_USB_EP2OUT_USED
+  if (out1int & OUT1INT_OUT2__SET)
+  {
+    handleOutEp(EP2OUT);
+  }
+#endif
+#if SLAB_USB_EP3OUT_USED
+  if (out1int & OUT1INT_OUT3__SET)
+  {
+    handleOutEp(EP3OUT);
+  }
+#endif
+
+  if (cmint & CMINT_SUSINT__SET)
+  {
+    handleSuspend();
+  }
+
+#if SLAB_USB_HANDLER_CB
+  USBD_ExitHandler();
+#endif
+}
+
+// -----------------------------------------------------------------------------
+// API
+
+int8_t USBD_Init(SI_VARIABLE_SEGMENT_POINTER(p, const USBD_Init_TypeDef,
+                                             SI_SEG_GENERIC))
+{
+  uint8_t i;
+  uint8_t SI_SEG_XDATA * dev = (uint8_t SI_SEG_XDATA *)&myUsbDevice;
+
+  EIE1 &= ~EIE1_EUSB0__BMASK;
+
+  for (i = 0; i < sizeof(myUsbDevice); i++)
+  {
+    dev[i] = 0;
+  }
+  myUsbDevice.init = p;
+  myUsbDevice.ep0.state = D_EP_IDLE;
+
+  // Reset USB0, then enable the interrupts the configuration needs
+  writeReg(POWER, POWER_USBRST__SET);
+  writeReg(IN1IE, IN_EP_INTERRUPTS);
+  writeReg(OUT1IE, OUT_EP_INTERRUPTS);
+  writeReg(CMIE, COMMON_INTERRUPTS);
+
+  USB0XCN = USB0XCN_PREN__PULL_UP_ENABLED | USB0XCN_PHYEN__ENABLED
+            | USB0XCN_SPEED;
+  writeReg(CLKREC, CLKREC_VALUE);
+
+  EIE1 |= EIE1_EUSB0__ENABLED;
+
+  // Enable suspend detection; this also releases the USB0 inhibit
+  writeReg(POWER, POWER_SUSEN__ENABLED);
+
+  setUsbState(USBD_STATE_POWERED);
+  return USB_STATUS_OK;
+}
+
+void USBD_Connect(void)
+{
+  USB0XCN |= USB0XCN_PREN__PULL_UP_ENABLED;
+}
+
+void USBD_Disconnect(void)
+{
+  USB0XCN &= ~USB0XCN_PREN__BMASK;
+}
+
+void USBD_Stop(void)
+{
+  USBD_Disconnect();
+  EIE1 &= ~EIE1_EUSB0__BMASK;
+  USBD_AbortAllTransfers();
+  writeReg(POWER, POWER_USBINH__DISABLED);
+  USB0XCN = 0;
+  setUsbState(USBD_STATE_NONE);
+}
+
+int8_t USBD_Write(uint8_t epAddr,
+                  SI_VARIABLE_SEGMENT_POINTER(dat, const uint8_t,
+                                              SI_SEG_GENERIC),
+                  uint16_t byteCount,
+                  bool callback)
+{
+  EpPointer ep = getEp(epAddr);
+  bool usbIntsEnabled;
+
+  if ((ep == 0) || ((epAddr != EP0) && !(epAddr & USB_EP_DIR_IN)))
+  {
+    return USB_STATUS_ILLEGAL;
+  }
+  if (epAddr != EP0)
+  {
+    if (myUsbDevice.state != USBD_STATE_CONFIGURED)
+    {
+      return USB_STATUS_DEVICE_UNCONFIGURED;
+    }
+    if (ep->state == D_EP_HALT)
+    {
+      return USB_STATUS_EP_STALLED;
+    }
+  }
+  if (ep->state != D_EP_IDLE)
+  {
+    return USB_STATUS_EP_BUSY;
+  }
+
+  ep->buf = (uint8_t *)dat;
+  ep->remaining = byteCount;
+  ep->xferred = 0;
+  ep->flags = callback ? EP_CALLBACK : 0;
+  ep->state = D_EP_TRANSMITTING;
+
+  if (epAddr == EP0)
+  {
+    // The data stage starts once the setup packet has been serviced
+    if (byteCount >= setup.wLength)
+    {
+      ep->remaining = setup.wLength;
+    }
+    else
+    {
+      ep->flags |= EP_ZLP;
+    }
+    return USB_STATUS_OK;
+  }
+
+  usbIntsEnabled = EIE1 & EIE1_EUSB0__BMASK;
+  EIE1 &= ~EIE1_EUSB0__BMASK;
+
+  writeReg(INDEX, epAddr & 0x7F);
+  loadInFifo(epAddr, ep);
+
+  if (usbIntsEnabled)
+  {
+    EIE1 |= EIE1_EUSB0__ENABLED;
+  }
+  return USB_STATUS_OK;
+}
+
+int8_t USBD_Read(uint8_t epAddr,
+                 SI_VARIABLE_SEGMENT_POINTER(dat, uint8_t, SI_SEG_GENERIC),
+                 uint16_t byteCount,
+                 bool callback)
+{
+  EpPointer ep = getEp(epAddr);
+
+  if ((ep == 0) || (epAddr & USB_EP_DIR_IN))
+  {
+    return USB_STATUS_ILLEGAL;
+  }
+  if (epAddr != EP0)
+  {
+    if (myUsbDevice.state != USBD_STATE_CONFIGURED)
+    {
+      return USB_STATUS_DEVICE_UNCONFIGURED;
+    }
+    if (ep->state == D_EP_HALT)
+    {
+      return USB_STATUS_EP_STALLED;
+    }
+  }
+  if (ep->state != D_EP_IDLE)
+  {
+    return USB_STATUS_EP_BUSY;
+  }
+
+  ep->buf = dat;
+  ep->remaining = byteCount;
+  ep->xferred = 0;
+  ep->flags = callback ? EP_CALLBACK : 0;
+  ep->state = D_EP_RECEIVING;
+
+  if (epAddr == EP0)
+  {
+    ep->remaining = EFM8_MIN(byteCount, setup.wLength);
+    return USB_STATUS_OK;
+  }
+
+  // A packet that arrived while the endpoint was idle is taken at the next
+  // start of frame; the host is NAK'd while the FIFO is full
+  return USB_STATUS_OK;
+}
+
+void USBD_AbortTransfer(uint8_t epAddr)
+{
+  EpPointer ep = getEp(epAddr);
+  bool usbIntsEnabled;
+
+  if ((ep == 0)
+      || ((ep->state != D_EP_TRANSMITTING) && (ep->state != D_EP_RECEIVING)))
+  {
+    return;
+  }
+
+  usbIntsEnabled = EIE1 & EIE1_EUSB0__BMASK;
+  EIE1 &= ~EIE1_EUSB0__BMASK;
+
+  if ((epAddr & USB_EP_DIR_IN) && (ep->state == D_EP_TRANSMITTING))
+  {
+    writeReg(INDEX, epAddr & 0x7F);
+    flushInFifo();
+  }
+  completeTransfer(epAddr, ep, USB_STATUS_EP_ABORTED);
+
+  if (usbIntsEnabled)
+  {
+    EIE1 |= EIE1_EUSB0__ENABLED;
+  }
+}
+
+void USBD_AbortAllTransfers(void)
+{
+  USBD_AbortTransfer(EP0);
+#if SLAB_USB_EP1IN_USED
+  USBD_AbortTransfer(EP1IN);
+#endif
+#if SLAB_USB_EP1OUT_USED
+  USBD_AbortTransfer(EP1OUT);
+#endif
+#if SLAB_USB_EP2IN_USED
+  USBD_AbortTransfer(EP2IN);
+#endif
+#if SLAB_USB_EP2OUT_USED
+  USBD_AbortTransfer(EP2OUT);
+#endif
+#if SLAB_USB_EP3IN_USED
+  USBD_AbortTransfer(EP3IN);
+#endif
+#if SLAB_USB_EP3OUT_USED
+  USBD_AbortTransfer(EP3OUT);
+#endif
+}
+
+bool USBD_EpIsBusy(uint8_t epAddr)
+{
+  EpPointer ep = getEp(epAddr);
+
+  return (ep != 0)
+         && ((ep->state == D_EP_TRANSMITTING)
+             || (ep->state == D_EP_RECEIVING));
+}
+
+int8_t USBD_StallEp(uint8_t epAddr)
+{
+  EpPointer ep = getEp(epAddr);
+  bool usbIntsEnabled;
+
+  if ((ep == 0) || ((epAddr & 0x7F) == 0))
+  {
+    return USB_STATUS_ILLEGAL;
+  }
+
+  USBD_AbortTransfer(epAddr);
+
+  usbIntsEnabled = EIE1 & EIE1_EUSB0__BMASK;
+  EIE1 &= ~EIE1_EUSB0__BMASK;
+
+  ep->state = D_EP_HALT;
+  writeReg(INDEX, epAddr & 0x7F);
+  if (epAddr & USB_EP_DIR_IN)
+  {
+    writeReg(EINCSRL, EINCSRL_SDSTL__SET);
+  }
+  else
+  {
+    writeReg(EOUTCSRL, EOUTCSRL_SDSTL__SET);
+  }
+
+  if (usbIntsEnabled)
+  {
+    EIE1 |= EIE1_EUSB0__ENABLED;
+  }
+  return USB_STATUS_OK;
+}
+
+int8_t USBD_UnStallEp(uint8_t epAddr)
+{
+  EpPointer ep = getEp(epAddr);
+  bool usbIntsEnabled;
+
+  if ((ep == 0) || ((epAddr & 0x7F) == 0))
+  {
+    return USB_STATUS_ILLEGAL;
+  }
+
+  usbIntsEnabled = EIE1 & EIE1_EUSB0__BMASK;
+  EIE1 &= ~EIE1_EUSB0__BMASK;
+
+  // Clearing the halt always resets the data toggle
+  writeReg(INDEX, epAddr & 0x7F);
+  if (epAddr & USB_EP_DIR_IN)
+  {
+    writeReg(EINCSRL, EINCSRL_CLRDT__BMASK);
+  }
+  else
+  {
+    writeReg(EOUTCSRL, EOUTCSRL_CLRDT__BMASK);
+  }
+  if (ep->state == D_EP_HALT)
+  {
+    ep->state = D_EP_IDLE;
+  }
+
+  if (usbIntsEnabled)
+  {
+    EIE1 |= EIE1_EUSB0__ENABLED;
+  }
+  return USB_STATUS_OK;
+}
+
+USBD_State_TypeDef USBD_GetUsbState(void)
+{
+  return (USBD_State_TypeDef)myUsbDevice.state;
+}
+
+#if SLAB_USB_REMOTE_WAKEUP_ENABLED
+int8_t USBD_RemoteWakeup(void)
+{
+  if ((myUsbDevice.state != USBD_STATE_SUSPENDED)
+      || !myUsbDevice.remoteWakeupEnabled)
+  {
+    return USB_STATUS_ILLEGAL;
+  }
+
+  writeReg(POWER, POWER_SUSEN__ENABLED | POWER_RESUME__START);
+  USBD_RemoteWakeupDelay();
+  writeReg(POWER, POWER_SUSEN__ENABLED);
+
+  // USB0 does not raise a resume interrupt for its own resume signalling
+  handleResume();
+  return USB_STATUS_OK;
+}
+#endif
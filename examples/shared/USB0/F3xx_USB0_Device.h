@@ -0,0 +1,649 @@
+/**************************************************************************//**
+ * Copyright (c) 2015 by Silicon Laboratories Inc. All rights reserved.
+ *
+ * http://developer.silabs.com/legal/version/v11/Silicon_Labs_Software_License_Agreement.txt
+ *****************************************************************************/
+
+#ifndef __F3XX_USB0_DEVICE_H__
+#define __F3XX_USB0_DEVICE_H__
+
+/**************************************************************************//**
+ * @addtogroup f3xx_usb0_device C8051F3xx USB Device Core
+ * @{
+ *
+ * @brief Descriptor table driven USB device stack for the C8051F32x, F34x
+ *   and F38x.
+ *
+ * This module has the same API as the efm8_usb library used by the EFM8UB
+ * examples, so an application written for one builds against the other.
+ * It is configured the same way, through SLAB_USB_* definitions in the
+ * application's usbconfig.h.
+ *
+ * ## Differences from efm8_usb
+ *
+ * - Each endpoint FIFO may be double buffered with
+ *   SLAB_USB_EPnIN_DOUBLE_BUFFERED and SLAB_USB_EPnOUT_DOUBLE_BUFFERED.
+ *   The stack then keeps both halves of the FIFO loaded, so the next packet
+ *   is ready when the host asks for it.
+ * - Only interrupt mode is supported (SLAB_USB_POLLED_MODE must be 0).
+ * - Only one string descriptor language is supported.
+ * - SLAB_USB_PWRSAVE_MODE is accepted but ignored; the application handles
+ *   suspend in USBD_DeviceStateChangeCb().
+ *
+ * ## Building
+ *
+ * The stack copies packets with the F3xx_USB0_Fifo routines, so the project
+ * builds F3xx_USB0_Fifo.c as well. Add a source file that includes the
+ * device header and then this module, as for the FIFO module:
+ *
+ * @code
+ * #include "SI_C8051F340_Register_Enums.h"
+ * #include "../../../../shared/USB0/F3xx_USB0_Device.c"
+ * @endcode
+ *
+ * The application supplies usbconfig.h on its include path, the
+ * USBD_Init_TypeDef with its descriptors, and the callbacks it enabled.
+ * USBD_XferCompleteCb() is always required.
+ *
+ * ## Transfers
+ *
+ * USBD_Read() and USBD_Write() move data directly between the endpoint
+ * FIFO and the application's buffer, which must stay valid until the
+ * transfer completes. Descriptors and other constant data are sent
+ * straight from code space.
+ *
+ * The stack's functions are not reentrant. Call USBD_Read(), USBD_Write()
+ * and the other API functions either from the USB callbacks (which run in
+ * the USB0 ISR) or from the foreground, not both, unless the foreground
+ * call is made with the USB0 interrupt disabled.
+ *****************************************************************************/
+
+#include <si_toolchain.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <endian.h>
+#include "usbconfig.h"
+
+// -----------------------------------------------------------------------------
+// Configuration defaults
+
+#ifndef SLAB_USB_BUS_POWERED
+#define SLAB_USB_BUS_POWERED                   1
+#endif
+#ifndef SLAB_USB_FULL_SPEED
+#define SLAB_USB_FULL_SPEED                    1
+#endif
+#ifndef SLAB_USB_CLOCK_RECOVERY_ENABLED
+#define SLAB_USB_CLOCK_RECOVERY_ENABLED        1
+#endif
+#ifndef SLAB_USB_REMOTE_WAKEUP_ENABLED
+#define SLAB_USB_REMOTE_WAKEUP_ENABLED         0
+#endif
+#ifndef SLAB_USB_NUM_INTERFACES
+#define SLAB_USB_NUM_INTERFACES                1
+#endif
+#ifndef SLAB_USB_SUPPORT_ALT_INTERFACES
+#define SLAB_USB_SUPPORT_ALT_INTERFACES        0
+#endif
+#ifndef SLAB_USB_HANDLER_CB
+#define SLAB_USB_HANDLER_CB                    0
+#endif
+#ifndef SLAB_USB_IS_SELF_POWERED_CB
+#define SLAB_USB_IS_SELF_POWERED_CB            0
+#endif
+#ifndef SLAB_USB_RESET_CB
+#define SLAB_USB_RESET_CB                      0
+#endif
+#ifndef SLAB_USB_SETUP_CMD_CB
+#define SLAB_USB_SETUP_CMD_CB                  0
+#endif
+#ifndef SLAB_USB_SOF_CB
+#define SLAB_USB_SOF_CB                        0
+#endif
+#ifndef SLAB_USB_STATE_CHANGE_CB
+#define SLAB_USB_STATE_CHANGE_CB               0
+#endif
+#ifndef SLAB_USB_NUM_LANGUAGES
+#define SLAB_USB_NUM_LANGUAGES                 1
+#endif
+#ifndef SLAB_USB_LANGUAGE
+#define SLAB_USB_LANGUAGE                      USB_LANGID_ENUS
+#endif
+#ifndef SLAB_USB_POLLED_MODE
+#define SLAB_USB_POLLED_MODE                   0
+#endif
+
+#ifndef SLAB_USB_EP1IN_USED
+#define SLAB_USB_EP1IN_USED                    0
+#endif
+#ifndef SLAB_USB_EP1IN_MAX_PACKET_SIZE
+#define SLAB_USB_EP1IN_MAX_PACKET_SIZE         64
+#endif
+#ifndef SLAB_USB_EP1IN_TRANSFER_TYPE
+#define SLAB_USB_EP1IN_TRANSFER_TYPE           USB_EPTYPE_BULK
+#endif
+#ifndef SLAB_USB_EP1OUT_USED
+#define SLAB_USB_EP1OUT_USED                   0
+#endif
+#ifndef SLAB_USB_EP1OUT_MAX_PACKET_SIZE
+#define SLAB_USB_EP1OUT_MAX_PACKET_SIZE        64
+#endif
+#ifndef SLAB_USB_EP1OUT_TRANSFER_TYPE
+#define SLAB_USB_EP1OUT_TRANSFER_TYPE          USB_EPTYPE_BULK
+#endif
+#ifndef SLAB_USB_EP2IN_USED
+#define SLAB_USB_EP2IN_USED                    0
+#endif
+#ifndef SLAB_USB_EP2IN_MAX_PACKET_SIZE
+#define SLAB_USB_EP2IN_MAX_PACKET_SIZE         64
+#endif
+#ifndef SLAB_USB_EP2IN_TRANSFER_TYPE
+#define SLAB_USB_EP2IN_TRANSFER_TYPE           USB_EPTYPE_BULK
+#endif
+#ifndef SLAB_USB_EP2OUT_USED
+#define SLAB_USB_EP2OUT_USED                   0
+#endif
+#ifndef SLAB_USB_EP2OUT_MAX_PACKET_SIZE
+#define SLAB_USB_EP2OUT_MAX_PACKET_SIZE        64
+#endif
+#ifndef SLAB_USB_EP2OUT_TRANSFER_TYPE
+#define SLAB_USB_EP2OUT_TRANSFER_TYPE          USB_EPTYPE_BULK
+#endif
+#ifndef SLAB_USB_EP3IN_USED
+#define SLAB_USB_EP3IN_USED                    0
+#endif
+#ifndef SLAB_USB_EP3IN_MAX_PACKET_SIZE
+#define SLAB_USB_EP3IN_MAX_PACKET_SIZE         64
+#endif
+#ifndef SLAB_USB_EP3IN_TRANSFER_TYPE
+#define SLAB_USB_EP3IN_TRANSFER_TYPE           USB_EPTYPE_BULK
+#endif
+#ifndef SLAB_USB_EP3OUT_USED
+#define SLAB_USB_EP3OUT_USED                   0
+#endif
+#ifndef SLAB_USB_EP3OUT_MAX_PACKET_SIZE
+#define SLAB_USB_EP3OUT_MAX_PACKET_SIZE        64
+#endif
+#ifndef SLAB_USB_EP3OUT_TRANSFER_TYPE
+#define SLAB_USB_EP3OUT_TRANSFER_TYPE          USB_EPTYPE_BULK
+#endif
+
+#ifndef SLAB_USB_EP1IN_DOUBLE_BUFFERED
+#define SLAB_USB_EP1IN_DOUBLE_BUFFERED         0
+#endif
+#ifndef SLAB_USB_EP1OUT_DOUBLE_BUFFERED
+#define SLAB_USB_EP1OUT_DOUBLE_BUFFERED        0
+#endif
+#ifndef SLAB_USB_EP2IN_DOUBLE_BUFFERED
+#define SLAB_USB_EP2IN_DOUBLE_BUFFERED         0
+#endif
+#ifndef SLAB_USB_EP2OUT_DOUBLE_BUFFERED
+#define SLAB_USB_EP2OUT_DOUBLE_BUFFERED        0
+#endif
+#ifndef SLAB_USB_EP3IN_DOUBLE_BUFFERED
+#define SLAB_USB_EP3IN_DOUBLE_BUFFERED         0
+#endif
+#ifndef SLAB_USB_EP3OUT_DOUBLE_BUFFERED
+#define SLAB_USB_EP3OUT_DOUBLE_BUFFERED        0
+#endif
+
+#if SLAB_USB_POLLED_MODE
+#error "F3xx_USB0_Device: SLAB_USB_POLLED_MODE is not supported"
+#endif
+#if SLAB_USB_NUM_LANGUAGES != 1
+#error "F3xx_USB0_Device: only one string descriptor language is supported"
+#endif
+
+// -----------------------------------------------------------------------------
+// Macros
+
+/// Smaller of two values
+#define EFM8_MIN(a, b)    ((a) < (b) ? (a) : (b))
+/// Larger of two values
+#define EFM8_MAX(a, b)    ((a) > (b) ? (a) : (b))
+
+/// Silences unused parameter warnings
+#define UNREFERENCED_ARGUMENT(arg)    (void)arg
+
+/// Memory segment of the stack's state and of the setup packet pointer
+/// passed to USBD_SetupCmdCb()
+#if defined(__C51__) && (__MODEL__ == 2)
+#define MEM_MODEL_SEG    SI_SEG_XDATA
+#elif defined(__C51__) && (__MODEL__ == 1)
+#define MEM_MODEL_SEG    SI_SEG_PDATA
+#else
+#define MEM_MODEL_SEG    SI_SEG_DATA
+#endif
+
+// -----------------------------------------------------------------------------
+// USB constants
+
+// Setup request bmRequestType fields
+#define USB_SETUP_DIR_OUT                   0
+#define USB_SETUP_DIR_IN                    1
+#define USB_SETUP_DIR_D2H                   USB_SETUP_DIR_IN
+#define USB_SETUP_DIR_H2D                   USB_SETUP_DIR_OUT
+#define USB_SETUP_TYPE_STANDARD             0
+#define USB_SETUP_TYPE_CLASS                1
+#define USB_SETUP_TYPE_VENDOR               2
+#define USB_SETUP_RECIPIENT_DEVICE          0
+#define USB_SETUP_RECIPIENT_INTERFACE       1
+#define USB_SETUP_RECIPIENT_ENDPOINT        2
+#define USB_SETUP_RECIPIENT_OTHER           3
+
+// Standard requests
+#define GET_STATUS                          0
+#define CLEAR_FEATURE                       1
+#define SET_FEATURE                         3
+#define SET_ADDRESS                         5
+#define GET_DESCRIPTOR                      6
+#define SET_DESCRIPTOR                      7
+#define GET_CONFIGURATION                   8
+#define SET_CONFIGURATION                   9
+#define GET_INTERFACE                       10
+#define SET_INTERFACE                       11
+#define SYNCH_FRAME                         12
+
+// HID class requests
+#define USB_HID_GET_REPORT                  0x01
+#define USB_HID_GET_IDLE                    0x02
+#define USB_HID_GET_PROTOCOL                0x03
+#define USB_HID_SET_REPORT                  0x09
+#define USB_HID_SET_IDLE                    0x0A
+#define USB_HID_SET_PROTOCOL                0x0B
+
+// Feature selectors
+#define USB_FEATURE_ENDPOINT_HALT           0
+#define USB_FEATURE_DEVICE_REMOTE_WAKEUP    1
+
+// Descriptor types
+#define USB_DEVICE_DESCRIPTOR               1
+#define USB_CONFIG_DESCRIPTOR               2
+#define USB_STRING_DESCRIPTOR               3
+#define USB_INTERFACE_DESCRIPTOR            4
+#define USB_ENDPOINT_DESCRIPTOR             5
+#define USB_DEVICE_QUALIFIER_DESCRIPTOR     6
+#define USB_OTHER_SPEED_CONFIG_DESCRIPTOR   7
+#define USB_INTERFACE_POWER_DESCRIPTOR      8
+#define USB_IAD_DESCRIPTOR                  11
+#define USB_HID_DESCRIPTOR                  0x21
+#define USB_HID_REPORT_DESCRIPTOR           0x22
+#define USB_CS_INTERFACE_DESCRIPTOR         0x24
+
+/// bDescriptorType of a string descriptor stored one byte per character.
+/// The stack sends it as USB_STRING_DESCRIPTOR, padding each character to
+/// UTF-16LE.
+#define USB_STRING_DESCRIPTOR_UTF16LE_PACKED  0x83
+
+// Descriptor sizes
+#define USB_DEVICE_DESCSIZE                 18
+#define USB_CONFIG_DESCSIZE                 9
+#define USB_INTERFACE_DESCSIZE              9
+#define USB_ENDPOINT_DESCSIZE               7
+#define USB_DEVICE_QUALIFIER_DESCSIZE       10
+#define USB_OTHER_SPEED_CONFIG_DESCSIZE     9
+#define USB_HID_DESCSIZE                    9
+#define USB_CDC_HEADER_FND_DESCSIZE         5
+#define USB_CDC_CALLMNG_FND_DESCSIZE        5
+#define USB_CDC_ACM_FND_DESCSIZE            4
+
+/// bLength of a string descriptor of n characters, counting the
+/// terminating '\0' as the descriptor header
+#define USB_STRING_DESC_SIZE(n)             ((n) * 2)
+
+// Configuration descriptor bmAttributes and bMaxPower
+#define CONFIG_DESC_BM_REMOTEWAKEUP         0x20
+#define CONFIG_DESC_BM_SELFPOWERED          0x40
+#define CONFIG_DESC_BM_RESERVED_D7          0x80
+#define CONFIG_DESC_BM_TRANSFERTYPE         0x03
+#define CONFIG_DESC_MAXPOWER_mA(x)          (((x) + 1) / 2)
+
+// Endpoint transfer types
+#define USB_EPTYPE_CTRL                     0
+#define USB_EPTYPE_ISOC                     1
+#define USB_EPTYPE_BULK                     2
+#define USB_EPTYPE_INTR                     3
+
+/// bEndpointAddress direction bit
+#define USB_EP_DIR_IN                       0x80
+#define USB_SETUP_PKT_SIZE                  8
+#define USB_EP0_SIZE                        64
+
+// Endpoint addresses
+#define EP0                                 0x00
+#define EP1IN                               0x81
+#define EP1OUT                              0x01
+#define EP2IN                               0x82
+#define EP2OUT                              0x02
+#define EP3IN                               0x83
+#define EP3OUT                              0x03
+
+/// US English language ID
+#define USB_LANGID_ENUS                     0x0409
+
+// Power save modes (accepted for compatibility; see the module notes)
+#define USB_PWRSAVE_MODE_OFF                0
+#define USB_PWRSAVE_MODE_ONSUSPEND          1
+#define USB_PWRSAVE_MODE_ONVBUSOFF          2
+#define USB_PWRSAVE_MODE_FASTWAKE           4
+
+// -----------------------------------------------------------------------------
+// Descriptor declaration macros
+
+/// Declares the language ID string descriptor (string index 0)
+#define LANGID_STATIC_CONST_STRING_DESC(__name, __val)                        \
+  SI_SEGMENT_VARIABLE(__name, static const USB_StringDescriptor_TypeDef,      \
+                      SI_SEG_CODE) =                                          \
+  { 4, USB_STRING_DESCRIPTOR,                                                 \
+    (uint8_t)le16toh(__val), (uint8_t)(le16toh(__val) >> 8) }
+
+/// Declares a string descriptor from a list of 8-bit characters ending in
+/// '\0'; __size counts the '\0'
+#define UTF16LE_PACKED_STATIC_CONST_STRING_DESC(__name, __val, __size)        \
+  SI_SEGMENT_VARIABLE(__name, static const USB_StringDescriptor_TypeDef,      \
+                      SI_SEG_CODE) =                                          \
+  { USB_STRING_DESC_SIZE(__size), USB_STRING_DESCRIPTOR_UTF16LE_PACKED, __val }
+
+// -----------------------------------------------------------------------------
+// Typedefs
+
+/// Status codes returned by the API and passed to the callbacks
+typedef enum
+{
+  USB_STATUS_OK = 0,                    ///< No errors
+  USB_STATUS_REQ_ERR = -1,              ///< Setup request error
+  USB_STATUS_EP_BUSY = -2,              ///< Endpoint is busy
+  USB_STATUS_REQ_UNHANDLED = -3,        ///< Setup request not handled
+  USB_STATUS_ILLEGAL = -4,              ///< Illegal operation attempted
+  USB_STATUS_EP_STALLED = -5,           ///< Endpoint is stalled
+  USB_STATUS_EP_ABORTED = -6,           ///< Endpoint transfer was aborted
+  USB_STATUS_EP_ERROR = -7,             ///< Endpoint transfer error
+  USB_STATUS_EP_NAK = -8,               ///< Endpoint NAK'ed transfer request
+  USB_STATUS_DEVICE_UNCONFIGURED = -9,  ///< Device is not configured
+  USB_STATUS_DEVICE_SUSPENDED = -10,    ///< Device is suspended
+  USB_STATUS_DEVICE_RESET = -11,        ///< Device was reset
+  USB_STATUS_TIMEOUT = -12,             ///< Transfer timeout
+  USB_STATUS_DEVICE_REMOVED = -13,      ///< Device was removed
+  USB_STATUS_EP_RX_BUFFER_OVERRUN = -14 ///< Receive buffer overrun
+} USB_Status_TypeDef;
+
+/// Device states, in the order the device passes through them
+typedef enum
+{
+  USBD_STATE_NONE,
+  USBD_STATE_ATTACHED,
+  USBD_STATE_POWERED,
+  USBD_STATE_DEFAULT,
+  USBD_STATE_ADDRESSED,
+  USBD_STATE_SUSPENDED,
+  USBD_STATE_CONFIGURED,
+  USBD_STATE_LASTMARKER
+} USBD_State_TypeDef;
+
+/// Endpoint states
+typedef enum
+{
+  D_EP_DISABLED,                        ///< Endpoint is not in use
+  D_EP_IDLE,                            ///< No transfer in progress
+  D_EP_TRANSMITTING,                    ///< IN transfer in progress
+  D_EP_RECEIVING,                       ///< OUT transfer in progress
+  D_EP_HALT                             ///< Endpoint is halted
+} USBD_EpState_TypeDef;
+
+/// Setup packet, with its 16-bit fields in native byte order
+typedef struct
+{
+  struct
+  {
+    uint8_t Recipient : 5;
+    uint8_t Type      : 2;
+    uint8_t Direction : 1;
+  } bmRequestType;
+  uint8_t  bRequest;
+  uint16_t wValue;
+  uint16_t wIndex;
+  uint16_t wLength;
+} USB_Setup_TypeDef;
+
+/// Device descriptor; 16-bit fields are little endian (use htole16())
+typedef struct
+{
+  uint8_t  bLength;
+  uint8_t  bDescriptorType;
+  uint16_t bcdUSB;
+  uint8_t  bDeviceClass;
+  uint8_t  bDeviceSubClass;
+  uint8_t  bDeviceProtocol;
+  uint8_t  bMaxPacketSize0;
+  uint16_t idVendor;
+  uint16_t idProduct;
+  uint16_t bcdDevice;
+  uint8_t  iManufacturer;
+  uint8_t  iProduct;
+  uint8_t  iSerialNumber;
+  uint8_t  bNumConfigurations;
+} USB_DeviceDescriptor_TypeDef;
+
+/// Configuration descriptor header; 16-bit fields are little endian
+typedef struct
+{
+  uint8_t  bLength;
+  uint8_t  bDescriptorType;
+  uint16_t wTotalLength;
+  uint8_t  bNumInterfaces;
+  uint8_t  bConfigurationValue;
+  uint8_t  iConfiguration;
+  uint8_t  bmAttributes;
+  uint8_t  bMaxPower;
+} USB_ConfigurationDescriptor_TypeDef;
+
+/// String descriptor bytes
+typedef uint8_t USB_StringDescriptor_TypeDef;
+
+/// Entry of the string descriptor table
+typedef SI_VARIABLE_SEGMENT_POINTER(USB_StringTable_TypeDef,
+                                    const USB_StringDescriptor_TypeDef,
+                                    SI_SEG_GENERIC);
+
+/// Descriptors passed to USBD_Init(). All tables live in code space.
+typedef struct
+{
+  /// Device descriptor
+  SI_VARIABLE_SEGMENT_POINTER(deviceDescriptor,
+                              const USB_DeviceDescriptor_TypeDef,
+                              SI_SEG_CODE);
+  /// Configuration descriptor, followed by its interface, endpoint and
+  /// class descriptors (wTotalLength bytes)
+  SI_VARIABLE_SEGMENT_POINTER(configDescriptor, const uint8_t, SI_SEG_CODE);
+  /// String descriptors; entry 0 is the language ID descriptor
+  SI_VARIABLE_SEGMENT_POINTER(stringDescriptors,
+                              const USB_StringTable_TypeDef,
+                              SI_SEG_CODE);
+  /// Number of entries in stringDescriptors
+  uint8_t numberOfStrings;
+} USBD_Init_TypeDef;
+
+// -----------------------------------------------------------------------------
+// API
+
+/**************************************************************************//**
+ * @brief Initializes USB0 and connects the device to the bus.
+ *
+ * The USB clock must already be running.
+ *
+ * @param p Descriptors of the device
+ * @return USB_STATUS_OK
+ *****************************************************************************/
+int8_t USBD_Init(SI_VARIABLE_SEGMENT_POINTER(p, const USBD_Init_TypeDef,
+                                             SI_SEG_GENERIC));
+
+/**************************************************************************//**
+ * @brief Enables the D+ (or D-) pull-up, so the host sees the device.
+ *****************************************************************************/
+void USBD_Connect(void);
+
+/**************************************************************************//**
+ * @brief Disables the pull-up, so the host sees the device as removed.
+ *****************************************************************************/
+void USBD_Disconnect(void);
+
+/**************************************************************************//**
+ * @brief Disconnects the device and disables USB0.
+ *****************************************************************************/
+void USBD_Stop(void);
+
+/**************************************************************************//**
+ * @brief Starts an IN transfer.
+ *
+ * The data is copied from @p dat to the endpoint FIFO one packet at a time,
+ * so @p dat must stay valid until the transfer completes. On EP0 the
+ * transfer is the data stage of the current setup request and must be
+ * started from USBD_SetupCmdCb().
+ *
+ * @param epAddr Endpoint address (EP0, EP1IN, EP2IN or EP3IN)
+ * @param dat Data to send, in any memory space
+ * @param byteCount Number of bytes to send; 0 sends a zero-length packet
+ * @param callback If true, USBD_XferCompleteCb() is called when done
+ * @return USB_STATUS_OK, or why the transfer was not started
+ *****************************************************************************/
+int8_t USBD_Write(uint8_t epAddr,
+                  SI_VARIABLE_SEGMENT_POINTER(dat, const uint8_t,
+                                              SI_SEG_GENERIC),
+                  uint16_t byteCount,
+                  bool callback);
+
+/**************************************************************************//**
+ * @brief Starts an OUT transfer.
+ *
+ * Received packets are copied from the endpoint FIFO to @p dat. The
+ * transfer completes when @p byteCount bytes or a short packet arrive.
+ * While no transfer is running, the host is NAK'd once the FIFO is full;
+ * a packet already waiting when the transfer starts is taken at the next
+ * start of frame.
+ *
+ * @param epAddr Endpoint address (EP0, EP1OUT, EP2OUT or EP3OUT)
+ * @param dat Buffer for the received data
+ * @param byteCount Size of @p dat
+ * @param callback If true, USBD_XferCompleteCb() is called when done
+ * @return USB_STATUS_OK, or why the transfer was not started
+ *****************************************************************************/
+int8_t USBD_Read(uint8_t epAddr,
+                 SI_VARIABLE_SEGMENT_POINTER(dat, uint8_t, SI_SEG_GENERIC),
+                 uint16_t byteCount,
+                 bool callback);
+
+/**************************************************************************//**
+ * @brief Aborts the transfer on an endpoint.
+ *
+ * If the transfer asked for a callback, USBD_XferCompleteCb() is called
+ * with USB_STATUS_EP_ABORTED.
+ *
+ * @param epAddr Endpoint address
+ *****************************************************************************/
+void USBD_AbortTransfer(uint8_t epAddr);
+
+/**************************************************************************//**
+ * @brief Aborts the transfers on all endpoints.
+ *****************************************************************************/
+void USBD_AbortAllTransfers(void);
+
+/**************************************************************************//**
+ * @brief Returns true if a transfer is in progress on an endpoint.
+ *
+ * @param epAddr Endpoint address
+ *****************************************************************************/
+bool USBD_EpIsBusy(uint8_t epAddr);
+
+/**************************************************************************//**
+ * @brief Halts an endpoint, so it answers the host with STALL.
+ *
+ * @param epAddr Endpoint address (not EP0)
+ * @return USB_STATUS_OK, or USB_STATUS_ILLEGAL
+ *****************************************************************************/
+int8_t USBD_StallEp(uint8_t epAddr);
+
+/**************************************************************************//**
+ * @brief Clears an endpoint halt and resets its data toggle.
+ *
+ * @param epAddr Endpoint address (not EP0)
+ * @return USB_STATUS_OK, or USB_STATUS_ILLEGAL
+ *****************************************************************************/
+int8_t USBD_UnStallEp(uint8_t epAddr);
+
+/**************************************************************************//**
+ * @brief Returns the current device state.
+ *****************************************************************************/
+USBD_State_TypeDef USBD_GetUsbState(void);
+
+#if SLAB_USB_REMOTE_WAKEUP_ENABLED
+/**************************************************************************//**
+ * @brief Signals resume to the host, if it enabled remote wakeup.
+ *
+ * @return USB_STATUS_OK, or USB_STATUS_ILLEGAL if the device is not
+ *   suspended or remote wakeup is disabled
+ *****************************************************************************/
+int8_t USBD_RemoteWakeup(void);
+#endif
+
+// -----------------------------------------------------------------------------
+// Callbacks supplied by the application
+
+#if SLAB_USB_HANDLER_CB
+/// Called on entry to the USB0 ISR
+void USBD_EnterHandler(void);
+/// Called on exit from the USB0 ISR
+void USBD_ExitHandler(void);
+#endif
+
+#if SLAB_USB_RESET_CB
+/// Called when the host resets the bus
+void USBD_ResetCb(void);
+#endif
+
+#if SLAB_USB_SOF_CB
+/// Called on each start of frame with the frame number
+void USBD_SofCb(uint16_t sofNr);
+#endif
+
+#if SLAB_USB_STATE_CHANGE_CB
+/// Called when the device state changes
+void USBD_DeviceStateChangeCb(USBD_State_TypeDef oldState,
+                              USBD_State_TypeDef newState);
+#endif
+
+#if SLAB_USB_IS_SELF_POWERED_CB
+/// Returns true if the device is currently self powered (GET_STATUS)
+bool USBD_IsSelfPoweredCb(void);
+#endif
+
+#if SLAB_USB_SETUP_CMD_CB
+/// Called for each setup request before the standard request handling.
+/// Returns USB_STATUS_OK if it handled the request, starting the data
+/// stage with USBD_Read() or USBD_Write() if there is one, or
+/// USB_STATUS_REQ_UNHANDLED to let the stack handle it.
+USB_Status_TypeDef USBD_SetupCmdCb(SI_VARIABLE_SEGMENT_POINTER(
+                                     setup,
+                                     USB_Setup_TypeDef,
+                                     MEM_MODEL_SEG));
+#endif
+
+#if SLAB_USB_SUPPORT_ALT_INTERFACES
+/// Called for SET_INTERFACE; returns USB_STATUS_OK to accept the setting
+USB_Status_TypeDef USBD_SetInterfaceCb(uint8_t interface, uint8_t altSetting);
+#endif
+
+#if SLAB_USB_REMOTE_WAKEUP_ENABLED
+/// Waits 10-15 ms while resume is signalled
+void USBD_RemoteWakeupDelay(void);
+#endif
+
+/// Called when a transfer started with callback set completes or is
+/// aborted. The return value is not used.
+uint16_t USBD_XferCompleteCb(uint8_t epAddr,
+                             USB_Status_TypeDef status,
+                             uint16_t xferred,
+                             uint16_t remaining);
+
+/** @} (end addtogroup f3xx_usb0_device) */
+
+#endif // __F3XX_USB0_DEVICE_H__
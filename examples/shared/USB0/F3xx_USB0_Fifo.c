@@ -0,0 +1,223 @@
+//-----------------------------------------------------------------------------
+// F3xx_USB0_Fifo.c
+//-----------------------------------------------------------------------------
+// Copyright 2014 Silicon Laboratories, Inc.
+// http://developer.silabs.com/legal/version/v11/Silicon_Labs_Software_License_Agreement.txt
+//
+// Program Description:
+//
+// USB0 endpoint FIFO copy routines shared by the C8051F3xx USB examples.
+// Each project builds this file through its own F3xx_USB0_Fifo.c, which
+// includes the device header first. See F3xx_USB0_Fifo.h for the cycle
+// counts.
+//
+// Target:         C8051F320/1,
+//                 C8051F326/7,
+//                 C8051F34x,
+//                 C8051F38x
+//
+// Tool chain:     Keil C51 7.50 / Keil EVAL C51
+//
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+
+#include "F3xx_USB0_Fifo.h"
+
+//-----------------------------------------------------------------------------
+// Definitions
+//-----------------------------------------------------------------------------
+
+// USB0ADR bits
+#define  USB0ADR_BUSY            0x80  // Indirect access in progress
+#define  USB0ADR_AUTORD          0x40  // Each USB0DAT read starts the next
+
+// Wait for BUSY->'0' (data ready / register available)
+#define  WAIT_READY()            while (USB0ADR & USB0ADR_BUSY)
+
+// Copy one byte from the FIFO and advance the pointer
+#define  READ_BYTE(p)            do { WAIT_READY(); *(p)++ = USB0DAT; } while (0)
+
+// Copy one byte to the FIFO and advance the pointer
+#define  WRITE_BYTE(p)           do { USB0DAT = *(p)++; WAIT_READY(); } while (0)
+
+// Memory type of a generic pointer (SI_GPTR_MTYPE_...). Keil C51 and SDCC
+// keep it in bits 16-23 when a generic pointer is cast to a long.
+#define  GPTR_MTYPE(p)           ((uint8_t)((uint32_t)(p) >> 16))
+
+// The copy loops below are the same for every memory space; only the type
+// of the buffer pointer differs. Odd bytes are moved first, then four per
+// pass.
+
+//-----------------------------------------------------------------------------
+// Fifo_ReadXdata / Fifo_ReadIdata
+//-----------------------------------------------------------------------------
+//
+// Return Value : None
+// Parameters   :
+//                1) uint8_t addr : target address
+//                2) buffer : read data destination
+//                3) uint8_t size : number of bytes to unload
+//
+// Read from the selected endpoint FIFO
+//
+//-----------------------------------------------------------------------------
+#define  FIFO_READ_BODY()                                                     \
+   uint8_t n;                                                                 \
+                                                                              \
+   if (size)                                                                  \
+   {                                                                          \
+      USB0ADR = addr;                  /* Set address */                      \
+      USB0ADR |= USB0ADR_BUSY | USB0ADR_AUTORD;  /* Initiate first read */    \
+                                                                              \
+      for (n = size & 3; n; n--)                                              \
+      {                                                                       \
+         READ_BYTE (buffer);                                                  \
+      }                                                                       \
+      for (n = size >> 2; n; n--)                                             \
+      {                                                                       \
+         READ_BYTE (buffer);                                                  \
+         READ_BYTE (buffer);                                                  \
+         READ_BYTE (buffer);                                                  \
+         READ_BYTE (buffer);                                                  \
+      }                                                                       \
+                                                                              \
+      USB0ADR = 0;                     /* Clear auto-read */                  \
+   }
+
+void Fifo_ReadXdata (uint8_t addr, uint8_t SI_SEG_XDATA * buffer, uint8_t size)
+{
+   FIFO_READ_BODY ()
+}
+
+void Fifo_ReadIdata (uint8_t addr, uint8_t SI_SEG_IDATA * buffer, uint8_t size)
+{
+   FIFO_READ_BODY ()
+}
+
+//-----------------------------------------------------------------------------
+// Fifo_WriteXdata / Fifo_WriteIdata / Fifo_WriteCode
+//-----------------------------------------------------------------------------
+//
+// Return Value : None
+// Parameters   :
+//                1) uint8_t addr : target address
+//                2) buffer : location of source data
+//                3) uint8_t size : number of bytes to load
+//
+// Write to the selected endpoint FIFO
+//
+//-----------------------------------------------------------------------------
+#define  FIFO_WRITE_BODY()                                                    \
+   uint8_t n;                                                                 \
+                                                                              \
+   if (size)                                                                  \
+   {                                                                          \
+      WAIT_READY ();                   /* Register available */               \
+      USB0ADR = addr;                  /* Set address */                      \
+                                                                              \
+      for (n = size & 3; n; n--)                                              \
+      {                                                                       \
+         WRITE_BYTE (buffer);                                                 \
+      }                                                                       \
+      for (n = size >> 2; n; n--)                                             \
+      {                                                                       \
+         WRITE_BYTE (buffer);                                                 \
+         WRITE_BYTE (buffer);                                                 \
+         WRITE_BYTE (buffer);                                                 \
+         WRITE_BYTE (buffer);                                                 \
+      }                                                                       \
+   }
+
+void Fifo_WriteXdata (uint8_t addr, uint8_t const SI_SEG_XDATA * buffer,
+                      uint8_t size)
+{
+   FIFO_WRITE_BODY ()
+}
+
+void Fifo_WriteIdata (uint8_t addr, uint8_t const SI_SEG_IDATA * buffer,
+                      uint8_t size)
+{
+   FIFO_WRITE_BODY ()
+}
+
+void Fifo_WriteCode (uint8_t addr, uint8_t const SI_SEG_CODE * buffer,
+                     uint8_t size)
+{
+   FIFO_WRITE_BODY ()
+}
+
+//-----------------------------------------------------------------------------
+// Fifo_Read
+//-----------------------------------------------------------------------------
+//
+// Return Value : None
+// Parameters   :
+//                1) uint8_t addr : target address
+//                2) uint8_t size : number of bytes to unload
+//                3) uint8_t* buffer : read data destination
+//
+// Read from the selected endpoint FIFO into any memory space. The size
+// comes before the generic pointer so that all three parameters are passed
+// in registers.
+//
+//-----------------------------------------------------------------------------
+void Fifo_Read (uint8_t addr, uint8_t size, uint8_t * buffer)
+{
+   switch (GPTR_MTYPE (buffer))
+   {
+      case SI_GPTR_MTYPE_XDATA:
+         Fifo_ReadXdata (addr, (uint8_t SI_SEG_XDATA *) buffer, size);
+         break;
+
+      case SI_GPTR_MTYPE_IDATA:
+         Fifo_ReadIdata (addr, (uint8_t SI_SEG_IDATA *) buffer, size);
+         break;
+
+      default:
+      {
+         // PDATA: rare enough for the generic pointer loop
+         FIFO_READ_BODY ()
+         break;
+      }
+   }
+}
+
+//-----------------------------------------------------------------------------
+// Fifo_Write
+//-----------------------------------------------------------------------------
+//
+// Return Value : None
+// Parameters   :
+//                1) uint8_t addr : target address
+//                2) uint8_t size : number of bytes to load
+//                3) uint8_t* buffer : location of source data
+//
+// Write to the selected endpoint FIFO from any memory space
+//
+//-----------------------------------------------------------------------------
+void Fifo_Write (uint8_t addr, uint8_t size, uint8_t const * buffer)
+{
+   switch (GPTR_MTYPE (buffer))
+   {
+      case SI_GPTR_MTYPE_XDATA:
+         Fifo_WriteXdata (addr, (uint8_t const SI_SEG_XDATA *) buffer, size);
+         break;
+
+      case SI_GPTR_MTYPE_IDATA:
+         Fifo_WriteIdata (addr, (uint8_t const SI_SEG_IDATA *) buffer, size);
+         break;
+
+      case SI_GPTR_MTYPE_CODE:
+         Fifo_WriteCode (addr, (uint8_t const SI_SEG_CODE *) buffer, size);
+         break;
+
+      default:
+      {
+         // PDATA: rare enough for the generic pointer loop
+         FIFO_WRITE_BODY ()
+         break;
+      }
+   }
+}
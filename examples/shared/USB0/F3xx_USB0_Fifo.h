@@ -0,0 +1,66 @@
+//-----------------------------------------------------------------------------
+// F3xx_USB0_Fifo.h
+//-----------------------------------------------------------------------------
+// Copyright 2014 Silicon Laboratories, Inc.
+// http://developer.silabs.com/legal/version/v11/Silicon_Labs_Software_License_Agreement.txt
+//
+// Program Description:
+//
+// USB0 endpoint FIFO copy routines shared by the C8051F3xx USB examples.
+// Include the device header (c8051f3xx.h or SI_C8051F3xx_Register_Enums.h)
+// before this file.
+//
+// Each routine keeps its parameters and loop counters in registers, so one
+// copy serves both the USB0 ISR and the foreground. Foreground callers must
+// still keep the USB0 interrupt disabled while they use a FIFO, since both
+// contexts share USB0ADR. One call moves at most 255 bytes; full speed
+// control, bulk and interrupt packets are at most 64.
+//
+// SYSCLK cycles per byte, from the CIP-51 instruction timings, with the
+// FIFO ready at the first BUSY poll:
+//
+//    Routine                        Read  Write
+//    Fifo_ReadXdata/Fifo_WriteXdata   12     12
+//    Fifo_ReadIdata/Fifo_WriteIdata    9      9
+//    Fifo_WriteCode                    -     13
+//    Fifo_Read/Fifo_Write           as the routine picked, plus about 30
+//                                   cycles per call to decode the pointer
+//    Previous generic byte loops      ~50    ~50
+//
+// Most of the gain is the specific pointer: a generic pointer store or load
+// is a library call per byte. Unrolling by four removes most of the loop
+// counter overhead.
+//
+// Target:         C8051F320/1,
+//                 C8051F326/7,
+//                 C8051F34x,
+//                 C8051F38x
+//
+// Tool chain:     Keil C51 7.50 / Keil EVAL C51
+//
+
+#ifndef _USB_FIFO_H_
+#define _USB_FIFO_H_
+
+//-----------------------------------------------------------------------------
+// Global Function Prototypes
+//-----------------------------------------------------------------------------
+
+// Copies from the FIFO at addr (FIFO_EPn) into a buffer in one memory space
+void Fifo_ReadXdata (uint8_t addr, uint8_t SI_SEG_XDATA * buffer, uint8_t size);
+void Fifo_ReadIdata (uint8_t addr, uint8_t SI_SEG_IDATA * buffer, uint8_t size);
+
+// Copies a buffer in one memory space into the FIFO at addr (FIFO_EPn)
+void Fifo_WriteXdata (uint8_t addr, uint8_t const SI_SEG_XDATA * buffer,
+                      uint8_t size);
+void Fifo_WriteIdata (uint8_t addr, uint8_t const SI_SEG_IDATA * buffer,
+                      uint8_t size);
+void Fifo_WriteCode (uint8_t addr, uint8_t const SI_SEG_CODE * buffer,
+                     uint8_t size);
+
+// Generic pointer versions; they call the routine for the pointer's memory
+// space
+void Fifo_Read (uint8_t addr, uint8_t size, uint8_t * buffer);
+void Fifo_Write (uint8_t addr, uint8_t size, uint8_t const * buffer);
+
+#endif // _USB_FIFO_H_
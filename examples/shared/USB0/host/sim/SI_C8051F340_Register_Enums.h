@@ -0,0 +1,19 @@
+/******************************************************************************
+ * Copyright (c) 2021 by Silicon Laboratories Inc. All rights reserved.
+ *
+ * http://developer.silabs.com/legal/version/v11/Silicon_Labs_Software_License_Agreement.txt
+ *****************************************************************************/
+
+// Host stand-in for the C8051F340 device header. The register bit values
+// come from the real header; its SFR definitions are replaced by the
+// USB0 SIE model in usb0_sim.h.
+
+#define SI_C8051F340_DEFS_H
+#include <si_toolchain.h>
+#include "usb0_sim.h"
+#include_next "SI_C8051F340_Register_Enums.h"
+
+// Port pins driven by the example firmware (the target board LEDs); the
+// test driver defines them
+extern bool P2_B2;
+extern bool P2_B3;
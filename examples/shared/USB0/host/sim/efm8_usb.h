@@ -0,0 +1,11 @@
+/******************************************************************************
+ * Copyright (c) 2021 by Silicon Laboratories Inc. All rights reserved.
+ *
+ * http://developer.silabs.com/legal/version/v11/Silicon_Labs_Software_License_Agreement.txt
+ *****************************************************************************/
+
+// Host stand-in for the efm8_usb library header. C8051F3xx applications
+// written for efm8_usb build against the F3xx USB device core, which has
+// the same API.
+
+#include "F3xx_USB0_Device.h"
@@ -0,0 +1,33 @@
+/******************************************************************************
+ * Copyright (c) 2021 by Silicon Laboratories Inc. All rights reserved.
+ *
+ * http://developer.silabs.com/legal/version/v11/Silicon_Labs_Software_License_Agreement.txt
+ *****************************************************************************/
+
+// Host stand-in for the si8051Base endian.h. It wraps the C library header
+// of the same name, which other system headers include, and makes the
+// conversions plain macros so that descriptor tables using them stay
+// constant initializers. The host is little endian.
+
+#ifndef __USB0_SIM_ENDIAN_H__
+#define __USB0_SIM_ENDIAN_H__
+
+#include_next <endian.h>
+
+#undef htole16
+#undef htole32
+#undef le16toh
+#undef le32toh
+#undef htobe16
+#undef htobe32
+#undef be16toh
+#undef be32toh
+
+#define htole16(x) ((uint16_t)(x))
+#define htole32(x) ((uint32_t)(x))
+#define le16toh(x) ((uint16_t)(x))
+#define le32toh(x) ((uint32_t)(x))
+#define htobe16(x) ((uint16_t)((((x) & 0xFF) << 8) | (((x) >> 8) & 0xFF)))
+#define be16toh(x) htobe16(x)
+
+#endif // __USB0_SIM_ENDIAN_H__
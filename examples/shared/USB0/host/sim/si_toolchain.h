@@ -0,0 +1,86 @@
+/******************************************************************************
+ * Copyright (c) 2021 by Silicon Laboratories Inc. All rights reserved.
+ *
+ * http://developer.silabs.com/legal/version/v11/Silicon_Labs_Software_License_Agreement.txt
+ *****************************************************************************/
+
+#ifndef __SI_TOOLCHAIN_H__
+#define __SI_TOOLCHAIN_H__
+
+// Host stand-in for si_toolchain.h, used to build USB firmware into the
+// USB0 simulators. Memory segments have no meaning on the host, interrupt
+// service routines are plain functions the SIE model calls, and SFRs come
+// from usb0_sim.h through the device header stand-ins.
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define SI_SEG_GENERIC
+#define SI_SEG_FAR
+#define SI_SEG_NEAR
+#define SI_SEG_DATA
+#define SI_SEG_IDATA
+#define SI_SEG_XDATA
+#define SI_SEG_PDATA
+#define SI_SEG_BDATA
+#define SI_SEG_CODE
+
+#define SI_INTERRUPT(name, vector) void name(void)
+#define SI_INTERRUPT_USING(name, vector, regnum) void name(void)
+#define SI_INTERRUPT_PROTO(name, vector) void name(void)
+#define SI_INTERRUPT_PROTO_USING(name, vector, regnum) void name(void)
+#define SI_FUNCTION_USING(name, return_value, parameter, regnum)              \
+             return_value name(parameter)
+#define SI_FUNCTION_PROTO_USING(name, return_value, parameter, regnum)        \
+             return_value name(parameter)
+#define SI_REENTRANT_FUNCTION(name, return_value, parameter)                  \
+             return_value name(parameter)
+#define SI_REENTRANT_FUNCTION_PROTO(name, return_value, parameter)            \
+             return_value name(parameter)
+
+#define SI_SEGMENT_VARIABLE(name, vartype, memseg) vartype name
+#define SI_VARIABLE_SEGMENT_POINTER(name, vartype, targseg) vartype * name
+#define SI_SEGMENT_VARIABLE_SEGMENT_POINTER(name, vartype, targseg, memseg)  \
+             vartype * name
+#define SI_SEGMENT_POINTER(name, vartype, memseg) vartype * name
+#define SI_LOCATED_VARIABLE_NO_INIT(name, vartype, memseg, address)          \
+             vartype name
+
+// Memory types of a Keil generic pointer. A host pointer has none; code
+// that switches on them takes whichever case matches its low bits, and
+// every case copies the same way here.
+#define SI_GPTR_MTYPE_DATA  0x00
+#define SI_GPTR_MTYPE_IDATA 0x00
+#define SI_GPTR_MTYPE_BDATA 0x00
+#define SI_GPTR_MTYPE_XDATA 0x01
+#define SI_GPTR_MTYPE_PDATA 0xFE
+#define SI_GPTR_MTYPE_CODE  0xFF
+
+// Byte order of the host (little endian)
+#define B0 0
+#define B1 1
+#define B2 2
+#define B3 3
+
+typedef union SI_UU16
+{
+  uint16_t u16;
+  int16_t s16;
+  uint8_t u8[2];
+  int8_t s8[2];
+} SI_UU16_t;
+
+typedef union SI_UU32
+{
+  uint32_t u32;
+  int32_t s32;
+  SI_UU16_t uu16[2];
+  uint16_t u16[2];
+  int16_t s16[2];
+  uint8_t u8[4];
+  int8_t s8[4];
+} SI_UU32_t;
+
+#define NOP()
+
+#endif // __SI_TOOLCHAIN_H__
@@ -0,0 +1,264 @@
+/******************************************************************************
+ * Copyright (c) 2021 by Silicon Laboratories Inc. All rights reserved.
+ *
+ * http://developer.silabs.com/legal/version/v11/Silicon_Labs_Software_License_Agreement.txt
+ *****************************************************************************/
+
+// Regression test of the C8051F340DK HID KeyboardExample on the USB0 SIE
+// model.
+//
+// usage: usb0_hid [-v]
+//
+//   -v  print each test as it runs
+//
+// The example's callback.c, descriptors.c and idle.c are built unchanged
+// against the F3xx USB device core; this file stands in for its main.c and
+// the target board. The virtual host enumerates the keyboard, reads its HID
+// descriptors, sets the LEDs with output reports and types the example's
+// key sequence by pressing the board button. The exit status is nonzero if
+// any check failed or the SIE model saw the firmware misuse a register. See
+// readme.txt for the build command.
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include "SI_C8051F340_Register_Enums.h"
+#include "efm8_usb.h"
+#include "descriptors.h"
+
+// -----------------------------------------------------------------------------
+// Target board and main.c stand-ins
+// -----------------------------------------------------------------------------
+
+extern void usbIrqHandler(void);
+
+bool P2_B2;                             // Num Lock LED
+bool P2_B3;                             // Caps Lock LED
+uint8_t keySeqNo;
+bool keyPushed;
+
+// Key codes the example types, one report per button press: "HID Keyboard "
+static const uint8_t keySequence[] =
+{
+  0x0B, 0x0C, 0x07, 0x2C, 0x0E, 0x08, 0x1C, 0x05, 0x12, 0x04, 0x15, 0x07, 0x2C
+};
+
+// -----------------------------------------------------------------------------
+// Virtual host checks
+// -----------------------------------------------------------------------------
+
+static bool verbose;
+static unsigned failures;
+
+#define CHECK(cond)                                                           \
+  do                                                                          \
+  {                                                                           \
+    if (!(cond))                                                              \
+    {                                                                         \
+      fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond);\
+      failures++;                                                             \
+    }                                                                         \
+  } while (0)
+
+static void begin(const char *name)
+{
+  if (verbose)
+  {
+    printf("%s\n", name);
+  }
+}
+
+static int request(uint8_t type, uint8_t req, uint16_t value, uint16_t index,
+                   uint8_t *data, uint16_t length, uint16_t *xferred)
+{
+  uint8_t setup[8];
+  uint16_t dummy;
+
+  setup[0] = type;
+  setup[1] = req;
+  setup[2] = (uint8_t)value;
+  setup[3] = (uint8_t)(value >> 8);
+  setup[4] = (uint8_t)index;
+  setup[5] = (uint8_t)(index >> 8);
+  setup[6] = (uint8_t)length;
+  setup[7] = (uint8_t)(length >> 8);
+  return usb0sim_control(setup, data, xferred ? xferred : &dummy);
+}
+
+static void testEnumeration(void)
+{
+  Usb0Sim_Device_t dev;
+  const Usb0Sim_Stats_t *stats;
+
+  begin("enumeration");
+  usb0sim_clearStats();
+  CHECK(usb0sim_enumerate(3, &dev) == USB0SIM_ACK);
+  CHECK((dev.device[8] == 0xC4) && (dev.device[9] == 0x10));
+  CHECK((dev.device[10] == 0x01) && (dev.device[11] == 0xFE));
+  CHECK(USBD_GetUsbState() == USBD_STATE_CONFIGURED);
+
+  stats = usb0sim_stats();
+  printf("Enumeration: %lu USB0ADR and %lu USB0DAT accesses, %lu interrupts\n",
+         stats->adrAccesses, stats->datAccesses, stats->interrupts);
+}
+
+static void testDescriptors(void)
+{
+  uint8_t buf[256];
+  uint16_t length;
+
+  begin("HID descriptors");
+
+  // Report descriptor, in full and cut short
+  CHECK(request(0x81, GET_DESCRIPTOR, USB_HID_REPORT_DESCRIPTOR << 8, 0,
+                buf, sizeof(buf), &length) == USB0SIM_ACK);
+  CHECK((length == sizeof(ReportDescriptor0))
+        && !memcmp(buf, ReportDescriptor0, length));
+  CHECK(request(0x81, GET_DESCRIPTOR, USB_HID_REPORT_DESCRIPTOR << 8, 0,
+                buf, 64, &length) == USB0SIM_ACK);
+  CHECK(length == 64);
+
+  // HID descriptor, as embedded in the configuration descriptor
+  CHECK(request(0x81, GET_DESCRIPTOR, USB_HID_DESCRIPTOR << 8, 0,
+                buf, sizeof(buf), &length) == USB0SIM_ACK);
+  CHECK((length == USB_HID_DESCSIZE) && !memcmp(buf, &configDesc[18], length));
+
+  // No second interface
+  CHECK(request(0x81, GET_DESCRIPTOR, USB_HID_REPORT_DESCRIPTOR << 8, 1,
+                buf, sizeof(buf), NULL) == USB0SIM_STALL);
+}
+
+static void testClassRequests(void)
+{
+  uint8_t buf[8];
+  uint16_t length;
+
+  begin("HID class requests");
+
+  CHECK(request(0x21, USB_HID_SET_IDLE, 0, 0, NULL, 0, NULL) == USB0SIM_ACK);
+  CHECK(request(0xA1, USB_HID_GET_IDLE, 0, 0, buf, 1, &length)
+        == USB0SIM_ACK);
+  CHECK((length == 1) && (buf[0] == 0));
+
+  // Input report with no key pressed
+  memset(buf, 0xFF, sizeof(buf));
+  CHECK(request(0xA1, USB_HID_GET_REPORT, 0x0100, 0, buf, 8, &length)
+        == USB0SIM_ACK);
+  CHECK((length == 8) && !buf[0] && !buf[2]);
+
+  // Output reports drive the LEDs
+  buf[0] = 0x03;
+  CHECK(request(0x21, USB_HID_SET_REPORT, 0x0200, 0, buf, 1, &length)
+        == USB0SIM_ACK);
+  CHECK(P2_B2 && P2_B3);
+  buf[0] = 0x02;
+  CHECK(request(0x21, USB_HID_SET_REPORT, 0x0200, 0, buf, 1, &length)
+        == USB0SIM_ACK);
+  CHECK(!P2_B2 && P2_B3);
+
+  // Wrong report length
+  CHECK(request(0x21, USB_HID_SET_REPORT, 0x0200, 0, buf, 2, NULL)
+        == USB0SIM_STALL);
+}
+
+static void testTyping(void)
+{
+  uint8_t report[64];
+  uint16_t length;
+  unsigned i;
+
+  begin("typing");
+
+  // Each press sends the next key, then a release report
+  for (i = 0; i < 2 * sizeof(keySequence); i++)
+  {
+    keyPushed = true;
+    CHECK(usb0sim_bulkIn(1, report, sizeof(report), &length) == USB0SIM_ACK);
+    CHECK((length == 8)
+          && (report[2] == keySequence[i % sizeof(keySequence)]));
+    CHECK(usb0sim_bulkIn(1, report, sizeof(report), &length) == USB0SIM_ACK);
+    CHECK((length == 8) && !report[2]);
+  }
+
+  // With an indefinite idle rate nothing more is sent
+  usb0sim_setRetries(200);
+  CHECK(usb0sim_bulkIn(1, report, sizeof(report), &length)
+        == USB0SIM_TIMEOUT);
+  usb0sim_setRetries(10000);
+
+  // With an idle rate the last report repeats
+  CHECK(request(0x21, USB_HID_SET_IDLE, 0x0800, 0, NULL, 0, NULL)
+        == USB0SIM_ACK);
+  CHECK(usb0sim_bulkIn(1, report, sizeof(report), &length) == USB0SIM_ACK);
+  CHECK((length == 8) && !report[2]);
+  CHECK(request(0x21, USB_HID_SET_IDLE, 0, 0, NULL, 0, NULL) == USB0SIM_ACK);
+}
+
+static void testSuspend(void)
+{
+  begin("suspend");
+
+  P2_B2 = P2_B3 = true;
+  usb0sim_suspend();
+  CHECK(USBD_GetUsbState() == USBD_STATE_SUSPENDED);
+  CHECK(!P2_B2 && !P2_B3);
+  usb0sim_resume();
+  CHECK(USBD_GetUsbState() == USBD_STATE_CONFIGURED);
+
+  // The keyboard still types after resume
+  keyPushed = true;
+  {
+    uint8_t report[64];
+    uint16_t length;
+
+    CHECK(usb0sim_bulkIn(1, report, sizeof(report), &length) == USB0SIM_ACK);
+    CHECK((length == 8) && report[2]);
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Main
+// -----------------------------------------------------------------------------
+
+int main(int argc, char *argv[])
+{
+  unsigned long errors;
+  int opt;
+
+  while ((opt = getopt(argc, argv, "v")) != -1)
+  {
+    switch (opt)
+    {
+      case 'v':
+        verbose = true;
+        break;
+      default:
+        fprintf(stderr, "usage: usb0_hid [-v]\n");
+        return 2;
+    }
+  }
+
+  usb0sim_init(usbIrqHandler);
+  USBD_Init(&initstruct);
+  IE_EA = 1;
+
+  testEnumeration();
+  errors = usb0sim_stats()->errors;
+  testDescriptors();
+  testClassRequests();
+  testTyping();
+  testSuspend();
+  errors += usb0sim_stats()->errors;
+
+  if (errors)
+  {
+    fprintf(stderr, "usb0_hid: %lu SIE errors\n", errors);
+  }
+  if (failures || errors)
+  {
+    fprintf(stderr, "usb0_hid: FAILED\n");
+    return 1;
+  }
+  printf("usb0_hid: all checks passed\n");
+  return 0;
+}
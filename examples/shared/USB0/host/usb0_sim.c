@@ -0,0 +1,1589 @@
+/******************************************************************************
+ * Copyright (c) 2021 by Silicon Laboratories Inc. All rights reserved.
+ *
+ * http://developer.silabs.com/legal/version/v11/Silicon_Labs_Software_License_Agreement.txt
+ *****************************************************************************/
+
+// Host model of the USB0 serial interface engine and a virtual USB host.
+// See usb0_sim.h.
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include "usb0_sim.h"
+
+// -----------------------------------------------------------------------------
+// Register bits (as in the device register enums, which firmware includes)
+// -----------------------------------------------------------------------------
+
+#define ADR_BUSY      0x80
+#define ADR_AUTORD    0x40
+#define ADR_ADDRESS   0x3F
+
+#define POWER_SUSEN   0x01
+#define POWER_SUSMD   0x02
+#define POWER_RESUME  0x04
+#define POWER_USBRST  0x08
+#define POWER_USBINH  0x10
+
+#define FADDR_UPDATE  0x80
+
+#define CMINT_SUSINT  0x01
+#define CMINT_RSUINT  0x02
+#define CMINT_RSTINT  0x04
+#define CMINT_SOF     0x08
+
+#define E0_OPRDY      0x01
+#define E0_INPRDY     0x02
+#define E0_STSTL      0x04
+#define E0_DATAEND    0x08
+#define E0_SUEND      0x10
+#define E0_SDSTL      0x20
+#define E0_SOPRDY     0x40
+#define E0_SSUEND     0x80
+
+#define IN_INPRDY     0x01
+#define IN_FIFONE     0x02
+#define IN_UNDRUN     0x04
+#define IN_FLUSH      0x08
+#define IN_SDSTL      0x10
+#define IN_STSTL      0x20
+#define IN_CLRDT      0x40
+
+#define INH_SPLIT     0x04
+#define INH_DIRSEL    0x20
+#define INH_DBIEN     0x80
+
+#define OUT_OPRDY     0x01
+#define OUT_FIFOFUL   0x02
+#define OUT_FLUSH     0x10
+#define OUT_SDSTL     0x20
+#define OUT_STSTL     0x40
+#define OUT_CLRDT     0x80
+
+#define OUTH_DBOEN    0x80
+
+#define XCN_PHYEN     0x40
+#define XCN_PREN      0x80
+
+#define EIE1_EUSB0    0x02
+
+// Interrupt enable values after a power-on or bus reset
+#define IN1IE_RESET   0x0F
+#define OUT1IE_RESET  0x0E
+#define CMIE_RESET    0x04
+#define CMIE_BUS_RESET 0x0E
+
+// Standard requests the virtual host tracks
+#define REQ_CLEAR_FEATURE     1
+#define REQ_SET_ADDRESS       5
+#define REQ_GET_DESCRIPTOR    6
+#define REQ_SET_CONFIGURATION 9
+#define REQ_SET_INTERFACE     11
+
+#define DESC_DEVICE           1
+#define DESC_CONFIG           2
+#define DESC_STRING           3
+#define DESC_ENDPOINT         5
+
+#define EP0_SIZE              64
+#define EP_COUNT              4
+
+// Endpoint FIFO sizes in bytes (EP0 to EP3)
+static const uint16_t fifoSize[EP_COUNT] = { 64, 128, 256, 512 };
+
+// Interrupt service routine calls allowed for one event before the flags
+// are taken to be stuck
+#define ISR_LIMIT             64
+
+// -----------------------------------------------------------------------------
+// SIE state
+// -----------------------------------------------------------------------------
+
+// One direction of an endpoint FIFO: up to two packets (double buffering)
+typedef struct
+{
+  uint8_t data[2][512];
+  uint16_t length[2];
+  uint8_t packets;      // complete packets held
+  uint8_t head;         // index of the oldest packet
+  uint16_t loaded;      // IN: bytes written toward the next packet
+  uint16_t readPos;     // OUT: bytes read from the oldest packet
+} Fifo_t;
+
+typedef struct
+{
+  uint8_t inCsrL;       // UNDRUN, SDSTL, STSTL
+  uint8_t inCsrH;
+  uint8_t outCsrL;      // SDSTL, STSTL
+  uint8_t outCsrH;
+  uint8_t inToggle;
+  uint8_t outToggle;
+  Fifo_t in;
+  Fifo_t out;
+} Endpoint_t;
+
+// EP0 control transfer phases
+typedef enum
+{
+  PHASE_IDLE,
+  PHASE_SETUP,          // SETUP received, OPRDY not yet serviced
+  PHASE_DATA_IN,
+  PHASE_DATA_OUT,
+  PHASE_STATUS_IN,      // device sends the zero length status packet
+  PHASE_STATUS_OUT      // host sends the zero length status packet
+} Phase_t;
+
+static struct
+{
+  uint8_t adr;          // USB0ADR without BUSY
+  uint8_t dat;          // USB0DAT read latch
+  uint8_t faddr;
+  uint8_t newAddr;      // FADDR written, applied after the status stage
+  bool addrPending;
+  uint8_t power;
+  uint8_t in1int;
+  uint8_t out1int;
+  uint8_t cmint;
+  uint8_t in1ie;
+  uint8_t out1ie;
+  uint8_t cmie;
+  uint16_t frame;
+  uint8_t index;
+  uint8_t clkrec;
+  uint8_t eenable;
+  uint8_t e0csr;        // OPRDY, INPRDY, STSTL, DATAEND, SUEND, SDSTL
+  uint8_t e0Toggle;
+  bool setupIn;         // data stage direction of the current request
+  uint16_t setupLength; // wLength of the current request
+  Phase_t phase;
+  bool wakeup;
+  Endpoint_t ep[EP_COUNT];
+} sie;
+
+uint8_t USB0XCN;
+uint8_t EIE1;
+uint8_t IE_EA;
+
+static void (*isrFunction)(void);
+static void (*idleFunction)(void);
+static void (*pollHook)(void);
+static bool inIsr;
+static Usb0Sim_Stats_t stats;
+
+// -----------------------------------------------------------------------------
+// SFR access tracking
+//
+// Each USB0ADR/USB0DAT access gets its own 16-bit slot, preloaded with the
+// register value in the low byte and a tag that changes with every access
+// in the high byte. Firmware stores only bytes, or bytes derived from the
+// value read through another slot, so a slot that no longer holds its
+// preload value was written. Interrupt handlers use their own slots so they
+// do not reuse a slot of the expression they interrupted.
+// -----------------------------------------------------------------------------
+
+#define SLOTS 8
+#define SLOT_ADR 1
+#define SLOT_DAT 2
+
+typedef struct
+{
+  uint16_t value;
+  uint16_t preload;
+  uint8_t kind;
+} Slot_t;
+
+typedef struct
+{
+  Slot_t slot[SLOTS];
+  uint8_t next;
+} Ring_t;
+
+static Ring_t rings[2];
+static uint8_t tag;
+
+static uint8_t readReg(uint8_t addr);
+static void writeReg(uint8_t addr, uint8_t value);
+static void runIsr(void);
+
+// Apply the stores made through the slots of one context, oldest first
+static void commit(Ring_t *ring)
+{
+  uint8_t i, n;
+  Slot_t *s;
+
+  for (i = 0; i < SLOTS; i++)
+  {
+    n = (ring->next + i) % SLOTS;
+    s = &ring->slot[n];
+    if (!s->kind || (s->value == s->preload))
+    {
+      continue;
+    }
+    s->preload = s->value;
+    if (s->kind == SLOT_ADR)
+    {
+      sie.adr = (uint8_t)s->value & (ADR_AUTORD | ADR_ADDRESS);
+      if (s->value & ADR_BUSY)
+      {
+        sie.dat = readReg(sie.adr & ADR_ADDRESS);
+      }
+    }
+    else
+    {
+      writeReg(sie.adr & ADR_ADDRESS, (uint8_t)s->value);
+    }
+  }
+}
+
+static uint16_t *access(uint8_t kind)
+{
+  Ring_t *ring = &rings[inIsr];
+  Slot_t *s;
+
+  commit(ring);
+
+  // Interrupts are taken between SFR accesses
+  if (!inIsr)
+  {
+    runIsr();
+  }
+
+  s = &ring->slot[ring->next];
+  ring->next = (ring->next + 1) % SLOTS;
+  tag = (uint8_t)(tag % 255 + 1);
+  s->kind = kind;
+  s->preload = (uint16_t)(tag << 8);
+  if (kind == SLOT_ADR)
+  {
+    stats.adrAccesses++;
+    s->preload |= sie.adr;
+  }
+  else
+  {
+    stats.datAccesses++;
+    s->preload |= sie.dat;
+
+    // Auto-read: this read starts the next one
+    if (sie.adr & ADR_AUTORD)
+    {
+      sie.dat = readReg(sie.adr & ADR_ADDRESS);
+    }
+  }
+  s->value = s->preload;
+  return &s->value;
+}
+
+uint16_t *usb0sim_adr(void)
+{
+  return access(SLOT_ADR);
+}
+
+uint16_t *usb0sim_dat(void)
+{
+  return access(SLOT_DAT);
+}
+
+// Complete the last store of the foreground before a bus event
+static void sync(void)
+{
+  commit(&rings[0]);
+}
+
+// -----------------------------------------------------------------------------
+// Interrupts
+// -----------------------------------------------------------------------------
+
+static bool irqPending(void)
+{
+  return (sie.in1int & sie.in1ie) || (sie.out1int & sie.out1ie)
+         || (sie.cmint & sie.cmie);
+}
+
+static void runIsr(void)
+{
+  int calls = 0;
+
+  if (!isrFunction || inIsr)
+  {
+    return;
+  }
+  while (IE_EA && (EIE1 & EIE1_EUSB0) && irqPending())
+  {
+    if (++calls > ISR_LIMIT)
+    {
+      usb0sim_error("interrupt flags not cleared by the ISR");
+      sie.in1int = sie.out1int = sie.cmint = 0;
+      return;
+    }
+    inIsr = true;
+    stats.interrupts++;
+    isrFunction();
+    commit(&rings[1]);
+    inIsr = false;
+  }
+}
+
+// -----------------------------------------------------------------------------
+// FIFOs
+// -----------------------------------------------------------------------------
+
+static void fifoClear(Fifo_t *f)
+{
+  f->packets = 0;
+  f->head = 0;
+  f->loaded = 0;
+  f->readPos = 0;
+}
+
+// Drop the oldest packet
+static void fifoPop(Fifo_t *f)
+{
+  if (f->packets)
+  {
+    f->head ^= 1;
+    f->packets--;
+  }
+  f->readPos = 0;
+}
+
+static void fifoPush(Fifo_t *f, const uint8_t *buf, uint16_t len)
+{
+  uint8_t n = (uint8_t)((f->head + f->packets) & 1);
+
+  memcpy(f->data[n], buf, len);
+  f->length[n] = len;
+  f->packets++;
+}
+
+// Bytes of the endpoint FIFO available to one direction, and the packets
+// that direction holds
+static uint16_t fifoSpace(uint8_t ep)
+{
+  Endpoint_t *e = &sie.ep[ep];
+  uint16_t size = fifoSize[ep];
+
+  if (ep && (e->inCsrH & INH_SPLIT))
+  {
+    size /= 2;
+  }
+  return size;
+}
+
+static uint8_t fifoDepth(uint8_t ep, bool in)
+{
+  Endpoint_t *e = &sie.ep[ep];
+
+  if (!ep)
+  {
+    return 1;
+  }
+  if (in)
+  {
+    return (e->inCsrH & INH_DBIEN) ? 2 : 1;
+  }
+  return (e->outCsrH & OUTH_DBOEN) ? 2 : 1;
+}
+
+// Largest packet one direction of an endpoint can hold
+static uint16_t packetSpace(uint8_t ep, bool in)
+{
+  return fifoSpace(ep) / fifoDepth(ep, in);
+}
+
+// True if the endpoint FIFO is set up for this direction
+static bool directionEnabled(uint8_t ep, bool in)
+{
+  Endpoint_t *e = &sie.ep[ep];
+
+  if (e->inCsrH & INH_SPLIT)
+  {
+    return true;
+  }
+  return in == !!(e->inCsrH & INH_DIRSEL);
+}
+
+static uint8_t fifoRead(uint8_t ep)
+{
+  Fifo_t *f = &sie.ep[ep].out;
+
+  if (!f->packets || (f->readPos >= f->length[f->head]))
+  {
+    // Auto-read runs one byte past the end of a packet; that byte is not
+    // used
+    return 0;
+  }
+  stats.fifoReads++;
+  return f->data[f->head][f->readPos++];
+}
+
+static void fifoWrite(uint8_t ep, uint8_t value)
+{
+  Fifo_t *f = &sie.ep[ep].in;
+  uint16_t space = ep ? packetSpace(ep, true) : EP0_SIZE;
+
+  stats.fifoWrites++;
+  if (f->packets >= fifoDepth(ep, true))
+  {
+    usb0sim_error("EP%u IN FIFO written while full", ep);
+    return;
+  }
+  if (f->loaded >= space)
+  {
+    usb0sim_error("EP%u IN packet longer than its %u byte FIFO", ep, space);
+    return;
+  }
+  f->data[(f->head + f->packets) & 1][f->loaded++] = value;
+}
+
+// -----------------------------------------------------------------------------
+// Indirect registers
+// -----------------------------------------------------------------------------
+
+// Registers that reset on a bus reset as well as at power-on
+static void resetEndpoints(void)
+{
+  uint8_t i;
+
+  for (i = 0; i < EP_COUNT; i++)
+  {
+    memset(&sie.ep[i], 0, sizeof(sie.ep[i]));
+  }
+  sie.faddr = 0;
+  sie.addrPending = false;
+  sie.index = 0;
+  sie.e0csr = 0;
+  sie.phase = PHASE_IDLE;
+  sie.in1int = sie.out1int = sie.cmint = 0;
+}
+
+static void powerOnReset(void)
+{
+  memset(&sie, 0, sizeof(sie));
+  resetEndpoints();
+  sie.power = POWER_USBINH;
+  sie.in1ie = IN1IE_RESET;
+  sie.out1ie = OUT1IE_RESET;
+  sie.cmie = CMIE_RESET;
+}
+
+static uint8_t readE0csr(void)
+{
+  return sie.e0csr;
+}
+
+static uint8_t readInCsrL(Endpoint_t *e, uint8_t ep)
+{
+  uint8_t csr = e->inCsrL & (IN_UNDRUN | IN_SDSTL | IN_STSTL);
+
+  if (e->in.packets)
+  {
+    csr |= IN_FIFONE;
+  }
+  if (e->in.packets >= fifoDepth(ep, true))
+  {
+    csr |= IN_INPRDY;
+  }
+  return csr;
+}
+
+static uint8_t readOutCsrL(Endpoint_t *e, uint8_t ep)
+{
+  uint8_t csr = e->outCsrL & (OUT_SDSTL | OUT_STSTL);
+
+  if (e->out.packets)
+  {
+    csr |= OUT_OPRDY;
+  }
+  if (e->out.packets >= fifoDepth(ep, false))
+  {
+    csr |= OUT_FIFOFUL;
+  }
+  return csr;
+}
+
+static uint8_t readReg(uint8_t addr)
+{
+  Endpoint_t *e = &sie.ep[sie.index];
+  Fifo_t *f = &e->out;
+  uint8_t value;
+
+  switch (addr)
+  {
+    case FADDR:
+      return sie.faddr | (sie.addrPending ? FADDR_UPDATE : 0);
+    case POWER:
+      return sie.power;
+    case IN1INT:
+      value = sie.in1int;
+      sie.in1int = 0;
+      return value;
+    case OUT1INT:
+      value = sie.out1int;
+      sie.out1int = 0;
+      return value;
+    case CMINT:
+      value = sie.cmint;
+      sie.cmint = 0;
+      if (pollHook && !inIsr)
+      {
+        pollHook();
+      }
+      return value;
+    case IN1IE:
+      return sie.in1ie;
+    case OUT1IE:
+      return sie.out1ie;
+    case CMIE:
+      return sie.cmie;
+    case FRAMEL:
+      return (uint8_t)sie.frame;
+    case FRAMEH:
+      return (uint8_t)(sie.frame >> 8);
+    case INDEX:
+      return sie.index;
+    case CLKREC:
+      return sie.clkrec;
+    case E0CSR:
+      return sie.index ? readInCsrL(e, sie.index) : readE0csr();
+    case EINCSRH:
+      return sie.index ? e->inCsrH : 0;
+    case EOUTCSRL:
+      return sie.index ? readOutCsrL(e, sie.index) : 0;
+    case EOUTCSRH:
+      return sie.index ? e->outCsrH : 0;
+    case E0CNT:
+      return f->packets ? (uint8_t)f->length[f->head] : 0;
+    case EOUTCNTH:
+      return (sie.index && f->packets) ? (uint8_t)(f->length[f->head] >> 8) : 0;
+    case EENABLE:
+      return sie.eenable;
+    case FIFO0:
+    case FIFO1:
+    case FIFO2:
+    case FIFO3:
+      return fifoRead(addr - FIFO0);
+    default:
+      usb0sim_error("read of unknown USB0 register 0x%02X", addr);
+      return 0;
+  }
+}
+
+// Apply a SET_ADDRESS once its status stage has completed
+static void endControl(void)
+{
+  sie.phase = PHASE_IDLE;
+  sie.e0csr &= ~E0_DATAEND;
+  if (sie.addrPending)
+  {
+    sie.faddr = sie.newAddr;
+    sie.addrPending = false;
+  }
+}
+
+static void writeE0csr(uint8_t value)
+{
+  Fifo_t *in = &sie.ep[0].in;
+
+  if (!(value & E0_STSTL))
+  {
+    sie.e0csr &= ~E0_STSTL;
+  }
+  if (value & E0_SSUEND)
+  {
+    sie.e0csr &= ~E0_SUEND;
+  }
+  if (value & E0_SDSTL)
+  {
+    sie.e0csr |= E0_SDSTL;
+  }
+  if (value & E0_SOPRDY)
+  {
+    if (sie.e0csr & E0_OPRDY)
+    {
+      sie.e0csr &= ~E0_OPRDY;
+      fifoPop(&sie.ep[0].out);
+      if (value & E0_DATAEND)
+      {
+        sie.e0csr |= E0_DATAEND;
+        if ((sie.phase == PHASE_SETUP) && sie.setupIn && sie.setupLength)
+        {
+          usb0sim_error("DATAEND set for an IN request before its data");
+        }
+        sie.phase = PHASE_STATUS_IN;
+      }
+      else if (sie.phase == PHASE_SETUP)
+      {
+        sie.phase = sie.setupIn ? PHASE_DATA_IN : PHASE_DATA_OUT;
+      }
+    }
+    else
+    {
+      usb0sim_error("E0CSR.SOPRDY written with no OUT packet");
+    }
+  }
+  if (value & E0_INPRDY)
+  {
+    if (sie.e0csr & E0_INPRDY)
+    {
+      usb0sim_error("E0CSR.INPRDY written while a packet is waiting");
+      return;
+    }
+    if (sie.e0csr & E0_OPRDY)
+    {
+      usb0sim_error("E0CSR.INPRDY written before the setup was serviced");
+    }
+    if ((sie.phase != PHASE_DATA_IN) && (sie.phase != PHASE_SETUP))
+    {
+      usb0sim_error("EP0 IN packet loaded outside an IN data stage");
+    }
+    sie.phase = PHASE_DATA_IN;
+    in->length[0] = in->loaded;
+    in->packets = 1;
+    in->loaded = 0;
+    sie.e0csr |= E0_INPRDY;
+    if (value & E0_DATAEND)
+    {
+      sie.e0csr |= E0_DATAEND;
+    }
+  }
+}
+
+static void writeInCsrL(Endpoint_t *e, uint8_t ep, uint8_t value)
+{
+  Fifo_t *f = &e->in;
+
+  if (!(value & IN_UNDRUN))
+  {
+    e->inCsrL &= ~IN_UNDRUN;
+  }
+  if (!(value & IN_STSTL))
+  {
+    e->inCsrL &= ~IN_STSTL;
+  }
+  e->inCsrL = (e->inCsrL & ~IN_SDSTL) | (value & IN_SDSTL);
+  if (value & IN_CLRDT)
+  {
+    e->inToggle = 0;
+  }
+  if (value & IN_FLUSH)
+  {
+    // Flushes the next packet to be sent, or the one being loaded
+    if (f->packets)
+    {
+      fifoPop(f);
+    }
+    else
+    {
+      f->loaded = 0;
+    }
+  }
+  if (value & IN_INPRDY)
+  {
+    if (f->packets >= fifoDepth(ep, true))
+    {
+      usb0sim_error("EP%u EINCSRL.INPRDY written with no free FIFO", ep);
+      return;
+    }
+    f->length[(f->head + f->packets) & 1] = f->loaded;
+    f->packets++;
+    f->loaded = 0;
+  }
+}
+
+static void writeOutCsrL(Endpoint_t *e, uint8_t value)
+{
+  if (!(value & OUT_STSTL))
+  {
+    e->outCsrL &= ~OUT_STSTL;
+  }
+  e->outCsrL = (e->outCsrL & ~OUT_SDSTL) | (value & OUT_SDSTL);
+  if (value & OUT_CLRDT)
+  {
+    e->outToggle = 0;
+  }
+  if (value & OUT_FLUSH)
+  {
+    fifoPop(&e->out);
+  }
+  else if (!(value & OUT_OPRDY))
+  {
+    // Clearing OPRDY releases the packet and presents the next one
+    fifoPop(&e->out);
+  }
+}
+
+static void writeReg(uint8_t addr, uint8_t value)
+{
+  Endpoint_t *e = &sie.ep[sie.index];
+
+  switch (addr)
+  {
+    case FADDR:
+      sie.newAddr = value & 0x7F;
+      if (sie.phase == PHASE_IDLE)
+      {
+        sie.faddr = sie.newAddr;
+      }
+      else
+      {
+        sie.addrPending = true;
+      }
+      break;
+    case POWER:
+      if (value & POWER_USBRST)
+      {
+        resetEndpoints();
+      }
+      if ((value & POWER_RESUME) && (sie.power & POWER_SUSMD))
+      {
+        sie.wakeup = true;
+      }
+      sie.power = (sie.power & POWER_SUSMD)
+                  | (value & ~(POWER_SUSMD | POWER_USBRST));
+      break;
+    case IN1IE:
+      sie.in1ie = value;
+      break;
+    case OUT1IE:
+      sie.out1ie = value;
+      break;
+    case CMIE:
+      sie.cmie = value;
+      break;
+    case INDEX:
+      if (value >= EP_COUNT)
+      {
+        usb0sim_error("INDEX set to %u", value);
+        value = 0;
+      }
+      sie.index = value;
+      break;
+    case CLKREC:
+      sie.clkrec = value;
+      break;
+    case E0CSR:
+      if (sie.index)
+      {
+        writeInCsrL(e, sie.index, value);
+      }
+      else
+      {
+        writeE0csr(value);
+      }
+      break;
+    case EINCSRH:
+      e->inCsrH = value;
+      break;
+    case EOUTCSRL:
+      writeOutCsrL(e, value);
+      break;
+    case EOUTCSRH:
+      e->outCsrH = value;
+      break;
+    case EENABLE:
+      sie.eenable = value;
+      break;
+    case FIFO0:
+    case FIFO1:
+    case FIFO2:
+    case FIFO3:
+      fifoWrite(addr - FIFO0, value);
+      break;
+    case IN1INT:
+    case OUT1INT:
+    case CMINT:
+    case E0CNT:
+    case EOUTCNTH:
+    case FRAMEL:
+    case FRAMEH:
+      usb0sim_error("write to read-only USB0 register 0x%02X", addr);
+      break;
+    default:
+      usb0sim_error("write of unknown USB0 register 0x%02X", addr);
+      break;
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Model control
+// -----------------------------------------------------------------------------
+
+void usb0sim_init(void (*isr)(void))
+{
+  powerOnReset();
+  memset(rings, 0, sizeof(rings));
+  memset(&stats, 0, sizeof(stats));
+  USB0XCN = 0;
+  EIE1 = 0;
+  IE_EA = 0;
+  isrFunction = isr;
+  inIsr = false;
+}
+
+void usb0sim_setIdle(void (*idle)(void))
+{
+  idleFunction = idle;
+}
+
+void usb0sim_setPollHook(void (*hook)(void))
+{
+  pollHook = hook;
+}
+
+const Usb0Sim_Stats_t *usb0sim_stats(void)
+{
+  return &stats;
+}
+
+void usb0sim_clearStats(void)
+{
+  memset(&stats, 0, sizeof(stats));
+}
+
+void usb0sim_error(const char *format, ...)
+{
+  va_list args;
+
+  stats.errors++;
+  fprintf(stderr, "usb0sim: ");
+  va_start(args, format);
+  vfprintf(stderr, format, args);
+  va_end(args);
+  fputc('\n', stderr);
+}
+
+bool usb0sim_attached(void)
+{
+  return ((USB0XCN & (XCN_PREN | XCN_PHYEN)) == (XCN_PREN | XCN_PHYEN))
+         && !(sie.power & POWER_USBINH);
+}
+
+bool usb0sim_wakeupSignaled(void)
+{
+  return sie.wakeup;
+}
+
+// -----------------------------------------------------------------------------
+// Bus events and transactions
+// -----------------------------------------------------------------------------
+
+void usb0sim_busReset(void)
+{
+  sync();
+  if ((USB0XCN & (XCN_PREN | XCN_PHYEN)) != (XCN_PREN | XCN_PHYEN))
+  {
+    return;
+  }
+  resetEndpoints();
+  sie.power &= ~POWER_SUSMD;
+  sie.in1ie = IN1IE_RESET;
+  sie.out1ie = OUT1IE_RESET;
+  sie.cmie = CMIE_BUS_RESET;
+  sie.cmint |= CMINT_RSTINT;
+  runIsr();
+}
+
+void usb0sim_sof(void)
+{
+  sync();
+  stats.frames++;
+  if (!usb0sim_attached())
+  {
+    return;
+  }
+  sie.frame = (sie.frame + 1) & 0x7FF;
+  sie.cmint |= CMINT_SOF;
+  runIsr();
+}
+
+void usb0sim_suspend(void)
+{
+  sync();
+  if (usb0sim_attached() && (sie.power & POWER_SUSEN))
+  {
+    sie.power |= POWER_SUSMD;
+    sie.wakeup = false;
+    sie.cmint |= CMINT_SUSINT;
+    runIsr();
+  }
+}
+
+void usb0sim_resume(void)
+{
+  sync();
+  if (sie.power & POWER_SUSMD)
+  {
+    sie.power &= ~(POWER_SUSMD | POWER_RESUME);
+    sie.cmint |= CMINT_RSUINT;
+    runIsr();
+  }
+}
+
+// A device responds only when attached and addressed
+static bool selected(uint8_t addr)
+{
+  sync();
+  return usb0sim_attached() && (addr == sie.faddr);
+}
+
+static int handshake(int result)
+{
+  if (result == USB0SIM_NAK)
+  {
+    stats.naks++;
+  }
+  runIsr();
+  return result;
+}
+
+int usb0sim_setup(uint8_t addr, const uint8_t setup[8])
+{
+  Endpoint_t *e = &sie.ep[0];
+
+  if (!selected(addr))
+  {
+    return USB0SIM_TIMEOUT;
+  }
+
+  // A SETUP ends any transfer in progress
+  if ((sie.phase != PHASE_IDLE) || (sie.e0csr & E0_OPRDY))
+  {
+    sie.e0csr |= E0_SUEND;
+  }
+  sie.e0csr &= ~(E0_INPRDY | E0_DATAEND | E0_SDSTL);
+  fifoClear(&e->in);
+  fifoClear(&e->out);
+  fifoPush(&e->out, setup, 8);
+  sie.e0csr |= E0_OPRDY;
+  sie.e0Toggle = 1;
+  sie.setupIn = !!(setup[0] & 0x80);
+  sie.setupLength = setup[6] | (setup[7] << 8);
+  sie.phase = PHASE_SETUP;
+  sie.in1int |= 0x01;
+  return handshake(USB0SIM_ACK);
+}
+
+static int stallEp0(void)
+{
+  sie.e0csr = (sie.e0csr & ~E0_SDSTL) | E0_STSTL;
+  sie.phase = PHASE_IDLE;
+  sie.in1int |= 0x01;
+  return handshake(USB0SIM_STALL);
+}
+
+static int inEp0(uint8_t *buf, uint16_t *len, uint8_t *toggle)
+{
+  Fifo_t *f = &sie.ep[0].in;
+
+  if (sie.e0csr & E0_SDSTL)
+  {
+    return stallEp0();
+  }
+  if (sie.phase == PHASE_STATUS_IN)
+  {
+    *len = 0;
+    *toggle = 1;
+    endControl();
+    sie.in1int |= 0x01;
+    return handshake(USB0SIM_ACK);
+  }
+  if ((sie.phase != PHASE_DATA_IN) || !(sie.e0csr & E0_INPRDY))
+  {
+    return handshake(USB0SIM_NAK);
+  }
+  *len = f->length[0];
+  memcpy(buf, f->data[0], *len);
+  *toggle = sie.e0Toggle;
+  sie.e0Toggle ^= 1;
+  fifoClear(f);
+  sie.e0csr &= ~E0_INPRDY;
+  if (sie.e0csr & E0_DATAEND)
+  {
+    sie.phase = PHASE_STATUS_OUT;
+  }
+  stats.packetsIn++;
+  sie.in1int |= 0x01;
+  return handshake(USB0SIM_ACK);
+}
+
+static int outEp0(uint8_t toggle, const uint8_t *buf, uint16_t len)
+{
+  Endpoint_t *e = &sie.ep[0];
+
+  if (sie.e0csr & E0_SDSTL)
+  {
+    return stallEp0();
+  }
+  if (sie.phase == PHASE_STATUS_OUT)
+  {
+    if (len)
+    {
+      return USB0SIM_PROTOCOL;
+    }
+    endControl();
+    sie.in1int |= 0x01;
+    return handshake(USB0SIM_ACK);
+  }
+  if (sie.phase == PHASE_DATA_IN)
+  {
+    // The host ended the data stage before the firmware set DATAEND
+    sie.e0csr |= E0_SUEND;
+    sie.e0csr &= ~E0_INPRDY;
+    fifoClear(&e->in);
+    sie.phase = PHASE_IDLE;
+    sie.in1int |= 0x01;
+    return handshake(USB0SIM_ACK);
+  }
+  if ((sie.phase != PHASE_DATA_OUT) || (sie.e0csr & E0_OPRDY))
+  {
+    return handshake(USB0SIM_NAK);
+  }
+  if (len > EP0_SIZE)
+  {
+    return USB0SIM_PROTOCOL;
+  }
+  if (toggle == sie.e0Toggle)
+  {
+    sie.e0Toggle ^= 1;
+    fifoClear(&e->out);
+    fifoPush(&e->out, buf, len);
+    sie.e0csr |= E0_OPRDY;
+    stats.packetsOut++;
+    sie.in1int |= 0x01;
+  }
+  return handshake(USB0SIM_ACK);
+}
+
+int usb0sim_in(uint8_t addr, uint8_t ep, uint8_t *buf, uint16_t *len,
+               uint8_t *toggle)
+{
+  Endpoint_t *e = &sie.ep[ep];
+  Fifo_t *f = &e->in;
+
+  *len = 0;
+  if ((ep >= EP_COUNT) || !selected(addr))
+  {
+    return USB0SIM_TIMEOUT;
+  }
+  if (!ep)
+  {
+    return inEp0(buf, len, toggle);
+  }
+  if (!directionEnabled(ep, true))
+  {
+    usb0sim_error("IN token for EP%u, which is set up for OUT", ep);
+    return USB0SIM_TIMEOUT;
+  }
+  if (e->inCsrL & IN_SDSTL)
+  {
+    e->inCsrL |= IN_STSTL;
+    sie.in1int |= 1 << ep;
+    return handshake(USB0SIM_STALL);
+  }
+  if (!f->packets)
+  {
+    return handshake(USB0SIM_NAK);
+  }
+  *len = f->length[f->head];
+  memcpy(buf, f->data[f->head], *len);
+  *toggle = e->inToggle;
+  e->inToggle ^= 1;
+  fifoPop(f);
+  stats.packetsIn++;
+  sie.in1int |= 1 << ep;
+  return handshake(USB0SIM_ACK);
+}
+
+int usb0sim_out(uint8_t addr, uint8_t ep, uint8_t toggle,
+                const uint8_t *buf, uint16_t len)
+{
+  Endpoint_t *e = &sie.ep[ep];
+  Fifo_t *f = &e->out;
+
+  if ((ep >= EP_COUNT) || !selected(addr))
+  {
+    return USB0SIM_TIMEOUT;
+  }
+  if (!ep)
+  {
+    return outEp0(toggle, buf, len);
+  }
+  if (!directionEnabled(ep, false))
+  {
+    usb0sim_error("OUT token for EP%u, which is set up for IN", ep);
+    return USB0SIM_TIMEOUT;
+  }
+  if (e->outCsrL & OUT_SDSTL)
+  {
+    e->outCsrL |= OUT_STSTL;
+    sie.out1int |= 1 << ep;
+    return handshake(USB0SIM_STALL);
+  }
+  if (len > packetSpace(ep, false))
+  {
+    usb0sim_error("EP%u OUT packet of %u bytes does not fit its FIFO",
+                  ep, len);
+    return USB0SIM_PROTOCOL;
+  }
+  if (f->packets >= fifoDepth(ep, false))
+  {
+    return handshake(USB0SIM_NAK);
+  }
+
+  // A packet with the wrong toggle repeats one whose ACK was lost; it is
+  // acknowledged and dropped
+  if (toggle == e->outToggle)
+  {
+    e->outToggle ^= 1;
+    fifoPush(f, buf, len);
+    stats.packetsOut++;
+    sie.out1int |= 1 << ep;
+  }
+  return handshake(USB0SIM_ACK);
+}
+
+// -----------------------------------------------------------------------------
+// Virtual host
+// -----------------------------------------------------------------------------
+
+static uint8_t hostAddr;
+static uint8_t hostInToggle[EP_COUNT];
+static uint8_t hostOutToggle[EP_COUNT];
+static uint16_t hostInSize[EP_COUNT];
+static uint16_t hostOutSize[EP_COUNT];
+static unsigned long retryLimit = 10000;
+
+void usb0sim_setMaxPacket(uint8_t epAddr, uint16_t size)
+{
+  uint8_t ep = epAddr & 0x0F;
+
+  if (ep < EP_COUNT)
+  {
+    if (epAddr & 0x80)
+    {
+      hostInSize[ep] = size;
+    }
+    else
+    {
+      hostOutSize[ep] = size;
+    }
+  }
+}
+
+void usb0sim_setRetries(unsigned long retries)
+{
+  retryLimit = retries;
+}
+
+// Let the device run, then start a new frame
+static void waitFrame(void)
+{
+  if (idleFunction)
+  {
+    idleFunction();
+  }
+  usb0sim_sof();
+}
+
+static int inPacket(uint8_t ep, uint8_t *toggle, uint8_t *buf, uint16_t *len)
+{
+  unsigned long tries = 0;
+  uint8_t pid;
+  int result;
+
+  for (;;)
+  {
+    result = usb0sim_in(hostAddr, ep, buf, len, &pid);
+    if (result == USB0SIM_ACK)
+    {
+      if (pid != *toggle)
+      {
+        usb0sim_error("EP%u IN packet has DATA%u, expected DATA%u",
+                      ep, pid, *toggle);
+        return USB0SIM_PROTOCOL;
+      }
+      *toggle ^= 1;
+      return result;
+    }
+    if ((result != USB0SIM_NAK) || (++tries > retryLimit))
+    {
+      return (result == USB0SIM_NAK) ? USB0SIM_TIMEOUT : result;
+    }
+    waitFrame();
+  }
+}
+
+static int outPacket(uint8_t ep, uint8_t *toggle, const uint8_t *buf,
+                     uint16_t len)
+{
+  unsigned long tries = 0;
+  int result;
+
+  for (;;)
+  {
+    result = usb0sim_out(hostAddr, ep, *toggle, buf, len);
+    if (result == USB0SIM_ACK)
+    {
+      *toggle ^= 1;
+      return result;
+    }
+    if ((result != USB0SIM_NAK) || (++tries > retryLimit))
+    {
+      return (result == USB0SIM_NAK) ? USB0SIM_TIMEOUT : result;
+    }
+    waitFrame();
+  }
+}
+
+static void resetToggles(void)
+{
+  memset(hostInToggle, 0, sizeof(hostInToggle));
+  memset(hostOutToggle, 0, sizeof(hostOutToggle));
+}
+
+// Host side effects of a completed standard request
+static void afterControl(const uint8_t setup[8])
+{
+  uint16_t value = setup[2] | (setup[3] << 8);
+  uint8_t ep = setup[4] & 0x0F;
+
+  if ((setup[0] & 0x60) != 0)
+  {
+    return;
+  }
+  switch (setup[1])
+  {
+    case REQ_SET_ADDRESS:
+      hostAddr = value & 0x7F;
+      break;
+    case REQ_SET_CONFIGURATION:
+    case REQ_SET_INTERFACE:
+      resetToggles();
+      break;
+    case REQ_CLEAR_FEATURE:
+      if (((setup[0] & 0x1F) == 2) && (value == 0) && (ep < EP_COUNT))
+      {
+        if (setup[4] & 0x80)
+        {
+          hostInToggle[ep] = 0;
+        }
+        else
+        {
+          hostOutToggle[ep] = 0;
+        }
+      }
+      break;
+  }
+}
+
+int usb0sim_control(const uint8_t setup[8], uint8_t *data, uint16_t *length)
+{
+  uint16_t wLength = setup[6] | (setup[7] << 8);
+  uint16_t count = 0;
+  uint16_t len;
+  uint8_t toggle = 1;
+  uint8_t packet[512];
+  int result;
+
+  *length = 0;
+  result = usb0sim_setup(hostAddr, setup);
+  if (result != USB0SIM_ACK)
+  {
+    return result;
+  }
+
+  if (wLength && (setup[0] & 0x80))
+  {
+    // IN data stage ends with a short packet or after wLength bytes
+    do
+    {
+      result = inPacket(0, &toggle, packet, &len);
+      if (result != USB0SIM_ACK)
+      {
+        return result;
+      }
+      if (len > EP0_SIZE || (count + len > wLength))
+      {
+        usb0sim_error("EP0 sent %u bytes for a wLength of %u",
+                      count + len, wLength);
+        return USB0SIM_PROTOCOL;
+      }
+      memcpy(data + count, packet, len);
+      count += len;
+    } while ((len == EP0_SIZE) && (count < wLength));
+
+    toggle = 1;
+    result = outPacket(0, &toggle, NULL, 0);
+  }
+  else
+  {
+    while (count < wLength)
+    {
+      len = wLength - count;
+      if (len > EP0_SIZE)
+      {
+        len = EP0_SIZE;
+      }
+      result = outPacket(0, &toggle, data + count, len);
+      if (result != USB0SIM_ACK)
+      {
+        return result;
+      }
+      count += len;
+    }
+
+    toggle = 1;
+    result = inPacket(0, &toggle, packet, &len);
+    if ((result == USB0SIM_ACK) && len)
+    {
+      usb0sim_error("EP0 status stage has %u bytes", len);
+      result = USB0SIM_PROTOCOL;
+    }
+  }
+
+  *length = count;
+  if (result == USB0SIM_ACK)
+  {
+    afterControl(setup);
+  }
+  return result;
+}
+
+int usb0sim_bulkIn(uint8_t ep, uint8_t *buf, uint16_t size, uint16_t *length)
+{
+  uint16_t count = 0;
+  uint16_t len;
+  uint8_t packet[512];
+  int result;
+
+  *length = 0;
+  do
+  {
+    result = inPacket(ep, &hostInToggle[ep], packet, &len);
+    if (result != USB0SIM_ACK)
+    {
+      break;
+    }
+    if ((len > hostInSize[ep]) || (count + len > size))
+    {
+      usb0sim_error("EP%u IN packet of %u bytes overruns the transfer",
+                    ep, len);
+      result = USB0SIM_PROTOCOL;
+      break;
+    }
+    memcpy(buf + count, packet, len);
+    count += len;
+  } while ((len == hostInSize[ep]) && (count < size));
+
+  *length = count;
+  return result;
+}
+
+int usb0sim_bulkOut(uint8_t ep, const uint8_t *buf, uint16_t size, bool zlp)
+{
+  uint16_t count = 0;
+  uint16_t len;
+  int result;
+
+  do
+  {
+    len = size - count;
+    if (len > hostOutSize[ep])
+    {
+      len = hostOutSize[ep];
+    }
+    result = outPacket(ep, &hostOutToggle[ep], buf + count, len);
+    if (result != USB0SIM_ACK)
+    {
+      return result;
+    }
+    count += len;
+  } while ((count < size) || (zlp && (len == hostOutSize[ep]) && len));
+
+  return result;
+}
+
+// -----------------------------------------------------------------------------
+// Enumeration
+// -----------------------------------------------------------------------------
+
+static int getDescriptor(uint8_t type, uint8_t index, uint16_t langId,
+                         uint8_t *buf, uint16_t size, uint16_t *length)
+{
+  uint8_t setup[8];
+
+  setup[0] = 0x80;
+  setup[1] = REQ_GET_DESCRIPTOR;
+  setup[2] = index;
+  setup[3] = type;
+  setup[4] = (uint8_t)langId;
+  setup[5] = (uint8_t)(langId >> 8);
+  setup[6] = (uint8_t)size;
+  setup[7] = (uint8_t)(size >> 8);
+  return usb0sim_control(setup, buf, length);
+}
+
+static int checkDescriptor(const char *name, const uint8_t *desc,
+                           uint16_t length, uint8_t type, uint16_t size)
+{
+  if ((length < 2) || (desc[1] != type) || (length != size))
+  {
+    usb0sim_error("%s descriptor: %u bytes of type %u, expected %u of "
+                  "type %u", name, length, length > 1 ? desc[1] : 0,
+                  size, type);
+    return USB0SIM_PROTOCOL;
+  }
+  return USB0SIM_ACK;
+}
+
+// Check that the descriptors of a configuration tile it exactly, and take
+// the packet size of each endpoint
+static int parseConfig(const uint8_t *config, uint16_t length)
+{
+  uint16_t pos = 0;
+
+  while (pos < length)
+  {
+    if ((config[pos] < 2) || (pos + config[pos] > length))
+    {
+      usb0sim_error("configuration descriptor: bad length at offset %u", pos);
+      return USB0SIM_PROTOCOL;
+    }
+    if ((config[pos + 1] == DESC_ENDPOINT) && (config[pos] >= 7))
+    {
+      usb0sim_setMaxPacket(config[pos + 2],
+                           config[pos + 4] | (config[pos + 5] << 8));
+    }
+    pos += config[pos];
+  }
+  return USB0SIM_ACK;
+}
+
+int usb0sim_enumerate(uint8_t address, Usb0Sim_Device_t *device)
+{
+  uint8_t setup[8] = { 0, REQ_SET_ADDRESS, 0, 0, 0, 0, 0, 0 };
+  uint8_t buf[256];
+  uint16_t langId = 0;
+  uint16_t length;
+  uint16_t total;
+  int result;
+  int i;
+
+  memset(device, 0, sizeof(*device));
+  hostAddr = 0;
+  resetToggles();
+  memset(hostInSize, 0, sizeof(hostInSize));
+  memset(hostOutSize, 0, sizeof(hostOutSize));
+  hostInSize[0] = hostOutSize[0] = EP0_SIZE;
+
+  if (!usb0sim_attached())
+  {
+    return USB0SIM_TIMEOUT;
+  }
+
+  // Read the start of the device descriptor at address 0, as Windows does,
+  // then reset again
+  usb0sim_busReset();
+  waitFrame();
+  result = getDescriptor(DESC_DEVICE, 0, 0, buf, 64, &length);
+  if (result != USB0SIM_ACK)
+  {
+    return result;
+  }
+  if ((length < 8) || (buf[1] != DESC_DEVICE))
+  {
+    usb0sim_error("device descriptor at address 0 has %u bytes", length);
+    return USB0SIM_PROTOCOL;
+  }
+  usb0sim_busReset();
+  waitFrame();
+
+  setup[2] = address;
+  result = usb0sim_control(setup, NULL, &length);
+  if (result != USB0SIM_ACK)
+  {
+    return result;
+  }
+  device->address = address;
+
+  // The new address takes effect once the status stage is done
+  waitFrame();
+  result = getDescriptor(DESC_DEVICE, 0, 0, device->device, 18, &length);
+  if ((result != USB0SIM_ACK)
+      || ((result = checkDescriptor("device", device->device, length,
+                                    DESC_DEVICE, 18)) != USB0SIM_ACK))
+  {
+    return result;
+  }
+
+  result = getDescriptor(DESC_CONFIG, 0, 0, buf, 9, &length);
+  if ((result != USB0SIM_ACK)
+      || ((result = checkDescriptor("configuration", buf, length,
+                                    DESC_CONFIG, 9)) != USB0SIM_ACK))
+  {
+    return result;
+  }
+  total = buf[2] | (buf[3] << 8);
+  if (total > sizeof(device->config))
+  {
+    usb0sim_error("configuration descriptor of %u bytes", total);
+    return USB0SIM_PROTOCOL;
+  }
+  result = getDescriptor(DESC_CONFIG, 0, 0, device->config, total, &length);
+  if (result != USB0SIM_ACK)
+  {
+    return result;
+  }
+  if (length != total)
+  {
+    usb0sim_error("configuration descriptor has %u of %u bytes",
+                  length, total);
+    return USB0SIM_PROTOCOL;
+  }
+  device->configLength = length;
+  result = parseConfig(device->config, length);
+  if (result != USB0SIM_ACK)
+  {
+    return result;
+  }
+
+  // Strings named by the device descriptor (iManufacturer, iProduct,
+  // iSerialNumber), read with the largest request a host makes
+  for (i = 14; i <= 16; i++)
+  {
+    if (!device->device[i])
+    {
+      continue;
+    }
+    if (!langId)
+    {
+      result = getDescriptor(DESC_STRING, 0, 0, buf, 255, &length);
+      if ((result != USB0SIM_ACK)
+          || ((result = checkDescriptor("language ID string", buf, length,
+                                        DESC_STRING, buf[0])) != USB0SIM_ACK))
+      {
+        return result;
+      }
+      langId = buf[2] | (buf[3] << 8);
+    }
+    result = getDescriptor(DESC_STRING, device->device[i], langId,
+                           buf, 255, &length);
+    if ((result != USB0SIM_ACK)
+        || ((result = checkDescriptor("string", buf, length,
+                                      DESC_STRING, buf[0])) != USB0SIM_ACK))
+    {
+      return result;
+    }
+    if (length & 1)
+    {
+      usb0sim_error("string descriptor %u has an odd length",
+                    device->device[i]);
+      return USB0SIM_PROTOCOL;
+    }
+  }
+
+  setup[1] = REQ_SET_CONFIGURATION;
+  setup[2] = device->config[5];
+  return usb0sim_control(setup, NULL, &length);
+}
@@ -0,0 +1,233 @@
+/******************************************************************************
+ * Copyright (c) 2021 by Silicon Laboratories Inc. All rights reserved.
+ *
+ * http://developer.silabs.com/legal/version/v11/Silicon_Labs_Software_License_Agreement.txt
+ *****************************************************************************/
+
+#ifndef __USB0_SIM_H__
+#define __USB0_SIM_H__
+
+// Host model of the C8051F3xx / EFM8UB USB0 serial interface engine (SIE),
+// plus a virtual USB host that drives it with SETUP, IN and OUT tokens.
+//
+// Firmware reaches the SIE through USB0ADR and USB0DAT only. Here both are
+// macros around accessor functions, so unmodified firmware source builds on
+// the host: every use of USB0ADR or USB0DAT in an expression is one SFR
+// access, and a store through it is seen at the next access. Interrupt
+// flags, endpoint CSRs and FIFOs behave as described in the device
+// reference manuals; misuse that the hardware would silently mishandle
+// (loading a full FIFO, setting INPRDY with no room, and so on) is counted
+// and reported as a firmware error.
+//
+// USB0ADR and USB0DAT are 16 bits wide here: the high byte holds a tag
+// that tells a store from a read. Firmware that uses a register read as a
+// byte (assigns it to a uint8_t, masks it with a byte constant) works
+// unchanged; firmware that compares a raw read or switches on it must copy
+// it to a uint8_t first. A store that leaves the value read unchanged
+// (USB0DAT |= bits that are already set) is not seen. None of the
+// supported firmware depends on either.
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// -----------------------------------------------------------------------------
+// Firmware side: SFR stand-ins
+// -----------------------------------------------------------------------------
+
+uint16_t *usb0sim_adr(void);
+uint16_t *usb0sim_dat(void);
+
+#define USB0ADR (*usb0sim_adr())
+#define USB0DAT (*usb0sim_dat())
+
+// Other SFRs used by USB firmware are plain variables
+extern uint8_t USB0XCN;
+extern uint8_t EIE1;
+extern uint8_t IE_EA;
+
+// USB0 indirect register addresses
+#define FADDR    0x00
+#define POWER    0x01
+#define IN1INT   0x02
+#define OUT1INT  0x04
+#define CMINT    0x06
+#define IN1IE    0x07
+#define OUT1IE   0x09
+#define CMIE     0x0B
+#define FRAMEL   0x0C
+#define FRAMEH   0x0D
+#define INDEX    0x0E
+#define CLKREC   0x0F
+#define E0CSR    0x11
+#define EINCSRL  0x11
+#define EINCSRH  0x12
+#define EOUTCSRL 0x14
+#define EOUTCSRH 0x15
+#define E0CNT    0x16
+#define EOUTCNTL 0x16
+#define EOUTCNTH 0x17
+#define EENABLE  0x1E
+#define FIFO0    0x20
+#define FIFO1    0x21
+#define FIFO2    0x22
+#define FIFO3    0x23
+
+// Interrupt vector number of USB0 on the C8051F3xx
+#define USB0_IRQn 8
+
+// -----------------------------------------------------------------------------
+// Virtual host
+// -----------------------------------------------------------------------------
+
+/// Transaction and transfer results
+#define USB0SIM_ACK       0   ///< Transaction acknowledged
+#define USB0SIM_NAK       1   ///< Device not ready; retry later
+#define USB0SIM_STALL     2   ///< Endpoint halted or request not supported
+#define USB0SIM_TIMEOUT   3   ///< No response: not attached or wrong address
+#define USB0SIM_PROTOCOL  4   ///< Wrong data toggle or packet size
+
+/// Counters kept by the SIE model. Register accesses are counted at the
+/// USB0ADR/USB0DAT level, as the firmware executes them.
+typedef struct
+{
+  unsigned long adrAccesses;    ///< USB0ADR reads and writes
+  unsigned long datAccesses;    ///< USB0DAT reads and writes
+  unsigned long fifoReads;      ///< Bytes unloaded from endpoint FIFOs
+  unsigned long fifoWrites;     ///< Bytes loaded into endpoint FIFOs
+  unsigned long interrupts;     ///< USB0 interrupt service routine calls
+  unsigned long packetsIn;      ///< Data packets sent to the host
+  unsigned long packetsOut;     ///< Data packets received from the host
+  unsigned long naks;           ///< NAK handshakes returned
+  unsigned long frames;         ///< Start of frame tokens
+  unsigned long errors;         ///< Firmware misuse of the SIE
+} Usb0Sim_Stats_t;
+
+/// Device descriptors read by usb0sim_enumerate()
+typedef struct
+{
+  uint8_t device[18];           ///< Device descriptor
+  uint8_t config[512];          ///< Full configuration descriptor
+  uint16_t configLength;        ///< Bytes in config
+  uint8_t address;              ///< Address assigned to the device
+} Usb0Sim_Device_t;
+
+/**************************************************************************//**
+ * Reset the SIE model to its power-on state.
+ *
+ * @param isr The firmware USB0 interrupt service routine, called while an
+ *   enabled interrupt is pending and EIE1.EUSB0 and IE_EA are set. Pass NULL
+ *   for firmware that polls the interrupt flags.
+ *****************************************************************************/
+void usb0sim_init(void (*isr)(void));
+
+/**************************************************************************//**
+ * Set the function the virtual host calls while it waits for the device.
+ *
+ * It is called after every NAK and once per frame. For polled firmware it
+ * must run the firmware until it next polls the interrupt flags.
+ *****************************************************************************/
+void usb0sim_setIdle(void (*idle)(void));
+
+/**************************************************************************//**
+ * Set a function called each time the firmware reads CMINT.
+ *
+ * Polled firmware reads CMINT once per pass of its USB poll loop, so this is
+ * where a simulator hands control back to the virtual host.
+ *****************************************************************************/
+void usb0sim_setPollHook(void (*hook)(void));
+
+/// Counters since usb0sim_init() or the last usb0sim_clearStats()
+const Usb0Sim_Stats_t *usb0sim_stats(void);
+void usb0sim_clearStats(void);
+
+/// Print an error attributed to the firmware and count it
+void usb0sim_error(const char *format, ...);
+
+// Single transactions. Each one first completes the firmware's last register
+// store, and afterwards runs the interrupt service routine while an enabled
+// interrupt is pending. len is the packet length; an IN buf must hold 512
+// bytes. toggle is the DATA0/DATA1 PID (0 or 1) of the data packet.
+
+/// Bus reset signaling
+void usb0sim_busReset(void);
+
+/// Start of frame token
+void usb0sim_sof(void);
+
+/// Bus idle for 3 ms, then resume signaling from the host
+void usb0sim_suspend(void);
+void usb0sim_resume(void);
+
+/// True once the firmware has signaled remote wakeup during suspend
+bool usb0sim_wakeupSignaled(void);
+
+/// True while the pull-up and transceiver are enabled
+bool usb0sim_attached(void);
+
+int usb0sim_setup(uint8_t addr, const uint8_t setup[8]);
+int usb0sim_in(uint8_t addr, uint8_t ep, uint8_t *buf, uint16_t *len,
+               uint8_t *toggle);
+int usb0sim_out(uint8_t addr, uint8_t ep, uint8_t toggle,
+                const uint8_t *buf, uint16_t len);
+
+// Transfers, as a host controller driver issues them. NAKed transactions are
+// retried after calling the idle function, up to a limit that ends the
+// transfer with USB0SIM_TIMEOUT. The host tracks data toggles and resets
+// them on SET_CONFIGURATION, SET_INTERFACE and CLEAR_FEATURE(ENDPOINT_HALT),
+// and uses a new address once SET_ADDRESS completes.
+
+/**************************************************************************//**
+ * Run a control transfer on EP0.
+ *
+ * @param setup The 8 byte setup packet (wLength little endian).
+ * @param data Data stage buffer of wLength bytes.
+ * @param length Set to the number of data stage bytes transferred.
+ * @return USB0SIM_ACK if the status stage completed.
+ *****************************************************************************/
+int usb0sim_control(const uint8_t setup[8], uint8_t *data, uint16_t *length);
+
+/**************************************************************************//**
+ * Receive a bulk or interrupt transfer.
+ *
+ * Reads packets until a short packet arrives or size bytes are received.
+ *
+ * @param ep Endpoint number (1-3).
+ * @param buf Receives the data.
+ * @param size Largest transfer to accept.
+ * @param length Set to the number of bytes received.
+ *****************************************************************************/
+int usb0sim_bulkIn(uint8_t ep, uint8_t *buf, uint16_t size, uint16_t *length);
+
+/**************************************************************************//**
+ * Send a bulk or interrupt transfer.
+ *
+ * @param ep Endpoint number (1-3).
+ * @param buf Data to send.
+ * @param size Bytes to send.
+ * @param zlp End a transfer that is a multiple of the packet size with a
+ *   zero length packet.
+ *****************************************************************************/
+int usb0sim_bulkOut(uint8_t ep, const uint8_t *buf, uint16_t size, bool zlp);
+
+/// Set the packet size the host uses for an IN (epAddr bit 7 set) or OUT
+/// endpoint. usb0sim_enumerate() sets them from the endpoint descriptors.
+void usb0sim_setMaxPacket(uint8_t epAddr, uint16_t size);
+
+/// Number of NAKed retries before a transfer times out (default 10000)
+void usb0sim_setRetries(unsigned long retries);
+
+/**************************************************************************//**
+ * Enumerate the device as a host does after attach.
+ *
+ * Resets the bus, reads the device descriptor at address 0, assigns an
+ * address, reads the device, configuration and string descriptors and sets
+ * the first configuration. Each descriptor is checked for a consistent
+ * length and type.
+ *
+ * @param address Address to assign (1-127).
+ * @param device Receives the descriptors.
+ * @return USB0SIM_ACK on success.
+ *****************************************************************************/
+int usb0sim_enumerate(uint8_t address, Usb0Sim_Device_t *device);
+
+#endif // __USB0_SIM_H__
@@ -0,0 +1,680 @@
+/******************************************************************************
+ * Copyright (c) 2021 by Silicon Laboratories Inc. All rights reserved.
+ *
+ * http://developer.silabs.com/legal/version/v11/Silicon_Labs_Software_License_Agreement.txt
+ *****************************************************************************/
+
+// Regression test and benchmark of the C8051F3xx USB device core
+// (F3xx_USB0_Device.c) on the USB0 SIE model.
+//
+// usage: usb0_test [options]
+//
+//   -n BYTES  bytes looped back through EP2 by the benchmark (default 1 MB)
+//   -s SIZE   bulk transfer size used by the benchmark, 1-1024 (default 1024)
+//   -v        print each test as it runs
+//
+// The firmware below is a vendor specific loopback device built on the
+// unmodified device core: every bulk OUT transfer on EP2 is sent back on
+// EP2 IN, vendor requests fill and read back a buffer over EP0, and a
+// vendor request queues a notification on the EP1 interrupt endpoint. The
+// virtual host enumerates it, checks the standard requests, endpoint halt,
+// suspend and remote wakeup, then measures the bulk loopback. The exit
+// status is nonzero if any check failed or the SIE model saw the firmware
+// misuse a register. See readme.txt for the build command.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "F3xx_USB0_Device.h"
+
+// -----------------------------------------------------------------------------
+// Firmware: descriptors
+// -----------------------------------------------------------------------------
+
+#define VENDOR_ID    0x10C4
+#define PRODUCT_ID   0x8A5E
+
+// Vendor requests
+#define VREQ_SET_BUFFER  0x01   ///< OUT: store wLength bytes in ctrlBuf
+#define VREQ_GET_BUFFER  0x02   ///< IN: read back up to wLength bytes
+#define VREQ_NOTIFY      0x03   ///< Queue an 8 byte packet on EP1 IN
+
+#define CTRL_BUF_SIZE    256
+#define LOOP_BUF_SIZE    1024
+
+SI_SEGMENT_VARIABLE(deviceDesc[],
+                    const USB_DeviceDescriptor_TypeDef,
+                    SI_SEG_CODE) =
+{
+  USB_DEVICE_DESCSIZE,             // bLength
+  USB_DEVICE_DESCRIPTOR,           // bDescriptorType
+  htole16(0x0200),                 // bcdUSB
+  0xFF,                            // bDeviceClass (vendor specific)
+  0,                               // bDeviceSubClass
+  0,                               // bDeviceProtocol
+  USB_EP0_SIZE,                    // bMaxPacketSize0
+  htole16(VENDOR_ID),              // idVendor
+  htole16(PRODUCT_ID),             // idProduct
+  htole16(0x0100),                 // bcdDevice
+  1,                               // iManufacturer
+  2,                               // iProduct
+  3,                               // iSerialNumber
+  1,                               // bNumConfigurations
+};
+
+SI_SEGMENT_VARIABLE(configDesc[], const uint8_t, SI_SEG_CODE) =
+{
+  USB_CONFIG_DESCSIZE,             // bLength
+  USB_CONFIG_DESCRIPTOR,           // bDescriptorType
+  USB_CONFIG_DESCSIZE + USB_INTERFACE_DESCSIZE + 3 * USB_ENDPOINT_DESCSIZE,
+  0x00,                            // wTotalLength (MSB)
+  1,                               // bNumInterfaces
+  1,                               // bConfigurationValue
+  0,                               // iConfiguration
+  CONFIG_DESC_BM_RESERVED_D7 | CONFIG_DESC_BM_REMOTEWAKEUP,
+  CONFIG_DESC_MAXPOWER_mA(100),    // bMaxPower
+
+  USB_INTERFACE_DESCSIZE,          // bLength
+  USB_INTERFACE_DESCRIPTOR,        // bDescriptorType
+  0,                               // bInterfaceNumber
+  0,                               // bAlternateSetting
+  3,                               // bNumEndpoints
+  0xFF,                            // bInterfaceClass (vendor specific)
+  0,                               // bInterfaceSubClass
+  0,                               // bInterfaceProtocol
+  0,                               // iInterface
+
+  USB_ENDPOINT_DESCSIZE,           // bLength
+  USB_ENDPOINT_DESCRIPTOR,         // bDescriptorType
+  EP1IN,                           // bEndpointAddress
+  USB_EPTYPE_INTR,                 // bmAttributes
+  SLAB_USB_EP1IN_MAX_PACKET_SIZE,  // wMaxPacketSize (LSB)
+  0,                               // wMaxPacketSize (MSB)
+  1,                               // bInterval
+
+  USB_ENDPOINT_DESCSIZE,           // bLength
+  USB_ENDPOINT_DESCRIPTOR,         // bDescriptorType
+  EP2IN,                           // bEndpointAddress
+  USB_EPTYPE_BULK,                 // bmAttributes
+  SLAB_USB_EP2IN_MAX_PACKET_SIZE,  // wMaxPacketSize (LSB)
+  0,                               // wMaxPacketSize (MSB)
+  0,                               // bInterval
+
+  USB_ENDPOINT_DESCSIZE,           // bLength
+  USB_ENDPOINT_DESCRIPTOR,         // bDescriptorType
+  EP2OUT,                          // bEndpointAddress
+  USB_EPTYPE_BULK,                 // bmAttributes
+  SLAB_USB_EP2OUT_MAX_PACKET_SIZE, // wMaxPacketSize (LSB)
+  0,                               // wMaxPacketSize (MSB)
+  0,                               // bInterval
+};
+
+#define LANG_STRING   htole16(SLAB_USB_LANGUAGE)
+#define MFR_STRING    'S','i','l','i','c','o','n',' ','L','a','b','o','r','a','t','o','r','i','e','s','\0'
+#define MFR_SIZE      21
+// 64 bytes: sent as one full packet and a zero length packet
+#define PROD_STRING   'F','3','x','x',' ','U','S','B','0',' ','C','o','r','e',' ','L','o','o','p','b','a','c','k',' ','D','e','v','i','c','e','!','\0'
+#define PROD_SIZE     32
+#define SER_STRING    '0','0','0','1','\0'
+#define SER_SIZE      5
+
+LANGID_STATIC_CONST_STRING_DESC(langDesc[], LANG_STRING);
+UTF16LE_PACKED_STATIC_CONST_STRING_DESC(mfrDesc[], MFR_STRING, MFR_SIZE);
+UTF16LE_PACKED_STATIC_CONST_STRING_DESC(prodDesc[], PROD_STRING, PROD_SIZE);
+UTF16LE_PACKED_STATIC_CONST_STRING_DESC(serDesc[], SER_STRING, SER_SIZE);
+
+SI_SEGMENT_POINTER(stringTable[],
+                   static const USB_StringDescriptor_TypeDef,
+                   const SI_SEG_CODE) =
+{
+  langDesc,
+  mfrDesc,
+  prodDesc,
+  serDesc,
+};
+
+SI_SEGMENT_VARIABLE(initstruct,
+                    const USBD_Init_TypeDef,
+                    SI_SEG_CODE) =
+{
+  deviceDesc,
+  configDesc,
+  stringTable,
+  sizeof(stringTable) / sizeof(stringTable[0])
+};
+
+// -----------------------------------------------------------------------------
+// Firmware: application
+// -----------------------------------------------------------------------------
+
+extern void usbIrqHandler(void);
+
+static uint8_t ctrlBuf[CTRL_BUF_SIZE];
+static uint16_t ctrlLength;
+// One packet more than the largest transfer, so that a transfer of exactly
+// LOOP_BUF_SIZE bytes ends with its zero length packet, not a full buffer
+static uint8_t loopBuf[LOOP_BUF_SIZE + SLAB_USB_EP2OUT_MAX_PACKET_SIZE];
+static bool loopZlp;
+static uint8_t notify[SLAB_USB_EP1IN_MAX_PACKET_SIZE];
+static unsigned stateChanges;
+
+static void armLoopback(void)
+{
+  USBD_Read(EP2OUT, loopBuf, sizeof(loopBuf), true);
+}
+
+void USBD_DeviceStateChangeCb(USBD_State_TypeDef oldState,
+                              USBD_State_TypeDef newState)
+{
+  stateChanges++;
+  if ((newState == USBD_STATE_CONFIGURED)
+      && (oldState != USBD_STATE_SUSPENDED))
+  {
+    loopZlp = false;
+    armLoopback();
+  }
+}
+
+USB_Status_TypeDef USBD_SetupCmdCb(SI_VARIABLE_SEGMENT_POINTER(
+                                     setup,
+                                     USB_Setup_TypeDef,
+                                     MEM_MODEL_SEG))
+{
+  if ((setup->bmRequestType.Type != USB_SETUP_TYPE_VENDOR)
+      || (setup->bmRequestType.Recipient != USB_SETUP_RECIPIENT_DEVICE))
+  {
+    return USB_STATUS_REQ_UNHANDLED;
+  }
+
+  switch (setup->bRequest)
+  {
+    case VREQ_SET_BUFFER:
+      if ((setup->bmRequestType.Direction == USB_SETUP_DIR_OUT)
+          && (setup->wLength <= sizeof(ctrlBuf)))
+      {
+        ctrlLength = setup->wLength;
+        USBD_Read(EP0, ctrlBuf, setup->wLength, false);
+        return USB_STATUS_OK;
+      }
+      break;
+
+    case VREQ_GET_BUFFER:
+      if (setup->bmRequestType.Direction == USB_SETUP_DIR_IN)
+      {
+        USBD_Write(EP0, ctrlBuf, EFM8_MIN(ctrlLength, setup->wLength), false);
+        return USB_STATUS_OK;
+      }
+      break;
+
+    case VREQ_NOTIFY:
+      if ((setup->bmRequestType.Direction == USB_SETUP_DIR_OUT)
+          && (setup->wLength == 0)
+          && (USBD_Write(EP1IN, notify, sizeof(notify), false)
+              == USB_STATUS_OK))
+      {
+        return USB_STATUS_OK;
+      }
+      break;
+  }
+
+  return USB_STATUS_REQ_UNHANDLED;
+}
+
+uint16_t USBD_XferCompleteCb(uint8_t epAddr,
+                             USB_Status_TypeDef status,
+                             uint16_t xferred,
+                             uint16_t remaining)
+{
+  UNREFERENCED_ARGUMENT(remaining);
+
+  if (status != USB_STATUS_OK)
+  {
+    return 0;
+  }
+
+  if (epAddr == EP2OUT)
+  {
+    // Echo the transfer; one that fills whole packets needs a ZLP to end it
+    loopZlp = (xferred != 0)
+              && ((xferred % SLAB_USB_EP2IN_MAX_PACKET_SIZE) == 0);
+    USBD_Write(EP2IN, loopBuf, xferred, true);
+  }
+  else if (epAddr == EP2IN)
+  {
+    if (loopZlp)
+    {
+      loopZlp = false;
+      USBD_Write(EP2IN, loopBuf, 0, true);
+    }
+    else
+    {
+      armLoopback();
+    }
+  }
+  return 0;
+}
+
+void USBD_RemoteWakeupDelay(void)
+{
+}
+
+// -----------------------------------------------------------------------------
+// Virtual host checks
+// -----------------------------------------------------------------------------
+
+static bool verbose;
+static unsigned failures;
+static unsigned long sieErrors;
+
+#define CHECK(cond)                                                           \
+  do                                                                          \
+  {                                                                           \
+    if (!(cond))                                                              \
+    {                                                                         \
+      fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond);\
+      failures++;                                                             \
+    }                                                                         \
+  } while (0)
+
+static void begin(const char *name)
+{
+  if (verbose)
+  {
+    printf("%s\n", name);
+  }
+}
+
+static void makeSetup(uint8_t setup[8], uint8_t type, uint8_t request,
+                      uint16_t value, uint16_t index, uint16_t length)
+{
+  setup[0] = type;
+  setup[1] = request;
+  setup[2] = (uint8_t)value;
+  setup[3] = (uint8_t)(value >> 8);
+  setup[4] = (uint8_t)index;
+  setup[5] = (uint8_t)(index >> 8);
+  setup[6] = (uint8_t)length;
+  setup[7] = (uint8_t)(length >> 8);
+}
+
+static int request(uint8_t type, uint8_t req, uint16_t value, uint16_t index,
+                   uint8_t *data, uint16_t length, uint16_t *xferred)
+{
+  uint8_t setup[8];
+  uint16_t dummy;
+
+  makeSetup(setup, type, req, value, index, length);
+  return usb0sim_control(setup, data, xferred ? xferred : &dummy);
+}
+
+static void fill(uint8_t *buf, uint16_t size, uint8_t seed)
+{
+  uint16_t i;
+
+  for (i = 0; i < size; i++)
+  {
+    buf[i] = (uint8_t)(seed + i * 7);
+  }
+}
+
+// Sends size bytes through the EP2 loopback and checks the echo
+static bool loopback(uint16_t size, uint8_t seed)
+{
+  static uint8_t tx[LOOP_BUF_SIZE];
+  static uint8_t rx[LOOP_BUF_SIZE + 64];
+  uint16_t length = 0xFFFF;
+  int rc;
+
+  fill(tx, size, seed);
+  rc = usb0sim_bulkOut(2, tx, size, true);
+  if (rc != USB0SIM_ACK)
+  {
+    fprintf(stderr, "loopback of %u bytes: OUT failed (%d)\n", size, rc);
+    return false;
+  }
+  rc = usb0sim_bulkIn(2, rx, sizeof(rx), &length);
+  if (rc != USB0SIM_ACK)
+  {
+    fprintf(stderr, "loopback of %u bytes: IN failed (%d)\n", size, rc);
+    return false;
+  }
+  if ((length != size) || memcmp(tx, rx, size))
+  {
+    fprintf(stderr, "loopback of %u bytes: %u bytes came back%s\n",
+            size, length, (length == size) ? " with wrong data" : "");
+    return false;
+  }
+  return true;
+}
+
+static void testEnumeration(Usb0Sim_Device_t *dev)
+{
+  begin("enumeration");
+  CHECK(usb0sim_attached());
+  CHECK(usb0sim_enumerate(5, dev) == USB0SIM_ACK);
+  CHECK(dev->address == 5);
+  CHECK(dev->device[8] == (uint8_t)VENDOR_ID);
+  CHECK(dev->device[10] == (uint8_t)PRODUCT_ID);
+  CHECK(dev->configLength == configDesc[2]);
+  CHECK(USBD_GetUsbState() == USBD_STATE_CONFIGURED);
+}
+
+static void testStandardRequests(void)
+{
+  uint8_t buf[64];
+  uint16_t length;
+
+  begin("standard requests");
+
+  // Bus powered, remote wakeup not yet enabled
+  CHECK(request(0x80, GET_STATUS, 0, 0, buf, 2, &length) == USB0SIM_ACK);
+  CHECK((length == 2) && (buf[0] == 0) && (buf[1] == 0));
+  CHECK(request(0x80, GET_CONFIGURATION, 0, 0, buf, 1, &length)
+        == USB0SIM_ACK);
+  CHECK((length == 1) && (buf[0] == 1));
+  CHECK(request(0x81, GET_INTERFACE, 0, 0, buf, 1, &length) == USB0SIM_ACK);
+  CHECK((length == 1) && (buf[0] == 0));
+  CHECK(request(0x82, GET_STATUS, 0, EP2IN, buf, 2, &length) == USB0SIM_ACK);
+  CHECK((length == 2) && (buf[0] == 0));
+
+  // Short reads of a descriptor stop at wLength
+  CHECK(request(0x80, GET_DESCRIPTOR, USB_CONFIG_DESCRIPTOR << 8, 0,
+                buf, 9, &length) == USB0SIM_ACK);
+  CHECK((length == 9) && (buf[1] == USB_CONFIG_DESCRIPTOR));
+
+  // Unsupported requests stall, and EP0 recovers at the next setup
+  CHECK(request(0x80, GET_DESCRIPTOR, (USB_STRING_DESCRIPTOR << 8) | 9, 0,
+                buf, 64, NULL) == USB0SIM_STALL);
+  CHECK(request(0xC0, 0x7F, 0, 0, buf, 8, NULL) == USB0SIM_STALL);
+  CHECK(request(0x40, VREQ_SET_BUFFER, 0, 0, buf, CTRL_BUF_SIZE + 1, NULL)
+        == USB0SIM_STALL);
+  CHECK(request(0x82, GET_STATUS, 0, 0x85, buf, 2, NULL) == USB0SIM_STALL);
+  CHECK(request(0x80, GET_STATUS, 0, 0, buf, 2, &length) == USB0SIM_ACK);
+
+  // Remote wakeup feature
+  CHECK(request(0x00, SET_FEATURE, USB_FEATURE_DEVICE_REMOTE_WAKEUP, 0,
+                NULL, 0, NULL) == USB0SIM_ACK);
+  CHECK(request(0x80, GET_STATUS, 0, 0, buf, 2, &length) == USB0SIM_ACK);
+  CHECK((length == 2) && (buf[0] == 2));
+}
+
+static void testControlData(void)
+{
+  uint8_t tx[CTRL_BUF_SIZE];
+  uint8_t rx[CTRL_BUF_SIZE];
+  static const uint16_t sizes[] = { 0, 1, 63, 64, 65, 128, 200, 256 };
+  unsigned i;
+  uint16_t length;
+
+  begin("control transfers");
+
+  for (i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+  {
+    fill(tx, sizes[i], (uint8_t)i);
+    CHECK(request(0x40, VREQ_SET_BUFFER, 0, 0, tx, sizes[i], &length)
+          == USB0SIM_ACK);
+    CHECK(length == sizes[i]);
+
+    // Asking for more than there is ends with a short or zero length packet
+    memset(rx, 0, sizeof(rx));
+    CHECK(request(0xC0, VREQ_GET_BUFFER, 0, 0, rx, sizeof(rx), &length)
+          == USB0SIM_ACK);
+    CHECK((length == sizes[i]) && !memcmp(tx, rx, sizes[i]));
+
+    // Asking for less stops at wLength
+    if (sizes[i] > 1)
+    {
+      CHECK(request(0xC0, VREQ_GET_BUFFER, 0, 0, rx, sizes[i] - 1, &length)
+            == USB0SIM_ACK);
+      CHECK(length == sizes[i] - 1);
+    }
+  }
+}
+
+static void testBulk(void)
+{
+  static const uint16_t sizes[] =
+  {
+    0, 1, 63, 64, 65, 127, 128, 129, 200, 511, 512, 513, 1000, 1024
+  };
+  unsigned i;
+
+  begin("bulk loopback");
+
+  for (i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+  {
+    CHECK(loopback(sizes[i], (uint8_t)(i * 13)));
+  }
+}
+
+static void testInterrupt(void)
+{
+  uint8_t buf[64];
+  uint16_t length;
+
+  begin("interrupt endpoint");
+
+  fill(notify, sizeof(notify), 0xA0);
+  CHECK(request(0x40, VREQ_NOTIFY, 0, 0, NULL, 0, NULL) == USB0SIM_ACK);
+  CHECK(usb0sim_bulkIn(1, buf, sizeof(notify), &length) == USB0SIM_ACK);
+  CHECK((length == sizeof(notify)) && !memcmp(buf, notify, sizeof(notify)));
+
+  // Nothing queued: the endpoint NAKs until the host gives up
+  usb0sim_setRetries(20);
+  CHECK(usb0sim_bulkIn(1, buf, sizeof(notify), &length) == USB0SIM_TIMEOUT);
+  usb0sim_setRetries(10000);
+}
+
+static void testHalt(void)
+{
+  uint8_t buf[64];
+  uint16_t length;
+
+  begin("endpoint halt");
+
+  // A halted IN endpoint stalls until CLEAR_FEATURE resets its toggle
+  CHECK(request(0x02, SET_FEATURE, USB_FEATURE_ENDPOINT_HALT, EP2IN,
+                NULL, 0, NULL) == USB0SIM_ACK);
+  CHECK(request(0x82, GET_STATUS, 0, EP2IN, buf, 2, &length) == USB0SIM_ACK);
+  CHECK((length == 2) && (buf[0] == 1));
+  CHECK(usb0sim_bulkIn(2, buf, sizeof(buf), &length) == USB0SIM_STALL);
+  CHECK(request(0x02, CLEAR_FEATURE, USB_FEATURE_ENDPOINT_HALT, EP2IN,
+                NULL, 0, NULL) == USB0SIM_ACK);
+  CHECK(request(0x82, GET_STATUS, 0, EP2IN, buf, 2, &length) == USB0SIM_ACK);
+  CHECK((length == 2) && (buf[0] == 0));
+  CHECK(loopback(100, 1));
+
+  // Halting the OUT endpoint aborts the armed read; the firmware rearms it
+  // when the host clears the halt
+  CHECK(request(0x02, SET_FEATURE, USB_FEATURE_ENDPOINT_HALT, EP2OUT,
+                NULL, 0, NULL) == USB0SIM_ACK);
+  CHECK(usb0sim_bulkOut(2, buf, 10, false) == USB0SIM_STALL);
+  CHECK(request(0x02, CLEAR_FEATURE, USB_FEATURE_ENDPOINT_HALT, EP2OUT,
+                NULL, 0, NULL) == USB0SIM_ACK);
+  if (!USBD_EpIsBusy(EP2OUT))
+  {
+    armLoopback();
+  }
+  CHECK(loopback(130, 2));
+
+  // EP0 cannot be halted with SET_FEATURE
+  CHECK(request(0x02, SET_FEATURE, USB_FEATURE_ENDPOINT_HALT, 0,
+                NULL, 0, NULL) == USB0SIM_STALL);
+}
+
+static void testSuspend(void)
+{
+  unsigned changes;
+
+  begin("suspend and remote wakeup");
+
+  changes = stateChanges;
+  usb0sim_suspend();
+  CHECK(USBD_GetUsbState() == USBD_STATE_SUSPENDED);
+  CHECK(USBD_RemoteWakeup() == USB_STATUS_OK);
+  CHECK(usb0sim_wakeupSignaled());
+  CHECK(USBD_GetUsbState() == USBD_STATE_CONFIGURED);
+  CHECK(loopback(64, 3));
+
+  // Host initiated resume
+  usb0sim_suspend();
+  CHECK(USBD_GetUsbState() == USBD_STATE_SUSPENDED);
+  usb0sim_resume();
+  CHECK(USBD_GetUsbState() == USBD_STATE_CONFIGURED);
+  CHECK(stateChanges == changes + 4);
+  CHECK(loopback(65, 4));
+
+  // Remote wakeup is refused once the host disables it
+  CHECK(request(0x00, CLEAR_FEATURE, USB_FEATURE_DEVICE_REMOTE_WAKEUP, 0,
+                NULL, 0, NULL) == USB0SIM_ACK);
+  usb0sim_suspend();
+  CHECK(USBD_RemoteWakeup() == USB_STATUS_ILLEGAL);
+  usb0sim_resume();
+}
+
+static void testReset(Usb0Sim_Device_t *dev)
+{
+  uint8_t buf[64];
+
+  begin("bus reset");
+
+  // A reset in the middle of a transfer returns the device to its default
+  // state; it enumerates again with its endpoints rearmed
+  fill(buf, sizeof(buf), 0);
+  CHECK(usb0sim_bulkOut(2, buf, sizeof(buf), false) == USB0SIM_ACK);
+  usb0sim_busReset();
+  CHECK(USBD_GetUsbState() == USBD_STATE_DEFAULT);
+  CHECK(usb0sim_enumerate(9, dev) == USB0SIM_ACK);
+  CHECK(loopback(300, 5));
+}
+
+// -----------------------------------------------------------------------------
+// Benchmark
+// -----------------------------------------------------------------------------
+
+static double now(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void benchmark(unsigned long bytes, uint16_t size)
+{
+  static uint8_t tx[LOOP_BUF_SIZE];
+  static uint8_t rx[LOOP_BUF_SIZE + 64];
+  unsigned long done = 0;
+  unsigned long transfers = 0;
+  uint16_t length;
+  const Usb0Sim_Stats_t *stats;
+  double start;
+  double elapsed;
+  double total;
+
+  fill(tx, size, 0x5A);
+  sieErrors += usb0sim_stats()->errors;
+  usb0sim_clearStats();
+  start = now();
+
+  while (done < bytes)
+  {
+    if ((usb0sim_bulkOut(2, tx, size, true) != USB0SIM_ACK)
+        || (usb0sim_bulkIn(2, rx, sizeof(rx), &length) != USB0SIM_ACK)
+        || (length != size))
+    {
+      fprintf(stderr, "benchmark: loopback failed after %lu bytes\n", done);
+      failures++;
+      return;
+    }
+    done += size;
+    transfers++;
+  }
+
+  elapsed = now() - start;
+  stats = usb0sim_stats();
+
+  // Both directions move the data once
+  total = 2.0 * done;
+  printf("Benchmark: %lu bytes in %lu transfers of %u bytes, EP2 %s "
+         "buffered\n", done, transfers, size,
+         SLAB_USB_EP2IN_DOUBLE_BUFFERED ? "double" : "single");
+  printf("  USB0ADR accesses per byte  %8.3f\n", stats->adrAccesses / total);
+  printf("  USB0DAT accesses per byte  %8.3f\n", stats->datAccesses / total);
+  printf("  interrupts per packet      %8.3f\n",
+         (double)stats->interrupts / (stats->packetsIn + stats->packetsOut));
+  printf("  NAKs per packet            %8.3f\n",
+         (double)stats->naks / (stats->packetsIn + stats->packetsOut));
+  printf("  packets in / out           %8lu / %lu\n",
+         stats->packetsIn, stats->packetsOut);
+  printf("  host time per byte         %8.1f ns\n", elapsed * 1e9 / total);
+}
+
+// -----------------------------------------------------------------------------
+// Main
+// -----------------------------------------------------------------------------
+
+int main(int argc, char *argv[])
+{
+  Usb0Sim_Device_t dev;
+  unsigned long bytes = 1024UL * 1024UL;
+  unsigned long size = LOOP_BUF_SIZE;
+  int opt;
+
+  while ((opt = getopt(argc, argv, "n:s:v")) != -1)
+  {
+    switch (opt)
+    {
+      case 'n':
+        bytes = strtoul(optarg, NULL, 0);
+        break;
+      case 's':
+        size = strtoul(optarg, NULL, 0);
+        break;
+      case 'v':
+        verbose = true;
+        break;
+      default:
+        fprintf(stderr, "usage: usb0_test [-n BYTES] [-s SIZE] [-v]\n");
+        return 2;
+    }
+  }
+  if ((size == 0) || (size > LOOP_BUF_SIZE))
+  {
+    fprintf(stderr, "usb0_test: SIZE must be 1-%u\n", LOOP_BUF_SIZE);
+    return 2;
+  }
+
+  usb0sim_init(usbIrqHandler);
+  USBD_Init(&initstruct);
+  IE_EA = 1;
+
+  testEnumeration(&dev);
+  testStandardRequests();
+  testControlData();
+  testBulk();
+  testInterrupt();
+  testHalt();
+  testSuspend();
+  testReset(&dev);
+
+  if (bytes)
+  {
+    benchmark(bytes, (uint16_t)size);
+  }
+
+  sieErrors += usb0sim_stats()->errors;
+  if (sieErrors)
+  {
+    fprintf(stderr, "usb0_test: %lu SIE errors\n", sieErrors);
+  }
+  if (failures || sieErrors)
+  {
+    fprintf(stderr, "usb0_test: FAILED\n");
+    return 1;
+  }
+  printf("usb0_test: all checks passed\n");
+  return 0;
+}
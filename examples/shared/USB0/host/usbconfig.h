@@ -0,0 +1,43 @@
+/******************************************************************************
+ * Copyright (c) 2021 by Silicon Laboratories Inc. All rights reserved.
+ *
+ * http://developer.silabs.com/legal/version/v11/Silicon_Labs_Software_License_Agreement.txt
+ *****************************************************************************/
+
+#ifndef __SILICON_LABS_USBCONFIG_H
+#define __SILICON_LABS_USBCONFIG_H
+
+// USB device core configuration of the usb0_test loopback device: a bulk
+// IN/OUT pair on EP2 and an interrupt IN endpoint on EP1. Build with
+// -DSIM_DOUBLE_BUFFERED=0 to measure single buffered EP2 FIFOs.
+
+#ifndef SIM_DOUBLE_BUFFERED
+#define SIM_DOUBLE_BUFFERED                    1
+#endif
+
+#define SLAB_USB_BUS_POWERED                   1
+#define SLAB_USB_FULL_SPEED                    1
+#define SLAB_USB_CLOCK_RECOVERY_ENABLED        1
+#define SLAB_USB_REMOTE_WAKEUP_ENABLED         1
+#define SLAB_USB_NUM_INTERFACES                1
+#define SLAB_USB_SUPPORT_ALT_INTERFACES        0
+
+#define SLAB_USB_EP1IN_USED                    1
+#define SLAB_USB_EP1IN_MAX_PACKET_SIZE         8
+#define SLAB_USB_EP1IN_TRANSFER_TYPE           USB_EPTYPE_INTR
+#define SLAB_USB_EP2IN_USED                    1
+#define SLAB_USB_EP2IN_MAX_PACKET_SIZE         64
+#define SLAB_USB_EP2IN_TRANSFER_TYPE           USB_EPTYPE_BULK
+#define SLAB_USB_EP2IN_DOUBLE_BUFFERED         SIM_DOUBLE_BUFFERED
+#define SLAB_USB_EP2OUT_USED                   1
+#define SLAB_USB_EP2OUT_MAX_PACKET_SIZE        64
+#define SLAB_USB_EP2OUT_TRANSFER_TYPE          USB_EPTYPE_BULK
+#define SLAB_USB_EP2OUT_DOUBLE_BUFFERED        SIM_DOUBLE_BUFFERED
+
+#define SLAB_USB_SETUP_CMD_CB                  1
+#define SLAB_USB_STATE_CHANGE_CB               1
+
+#define SLAB_USB_NUM_LANGUAGES                 1
+#define SLAB_USB_LANGUAGE                      USB_LANGID_ENUS
+
+#endif // __SILICON_LABS_USBCONFIG_H